@@ -0,0 +1,85 @@
+﻿#include "Commands.h"
+#include "AnimationAssembler.h"
+#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include <iostream>
+
+// JPEG 연속 프레임 -> 애니메이션 WebP 한 개
+//   WebPCli animate burst/ --out burst.webp [--fps 10 | --frame-ms 100] [--loop 0]
+//   폴더는 이름순으로 프레임이 된다. 파일을 직접 나열하면 나열한 순서대로.
+//   --window N: 준비했지만 아직 인코더에 넣지 않은 프레임 수 상한 (최대 메모리 ~ N x 폭 x 높이 x 4 바이트)
+
+int RunAnimate(const CliArgs& args)
+{
+    const std::string strOutPath = args.GetString("out");
+    if (strOutPath.empty())
+    {
+        std::cerr << "Error: --out 에 결과 .webp 경로가 필요합니다.\n";
+        return 2;
+    }
+
+    const std::vector<std::string> vecPath = CollectJpegInputs(args);
+    if (vecPath.empty())
+    {
+        std::cerr << "Error: 프레임으로 쓸 JPEG 이 없습니다.\n";
+        return 2;
+    }
+
+    AnimationOption option;
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", 0));
+    option.nWindow = static_cast<int>(args.GetInt("window", 0));
+    option.nLoopCount = static_cast<int>(args.GetInt("loop", 0));
+    option.bMinimizeSize = args.Has("minimize-size");
+    if (args.Has("fps"))
+    {
+        const double fFps = args.GetDouble("fps", 10.0);
+        if (fFps <= 0.0 || fFps > 1000.0)
+        {
+            std::cerr << "Error: --fps 는 0 보다 크고 1000 이하여야 합니다.\n";
+            return 2;
+        }
+        option.nFrameMs = static_cast<int>(1000.0 / fFps + 0.5);
+    }
+    option.nFrameMs = static_cast<int>(args.GetInt("frame-ms", option.nFrameMs));
+    if (option.nFrameMs <= 0 || option.nLoopCount < 0 || option.nLoopCount > 65535)
+    {
+        std::cerr << "Error: --frame-ms 는 1 이상, --loop 는 0..65535 여야 합니다.\n";
+        return 2;
+    }
+
+    ConvertOption convertOption;
+    convertOption.fQuality = static_cast<float>(args.GetDouble("quality", convertOption.fQuality));
+    if (!ApplyDecoderOption(args, convertOption) || !ApplyEncoderOption(args, convertOption))
+        return 2;
+    ConvertEngine engine(convertOption);
+
+    FileListSource source(vecPath);
+    AnimationAssembler assembler(engine, option);
+    std::vector<uint8_t> vecWebp;
+    AnimationStats stats;
+    const bool bOk = assembler.Run(source, vecWebp, stats);
+
+    std::cout << "frames=" << stats.nEncoded << " skipped=" << stats.nSkipped << " size=" << stats.nWidth << "x" << stats.nHeight
+        << " in=" << stats.nInputBytes << "B out=" << stats.nOutputBytes << "B " << stats.fElapsedSec << "s ("
+        << stats.GetFramesPerSec() << " frames/s)\n";
+    std::cout << "animate: window=" << stats.nWindow << " peak_frames=" << stats.nPeakFrames << " peak_frame_mb=" << (stats.nPeakFrameBytes >> 20)
+        << " prepare=" << stats.durationPrepare.count() / 1000 << "ms encode=" << stats.durationEncode.count() / 1000
+        << "ms wait=" << stats.durationWait.count() / 1000 << "ms\n";
+
+    if (!bOk)
+    {
+        std::cerr << "Error: 애니메이션을 만들지 못했습니다: " << stats.strError << "\n";
+        return 1;
+    }
+
+    if (!WriteMemoryToFile(strOutPath, vecWebp.data(), vecWebp.size()))
+    {
+        std::cerr << "Error: 결과를 쓰지 못했습니다: " << strOutPath << "\n";
+        return 1;
+    }
+
+    if (stats.bSourceError)
+        std::cerr << "Error: 입력 일부를 읽지 못했습니다.\n";
+
+    return (stats.bSourceError || stats.nSkipped > 0) ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+// "--key value", "--flag", 위치 인자를 구분하는 간단한 명령행 파서
+class CliArgs
+{
+public:
+    CliArgs(int argc, char** argv, int nFirst)
+    {
+        for (int i = nFirst; i < argc; ++i)
+        {
+            std::string strArg = argv[i];
+            if (strArg.size() > 2 && strArg.compare(0, 2, "--") == 0)
+            {
+                std::string strKey = strArg.substr(2);
+                const size_t nEq = strKey.find('=');
+                if (nEq != std::string::npos)
+                    m_mapOption[strKey.substr(0, nEq)] = strKey.substr(nEq + 1);
+                else if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+                    m_mapOption[strKey] = argv[++i];
+                else
+                    m_mapOption[strKey] = "";
+            }
+            else
+            {
+                m_vecPositional.push_back(strArg);
+            }
+        }
+    }
+
+    bool Has(const std::string& strKey) const { return m_mapOption.count(strKey) != 0; }
+
+    std::string GetString(const std::string& strKey, const std::string& strDefault = "") const
+    {
+        auto it = m_mapOption.find(strKey);
+        return (it != m_mapOption.end()) ? it->second : strDefault;
+    }
+
+    long long GetInt(const std::string& strKey, long long nDefault) const
+    {
+        auto it = m_mapOption.find(strKey);
+        return (it != m_mapOption.end() && !it->second.empty()) ? std::strtoll(it->second.c_str(), nullptr, 10) : nDefault;
+    }
+
+    double GetDouble(const std::string& strKey, double fDefault) const
+    {
+        auto it = m_mapOption.find(strKey);
+        return (it != m_mapOption.end() && !it->second.empty()) ? std::strtod(it->second.c_str(), nullptr) : fDefault;
+    }
+
+    const std::vector<std::string>& GetPositional() const { return m_vecPositional; }
+    const std::map<std::string, std::string>& GetOptions() const { return m_mapOption; }
+
+private:
+    std::map<std::string, std::string> m_mapOption;
+    std::vector<std::string> m_vecPositional;
+};
@@ -0,0 +1,320 @@
+﻿#include "Commands.h"
+#include "AdaptiveQuality.h"
+#include "CropList.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "OutputWriter.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// 여러 하위 명령이 같이 쓰는 옵션 처리
+
+namespace
+{
+    // "2G", "512M", "1.5g", "65536" -> 바이트. 형식 오류면 false
+    bool ParseByteSize(const std::string& strText, uint64_t& nBytes)
+    {
+        char* pszEnd = nullptr;
+        const double fValue = std::strtod(strText.c_str(), &pszEnd);
+        if (pszEnd == strText.c_str() || fValue <= 0.0)
+            return false;
+
+        double fUnit = 1.0;
+        const std::string strUnit = pszEnd;
+        if (strUnit == "K" || strUnit == "k")
+            fUnit = 1024.0;
+        else if (strUnit == "M" || strUnit == "m")
+            fUnit = 1024.0 * 1024.0;
+        else if (strUnit == "G" || strUnit == "g")
+            fUnit = 1024.0 * 1024.0 * 1024.0;
+        else if (!strUnit.empty())
+            return false;
+
+        nBytes = static_cast<uint64_t>(fValue * fUnit);
+        return true;
+    }
+
+    double ToMegabytes(uint64_t nBytes)
+    {
+        return static_cast<double>(nBytes) / (1024.0 * 1024.0);
+    }
+}
+
+bool ApplyDecoderOption(const CliArgs& args, ConvertOption& option)
+{
+    option.strDecoder = args.GetString("decoder", option.strDecoder);
+    if (DecoderRegistry::Has(option.strDecoder))
+        return true;
+
+    std::cerr << "Error: 등록되지 않은 디코더입니다: " << option.strDecoder << " (사용 가능:";
+    for (const auto& strName : DecoderRegistry::GetNames())
+        std::cerr << " " << strName;
+    std::cerr << ")\n";
+    return false;
+}
+
+bool ApplyCropOption(const CliArgs& args, ConvertOption& option, CropList& cropList, PipelineOption& pipelineOption)
+{
+    if (args.Has("crop") && !CropList::ParseRegion(args.GetString("crop"), option.crop))
+    {
+        std::cerr << "Error: --crop 은 x,y,w,h 형식이어야 합니다: " << args.GetString("crop") << "\n";
+        return false;
+    }
+
+    if (args.Has("crop-list"))
+    {
+        if (!cropList.Load(args.GetString("crop-list")))
+            return false;
+        pipelineOption.pCropList = &cropList;
+    }
+    return true;
+}
+
+bool ApplyAdaptiveQualityOption(const CliArgs& args, ConvertOption& option)
+{
+    if (!args.Has("aq"))
+        return true;
+
+    auto pAdaptiveQuality = std::make_shared<AdaptiveQuality>();
+    const std::string strCurve = args.GetString("aq");
+    if (strCurve != "default" && !pAdaptiveQuality->Parse(strCurve))
+    {
+        std::cerr << "Error: --aq 는 \"복잡도:품질,...\" 형식이어야 합니다: " << strCurve << " (기본: " << AdaptiveQuality::DEFAULT_CURVE << ")\n";
+        return false;
+    }
+
+    pAdaptiveQuality->SetSourceMargin(static_cast<float>(args.GetDouble("aq-margin", pAdaptiveQuality->GetSourceMargin())));
+    option.pAdaptiveQuality = pAdaptiveQuality;
+    return true;
+}
+
+void PrintAdaptiveQualityStats(std::ostream& os, const ConvertOption& option, const PipelineStats& stats)
+{
+    if (!option.pAdaptiveQuality || stats.nConverted == 0)
+        return;
+
+    const auto work = stats.durationDecode + stats.durationEncode;
+    os << "aq: curve=" << option.pAdaptiveQuality->ToString() << " avg_quality=" << stats.fQualitySum / static_cast<double>(stats.nConverted)
+        << " analyze_overhead=" << (work.count() > 0 ? 100.0 * static_cast<double>(stats.durationAnalyze.count()) / static_cast<double>(work.count()) : 0.0) << "%\n";
+}
+
+bool ApplyVerifyOption(const CliArgs& args, ConvertOption& option)
+{
+    VerifyOption& verify = option.verify;
+    verify.fMinPsnr = args.GetDouble("min-psnr", verify.fMinPsnr);
+    verify.fMinSsim = args.GetDouble("min-ssim", verify.fMinSsim);
+    const bool bThreshold = verify.fMinPsnr > 0.0 || verify.fMinSsim > 0.0;
+    verify.nEvery = static_cast<int>(args.GetInt("verify", bThreshold ? 1 : 0));
+    verify.nTileSize = static_cast<int>(args.GetInt("verify-tile", verify.nTileSize));
+    verify.nTileEvery = static_cast<int>(args.GetInt("verify-tile-every", verify.nTileEvery));
+
+    if (verify.nEvery < 0 || verify.nTileSize < 0 || verify.nTileEvery <= 0 || verify.fMinSsim > 1.0)
+    {
+        std::cerr << "Error: 검증 옵션 값이 잘못되었습니다. (--verify N>=0, --verify-tile S>=0, --verify-tile-every K>0, --min-ssim <= 1)\n";
+        return false;
+    }
+    return true;
+}
+
+void PrintVerifyStats(std::ostream& os, const PipelineStats& stats)
+{
+    if (stats.nVerified == 0)
+        return;
+
+    const auto work = stats.durationDecode + stats.durationEncode;
+    os << "verify: sampled=" << stats.nVerified << " below_threshold=" << stats.nVerifyFailed
+        << " avg_psnr=" << stats.fPsnrSum / static_cast<double>(stats.nVerified) << " min_psnr=" << stats.fMinPsnr
+        << " avg_ssim=" << stats.fSsimSum / static_cast<double>(stats.nVerified) << " min_ssim=" << stats.fMinSsim
+        << " overhead=" << (work.count() > 0 ? 100.0 * static_cast<double>(stats.durationVerify.count()) / static_cast<double>(work.count()) : 0.0) << "%\n";
+}
+
+bool ApplyEncoderOption(const CliArgs& args, ConvertOption& option)
+{
+    if (args.Has("lossless"))
+    {
+        if (!ParseLosslessLevel(args.GetString("lossless"), option.nLosslessLevel))
+        {
+            std::cerr << "Error: --lossless 는 fast, default, max 또는 0-9 여야 합니다: " << args.GetString("lossless") << "\n";
+            return false;
+        }
+        option.bLossless = true;
+    }
+
+    if (!args.Has("encoder") || option.encoder.Parse(args.GetString("encoder")))
+        return true;
+
+    std::cerr << "Error: --encoder 는 \"key=value;...\" 형식이어야 합니다: " << args.GetString("encoder")
+        << " (키: method 0-6, filter_strength 0-100, sns_strength 0-100, segments 1-4, pass 1-10, thread_level 0-1)\n";
+    return false;
+}
+
+bool ApplyTraceOption(const CliArgs& args, ConvertOption& option, std::unique_ptr<TraceRecorder>& pTrace)
+{
+    if (!args.Has("trace"))
+        return true;
+
+    if (args.GetString("trace").empty())
+    {
+        std::cerr << "Error: --trace 에 출력 JSON 경로가 필요합니다.\n";
+        return false;
+    }
+
+    const long long nSpans = args.GetInt("trace-buffer", 65536);
+    if (nSpans <= 0)
+    {
+        std::cerr << "Error: --trace-buffer 는 1 이상이어야 합니다.\n";
+        return false;
+    }
+
+    pTrace.reset(new TraceRecorder(static_cast<size_t>(nSpans)));
+    option.pTrace = pTrace.get();
+    return true;
+}
+
+bool WriteTraceOption(std::ostream& os, const CliArgs& args, const TraceRecorder* pTrace)
+{
+    if (!pTrace)
+        return true;
+
+    const std::string strPath = args.GetString("trace");
+    std::ofstream file(strPath, std::ios::binary);
+    if (!file || !pTrace->WriteChromeTrace(file))
+    {
+        std::cerr << "Error: 추적 파일을 쓰지 못했습니다: " << strPath << "\n";
+        return false;
+    }
+
+    os << "trace: spans=" << pTrace->GetSpanCount() << " dropped=" << pTrace->GetDroppedCount() << " file=" << strPath << "\n";
+    return true;
+}
+
+bool ApplyMemoryBudgetOption(const CliArgs& args, ConvertOption& option, std::unique_ptr<MemoryBudget>& pBudget)
+{
+    if (!args.Has("mem-budget"))
+        return true;
+
+    // auto: 컨테이너/Job object 한도의 3/4 (나머지는 입력/출력 대기열과 프로세스 자체 몫)
+    const std::string strBudget = args.GetString("mem-budget");
+    uint64_t nBudget = 0;
+    if (strBudget == "auto")
+    {
+        nBudget = MemoryBudget::DetectSystemLimit() / 4 * 3;
+        if (nBudget == 0)
+        {
+            LogInfo("memory", "메모리 한도를 찾지 못해서 예산 없이 실행합니다. (--mem-budget auto)");
+            return true;
+        }
+    }
+    else if (!ParseByteSize(strBudget, nBudget))
+    {
+        std::cerr << "Error: --mem-budget 은 auto 또는 크기(예: 2G, 512M)여야 합니다: " << strBudget << "\n";
+        return false;
+    }
+
+    pBudget.reset(new MemoryBudget(nBudget));
+    option.pMemoryBudget = pBudget.get();
+    return true;
+}
+
+void PrintMemoryBudgetStats(std::ostream& os, const MemoryBudget* pBudget)
+{
+    if (!pBudget)
+        return;
+
+    const MemoryBudgetStats stats = pBudget->GetStats();
+    os << "memory: budget=" << ToMegabytes(stats.nBudget) << "MB peak_reserved=" << ToMegabytes(stats.nPeakReserved)
+        << "MB peak_actual=" << ToMegabytes(stats.nPeakActual) << "MB jobs=" << stats.nReservations << " waits=" << stats.nWaits
+        << " wait=" << static_cast<double>(stats.durationWait.count()) / 1e6 << "s oversize=" << stats.nOversize
+        << " underestimated=" << stats.nUnderestimated << "\n";
+}
+
+bool ApplyOutputWriterOption(const CliArgs& args, std::unique_ptr<OutputWriter>& pWriter)
+{
+    const int nWriters = static_cast<int>(args.GetInt("writers", 0));
+    if (nWriters <= 0)
+    {
+        if (args.Has("durability") || args.Has("scratch"))
+        {
+            std::cerr << "Error: --durability / --scratch 는 --writers N 과 함께 써야 합니다.\n";
+            return false;
+        }
+        return true;
+    }
+
+    OutputWriterOption option;
+    option.nWriterCount = nWriters;
+    option.strScratchDir = args.GetString("scratch");
+    option.nBatchFiles = static_cast<int>(args.GetInt("sync-batch", option.nBatchFiles));
+
+    const std::string strStage = args.GetString("stage", "256M");
+    const std::string strScratchSize = args.GetString("scratch-size", "4G");
+    if (!ParseByteSize(strStage, option.nQueueBytes) || !ParseByteSize(strScratchSize, option.nScratchBytes))
+    {
+        std::cerr << "Error: --stage / --scratch-size 는 크기(예: 256M, 4G)여야 합니다.\n";
+        return false;
+    }
+
+    const std::string strDurability = args.GetString("durability", "none");
+    if (!ParseWriteDurability(strDurability, option.eDurability))
+    {
+        std::cerr << "Error: --durability 는 none, batch, each 중 하나여야 합니다: " << strDurability << "\n";
+        return false;
+    }
+
+    pWriter.reset(new OutputWriter(option));
+    if (!pWriter->Start())
+    {
+        std::cerr << "Error: 임시 폴더를 만들 수 없습니다: " << option.strScratchDir << "\n";
+        return false;
+    }
+    return true;
+}
+
+void PrintOutputWriterStats(std::ostream& os, const OutputWriter* pWriter)
+{
+    if (!pWriter)
+        return;
+
+    const OutputWriterStats stats = pWriter->GetStats();
+    os << "write-behind: written=" << stats.nWritten << " failed=" << stats.nFailed << " batches=" << stats.nBatches
+        << " syncs=" << stats.nSyncs << " spilled=" << stats.nSpilled << " peak_queue=" << ToMegabytes(stats.nPeakQueueBytes)
+        << "MB peak_scratch=" << ToMegabytes(stats.nPeakScratchBytes) << "MB blocked=" << stats.nBlocked
+        << " (" << static_cast<double>(stats.durationBlocked.count()) / 1e6 << "s)\n";
+}
+
+bool ApplyLogOption(const CliArgs& args)
+{
+    LogOption option;
+
+    const std::string strLevel = args.GetString("log-level", "info");
+    const char* const levelNames[] = { "debug", "info", "warn", "error", "off" };
+    const auto itLevel = std::find(std::begin(levelNames), std::end(levelNames), strLevel);
+    if (itLevel == std::end(levelNames))
+    {
+        std::cerr << "Error: --log-level 은 debug, info, warn, error, off 중 하나여야 합니다: " << strLevel << "\n";
+        return false;
+    }
+    option.eLevel = static_cast<LOG_LEVEL>(itLevel - std::begin(levelNames));
+
+    const std::string strFormat = args.GetString("log-format", "text");
+    if (strFormat != "text" && strFormat != "kv")
+    {
+        std::cerr << "Error: --log-format 은 text 또는 kv 여야 합니다: " << strFormat << "\n";
+        return false;
+    }
+    option.eFormat = (strFormat == "kv") ? LOG_FORMAT_KV : LOG_FORMAT_TEXT;
+
+    option.nBurst = static_cast<int>(args.GetInt("log-burst", option.nBurst));
+    option.fPerSecond = args.GetDouble("log-rate", option.fPerSecond);
+    if (option.nBurst < 1 || option.fPerSecond < 0.0)
+    {
+        std::cerr << "Error: --log-burst 는 1 이상, --log-rate 는 0 이상이어야 합니다.\n";
+        return false;
+    }
+
+    Logger::Configure(option);
+    return true;
+}
@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include "CliArgs.h"
+#include "BatchPipeline.h"
+#include "ConvertEngine.h"
+#include <iosfwd>
+#include <memory>
+
+class CorpusIndex;
+class MemoryBudget;
+class OutputWriter;
+struct CorpusSummary;
+class TraceRecorder;
+
+// WebPCli 하위 명령. 반환값은 프로세스 종료 코드.
+int RunConvert(const CliArgs& args);
+int RunAnimate(const CliArgs& args);
+int RunServe(const CliArgs& args);
+int RunBenchHttp(const CliArgs& args);
+int RunStream(const CliArgs& args);
+int RunFrame(const CliArgs& args);
+int RunUnframe(const CliArgs& args);
+int RunPackGet(const CliArgs& args);
+int RunBenchPack(const CliArgs& args);
+int RunBenchDecode(const CliArgs& args);
+int RunSweep(const CliArgs& args);
+int RunGenCorpus(const CliArgs& args);
+int RunIndex(const CliArgs& args);
+int RunBenchPlacement(const CliArgs& args);
+int RunBenchKernels(const CliArgs& args);
+int RunBenchLossless(const CliArgs& args);
+int RunShardPlan(const CliArgs& args);
+int RunShardWork(const CliArgs& args);
+int RunShardRun(const CliArgs& args);
+int RunShardMerge(const CliArgs& args);
+
+// --decoder 이름을 option 에 반영. 등록되지 않은 백엔드면 오류를 출력하고 false
+bool ApplyDecoderOption(const CliArgs& args, ConvertOption& option);
+
+// --crop x,y,w,h (모든 항목) 과 --crop-list 파일 (항목별) 을 반영. 형식 오류면 false
+bool ApplyCropOption(const CliArgs& args, ConvertOption& option, CropList& cropList, PipelineOption& pipelineOption);
+
+// --encoder "method=4;sns_strength=50" (sweep 으로 고른 libwebp 세부 설정) 과
+// --lossless fast|default|max|0-9 (원래 그레이 값 그대로 무손실 인코딩, bench-lossless 로 수준 비교) 를 반영. 형식 오류면 false
+bool ApplyEncoderOption(const CliArgs& args, ConvertOption& option);
+
+// --aq <곡선 | default> 와 --aq-margin N 을 반영 (이미지별 적응형 품질). 곡선 형식 오류면 false
+bool ApplyAdaptiveQualityOption(const CliArgs& args, ConvertOption& option);
+
+// 적응형 품질을 쓴 실행이면 평균 품질과 분석 비용(디코딩+인코딩 대비)을 한 줄로 출력
+void PrintAdaptiveQualityStats(std::ostream& os, const ConvertOption& option, const PipelineStats& stats);
+
+// --verify N (N 장마다 검증), --verify-tile S, --verify-tile-every K, --min-psnr, --min-ssim 을 반영
+// 기준값만 주고 --verify 를 생략하면 모든 이미지를 검증한다. 값이 잘못되면 false
+bool ApplyVerifyOption(const CliArgs& args, ConvertOption& option);
+
+// 검증한 실행이면 표본 수/기준 미달 수/평균·최저 점수/검증 비용을 한 줄로 출력
+void PrintVerifyStats(std::ostream& os, const PipelineStats& stats);
+
+// --trace out.json 이면 구간 기록기를 만들어 option 에 연결한다. (--trace-buffer N: 스레드당 링 버퍼 구간 수) 값이 잘못되면 false
+bool ApplyTraceOption(const CliArgs& args, ConvertOption& option, std::unique_ptr<TraceRecorder>& pTrace);
+
+// 기록 중이었으면 Chrome trace-event JSON 을 --trace 경로에 쓰고 구간 수/덮어쓴 수를 한 줄로 출력. 쓰기 실패면 false
+bool WriteTraceOption(std::ostream& os, const CliArgs& args, const TraceRecorder* pTrace);
+
+// --mem-budget 2G | auto 면 작업별 메모리 예약을 켠다. (auto: cgroup/Job object 한도의 3/4, 한도가 없으면 끔) 값이 잘못되면 false
+bool ApplyMemoryBudgetOption(const CliArgs& args, ConvertOption& option, std::unique_ptr<MemoryBudget>& pBudget);
+
+// 예산을 쓴 실행이면 예산/최대 예약/최대 실제 버퍼/대기 횟수와 시간을 한 줄로 출력
+void PrintMemoryBudgetStats(std::ostream& os, const MemoryBudget* pBudget);
+
+// --writers N 이면 결과 파일을 뒤쓰기 스레드 N 개로 쓴다. --stage 256M (메모리 큐), --scratch dir [--scratch-size 4G] (큐가 차면 거치는 로컬 폴더),
+// --durability none|batch|each, --sync-batch 32 (폴더별 묶음 크기). 값이 잘못되거나 임시 폴더를 만들 수 없으면 false
+bool ApplyOutputWriterOption(const CliArgs& args, std::unique_ptr<OutputWriter>& pWriter);
+
+// 뒤쓰기를 쓴 실행이면 쓴 파일/실패/묶음/fsync/임시 폴더 경유/최대 큐/막힌 횟수와 시간을 한 줄로 출력
+void PrintOutputWriterStats(std::ostream& os, const OutputWriter* pWriter);
+
+// 위치 인자(파일/폴더, --recursive)를 JPEG 파일 목록으로 펼친다.
+std::vector<std::string> CollectJpegInputs(const CliArgs& args);
+
+// 위치 인자 중 파일/폴더 입력의 공통 상위 폴더 (폴더는 그 자체, 파일은 상위 폴더. "-" 와 아카이브는 제외)
+//   --out 아래에는 이 폴더 기준 상대 경로로 쓴다. ("../in" 이나 절대 경로 입력도 출력 폴더 안에 들어간다)
+std::string FindJpegInputRoot(const CliArgs& args);
+
+// --index 색인(기본 corpus.wci)을 vecPath 에 맞게 갱신하고 저장한 뒤 검사 결과를 한 줄로 출력. 색인을 쓰지 못하면 false
+bool UpdateCorpusIndex(std::ostream& os, const CliArgs& args, const std::vector<std::string>& vecPath, CorpusIndex& index);
+
+// 파일 수/바이트/픽셀/최대 이미지/progressive/restart/손상 수와 서브샘플링 분포
+void PrintCorpusSummary(std::ostream& os, const CorpusSummary& summary);
+
+// 모든 명령 공통: --log-level debug|info|warn|error|off (기본 info), --log-format text|kv,
+// --log-burst N (분류별로 제한 없이 출력하는 건수), --log-rate R (그 이후 분류별 초당 건수) 을 로거에 반영. 값이 잘못되면 false
+bool ApplyLogOption(const CliArgs& args);
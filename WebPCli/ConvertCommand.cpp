@@ -0,0 +1,243 @@
+﻿#include "Commands.h"
+#include "ArchiveSource.h"
+#include "ConversionCache.h"
+#include "CorpusIndex.h"
+#include "CostModel.h"
+#include "CropList.h"
+#include "FileEndpoint.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "OutputWriter.h"
+#include "PackFile.h"
+#include "RunReport.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+// 파일 / 폴더 / tar / zip 입력을 한 번에 변환
+//   WebPCli convert a.jpg photos/ bundle.tar scans.zip --out out/
+//   cat bundle.tar | WebPCli convert - --out out/
+//   WebPCli convert photos/ --pack out/photos   (out/photos.0000.wpk + out/photos.wpx)
+//   WebPCli convert photos/ --out out/ --index photos.wci   (헤더 사전 검사: 배치 규모 출력, 변환할 수 없는 파일은 읽지 않음)
+//   WebPCli convert photos/ --out out/ --index photos.wci --cost-model cost.txt --order cost
+//       (이전 실행에서 배운 비용 모델로 예상 작업/시간을 먼저 출력하고 큰 파일부터 변환, 이번 관측으로 모델 갱신)
+
+namespace
+{
+    // 변환 결과의 단계 시간으로 비용 모델을 갱신하고 그대로 넘긴다.
+    class CostObserveSink : public IOutputSink
+    {
+    public:
+        CostObserveSink(IOutputSink& inner, CostModel& model, const std::unordered_map<std::string, CostFeatures>& mapFeature)
+            : m_inner(inner), m_model(model), m_mapFeature(mapFeature) {}
+
+        bool Write(OutputItem& item) override
+        {
+            // 색인이 있으면 헤더 특징 (progressive 포함), 없으면 결과의 크기로
+            auto it = m_mapFeature.find(item.strName);
+            m_model.Observe((it != m_mapFeature.end()) ? it->second : CostFeatures::FromResult(item.result), item.result);
+            return m_inner.Write(item);
+        }
+
+        bool Finish() override { return m_inner.Finish(); }
+
+    private:
+        IOutputSink& m_inner;
+        CostModel& m_model;
+        const std::unordered_map<std::string, CostFeatures>& m_mapFeature;
+    };
+}
+
+int RunConvert(const CliArgs& args)
+{
+    const bool bRecursive = args.Has("recursive");
+    ChainedSource source;
+    std::vector<std::string> vecLooseFiles;
+    bool bArchiveInput = false;
+
+    for (const auto& strInput : args.GetPositional())
+    {
+        std::error_code ec;
+        if (strInput != "-" && std::filesystem::is_directory(strInput, ec))
+        {
+            const std::vector<std::string> vecFiles = ListJpegFiles(strInput, bRecursive);
+            vecLooseFiles.insert(vecLooseFiles.end(), vecFiles.begin(), vecFiles.end());
+        }
+        else if (strInput == "-" || IsArchiveFileName(strInput))
+        {
+            std::unique_ptr<IInputSource> pArchive = OpenArchiveSource(strInput);
+            if (!pArchive)
+            {
+                std::cerr << "Error: 아카이브를 열지 못했습니다: " << strInput << "\n";
+                return 2;
+            }
+            source.Add(std::move(pArchive));
+            bArchiveInput = true;
+        }
+        else
+        {
+            vecLooseFiles.push_back(strInput);
+        }
+    }
+
+    // 아카이브 멤버에는 "원본 옆" 이 없다. 현재 폴더에 멤버 경로대로 흩어 쓰지 않도록 출력 위치를 받는다.
+    if (bArchiveInput && !args.Has("out") && !args.Has("pack"))
+    {
+        std::cerr << "Error: tar / zip 입력은 --out 또는 --pack 이 필요합니다.\n";
+        return 2;
+    }
+
+    // 색인을 쓰면 배치 규모를 먼저 출력하고, 헤더가 깨졌거나 그레이가 아닌 파일은 읽지 않고 실패로 센다.
+    // (아카이브 멤버는 색인 대상이 아님)
+    uint64_t nSkipped = 0;
+    CorpusSummary corpusSummary;
+    std::unordered_map<std::string, CostFeatures> mapFeature;
+    if (args.Has("index") && !vecLooseFiles.empty())
+    {
+        CorpusIndex index;
+        if (!UpdateCorpusIndex(std::cout, args, vecLooseFiles, index))
+            return 2;
+        corpusSummary = index.Summarize();
+        PrintCorpusSummary(std::cout, corpusSummary);
+
+        std::vector<std::string> vecConvertible;
+        for (const auto& strPath : vecLooseFiles)
+        {
+            const CorpusFileInfo* pFile = index.Find(strPath);
+            if (pFile && pFile->info.eStatus == JPEG_SCAN_OK && pFile->info.nSubSampling != JPEG_SUBSAMP_GRAY)
+                LogInfo("index", "그레이스케일 JPEG 가 아니라 건너뜁니다: " + strPath);
+            if (pFile && (pFile->info.eStatus != JPEG_SCAN_OK || pFile->info.nSubSampling != JPEG_SUBSAMP_GRAY))
+                ++nSkipped;
+            else
+                vecConvertible.push_back(strPath);
+            if (pFile)
+                mapFeature[strPath] = CostFeatures::FromScan(pFile->info, pFile->nFileSize);
+        }
+        vecLooseFiles.swap(vecConvertible);
+    }
+
+    PipelineOption option;
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", 0));
+    option.nMaxInflight = static_cast<int>(args.GetInt("window", 0));
+    option.bPreserveOrder = false; // 파일 출력은 순서가 의미 없음
+    option.bPinWorkers = args.Has("pin-workers");
+
+    ConvertOption convertOption;
+    convertOption.fQuality = static_cast<float>(args.GetDouble("quality", convertOption.fQuality));
+    if (!ApplyDecoderOption(args, convertOption) || !ApplyEncoderOption(args, convertOption))
+        return 2;
+
+    CropList cropList;
+    if (!ApplyCropOption(args, convertOption, cropList, option))
+        return 2;
+    std::unique_ptr<TraceRecorder> pTrace;
+    std::unique_ptr<MemoryBudget> pMemoryBudget;
+    if (!ApplyAdaptiveQualityOption(args, convertOption) || !ApplyVerifyOption(args, convertOption) || !ApplyTraceOption(args, convertOption, pTrace)
+        || !ApplyMemoryBudgetOption(args, convertOption, pMemoryBudget))
+        return 2;
+    ConvertEngine engine(convertOption);
+
+    // 비용 모델: 같은 설정으로 저장된 모델이 있으면 이어서 배운다.
+    const std::string strOrder = args.GetString("order", "input");
+    if (strOrder != "input" && strOrder != "cost")
+    {
+        std::cerr << "Error: --order 는 input 또는 cost 입니다: " << strOrder << "\n";
+        return 2;
+    }
+    if (strOrder == "cost" && mapFeature.empty())
+    {
+        std::cerr << "Error: --order cost 는 헤더 특징이 필요합니다. (--index 와 함께)\n";
+        return 2;
+    }
+    CostModel costModel;
+    const std::string strCostModelPath = args.GetString("cost-model");
+    const std::string strCostSettings = ConversionCache::MakeSettingsKey(convertOption);
+    const bool bCostModelLoaded = !strCostModelPath.empty() && costModel.Load(strCostModelPath, strCostSettings);
+    if (!mapFeature.empty() && (!strCostModelPath.empty() || strOrder == "cost"))
+    {
+        const CostCoefficients coefficients = costModel.GetCoefficients();
+        std::unordered_map<std::string, double> mapCost;
+        double fWorkSec = 0.0;
+        for (const auto& strPath : vecLooseFiles)
+        {
+            auto it = mapFeature.find(strPath);
+            const double fSec = (it != mapFeature.end()) ? coefficients.Predict(it->second).GetTotalSec() : 0.0;
+            mapCost[strPath] = fSec;
+            fWorkSec += fSec;
+        }
+
+        // 큰 파일부터: 마지막에 큰 파일 하나가 혼자 도는 꼬리를 줄인다.
+        if (strOrder == "cost")
+            std::stable_sort(vecLooseFiles.begin(), vecLooseFiles.end(), [&](const std::string& a, const std::string& b) { return mapCost.at(a) > mapCost.at(b); });
+
+        const int nWorkers = (option.nWorkerCount > 0) ? option.nWorkerCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        const RemainingEstimate estimate = EstimateRemaining(fWorkSec, 0.0, 0.0, nWorkers);
+        std::cout << "predicted: work=" << estimate.fRemainingWorkSec << "s eta=" << estimate.fEtaSec << "s (" << nWorkers << " workers, "
+            << (bCostModelLoaded ? "learned model" : "prior") << ", order=" << strOrder << ")\n";
+    }
+    if (!vecLooseFiles.empty())
+    {
+        std::unique_ptr<FileListSource> pFileSource(new FileListSource(vecLooseFiles));
+        if (args.Has("out"))
+            pFileSource->SetInputRoot(FindJpegInputRoot(args));
+        source.Add(std::move(pFileSource));
+    }
+
+    if (pMemoryBudget && corpusSummary.nMaxPixels > 0)
+    {
+        const uint64_t nLargest = MemoryBudget::EstimateConvertBytes(corpusSummary.nMaxWidth, corpusSummary.nMaxHeight, 0, convertOption.verify.IsEnabled(), convertOption.bLossless);
+        if (nLargest > pMemoryBudget->GetBudget())
+            LogWarn("memory", "가장 큰 이미지의 추정 사용량(" + std::to_string(nLargest >> 20) + "MB)이 예산보다 커서 그 이미지는 혼자 처리됩니다.");
+    }
+
+    DirectorySink directorySink(args.GetString("out"));
+    std::unique_ptr<OutputWriter> pOutputWriter;
+    if (!ApplyOutputWriterOption(args, pOutputWriter))
+        return 2;
+    directorySink.SetOutputWriter(pOutputWriter.get());
+    std::unique_ptr<PackWriter> pPackWriter;
+    if (args.Has("pack"))
+        pPackWriter.reset(new PackWriter(args.GetString("pack"), static_cast<uint64_t>(args.GetInt("pack-mb", 1024)) << 20));
+
+    IOutputSink& outputSink = pPackWriter ? static_cast<IOutputSink&>(*pPackWriter) : directorySink;
+    ReportSink reportSink(outputSink);
+    if (args.Has("report") && !reportSink.Open(args.GetString("report")))
+        return 2;
+
+    IOutputSink& reportedSink = args.Has("report") ? static_cast<IOutputSink&>(reportSink) : outputSink;
+    CostObserveSink costSink(reportedSink, costModel, mapFeature);
+    IOutputSink& sink = strCostModelPath.empty() ? reportedSink : static_cast<IOutputSink&>(costSink);
+    BatchPipeline pipeline(engine, option);
+    const PipelineStats stats = pipeline.Run(source, sink);
+
+    std::cout << "converted=" << stats.nConverted << " failed=" << stats.nFailed + nSkipped << " write_failed=" << directorySink.GetWriteFailCount()
+        << " in=" << stats.nInputBytes << "B out=" << stats.nOutputBytes << "B " << stats.fElapsedSec << "s ("
+        << (stats.fElapsedSec > 0.0 ? static_cast<double>(stats.nItems) / stats.fElapsedSec : 0.0) << " img/s)\n";
+    PrintAdaptiveQualityStats(std::cout, convertOption, stats);
+    PrintVerifyStats(std::cout, stats);
+    PrintMemoryBudgetStats(std::cout, pMemoryBudget.get());
+    PrintOutputWriterStats(std::cout, pOutputWriter.get());
+    if (!strCostModelPath.empty())
+    {
+        const CostModelStats costStats = costModel.GetStats();
+        std::cout << "cost model: observed=" << costStats.nObserved << " predicted_error=" << costStats.GetRelativeError() * 100.0 << "% actual_work="
+            << costStats.fActualSec << "s (" << strCostModelPath << ")\n";
+        if (!costModel.Save(strCostModelPath, strCostSettings))
+            LogWarn("cost", "비용 모델을 저장하지 못했습니다: " + strCostModelPath);
+    }
+    const bool bTraceWritten = WriteTraceOption(std::cout, args, pTrace.get());
+
+    if (stats.bSourceError)
+        std::cerr << "Error: 입력 일부를 읽지 못했습니다.\n";
+
+    if (stats.bSinkError)
+        std::cerr << "Error: 출력 기록 실패\n";
+
+    if (stats.nVerifyFailed > 0)
+        std::cerr << "Error: 품질 기준 미달 " << stats.nVerifyFailed << "건\n";
+
+    return (!bTraceWritten || stats.bSourceError || stats.bSinkError || stats.nFailed + nSkipped > 0 || stats.nVerifyFailed > 0 || directorySink.GetWriteFailCount() > 0) ? 1 : 0;
+}
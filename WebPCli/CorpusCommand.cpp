@@ -0,0 +1,180 @@
+﻿#include "Commands.h"
+#include "CorpusGenerator.h"
+#include "FileUtil.h"
+#include "JobPool.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// 재현 가능한 합성 JPEG 코퍼스 생성
+//   WebPCli gen-corpus --out corpus/ --count 500 --seed 7 --sizes "640x480:6,1920x1080:3,6000x4000:1"
+//           --subsamp "gray:8,420:1,444:1" --progressive 0.2 --restart "0:3,4:1" --complexity "0.1,0.5,0.9" --quality "75,90"
+//   corpus/img_000000.jpg ... 와 corpus/manifest.csv (이미지별 속성, 원본 픽셀 해시, JPEG 크기) 를 만든다.
+//   같은 인자면 스레드 수와 상관없이 같은 목록/픽셀이 나온다. --verify manifest.csv 를 주면 파일은 쓰지 않고
+//   그 manifest 와 이름/픽셀 해시를 비교한다. (다른 머신에서 같은 코퍼스인지 확인)
+
+namespace
+{
+    bool ParseCorpusSpec(const CliArgs& args, CorpusSpec& spec)
+    {
+        spec.nSeed = static_cast<uint64_t>(args.GetInt("seed", static_cast<long long>(spec.nSeed)));
+        spec.nCount = static_cast<int>(args.GetInt("count", spec.nCount));
+        spec.fProgressive = args.GetDouble("progressive", spec.fProgressive);
+
+        struct ListOption
+        {
+            const char* pszKey;
+            bool (CorpusSpec::*pfnParse)(const std::string&);
+        };
+        const ListOption listOptions[] =
+        {
+            { "sizes",      &CorpusSpec::ParseSizes },
+            { "subsamp",    &CorpusSpec::ParseSubsamp },
+            { "restart",    &CorpusSpec::ParseRestartRows },
+            { "complexity", &CorpusSpec::ParseComplexity },
+            { "quality",    &CorpusSpec::ParseQuality },
+        };
+
+        for (const auto& option : listOptions)
+        {
+            if (args.Has(option.pszKey) && !(spec.*option.pfnParse)(args.GetString(option.pszKey)))
+            {
+                std::cerr << "Error: --" << option.pszKey << " 형식이 잘못되었습니다: " << args.GetString(option.pszKey) << "\n";
+                return false;
+            }
+        }
+
+        if (spec.nCount <= 0 || spec.fProgressive < 0.0 || spec.fProgressive > 1.0)
+        {
+            std::cerr << "Error: --count 는 1 이상, --progressive 는 0..1 이어야 합니다.\n";
+            return false;
+        }
+        return true;
+    }
+
+    // manifest 의 (이름, 픽셀 해시) 목록 (번호순)
+    bool LoadManifestHashes(const std::string& strPath, std::vector<std::pair<std::string, uint64_t>>& vecHash)
+    {
+        std::ifstream file(strPath);
+        if (!file)
+            return false;
+
+        std::string strLine;
+        while (std::getline(file, strLine))
+        {
+            if (strLine.empty() || strLine[0] == '#' || strLine.compare(0, 5, "name,") == 0)
+                continue;
+
+            // name,width,height,subsamp,progressive,restart_rows,complexity,quality,pixel_hash,bytes
+            std::vector<std::string> vecField;
+            size_t nPos = 0;
+            while (true)
+            {
+                const size_t nComma = strLine.find(',', nPos);
+                vecField.push_back(strLine.substr(nPos, nComma - nPos));
+                if (nComma == std::string::npos)
+                    break;
+                nPos = nComma + 1;
+            }
+            if (vecField.size() != 10)
+                return false;
+            vecHash.emplace_back(vecField[0], std::strtoull(vecField[8].c_str(), nullptr, 16));
+        }
+        return true;
+    }
+}
+
+int RunGenCorpus(const CliArgs& args)
+{
+    CorpusSpec spec;
+    if (!ParseCorpusSpec(args, spec))
+        return 2;
+
+    const std::string strOutDir = args.GetString("out", "corpus");
+    const bool bVerify = args.Has("verify");
+    const std::string strManifest = bVerify ? args.GetString("verify") : (std::filesystem::path(strOutDir) / "manifest.csv").string();
+
+    std::error_code ec;
+    if (!bVerify && !std::filesystem::create_directories(strOutDir, ec) && ec)
+    {
+        std::cerr << "Error: 출력 폴더를 만들지 못했습니다: " << strOutDir << "\n";
+        return 2;
+    }
+
+    // 이미지 i 는 (시드, i) 로만 정해지므로 순서와 상관없이 병렬로 만들고 manifest 는 번호순으로 쓴다.
+    CorpusGenerator generator(spec);
+    std::vector<CorpusImage> vecImage(static_cast<size_t>(spec.nCount));
+    std::vector<char> vecOk(vecImage.size(), 0);
+    {
+        JobPool pool(static_cast<int>(args.GetInt("threads", 0)));
+        for (int i = 0; i < spec.nCount; ++i)
+        {
+            pool.push([&, i]()
+            {
+                CorpusImage& image = vecImage[static_cast<size_t>(i)];
+                image = generator.Describe(i);
+
+                std::vector<uint8_t> vecJpeg;
+                if (!generator.Generate(image, vecJpeg))
+                    return;
+                if (!bVerify && !WriteMemoryToFile((std::filesystem::path(strOutDir) / image.strName).string(), vecJpeg.data(), vecJpeg.size()))
+                    return;
+                vecOk[static_cast<size_t>(i)] = 1;
+            });
+        }
+        pool.stop();
+    }
+
+    uint64_t nFailed = 0;
+    uint64_t nTotalBytes = 0;
+    for (size_t i = 0; i < vecImage.size(); ++i)
+    {
+        if (!vecOk[i])
+        {
+            ++nFailed;
+            std::cerr << "Error: 생성 실패: " << vecImage[i].strName << "\n";
+        }
+        nTotalBytes += vecImage[i].nBytes;
+    }
+
+    if (bVerify)
+    {
+        std::vector<std::pair<std::string, uint64_t>> vecHash;
+        if (!LoadManifestHashes(strManifest, vecHash))
+        {
+            std::cerr << "Error: manifest 를 읽지 못했습니다: " << strManifest << "\n";
+            return 2;
+        }
+
+        uint64_t nMismatch = 0;
+        for (size_t i = 0; i < vecImage.size(); ++i)
+        {
+            const bool bMatch = vecOk[i] && i < vecHash.size() && vecHash[i].first == vecImage[i].strName && vecHash[i].second == vecImage[i].nPixelHash;
+            if (!bMatch)
+            {
+                ++nMismatch;
+                std::cerr << "mismatch: " << vecImage[i].strName << "\n";
+            }
+        }
+        if (vecHash.size() != vecImage.size())
+            std::cerr << "mismatch: manifest " << vecHash.size() << "개, 생성 " << vecImage.size() << "개\n";
+
+        std::cout << "verify: images=" << vecImage.size() << " mismatch=" << nMismatch << "\n";
+        return (nMismatch > 0 || nFailed > 0 || vecHash.size() != vecImage.size()) ? 1 : 0;
+    }
+
+    std::ofstream manifest(strManifest);
+    CorpusGenerator::WriteManifestHeader(manifest, spec);
+    for (const auto& image : vecImage)
+        CorpusGenerator::WriteManifestRow(manifest, image);
+    if (!manifest)
+    {
+        std::cerr << "Error: manifest 를 쓰지 못했습니다: " << strManifest << "\n";
+        return 2;
+    }
+
+    std::cout << "corpus: images=" << vecImage.size() - nFailed << " failed=" << nFailed << " bytes=" << nTotalBytes << " dir=" << strOutDir
+        << " (" << spec.ToString() << ")\n";
+    return nFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+﻿#include "Commands.h"
+#include "CropList.h"
+#include "DecoderBackend.h"
+#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+// 등록된 디코더 백엔드를 같은 코퍼스로 나란히 비교
+//   WebPCli bench-decode photos/ [--decoder turbojpeg,nvjpeg] [--iterations 3]
+//   각 백엔드의 Probe + DecodeInto 시간(최선 반복)과, 첫 번째 측정 대비 Y 평면 일치 여부를 출력한다.
+//   --crop 을 주면 decode-then-crop 과 부분 디코딩(DecodeRegion)의 시간/평면 메모리/픽셀 일치를 비교한다.
+//   (GPU 디코더는 IDCT 반올림이 달라 일부 이미지가 다를 수 있으므로 불일치는 정보로만 표시)
+
+namespace
+{
+    struct BenchImage
+    {
+        std::string strPath;
+        std::vector<uint8_t> vecData;
+    };
+
+    uint64_t HashPlane(const uint8_t* pData, size_t nSize)
+    {
+        uint64_t nHash = 1469598103934665603ULL; // FNV-1a
+        for (size_t i = 0; i < nSize; ++i)
+        {
+            nHash ^= pData[i];
+            nHash *= 1099511628211ULL;
+        }
+        return nHash;
+    }
+
+    enum BENCH_MODE
+    {
+        BENCH_FULL = 0,         // 전체 디코딩
+        BENCH_FULL_THEN_CROP,   // 전체 디코딩 후 영역 복사 (--crop 비교 기준)
+        BENCH_REGION            // DecodeRegion (부분 디코딩)
+    };
+
+    const char* GetBenchModeName(BENCH_MODE eMode)
+    {
+        switch (eMode)
+        {
+        case BENCH_FULL:            return "full";
+        case BENCH_FULL_THEN_CROP:  return "full+crop";
+        case BENCH_REGION:          return "region";
+        default:                    return "unknown";
+        }
+    }
+
+    std::vector<std::string> SplitList(const std::string& strList)
+    {
+        std::vector<std::string> vecItem;
+        std::stringstream ss(strList);
+        std::string strItem;
+        while (std::getline(ss, strItem, ','))
+        {
+            if (!strItem.empty())
+                vecItem.push_back(strItem);
+        }
+        return vecItem;
+    }
+}
+
+int RunBenchDecode(const CliArgs& args)
+{
+    std::vector<std::string> vecPath;
+    for (const auto& strInput : args.GetPositional())
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(strInput, ec))
+        {
+            const std::vector<std::string> vecFiles = ListJpegFiles(strInput, args.Has("recursive"));
+            vecPath.insert(vecPath.end(), vecFiles.begin(), vecFiles.end());
+        }
+        else
+        {
+            vecPath.push_back(strInput);
+        }
+    }
+
+    // 디스크 I/O 는 측정에서 빼기 위해 먼저 모두 메모리에 올린다.
+    std::vector<BenchImage> vecImage;
+    for (const auto& strPath : vecPath)
+    {
+        BenchImage image;
+        image.strPath = strPath;
+        if (!ReadFileToMemory(strPath, image.vecData))
+        {
+            std::cerr << "Error: JPEG 파일을 읽지 못했습니다: " << strPath << "\n";
+            continue;
+        }
+        vecImage.push_back(std::move(image));
+    }
+
+    if (vecImage.empty())
+    {
+        std::cerr << "Error: 입력 JPEG 이 없습니다.\n";
+        return 2;
+    }
+
+    const std::vector<std::string> vecDecoder = args.Has("decoder") ? SplitList(args.GetString("decoder")) : DecoderRegistry::GetNames();
+    const int nIterations = std::max(1, static_cast<int>(args.GetInt("iterations", 3)));
+
+    JpegRegion crop;
+    if (args.Has("crop") && !CropList::ParseRegion(args.GetString("crop"), crop))
+    {
+        std::cerr << "Error: --crop 은 x,y,w,h 형식이어야 합니다: " << args.GetString("crop") << "\n";
+        return 2;
+    }
+
+    // --crop 이면 같은 백엔드로 "전체 디코딩 후 잘라내기" 와 "부분 디코딩" 을 나란히 측정하고 픽셀을 비교한다.
+    std::vector<BENCH_MODE> vecMode;
+    if (crop.IsFull())
+    {
+        vecMode.push_back(BENCH_FULL);
+    }
+    else
+    {
+        vecMode.push_back(BENCH_FULL_THEN_CROP);
+        vecMode.push_back(BENCH_REGION);
+    }
+
+    std::vector<uint64_t> vecReferenceHash;     // 첫 백엔드의 이미지별 출력 평면 해시 (실패는 0)
+    std::vector<uint8_t> vecFrame;
+    std::vector<uint8_t> vecOut;
+    int nExitCode = 0;
+
+    std::printf("%-12s %-10s %8s %6s %10s %10s %10s %10s %8s\n", "decoder", "mode", "images", "fail", "best_ms", "MP/s", "img/s", "plane_KB", "match");
+
+    for (size_t d = 0; d < vecDecoder.size(); ++d)
+    {
+        std::unique_ptr<IDecoderBackend> pDecoder = DecoderRegistry::Create(vecDecoder[d]);
+        if (!pDecoder)
+        {
+            std::printf("%-12s (사용할 수 없음)\n", vecDecoder[d].c_str());
+            continue;
+        }
+
+        std::vector<uint64_t> vecBackendBaseline;   // 이 백엔드의 decode-then-crop 해시
+
+        for (BENCH_MODE eMode : vecMode)
+        {
+            std::vector<uint64_t> vecHash(vecImage.size(), 0);
+            double fBestSec = 0.0;
+            size_t nFail = 0;
+            uint64_t nPixels = 0;
+            size_t nPeakPlaneBytes = 0;
+
+            for (int nIter = 0; nIter < nIterations; ++nIter)
+            {
+                nFail = 0;
+                nPixels = 0;
+                const auto startTime = std::chrono::steady_clock::now();
+
+                for (size_t i = 0; i < vecImage.size(); ++i)
+                {
+                    const BenchImage& image = vecImage[i];
+                    JpegHeader header;
+                    if (!pDecoder->Probe(image.vecData.data(), image.vecData.size(), header) || header.nSubSampling != JPEG_SUBSAMP_GRAY)
+                    {
+                        ++nFail;
+                        continue;
+                    }
+
+                    JpegRegion region = crop;
+                    if (eMode == BENCH_FULL)
+                    {
+                        region.nX = 0;
+                        region.nY = 0;
+                        region.nWidth = header.nWidth;
+                        region.nHeight = header.nHeight;
+                    }
+                    else if (region.nWidth > header.nWidth - region.nX || region.nHeight > header.nHeight - region.nY)
+                    {
+                        ++nFail;
+                        continue;
+                    }
+
+                    const size_t nOutSize = static_cast<size_t>(region.nWidth) * static_cast<size_t>(region.nHeight);
+                    if (vecOut.size() < nOutSize)
+                        vecOut.resize(nOutSize);
+
+                    DecodePlanes planes;
+                    planes.pY = vecOut.data();
+                    planes.nYStride = region.nWidth;
+
+                    bool bOk = false;
+                    size_t nPlaneBytes = nOutSize;
+                    if (eMode == BENCH_REGION)
+                    {
+                        bOk = pDecoder->DecodeRegion(image.vecData.data(), image.vecData.size(), header, region, planes);
+                    }
+                    else if (eMode == BENCH_FULL)
+                    {
+                        bOk = pDecoder->DecodeInto(image.vecData.data(), image.vecData.size(), header, planes);
+                    }
+                    else
+                    {
+                        // 비교 기준: 전체 프레임을 디코딩한 뒤 영역을 복사
+                        const size_t nFrameSize = static_cast<size_t>(header.nWidth) * static_cast<size_t>(header.nHeight);
+                        if (vecFrame.size() < nFrameSize)
+                            vecFrame.resize(nFrameSize);
+
+                        DecodePlanes framePlanes;
+                        framePlanes.pY = vecFrame.data();
+                        framePlanes.nYStride = header.nWidth;
+                        bOk = pDecoder->DecodeInto(image.vecData.data(), image.vecData.size(), header, framePlanes);
+                        for (int y = 0; bOk && y < region.nHeight; ++y)
+                            std::memcpy(vecOut.data() + static_cast<size_t>(y) * region.nWidth, vecFrame.data() + static_cast<size_t>(region.nY + y) * header.nWidth + region.nX, static_cast<size_t>(region.nWidth));
+                        nPlaneBytes += nFrameSize;
+                    }
+
+                    if (!bOk)
+                    {
+                        ++nFail;
+                        continue;
+                    }
+
+                    nPixels += nOutSize;
+                    nPeakPlaneBytes = std::max(nPeakPlaneBytes, nPlaneBytes);
+                    if (nIter == 0)
+                        vecHash[i] = HashPlane(vecOut.data(), nOutSize); // 해시는 첫 반복에서만 (시간에 조금 포함됨)
+                }
+
+                const double fSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                if (nIter == 0 || fSec < fBestSec)
+                    fBestSec = fSec;
+            }
+
+            // 부분 디코딩은 같은 백엔드의 decode-then-crop 과, 나머지는 첫 백엔드의 결과와 비교한다.
+            const std::vector<uint64_t>& vecExpected = (eMode == BENCH_REGION) ? vecBackendBaseline : vecReferenceHash;
+            size_t nMismatch = 0;
+            for (size_t i = 0; i < vecExpected.size(); ++i)
+            {
+                if (vecHash[i] != vecExpected[i])
+                    ++nMismatch;
+            }
+
+            if (vecReferenceHash.empty())
+                vecReferenceHash = vecHash;
+            if (eMode != BENCH_REGION)
+                vecBackendBaseline = vecHash;
+
+            // 부분 디코딩 픽셀이 decode-then-crop 과 다르면 버그이므로 실패로 끝낸다.
+            if (eMode == BENCH_REGION && nMismatch != 0)
+                nExitCode = 1;
+
+            const double fMPixPerSec = (fBestSec > 0.0) ? static_cast<double>(nPixels) / 1e6 / fBestSec : 0.0;
+            const double fImgPerSec = (fBestSec > 0.0) ? static_cast<double>(vecImage.size() - nFail) / fBestSec : 0.0;
+            const std::string strMatch = (nMismatch == 0) ? "yes" : std::to_string(nMismatch) + " diff";
+            std::printf("%-12s %-10s %8zu %6zu %10.2f %10.1f %10.1f %10zu %8s\n", pDecoder->GetName(), GetBenchModeName(eMode), vecImage.size(), nFail,
+                fBestSec * 1000.0, fMPixPerSec, fImgPerSec, nPeakPlaneBytes >> 10, strMatch.c_str());
+        }
+    }
+
+    return nExitCode;
+}
@@ -0,0 +1,211 @@
+﻿#include "Commands.h"
+#include "FileUtil.h"
+#include "SocketUtil.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// HTTP 변환 서버 부하 생성기: 동시 keep-alive 연결로 같은 JPEG 을 반복 POST 하고 RPS / 지연 분위수를 보고한다.
+namespace
+{
+    struct ClientStats
+    {
+        std::vector<int64_t> vecLatencyUs;
+        std::map<int, uint64_t> mapStatus;
+        uint64_t nErrors = 0;
+        uint64_t nBytesOut = 0;
+    };
+
+    // 응답 헤더 + 본문을 읽고 상태 코드를 반환 (실패 시 -1)
+    int ReadResponse(socket_t sock, std::string& strBuffer, bool& bKeepAlive, size_t& nBodySize)
+    {
+        size_t nHeadEnd;
+        while ((nHeadEnd = strBuffer.find("\r\n\r\n")) == std::string::npos)
+        {
+            char szChunk[4096];
+            const int nRead = SocketUtil::Recv(sock, szChunk, sizeof(szChunk));
+            if (nRead <= 0)
+                return -1;
+            strBuffer.append(szChunk, static_cast<size_t>(nRead));
+        }
+
+        const std::string strHead = strBuffer.substr(0, nHeadEnd);
+        strBuffer.erase(0, nHeadEnd + 4);
+
+        int nStatus = -1;
+        if (strHead.size() > 12)
+            nStatus = std::atoi(strHead.c_str() + 9); // "HTTP/1.1 200 ..."
+
+        nBodySize = 0;
+        bKeepAlive = true;
+        std::istringstream iss(strHead);
+        std::string strLine;
+        while (std::getline(iss, strLine))
+        {
+            std::string strLower = strLine;
+            std::transform(strLower.begin(), strLower.end(), strLower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (strLower.compare(0, 15, "content-length:") == 0)
+                nBodySize = static_cast<size_t>(std::strtoull(strLine.c_str() + 15, nullptr, 10));
+            else if (strLower.compare(0, 11, "connection:") == 0 && strLower.find("close") != std::string::npos)
+                bKeepAlive = false;
+        }
+
+        size_t nRemain = nBodySize;
+        const size_t nBuffered = std::min(nRemain, strBuffer.size());
+        strBuffer.erase(0, nBuffered);
+        nRemain -= nBuffered;
+
+        char szDiscard[65536];
+        while (nRemain > 0)
+        {
+            const int nRead = SocketUtil::Recv(sock, szDiscard, std::min(nRemain, sizeof(szDiscard)));
+            if (nRead <= 0)
+                return -1;
+            nRemain -= static_cast<size_t>(nRead);
+        }
+        return nStatus;
+    }
+
+    void ClientLoop(const std::string& strHost, uint16_t nPort, const std::string& strRequestHead, const std::vector<uint8_t>& vecBody,
+        std::chrono::steady_clock::time_point deadline, ClientStats& stats)
+    {
+        socket_t sock = INVALID_SOCKET;
+        std::string strBuffer;
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (sock == INVALID_SOCKET)
+            {
+                sock = SocketUtil::Connect(strHost, nPort);
+                if (sock == INVALID_SOCKET)
+                {
+                    ++stats.nErrors;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                SocketUtil::SetNoDelay(sock);
+                strBuffer.clear();
+            }
+
+            const auto startTime = std::chrono::steady_clock::now();
+            bool bKeepAlive = false;
+            size_t nBodySize = 0;
+            int nStatus = -1;
+            if (SocketUtil::SendAll(sock, strRequestHead.data(), strRequestHead.size()) && SocketUtil::SendAll(sock, vecBody.data(), vecBody.size()))
+                nStatus = ReadResponse(sock, strBuffer, bKeepAlive, nBodySize);
+
+            if (nStatus < 0)
+            {
+                ++stats.nErrors;
+                SocketUtil::Close(sock);
+                sock = INVALID_SOCKET;
+                continue;
+            }
+
+            stats.vecLatencyUs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+            ++stats.mapStatus[nStatus];
+            if (nStatus == 200)
+                stats.nBytesOut += nBodySize;
+
+            if (!bKeepAlive)
+            {
+                SocketUtil::Close(sock);
+                sock = INVALID_SOCKET;
+            }
+        }
+
+        SocketUtil::Close(sock);
+    }
+
+    double Percentile(const std::vector<int64_t>& vecSorted, double fRatio)
+    {
+        if (vecSorted.empty())
+            return 0.0;
+        const size_t nIndex = std::min(vecSorted.size() - 1, static_cast<size_t>(fRatio * static_cast<double>(vecSorted.size())));
+        return static_cast<double>(vecSorted[nIndex]) / 1000.0;
+    }
+}
+
+int RunBenchHttp(const CliArgs& args)
+{
+    const std::string strHost = args.GetString("host", "127.0.0.1");
+    const uint16_t nPort = static_cast<uint16_t>(args.GetInt("port", 8080));
+    const std::string strFile = args.GetString("file", "Crater.jpg");
+    const int nConcurrency = static_cast<int>(std::max<long long>(1, args.GetInt("concurrency", 16)));
+    const double fDurationSec = args.GetDouble("duration", 10.0);
+
+    std::vector<uint8_t> vecBody;
+    if (!ReadFileToMemory(strFile, vecBody) || vecBody.empty())
+    {
+        std::cerr << "Error: JPEG 파일을 읽지 못했습니다: " << strFile << "\n";
+        return 2;
+    }
+
+    std::string strTarget = "/convert";
+    if (args.Has("quality"))
+        strTarget += "?quality=" + args.GetString("quality");
+    if (args.Has("priority"))
+        strTarget += (strTarget.find('?') == std::string::npos ? "?priority=" : "&priority=") + args.GetString("priority");
+
+    std::ostringstream oss;
+    oss << "POST " << strTarget << " HTTP/1.1\r\n"
+        << "Host: " << strHost << ":" << nPort << "\r\n"
+        << "Content-Type: image/jpeg\r\n"
+        << "Content-Length: " << vecBody.size() << "\r\n"
+        << "Connection: keep-alive\r\n\r\n";
+    const std::string strRequestHead = oss.str();
+
+    if (!SocketUtil::Startup())
+        return 2;
+
+    std::vector<ClientStats> vecStats(static_cast<size_t>(nConcurrency));
+    std::vector<std::thread> vecThreads;
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto deadline = startTime + std::chrono::microseconds(static_cast<int64_t>(fDurationSec * 1e6));
+
+    for (int i = 0; i < nConcurrency; ++i)
+        vecThreads.emplace_back(ClientLoop, strHost, nPort, std::cref(strRequestHead), std::cref(vecBody), deadline, std::ref(vecStats[static_cast<size_t>(i)]));
+
+    for (auto& thread : vecThreads)
+        thread.join();
+
+    const double fElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    SocketUtil::Cleanup();
+
+    // 결과 취합
+    std::vector<int64_t> vecLatency;
+    std::map<int, uint64_t> mapStatus;
+    uint64_t nErrors = 0, nBytesOut = 0;
+    for (const auto& stats : vecStats)
+    {
+        vecLatency.insert(vecLatency.end(), stats.vecLatencyUs.begin(), stats.vecLatencyUs.end());
+        for (const auto& it : stats.mapStatus)
+            mapStatus[it.first] += it.second;
+        nErrors += stats.nErrors;
+        nBytesOut += stats.nBytesOut;
+    }
+    std::sort(vecLatency.begin(), vecLatency.end());
+
+    const uint64_t nOk = mapStatus[200];
+    std::cout << std::fixed << std::setprecision(2)
+        << "requests   : " << vecLatency.size() << " in " << fElapsed << " s (concurrency " << nConcurrency << ")\n"
+        << "rps        : " << static_cast<double>(vecLatency.size()) / fElapsed << " (ok " << static_cast<double>(nOk) / fElapsed << ")\n"
+        << "latency ms : p50 " << Percentile(vecLatency, 0.50) << ", p90 " << Percentile(vecLatency, 0.90)
+        << ", p99 " << Percentile(vecLatency, 0.99) << ", max " << (vecLatency.empty() ? 0.0 : vecLatency.back() / 1000.0) << "\n"
+        << "status     :";
+    for (const auto& it : mapStatus)
+        std::cout << " " << it.first << "=" << it.second;
+    std::cout << " (socket errors " << nErrors << ")\n";
+    if (nOk > 0)
+        std::cout << "bytes/resp : " << nBytesOut / nOk << "\n";
+
+    return 0;
+}
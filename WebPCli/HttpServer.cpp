@@ -0,0 +1,896 @@
+﻿#include "HttpServer.h"
+#include "Commands.h"
+#include "FileUtil.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    const size_t MAX_HEADER_BYTES = 16u << 10;
+    const int RECV_TIMEOUT_MS = 1000;
+    const int KEEP_ALIVE_IDLE_MS = 30000;
+    const int BODY_IDLE_MS = 10000;         // 본문이 이만큼 한 바이트도 오지 않으면 연결을 닫는다.
+    const int BODY_TOTAL_MS = 120000;       // 본문 전체를 받는 상한 (조금씩 흘려 보내며 연결 스레드를 붙잡는 것 방지)
+
+    const char* GetStatusText(int nStatus)
+    {
+        switch (nStatus)
+        {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+        }
+    }
+
+    int GetHttpStatus(CONVERT_STATUS eStatus)
+    {
+        switch (eStatus)
+        {
+        case CONVERT_OK:            return 200;
+        case CONVERT_ERR_HEADER:
+        case CONVERT_ERR_DECODE:    return 400;
+        case CONVERT_ERR_NOT_GRAY:  return 415;
+        default:                    return 500;
+        }
+    }
+
+    volatile std::sig_atomic_t g_bInterrupted = 0;
+
+    void OnInterrupt(int)
+    {
+        g_bInterrupted = 1;
+    }
+
+    std::string ToLower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return str;
+    }
+
+    std::string Trim(const std::string& str)
+    {
+        const size_t nBegin = str.find_first_not_of(" \t");
+        if (nBegin == std::string::npos)
+            return std::string();
+        const size_t nEnd = str.find_last_not_of(" \t\r");
+        return str.substr(nBegin, nEnd - nBegin + 1);
+    }
+
+    // "a=1&quality=75" 에서 key 값 찾기
+    bool FindQueryValue(const std::string& strQuery, const std::string& strKey, std::string& strValue)
+    {
+        size_t nPos = 0;
+        while (nPos < strQuery.size())
+        {
+            size_t nAmp = strQuery.find('&', nPos);
+            if (nAmp == std::string::npos)
+                nAmp = strQuery.size();
+
+            const std::string strPair = strQuery.substr(nPos, nAmp - nPos);
+            const size_t nEq = strPair.find('=');
+            if (nEq != std::string::npos && strPair.compare(0, nEq, strKey) == 0)
+            {
+                strValue = strPair.substr(nEq + 1);
+                return true;
+            }
+            nPos = nAmp + 1;
+        }
+        return false;
+    }
+
+    int HexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    // "%20" -> " " (잘못된 % 표기는 그대로 둔다)
+    std::string DecodeUrlPath(const std::string& strPath)
+    {
+        std::string strOut;
+        for (size_t i = 0; i < strPath.size(); ++i)
+        {
+            if (strPath[i] == '%' && i + 2 < strPath.size() && HexValue(strPath[i + 1]) >= 0 && HexValue(strPath[i + 2]) >= 0)
+            {
+                strOut += static_cast<char>(HexValue(strPath[i + 1]) * 16 + HexValue(strPath[i + 2]));
+                i += 2;
+            }
+            else
+            {
+                strOut += strPath[i];
+            }
+        }
+        return strOut;
+    }
+
+    // 원본 폴더 밖을 가리킬 수 있는 경로(절대 경로, .. 구성 요소)는 받지 않는다.
+    bool IsSafeRelativePath(const std::string& strPath)
+    {
+        if (strPath.empty() || strPath.find('\0') != std::string::npos)
+            return false;
+
+        const std::filesystem::path path(strPath);
+        if (path.is_absolute() || path.has_root_name() || path.has_root_directory())
+            return false;
+
+        for (const auto& part : path)
+        {
+            if (part == "..")
+                return false;
+        }
+        return true;
+    }
+}
+
+HttpServer::HttpServer(const HttpServerOption& option)
+    : m_option(option)
+    , m_engine(option.convertOption)
+    , m_bStop(false)
+    , m_nInflightBytes(0)
+    , m_nRequests(0)
+    , m_nConverted(0)
+    , m_nFailed(0)
+    , m_nRejected(0)
+    , m_nBatches(0)
+    , m_nBatchedItems(0)
+{
+}
+
+HttpServer::~HttpServer()
+{
+    Stop();
+}
+
+bool HttpServer::Start()
+{
+    if (m_option.bCache)
+    {
+        m_pCache.reset(new ConversionCache(m_option.cacheOption));
+        if (!m_pCache->Open())
+            return false;
+    }
+
+    m_listenSocket = SocketUtil::Listen(m_option.strHost, m_option.nPort, 128);
+    if (m_listenSocket == INVALID_SOCKET)
+    {
+        std::cerr << "Error: listen 실패: " << m_option.strHost << ":" << m_option.nPort << "\n";
+        return false;
+    }
+
+    JobPoolOption poolOption;
+    poolOption.nWorkerCount = m_option.nWorkerCount;
+    poolOption.nReservedHighWorkers = m_option.nReservedHighWorkers;
+    poolOption.ePolicy = m_option.eLanePolicy;
+    poolOption.nHighWeight = m_option.nHighWeight;
+    m_pJobPool.reset(new JobPool(poolOption));
+    m_bStop = false;
+    m_bStopBatch = false;
+    m_threadBatch = std::thread(&HttpServer::BatchLoop, this);
+
+    const int nConnectionThreads = std::max(1, std::min(m_option.nConnectionThreads, m_option.nMaxConnections));
+    for (int i = 0; i < nConnectionThreads; ++i)
+        m_vecConnectionThreads.emplace_back(&HttpServer::ConnectionLoop, this);
+
+    m_threadAccept = std::thread(&HttpServer::AcceptLoop, this);
+    return true;
+}
+
+void HttpServer::Stop()
+{
+    if (m_bStop.exchange(true))
+        return;
+
+    if (m_listenSocket != INVALID_SOCKET)
+    {
+        SocketUtil::ShutdownBoth(m_listenSocket);
+        SocketUtil::Close(m_listenSocket);
+        m_listenSocket = INVALID_SOCKET;
+    }
+
+    if (m_threadAccept.joinable())
+        m_threadAccept.join();
+
+    // 연결 스레드는 처리 중인 요청을 끝내고(recv 타임아웃마다 m_bStop 확인) 큐에 남은 소켓을 닫은 뒤 종료한다.
+    {
+        std::lock_guard<std::mutex> lock(m_mutexConnection); // wait 직전에 m_bStop 을 확인한 스레드가 알림을 놓치지 않도록
+    }
+    m_cvConnection.notify_all();
+    for (auto& thread : m_vecConnectionThreads)
+        thread.join();
+    m_vecConnectionThreads.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexBatch);
+        m_bStopBatch = true;
+    }
+    m_cvBatch.notify_all();
+    if (m_threadBatch.joinable())
+        m_threadBatch.join();
+
+    if (m_pJobPool)
+        m_pJobPool->stop();
+}
+
+HttpServerStats HttpServer::GetStats() const
+{
+    HttpServerStats stats;
+    stats.nRequests = m_nRequests.load();
+    stats.nConverted = m_nConverted.load();
+    stats.nFailed = m_nFailed.load();
+    stats.nRejected = m_nRejected.load();
+    stats.nBatches = m_nBatches.load();
+    stats.nBatchedItems = m_nBatchedItems.load();
+    stats.nInflightBytes = m_nInflightBytes.load();
+    stats.bCache = m_pCache != nullptr;
+    if (m_pCache)
+        stats.cache = m_pCache->GetStats();
+    return stats;
+}
+
+void HttpServer::AcceptLoop()
+{
+    while (!m_bStop)
+    {
+        socket_t sock = SocketUtil::Accept(m_listenSocket);
+        if (sock == INVALID_SOCKET)
+        {
+            if (m_bStop)
+                break;
+            continue;
+        }
+
+        bool bQueued = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutexConnection);
+            if (m_nActiveConnections + static_cast<int>(m_deqAccepted.size()) < m_option.nMaxConnections)
+            {
+                m_deqAccepted.push_back(sock);
+                bQueued = true;
+            }
+        }
+
+        if (!bQueued)
+        {
+            static const char szBusy[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            SocketUtil::SendAll(sock, szBusy, sizeof(szBusy) - 1);
+            SocketUtil::Close(sock);
+            continue;
+        }
+        m_cvConnection.notify_one();
+    }
+}
+
+void HttpServer::ConnectionLoop()
+{
+    while (true)
+    {
+        socket_t sock;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexConnection);
+            m_cvConnection.wait(lock, [this]() { return m_bStop || !m_deqAccepted.empty(); });
+            if (m_deqAccepted.empty())
+                break;
+
+            sock = m_deqAccepted.front();
+            m_deqAccepted.pop_front();
+            ++m_nActiveConnections;
+        }
+
+        // 종료 중이면 HandleConnection 은 요청을 읽지 않고 바로 돌아온다.
+        HandleConnection(sock);
+
+        // 자리를 먼저 비우고 닫는다. (닫힌 것을 보고 바로 다시 연결한 클라이언트가 503 을 받지 않도록)
+        {
+            std::lock_guard<std::mutex> lock(m_mutexConnection);
+            --m_nActiveConnections;
+        }
+        SocketUtil::Close(sock);
+    }
+}
+
+bool HttpServer::HasWaitingConnection()
+{
+    std::lock_guard<std::mutex> lock(m_mutexConnection);
+    return !m_deqAccepted.empty();
+}
+
+void HttpServer::HandleConnection(socket_t sock)
+{
+    SocketUtil::SetNoDelay(sock);
+    SocketUtil::SetRecvTimeout(sock, RECV_TIMEOUT_MS);
+
+    std::string strBuffer;
+    while (!m_bStop)
+    {
+        HttpRequest request;
+        if (!ReadRequestHead(sock, strBuffer, request))
+            break;
+
+        ++m_nRequests;
+
+        // 연결 스레드가 모자라면 이 응답 뒤에 연결을 닫아서 큐에서 기다리는 연결에 차례를 넘긴다.
+        if (request.bKeepAlive && HasWaitingConnection())
+            request.bKeepAlive = false;
+
+        if (request.strPath == "/healthz")
+        {
+            if (!SendResponse(sock, 200, "text/plain", "ok", 2, request.bKeepAlive) || !request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        if (request.strPath == "/stats")
+        {
+            const HttpServerStats stats = GetStats();
+            std::ostringstream oss;
+            oss << "{\"requests\":" << stats.nRequests << ",\"converted\":" << stats.nConverted
+                << ",\"failed\":" << stats.nFailed << ",\"rejected\":" << stats.nRejected
+                << ",\"batches\":" << stats.nBatches << ",\"batched_items\":" << stats.nBatchedItems
+                << ",\"inflight_bytes\":" << stats.nInflightBytes
+                << ",\"queue\":" << m_pJobPool->getCurrentQueueSize()
+                << ",\"active_workers\":" << m_pJobPool->getActivatedWorkerCount() << ",\"lanes\":{";
+            for (int nLane = 0; nLane < JOB_PRIORITY_COUNT; ++nLane)
+            {
+                const JobLaneStats lane = m_pJobPool->getLaneStats(static_cast<JOB_PRIORITY>(nLane));
+                oss << (nLane > 0 ? "," : "") << "\"" << GetJobPriorityString(static_cast<JOB_PRIORITY>(nLane)) << "\":{"
+                    << "\"submitted\":" << lane.nSubmitted << ",\"completed\":" << lane.nCompleted << ",\"queued\":" << lane.nQueued
+                    << ",\"wait_p50_ms\":" << lane.queueWait.fP50Ms << ",\"wait_p99_ms\":" << lane.queueWait.fP99Ms
+                    << ",\"total_p50_ms\":" << lane.total.fP50Ms << ",\"total_p99_ms\":" << lane.total.fP99Ms
+                    << ",\"total_max_ms\":" << lane.total.fMaxMs << "}";
+            }
+            oss << "}";
+            if (stats.bCache)
+            {
+                oss << ",\"cache\":{\"memory_hits\":" << stats.cache.nMemoryHits << ",\"disk_hits\":" << stats.cache.nDiskHits
+                    << ",\"shared_hits\":" << stats.cache.nSharedHits << ",\"misses\":" << stats.cache.nMisses
+                    << ",\"failed\":" << stats.cache.nFailed << ",\"hit_ratio\":" << stats.cache.GetHitRatio()
+                    << ",\"memory_entries\":" << stats.cache.nMemoryEntries << ",\"memory_bytes\":" << stats.cache.nMemoryBytes
+                    << ",\"memory_evictions\":" << stats.cache.nMemoryEvictions << ",\"disk_entries\":" << stats.cache.nDiskEntries
+                    << ",\"disk_bytes\":" << stats.cache.nDiskBytes << ",\"disk_evictions\":" << stats.cache.nDiskEvictions
+                    << ",\"disk_write_failed\":" << stats.cache.nDiskWriteFailed << "}";
+            }
+            oss << "}";
+            const std::string strBody = oss.str();
+            if (!SendResponse(sock, 200, "application/json", strBody.data(), strBody.size(), request.bKeepAlive) || !request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        if (request.strPath.compare(0, 7, "/image/") == 0 && request.strMethod == "GET")
+        {
+            if (!ReadBody(sock, strBuffer, request.nContentLength, nullptr))
+                break;
+            HandleImage(sock, request);
+            if (!request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        if (request.strPath != "/convert")
+        {
+            if (!ReadBody(sock, strBuffer, request.nContentLength, nullptr) || !SendResponse(sock, 404, "text/plain", "", 0, request.bKeepAlive) || !request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        if (request.strMethod != "POST")
+        {
+            if (!ReadBody(sock, strBuffer, request.nContentLength, nullptr) || !SendResponse(sock, 405, "text/plain", "", 0, request.bKeepAlive) || !request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        if (!request.bHasContentLength)
+        {
+            SendResponse(sock, 411, "text/plain", "", 0, false); // chunked 전송은 지원하지 않음
+            break;
+        }
+
+        if (request.nContentLength > m_option.nMaxBodyBytes)
+        {
+            SendResponse(sock, 413, "text/plain", "", 0, false);
+            break;
+        }
+
+        // 승인 제어: 처리 중 바이트가 상한을 넘으면 본문을 버리고 즉시 429
+        if (!TryAdmit(request.nContentLength))
+        {
+            ++m_nRejected;
+            if (!ReadBody(sock, strBuffer, request.nContentLength, nullptr) || !SendResponse(sock, 429, "text/plain", "", 0, request.bKeepAlive) || !request.bKeepAlive)
+                break;
+            continue;
+        }
+
+        std::vector<uint8_t> vecBody;
+        if (!ReadBody(sock, strBuffer, request.nContentLength, &vecBody))
+        {
+            Release(request.nContentLength);
+            break;
+        }
+
+        const size_t nAdmitted = request.nContentLength;
+        HandleConvert(sock, request, std::move(vecBody));
+        Release(nAdmitted);
+
+        if (!request.bKeepAlive)
+            break;
+    }
+
+}
+
+bool HttpServer::ReadRequestHead(socket_t sock, std::string& strBuffer, HttpRequest& request)
+{
+    int nIdleMs = 0;
+    size_t nHeadEnd;
+    while ((nHeadEnd = strBuffer.find("\r\n\r\n")) == std::string::npos)
+    {
+        if (strBuffer.size() > MAX_HEADER_BYTES)
+            return false;
+
+        char szChunk[4096];
+        const int nRead = SocketUtil::Recv(sock, szChunk, sizeof(szChunk));
+        if (nRead == 0)
+            return false;
+
+        if (nRead < 0)
+        {
+            if (!SocketUtil::LastErrorIsTimeout() || m_bStop)
+                return false;
+
+            // 요청 사이에 쉬고 있는 keep-alive 연결은 기다리는 연결에 스레드를 넘긴다.
+            if (strBuffer.empty() && HasWaitingConnection())
+                return false;
+
+            nIdleMs += RECV_TIMEOUT_MS;
+            if (nIdleMs >= KEEP_ALIVE_IDLE_MS)
+                return false;
+            continue;
+        }
+
+        nIdleMs = 0;
+        strBuffer.append(szChunk, static_cast<size_t>(nRead));
+    }
+
+    std::istringstream iss(strBuffer.substr(0, nHeadEnd));
+    strBuffer.erase(0, nHeadEnd + 4);
+
+    std::string strLine;
+    if (!std::getline(iss, strLine))
+        return false;
+
+    std::string strTarget, strVersion;
+    std::istringstream issLine(strLine);
+    issLine >> request.strMethod >> strTarget >> strVersion;
+    if (request.strMethod.empty() || strTarget.empty())
+        return false;
+
+    const size_t nQuestion = strTarget.find('?');
+    request.strPath = strTarget.substr(0, nQuestion);
+    if (nQuestion != std::string::npos)
+        request.strQuery = strTarget.substr(nQuestion + 1);
+
+    request.bKeepAlive = (Trim(strVersion) != "HTTP/1.0");
+
+    while (std::getline(iss, strLine))
+    {
+        const size_t nColon = strLine.find(':');
+        if (nColon == std::string::npos)
+            continue;
+
+        const std::string strName = ToLower(Trim(strLine.substr(0, nColon)));
+        const std::string strValue = Trim(strLine.substr(nColon + 1));
+
+        if (strName == "content-length")
+        {
+            request.nContentLength = static_cast<size_t>(std::strtoull(strValue.c_str(), nullptr, 10));
+            request.bHasContentLength = true;
+        }
+        else if (strName == "connection")
+        {
+            const std::string strLower = ToLower(strValue);
+            if (strLower == "close")
+                request.bKeepAlive = false;
+            else if (strLower == "keep-alive")
+                request.bKeepAlive = true;
+        }
+    }
+    return true;
+}
+
+bool HttpServer::ReadBody(socket_t sock, std::string& strBuffer, size_t nLength, std::vector<uint8_t>* pBody)
+{
+    // 헤더와 함께 이미 받아 둔 바이트부터 사용
+    const size_t nBuffered = std::min(nLength, strBuffer.size());
+    if (pBody)
+    {
+        pBody->reserve(nLength);
+        pBody->assign(strBuffer.begin(), strBuffer.begin() + static_cast<std::ptrdiff_t>(nBuffered));
+    }
+    strBuffer.erase(0, nBuffered);
+
+    size_t nRemain = nLength - nBuffered;
+    if (pBody)
+        pBody->resize(nLength);
+
+    // 연결 스레드 수가 고정이라, 멈춘 클라이언트가 스레드를 붙잡지 않도록 무응답/전체 시간에 상한을 둔다.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(BODY_TOTAL_MS);
+    int nIdleMs = 0;
+    char szDiscard[16384];
+    while (nRemain > 0)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+        uint8_t* pDest = pBody ? pBody->data() + (nLength - nRemain) : reinterpret_cast<uint8_t*>(szDiscard);
+        const size_t nWant = pBody ? nRemain : std::min(nRemain, sizeof(szDiscard));
+        const int nRead = SocketUtil::Recv(sock, pDest, nWant);
+        if (nRead <= 0)
+        {
+            if (nRead == 0 || !SocketUtil::LastErrorIsTimeout() || m_bStop)
+                return false;
+
+            nIdleMs += RECV_TIMEOUT_MS;
+            if (nIdleMs >= BODY_IDLE_MS)
+                return false;
+            continue;
+        }
+        nIdleMs = 0;
+        nRemain -= static_cast<size_t>(nRead);
+    }
+    return true;
+}
+
+void HttpServer::ParseConvertQuery(const HttpRequest& request, ConvertOption& option, JOB_PRIORITY& ePriority) const
+{
+    option = m_option.convertOption;
+    std::string strValue;
+    if (FindQueryValue(request.strQuery, "quality", strValue))
+    {
+        // 요청에 품질을 직접 지정하면 적응형 품질보다 우선한다.
+        option.fQuality = std::max(0.0f, std::min(100.0f, static_cast<float>(std::atof(strValue.c_str()))));
+        option.pAdaptiveQuality.reset();
+    }
+
+    ePriority = (FindQueryValue(request.strQuery, "priority", strValue) && strValue == "high") ? JOB_PRIORITY_HIGH : JOB_PRIORITY_NORMAL;
+}
+
+void HttpServer::HandleConvert(socket_t sock, const HttpRequest& request, std::vector<uint8_t>&& vecBody)
+{
+    ConvertOption option;
+    JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL;
+    ParseConvertQuery(request, option, ePriority);
+
+    auto convert = [&](std::vector<uint8_t>& vecWebp, ConvertResult& result)
+    {
+        ConvertReply reply = Submit(std::move(vecBody), option, ePriority).get();
+        vecWebp.swap(reply.vecWebp);
+        result = reply.result;
+        return reply.bOk;
+    };
+
+    CacheLookup lookup;
+    if (m_pCache)
+    {
+        lookup = m_pCache->GetOrConvert(ConversionCache::MakeContentKey(vecBody.data(), vecBody.size(), option), convert);
+    }
+    else
+    {
+        std::shared_ptr<std::vector<uint8_t>> pWebp = std::make_shared<std::vector<uint8_t>>();
+        lookup.bOk = convert(*pWebp, lookup.result);
+        lookup.pWebp = pWebp;
+    }
+    SendConvertReply(sock, request, lookup);
+}
+
+void HttpServer::HandleImage(socket_t sock, const HttpRequest& request)
+{
+    const std::string strRelative = DecodeUrlPath(request.strPath.substr(7));
+    if (m_option.strRoot.empty() || !IsSafeRelativePath(strRelative))
+    {
+        SendResponse(sock, 404, "text/plain", "", 0, request.bKeepAlive);
+        return;
+    }
+
+    // 캐시 적중이면 원본은 크기/수정 시각만 확인하고 읽지 않는다.
+    const std::string strPath = (std::filesystem::path(m_option.strRoot) / strRelative).string();
+    std::error_code ec;
+    const uint64_t nFileSize = std::filesystem::is_regular_file(strPath, ec) ? std::filesystem::file_size(strPath, ec) : 0;
+    const auto modifiedTime = std::filesystem::last_write_time(strPath, ec);
+    if (ec || nFileSize == 0)
+    {
+        SendResponse(sock, 404, "text/plain", "", 0, request.bKeepAlive);
+        return;
+    }
+
+    // POST 와 같은 본문 크기 상한과 처리 중 바이트 승인 제어를 원본 파일 크기로 적용한다.
+    if (nFileSize > m_option.nMaxBodyBytes)
+    {
+        SendResponse(sock, 413, "text/plain", "", 0, request.bKeepAlive);
+        return;
+    }
+    const size_t nAdmitted = static_cast<size_t>(nFileSize);
+    if (!TryAdmit(nAdmitted))
+    {
+        ++m_nRejected;
+        SendResponse(sock, 429, "text/plain", "", 0, request.bKeepAlive);
+        return;
+    }
+
+    ConvertOption option;
+    JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL;
+    ParseConvertQuery(request, option, ePriority);
+
+    auto convert = [&](std::vector<uint8_t>& vecWebp, ConvertResult& result)
+    {
+        std::vector<uint8_t> vecJpeg;
+        if (!ReadFileToMemory(strPath, vecJpeg))
+        {
+            result.eStatus = CONVERT_ERR_READ;
+            return false;
+        }
+        ConvertReply reply = Submit(std::move(vecJpeg), option, ePriority).get();
+        vecWebp.swap(reply.vecWebp);
+        result = reply.result;
+        return reply.bOk;
+    };
+
+    CacheLookup lookup;
+    if (m_pCache)
+    {
+        const int64_t nModifiedTime = static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+        lookup = m_pCache->GetOrConvert(ConversionCache::MakePathKey(strPath, nFileSize, nModifiedTime, option), convert);
+    }
+    else
+    {
+        std::shared_ptr<std::vector<uint8_t>> pWebp = std::make_shared<std::vector<uint8_t>>();
+        lookup.bOk = convert(*pWebp, lookup.result);
+        lookup.pWebp = pWebp;
+    }
+    Release(nAdmitted);
+    SendConvertReply(sock, request, lookup);
+}
+
+void HttpServer::SendConvertReply(socket_t sock, const HttpRequest& request, const CacheLookup& lookup)
+{
+    const char* pszCacheTier = m_pCache ? GetCacheTierString(lookup.eTier) : nullptr;
+    if (lookup.bOk)
+    {
+        if (lookup.eTier == CACHE_TIER_CONVERTED)
+            ++m_nConverted;
+        SendResponse(sock, 200, "image/webp", lookup.pWebp->data(), lookup.pWebp->size(), request.bKeepAlive, pszCacheTier);
+    }
+    else
+    {
+        ++m_nFailed;
+        const char* pszReason = GetConvertStatusString(lookup.result.eStatus);
+        SendResponse(sock, GetHttpStatus(lookup.result.eStatus), "text/plain", pszReason, std::char_traits<char>::length(pszReason), request.bKeepAlive, pszCacheTier);
+    }
+}
+
+bool HttpServer::SendResponse(socket_t sock, int nStatus, const char* pszContentType, const void* pBody, size_t nBodySize, bool bKeepAlive, const char* pszCacheTier /*= nullptr*/)
+{
+    std::ostringstream oss;
+    oss << "HTTP/1.1 " << nStatus << " " << GetStatusText(nStatus) << "\r\n"
+        << "Content-Type: " << pszContentType << "\r\n"
+        << "Content-Length: " << nBodySize << "\r\n"
+        << "Connection: " << (bKeepAlive ? "keep-alive" : "close") << "\r\n";
+    if (nStatus == 429)
+        oss << "Retry-After: 1\r\n";
+    if (pszCacheTier)
+        oss << "X-Cache: " << pszCacheTier << "\r\n";
+    oss << "\r\n";
+
+    const std::string strHead = oss.str();
+    if (!SocketUtil::SendAll(sock, strHead.data(), strHead.size()))
+        return false;
+
+    return nBodySize == 0 || SocketUtil::SendAll(sock, pBody, nBodySize);
+}
+
+bool HttpServer::TryAdmit(size_t nBytes)
+{
+    uint64_t nCurrent = m_nInflightBytes.load();
+    while (true)
+    {
+        // 요청 하나가 상한보다 크더라도 아무것도 처리 중이 아니면 받아들인다. (기아 방지)
+        if (nCurrent != 0 && nCurrent + nBytes > m_option.nMaxInflightBytes)
+            return false;
+
+        if (m_nInflightBytes.compare_exchange_weak(nCurrent, nCurrent + nBytes))
+            return true;
+    }
+}
+
+std::future<HttpServer::ConvertReply> HttpServer::Submit(std::vector<uint8_t>&& vecJpeg, const ConvertOption& option, JOB_PRIORITY ePriority)
+{
+    auto pTask = std::make_shared<ConvertTask>();
+    pTask->vecJpeg = std::move(vecJpeg);
+    pTask->option = option;
+    std::future<ConvertReply> future = pTask->promise.get_future();
+
+    // 큰 요청과 HIGH 요청은 단독으로 작업자에 넘긴다. (HIGH 는 배치 창을 기다리지 않는다)
+    if (ePriority == JOB_PRIORITY_HIGH || pTask->vecJpeg.size() > m_option.nSmallRequestBytes || m_option.nMaxBatchSize <= 1)
+    {
+        m_pJobPool->push([this, pTask]() { RunTask(pTask); }, ePriority);
+        return future;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexBatch);
+        if (m_vecPending.empty())
+        {
+            // 쉬고 있는 일반 작업자가 있으면 배치 창을 기다릴 이유가 없다. 모든 작업자가 바쁠 때만 모아서 한 번에 넣는다.
+            const int nNormalWorkers = m_pJobPool->getTotalWorkerCount() - m_pJobPool->getReservedHighWorkerCount();
+            if (m_pJobPool->getActivatedWorkerCount() + m_pJobPool->getCurrentQueueSize() < nNormalWorkers)
+            {
+                m_pJobPool->push([this, pTask]() { RunTask(pTask); });
+                return future;
+            }
+            m_timeFirstPending = std::chrono::steady_clock::now();
+        }
+
+        m_vecPending.push_back(pTask);
+        if (static_cast<int>(m_vecPending.size()) >= m_option.nMaxBatchSize)
+            FlushPendingLocked();
+    }
+    m_cvBatch.notify_one();
+    return future;
+}
+
+void HttpServer::BatchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutexBatch);
+    while (!m_bStopBatch)
+    {
+        if (m_vecPending.empty())
+        {
+            m_cvBatch.wait(lock, [this]() { return m_bStopBatch || !m_vecPending.empty(); });
+            continue;
+        }
+
+        // 가장 오래된 대기 요청이 batchWindow 를 넘기면 덜 찬 배치라도 내보낸다.
+        const auto deadline = m_timeFirstPending + m_option.batchWindow;
+        if (std::chrono::steady_clock::now() >= deadline)
+            FlushPendingLocked();
+        else
+            m_cvBatch.wait_until(lock, deadline);
+    }
+    FlushPendingLocked();
+}
+
+void HttpServer::FlushPendingLocked()
+{
+    if (m_vecPending.empty())
+        return;
+
+    // 배치는 풀 큐 잠금과 작업자 깨우기를 한 번으로 묶는다. 변환은 항목마다 작업으로 나눠서 작업자들이 나눠 맡는다.
+    // (한 작업자가 배치를 연속으로 변환하면 마지막 항목이 앞 항목 변환 시간을 모두 기다려서 p99 가 배치 크기만큼 늘어난다)
+    ++m_nBatches;
+    m_nBatchedItems += m_vecPending.size();
+
+    std::vector<std::function<void()>> vecJob;
+    vecJob.reserve(m_vecPending.size());
+    for (auto& pTask : m_vecPending)
+        vecJob.push_back([this, pTask]() { RunTask(pTask); });
+    m_vecPending.clear();
+    m_pJobPool->pushBatch(std::move(vecJob));
+}
+
+void HttpServer::RunTask(const std::shared_ptr<ConvertTask>& pTask)
+{
+    // 디코더 핸들과 평면 버퍼는 작업자 스레드 로컬이라 같은 작업자가 다음 항목에서 그대로 재사용한다.
+    // 예외도 실패 응답(500)으로 바꿔서 promise 를 채운다. 그러지 않으면 연결 스레드가 get() 에서 영원히 기다린다.
+    ConvertReply reply;
+    try
+    {
+        reply.bOk = m_engine.ConvertMemory(pTask->vecJpeg.data(), pTask->vecJpeg.size(), pTask->option, reply.vecWebp, reply.result);
+    }
+    catch (const std::bad_alloc&)
+    {
+        reply = ConvertReply();
+        reply.result.eStatus = CONVERT_ERR_ALLOC;
+        LogError("serve", "변환 중 메모리 할당 실패 (" + std::to_string(pTask->vecJpeg.size()) + " 바이트 요청)");
+    }
+    catch (const std::exception& e)
+    {
+        reply = ConvertReply();
+        reply.result.eStatus = CONVERT_ERR_ENCODE;
+        LogError("serve", std::string("변환 중 예외: ") + e.what());
+    }
+    catch (...)
+    {
+        reply = ConvertReply();
+        reply.result.eStatus = CONVERT_ERR_ENCODE;
+        LogError("serve", "변환 중 알 수 없는 예외");
+    }
+    pTask->vecJpeg.clear();
+    pTask->vecJpeg.shrink_to_fit();
+    pTask->promise.set_value(std::move(reply));
+}
+
+int RunServe(const CliArgs& args)
+{
+    HttpServerOption option;
+    option.strHost = args.GetString("host", option.strHost);
+    option.nPort = static_cast<uint16_t>(args.GetInt("port", option.nPort));
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", option.nWorkerCount));
+    option.nReservedHighWorkers = static_cast<int>(args.GetInt("reserved-high", option.nReservedHighWorkers));
+    option.nHighWeight = static_cast<int>(args.GetInt("high-weight", option.nHighWeight));
+    const std::string strLanePolicy = args.GetString("lane-policy", "strict");
+    if (strLanePolicy != "strict" && strLanePolicy != "weighted")
+    {
+        std::cerr << "Error: --lane-policy 는 strict 또는 weighted 여야 합니다: " << strLanePolicy << "\n";
+        return 2;
+    }
+    option.eLanePolicy = (strLanePolicy == "weighted") ? LANE_POLICY_WEIGHTED : LANE_POLICY_STRICT;
+    option.nMaxConnections = static_cast<int>(args.GetInt("max-connections", option.nMaxConnections));
+    option.nConnectionThreads = static_cast<int>(args.GetInt("connection-threads", option.nConnectionThreads));
+    option.nMaxBodyBytes = static_cast<size_t>(args.GetInt("max-body-mb", static_cast<long long>(option.nMaxBodyBytes >> 20))) << 20;
+    option.nMaxInflightBytes = static_cast<size_t>(args.GetInt("max-inflight-mb", static_cast<long long>(option.nMaxInflightBytes >> 20))) << 20;
+    option.nSmallRequestBytes = static_cast<size_t>(args.GetInt("small-kb", static_cast<long long>(option.nSmallRequestBytes >> 10))) << 10;
+    option.nMaxBatchSize = static_cast<int>(args.GetInt("batch", option.nMaxBatchSize));
+    option.batchWindow = std::chrono::microseconds(args.GetInt("batch-window-us", option.batchWindow.count()));
+    option.convertOption.fQuality = static_cast<float>(args.GetDouble("quality", option.convertOption.fQuality));
+    if (!ApplyDecoderOption(args, option.convertOption) || !ApplyEncoderOption(args, option.convertOption) || !ApplyAdaptiveQualityOption(args, option.convertOption))
+        return 2;
+
+    // --cache-mb (메모리 계층) 나 --cache-dir (디스크 계층) 중 하나라도 주면 캐시를 켠다.
+    option.strRoot = args.GetString("root");
+    option.bCache = args.Has("cache-mb") || args.Has("cache-dir");
+    option.cacheOption.nMemoryBytes = static_cast<uint64_t>(args.GetInt("cache-mb", static_cast<long long>(option.cacheOption.nMemoryBytes >> 20))) << 20;
+    option.cacheOption.nShardCount = static_cast<int>(args.GetInt("cache-shards", option.cacheOption.nShardCount));
+    option.cacheOption.strDiskDir = args.GetString("cache-dir");
+    option.cacheOption.nDiskBytes = static_cast<uint64_t>(args.GetInt("cache-disk-mb", static_cast<long long>(option.cacheOption.nDiskBytes >> 20))) << 20;
+
+    if (!SocketUtil::Startup())
+        return 2;
+
+    HttpServer server(option);
+    if (!server.Start())
+    {
+        SocketUtil::Cleanup();
+        return 2;
+    }
+
+    std::cout << "listening on http://" << option.strHost << ":" << option.nPort << " (Ctrl+C 로 종료)\n";
+
+    std::signal(SIGINT, OnInterrupt);
+    std::signal(SIGTERM, OnInterrupt);
+    while (!g_bInterrupted)
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    server.Stop();
+    SocketUtil::Cleanup();
+
+    const HttpServerStats stats = server.GetStats();
+    std::cout << "requests=" << stats.nRequests << " converted=" << stats.nConverted << " failed=" << stats.nFailed
+        << " rejected=" << stats.nRejected << " batches=" << stats.nBatches << " batched_items=" << stats.nBatchedItems << "\n";
+    if (stats.bCache)
+    {
+        std::cout << "cache: hits=" << stats.cache.nMemoryHits << "(memory)+" << stats.cache.nDiskHits << "(disk)+" << stats.cache.nSharedHits
+            << "(shared) misses=" << stats.cache.nMisses << " hit_ratio=" << stats.cache.GetHitRatio()
+            << " memory=" << (stats.cache.nMemoryBytes >> 20) << "MB/" << stats.cache.nMemoryEntries
+            << " disk=" << (stats.cache.nDiskBytes >> 20) << "MB/" << stats.cache.nDiskEntries
+            << " evictions=" << stats.cache.nMemoryEvictions << "(memory)+" << stats.cache.nDiskEvictions << "(disk)\n";
+    }
+    return 0;
+}
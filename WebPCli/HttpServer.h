@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include "ConversionCache.h"
+#include "ConvertEngine.h"
+#include "JobPool.h"
+#include "SocketUtil.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct HttpServerOption
+{
+    std::string strHost = "127.0.0.1";
+    uint16_t nPort = 8080;
+    int nWorkerCount = 0;                            // 0 = 하드웨어 스레드 수
+    int nReservedHighWorkers = 0;                    // ?priority=high 요청만 처리하는 작업자 수
+    LANE_POLICY eLanePolicy = LANE_POLICY_STRICT;
+    int nHighWeight = 4;                             // LANE_POLICY_WEIGHTED 에서 NORMAL 1 개당 HIGH 수
+    int nMaxConnections = 256;                       // 처리 중 + 대기 중 연결 수 상한 (넘으면 503)
+    int nConnectionThreads = 64;                     // 연결을 처리하는 스레드 수 (nMaxConnections 이하로 줄인다)
+    size_t nMaxBodyBytes = 64u << 20;                // 이보다 큰 요청은 413
+    size_t nMaxInflightBytes = 256u << 20;           // 처리 중인 요청 본문 합계가 이를 넘으면 429
+    size_t nSmallRequestBytes = 256u << 10;          // 이하인 요청은 작업자가 모두 바쁘면 micro-batch 로 모아서 한 번에 작업 풀에 넣는다.
+    int nMaxBatchSize = 16;
+    std::chrono::microseconds batchWindow{ 2000 };   // 배치를 채우기 위해 기다리는 최대 시간
+    ConvertOption convertOption;
+    bool bCache = false;                             // 변환 결과 캐시 (POST 는 본문 해시, GET /image 는 경로 키)
+    ConversionCacheOption cacheOption;
+    std::string strRoot;                             // GET /image/<상대 경로> 가 읽는 원본 폴더 (비어 있으면 404)
+};
+
+struct HttpServerStats
+{
+    uint64_t nRequests = 0;
+    uint64_t nConverted = 0;
+    uint64_t nFailed = 0;
+    uint64_t nRejected = 0;      // 429
+    uint64_t nBatches = 0;
+    uint64_t nBatchedItems = 0;
+    uint64_t nInflightBytes = 0;
+    bool bCache = false;
+    ConversionCacheStats cache;
+};
+
+// localhost 전용 변환 서버
+//   POST /convert[?quality=Q][&priority=high]  : 본문 JPEG -> 응답 image/webp
+//                                 priority=high 는 micro-batch 를 거치지 않고 HIGH 줄로 바로 들어간다.
+//   GET  /image/<상대 경로>[?quality=Q][&priority=high]
+//                              : strRoot 아래 JPEG 을 처음 요청될 때 변환해서 image/webp 로 응답 (캐시를 켜면 다음부터 재사용)
+//   GET  /stats                : 카운터 + 줄별 대기/완료 지연 + 캐시 적중 JSON
+//   캐시를 켜면 변환 응답에 X-Cache: memory | disk | shared | miss 헤더를 붙인다.
+//   GET  /healthz
+class HttpServer
+{
+public:
+    explicit HttpServer(const HttpServerOption& option);
+    ~HttpServer();
+
+    bool Start();
+    void Stop();
+
+    HttpServerStats GetStats() const;
+
+private:
+    struct ConvertReply
+    {
+        ConvertResult result;
+        std::vector<uint8_t> vecWebp;
+        bool bOk = false;
+    };
+
+    struct ConvertTask
+    {
+        std::vector<uint8_t> vecJpeg;
+        ConvertOption option;
+        std::promise<ConvertReply> promise;
+    };
+
+    struct HttpRequest
+    {
+        std::string strMethod;
+        std::string strPath;
+        std::string strQuery;
+        size_t nContentLength = 0;
+        bool bHasContentLength = false;
+        bool bKeepAlive = true;
+    };
+
+    void AcceptLoop();
+    void ConnectionLoop();
+    bool HasWaitingConnection();
+    void HandleConnection(socket_t sock);
+    bool ReadRequestHead(socket_t sock, std::string& strBuffer, HttpRequest& request);
+    bool ReadBody(socket_t sock, std::string& strBuffer, size_t nLength, std::vector<uint8_t>* pBody);
+    void HandleConvert(socket_t sock, const HttpRequest& request, std::vector<uint8_t>&& vecBody);
+    void HandleImage(socket_t sock, const HttpRequest& request);
+    void ParseConvertQuery(const HttpRequest& request, ConvertOption& option, JOB_PRIORITY& ePriority) const;
+    void SendConvertReply(socket_t sock, const HttpRequest& request, const CacheLookup& lookup);
+    bool SendResponse(socket_t sock, int nStatus, const char* pszContentType, const void* pBody, size_t nBodySize, bool bKeepAlive, const char* pszCacheTier = nullptr);
+
+    // 소형 요청 micro-batching
+    std::future<ConvertReply> Submit(std::vector<uint8_t>&& vecJpeg, const ConvertOption& option, JOB_PRIORITY ePriority);
+    void BatchLoop();
+    void FlushPendingLocked();
+    void RunTask(const std::shared_ptr<ConvertTask>& pTask);
+
+    bool TryAdmit(size_t nBytes);
+    void Release(size_t nBytes) { m_nInflightBytes -= nBytes; }
+
+    HttpServerOption m_option;
+    ConvertEngine m_engine;
+    std::unique_ptr<JobPool> m_pJobPool;
+    std::unique_ptr<ConversionCache> m_pCache;
+
+    socket_t m_listenSocket = INVALID_SOCKET;
+    std::thread m_threadAccept;
+    std::thread m_threadBatch;
+    std::atomic<bool> m_bStop;
+
+    // 연결 풀: 받은 소켓은 큐에 넣고 고정된 연결 스레드가 꺼내서 처리한다.
+    std::mutex m_mutexConnection;
+    std::condition_variable m_cvConnection;
+    std::deque<socket_t> m_deqAccepted;
+    std::vector<std::thread> m_vecConnectionThreads;
+    int m_nActiveConnections = 0;
+
+    std::mutex m_mutexBatch;
+    std::condition_variable m_cvBatch;
+    bool m_bStopBatch = false; // 모든 연결이 끝난 뒤에 배치 스레드를 멈춘다.
+    std::vector<std::shared_ptr<ConvertTask>> m_vecPending;
+    std::chrono::steady_clock::time_point m_timeFirstPending;
+
+    std::atomic<uint64_t> m_nInflightBytes;
+    std::atomic<uint64_t> m_nRequests;
+    std::atomic<uint64_t> m_nConverted;
+    std::atomic<uint64_t> m_nFailed;
+    std::atomic<uint64_t> m_nRejected;
+    std::atomic<uint64_t> m_nBatches;
+    std::atomic<uint64_t> m_nBatchedItems;
+};
@@ -0,0 +1,124 @@
+﻿#include "Commands.h"
+#include "ArchiveSource.h"
+#include "CorpusIndex.h"
+#include "FileEndpoint.h"
+#include "Logger.h"
+#include <filesystem>
+#include <iostream>
+
+// 헤더만 읽는 코퍼스 사전 검사
+//   WebPCli index photos/ more/ --index photos.wci --recursive
+//   파일마다 JPEG 마커만 읽어서 크기/서브샘플링/progressive/restart/손상 여부를 색인에 저장하고 요약을 출력한다.
+//   같은 색인으로 다시 실행하면 크기나 수정 시각이 바뀐 파일만 다시 읽는다.
+//   convert --index photos.wci 는 같은 색인을 갱신해서 배치 규모를 먼저 보여 주고, 변환할 수 없는 파일은 읽지 않고 건너뛴다.
+
+namespace
+{
+    const char* const DEFAULT_INDEX = "corpus.wci";
+
+    double ToMegapixels(uint64_t nPixels)
+    {
+        return static_cast<double>(nPixels) / 1e6;
+    }
+}
+
+std::vector<std::string> CollectJpegInputs(const CliArgs& args)
+{
+    const bool bRecursive = args.Has("recursive");
+    std::vector<std::string> vecPath;
+    for (const auto& strInput : args.GetPositional())
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(strInput, ec))
+        {
+            const std::vector<std::string> vecFiles = ListJpegFiles(strInput, bRecursive);
+            vecPath.insert(vecPath.end(), vecFiles.begin(), vecFiles.end());
+        }
+        else
+        {
+            vecPath.push_back(strInput);
+        }
+    }
+    return vecPath;
+}
+
+std::string FindJpegInputRoot(const CliArgs& args)
+{
+    std::vector<std::string> vecDirectory;
+    for (const auto& strInput : args.GetPositional())
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(strInput, ec))
+            vecDirectory.push_back(strInput);
+        else if (strInput != "-" && !IsArchiveFileName(strInput))
+            vecDirectory.push_back(std::filesystem::path(strInput).parent_path().string());
+    }
+    return FindInputRoot(vecDirectory);
+}
+
+bool UpdateCorpusIndex(std::ostream& os, const CliArgs& args, const std::vector<std::string>& vecPath, CorpusIndex& index)
+{
+    const std::string strIndexPath = args.GetString("index", DEFAULT_INDEX);
+    if (strIndexPath.empty())
+    {
+        std::cerr << "Error: --index 에 색인 파일 경로가 필요합니다.\n";
+        return false;
+    }
+
+    // 없거나 형식이 다른 색인은 처음부터 다시 만든다.
+    index.Load(strIndexPath);
+    const CorpusScanStats scanStats = index.Update(vecPath, static_cast<int>(args.GetInt("threads", 0)));
+    if (!index.Save(strIndexPath))
+    {
+        std::cerr << "Error: 색인을 쓰지 못했습니다: " << strIndexPath << "\n";
+        return false;
+    }
+
+    os << "index: files=" << vecPath.size() << " reused=" << scanStats.nReused << " scanned=" << scanStats.nScanned
+        << " removed=" << scanStats.nRemoved << " " << scanStats.fElapsedSec << "s file=" << strIndexPath << "\n";
+
+    for (const auto& file : index.GetFiles())
+    {
+        if (file.info.eStatus == JPEG_SCAN_UNREADABLE)
+            LogError("index", "파일을 열지 못했습니다: " + file.strPath);
+        else if (file.info.eStatus != JPEG_SCAN_OK)
+            LogWarn("index", "손상된 JPEG 헤더: " + file.strPath);
+    }
+    return true;
+}
+
+void PrintCorpusSummary(std::ostream& os, const CorpusSummary& summary)
+{
+    static const char* const subsampNames[] = { "unknown", "444", "422", "420", "gray", "440", "411" };
+
+    os << "corpus: files=" << summary.nFiles << " bytes=" << summary.nBytes << " pixels=" << ToMegapixels(summary.nPixels)
+        << "MP max=" << summary.nMaxWidth << "x" << summary.nMaxHeight << " progressive=" << summary.nProgressive << " restart=" << summary.nRestart
+        << " corrupt=" << summary.nCorrupt << " unreadable=" << summary.nUnreadable << "\n";
+
+    os << "subsamp:";
+    for (size_t i = 0; i < sizeof(subsampNames) / sizeof(subsampNames[0]); ++i)
+    {
+        if (summary.nSubSampling[i] > 0)
+            os << " " << subsampNames[i] << "=" << summary.nSubSampling[i];
+    }
+    os << "\n";
+}
+
+int RunIndex(const CliArgs& args)
+{
+    const std::vector<std::string> vecPath = CollectJpegInputs(args);
+    if (vecPath.empty())
+    {
+        std::cerr << "Error: 검사할 JPEG 파일이 없습니다.\n";
+        return 2;
+    }
+
+    CorpusIndex index;
+    if (!UpdateCorpusIndex(std::cout, args, vecPath, index))
+        return 2;
+
+    const CorpusSummary summary = index.Summarize();
+    PrintCorpusSummary(std::cout, summary);
+    Logger::Flush();
+    return (summary.nCorrupt > 0 || summary.nUnreadable > 0) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+﻿#include "Commands.h"
+#include "PlanePipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// 평면 루프 비교: 기준 경로(표 조회 범위 변환) vs 특수화한 파이프라인(SelectPlanePipeline 로 고른 인스턴스)
+//   WebPCli bench-kernels [--sizes 640x480,1920x1080,4000x3000] [--iterations 20]
+//   크기마다 같은 평면을 두 경로로 --iterations 번 처리해서 최선 시간의 MP/s 와 배율, 결과 일치 여부를 출력한다.
+//   디코딩/인코딩은 포함하지 않는다. (전체 변환에서 차지하는 비중은 --trace 의 range_map 구간으로 확인)
+
+namespace
+{
+    struct PlaneSize
+    {
+        int nWidth = 0;
+        int nHeight = 0;
+    };
+
+    bool ParseSizes(const std::string& strList, std::vector<PlaneSize>& vecSize)
+    {
+        std::stringstream ss(strList);
+        std::string strItem;
+        while (std::getline(ss, strItem, ','))
+        {
+            PlaneSize size;
+            char chX = 0;
+            std::istringstream iss(strItem);
+            if (!(iss >> size.nWidth >> chX >> size.nHeight) || chX != 'x' || size.nWidth <= 0 || size.nHeight <= 0)
+                return false;
+            vecSize.push_back(size);
+        }
+        return !vecSize.empty();
+    }
+
+    // 0..255 가 고르게 섞인 재현 가능한 평면 (LCG)
+    void FillPlane(std::vector<uint8_t>& vecPlane)
+    {
+        uint32_t nState = 12345;
+        for (auto& value : vecPlane)
+        {
+            nState = nState * 1664525u + 1013904223u;
+            value = static_cast<uint8_t>(nState >> 24);
+        }
+    }
+
+    template <typename F>
+    double MeasureBestSec(int nIterations, std::vector<uint8_t>& vecWork, const std::vector<uint8_t>& vecSource, F run)
+    {
+        double fBestSec = 0.0;
+        for (int nIter = 0; nIter < nIterations; ++nIter)
+        {
+            std::copy(vecSource.begin(), vecSource.end(), vecWork.begin());
+            const auto startTime = std::chrono::steady_clock::now();
+            run();
+            const double fSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            if (nIter == 0 || fSec < fBestSec)
+                fBestSec = fSec;
+        }
+        return fBestSec;
+    }
+}
+
+int RunBenchKernels(const CliArgs& args)
+{
+    std::vector<PlaneSize> vecSize;
+    const std::string strSizes = args.GetString("sizes", "640x480,1920x1080,4000x3000");
+    if (!ParseSizes(strSizes, vecSize))
+    {
+        std::cerr << "Error: --sizes 는 WxH,WxH 형식이어야 합니다: " << strSizes << "\n";
+        return 2;
+    }
+    const int nIterations = std::max(1, static_cast<int>(args.GetInt("iterations", 20)));
+
+    const LimitedRangeTable table;
+    int nExitCode = 0;
+    std::printf("%-12s %10s %12s %12s %8s %6s\n", "size", "pipeline", "generic_MP/s", "special_MP/s", "speedup", "match");
+
+    for (const PlaneSize& size : vecSize)
+    {
+        const size_t nYSize = static_cast<size_t>(size.nWidth) * static_cast<size_t>(size.nHeight);
+        std::vector<uint8_t> vecSource(nYSize), vecGeneric(nYSize), vecSpecial(nYSize);
+        FillPlane(vecSource);
+
+        // 기준 경로: 이미지마다 표 조회 + 크로마 크기 계산 + memset (특수화 전 ConvertEngine 과 같은 루프)
+        std::vector<uint8_t> vecUV;
+        const double fGenericSec = MeasureBestSec(nIterations, vecGeneric, vecSource, [&]()
+        {
+            MapRangeGeneric(table, vecGeneric.data(), nYSize);
+            const size_t nUVSize = static_cast<size_t>((size.nWidth + 1) / 2) * static_cast<size_t>((size.nHeight + 1) / 2);
+            vecUV.resize(nUVSize);
+            std::memset(vecUV.data(), 128, nUVSize);
+        });
+
+        // 특수화 경로: 헤더로 한 번 고른 인스턴스
+        const PlanePipeline* pPipeline = SelectPlanePipeline(JPEG_SUBSAMP_GRAY);
+        const double fSpecialSec = MeasureBestSec(nIterations, vecSpecial, vecSource, [&]()
+        {
+            pPipeline->pfnMapRange(vecSpecial.data(), nYSize);
+            const size_t nUVSize = static_cast<size_t>(pPipeline->pfnGetChromaWidth(size.nWidth)) * static_cast<size_t>(pPipeline->pfnGetChromaHeight(size.nHeight));
+            vecUV.resize(nUVSize);
+            pPipeline->pfnPrepareChroma(vecUV.data(), nUVSize);
+        });
+
+        const bool bMatch = vecGeneric == vecSpecial;
+        if (!bMatch)
+            nExitCode = 1;
+
+        const double fMegaPixels = static_cast<double>(nYSize) / 1e6;
+        const std::string strSize = std::to_string(size.nWidth) + "x" + std::to_string(size.nHeight);
+        std::printf("%-12s %10s %12.1f %12.1f %7.2fx %6s\n", strSize.c_str(), pPipeline->pszName,
+            fGenericSec > 0.0 ? fMegaPixels / fGenericSec : 0.0, fSpecialSec > 0.0 ? fMegaPixels / fSpecialSec : 0.0,
+            fSpecialSec > 0.0 ? fGenericSec / fSpecialSec : 0.0, bMatch ? "yes" : "NO");
+    }
+    return nExitCode;
+}
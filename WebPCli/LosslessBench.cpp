@@ -0,0 +1,126 @@
+﻿#include "Commands.h"
+#include "MemoryEndpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+// 무손실 수준별 처리량/크기 비교 (--lossless 프리셋을 고르는 근거)
+//   WebPCli bench-lossless photos/ [--levels 0,1,3,6,9] [--threads N] [--repeat 2] [--quality 80]
+//   입력을 메모리에 올린 뒤 convert 와 같은 BatchPipeline 으로 수준마다 --repeat 번 돌려 최선 시간을 쓴다.
+//   비교용으로 손실 (--quality) 결과를 첫 줄에 함께 출력한다. 출력은 버리므로 디스크 I/O 는 측정에 들어가지 않는다.
+
+namespace
+{
+    struct LosslessRow
+    {
+        std::string strName;
+        bool bLossless = false;
+        int nLevel = 0;
+        double fBestSec = 0.0;
+        uint64_t nConverted = 0;
+        uint64_t nFailed = 0;
+        uint64_t nPixels = 0;
+        uint64_t nOutputBytes = 0;
+    };
+
+    bool ParseLevels(const std::string& strList, std::vector<int>& vecLevel)
+    {
+        std::stringstream ss(strList);
+        std::string strItem;
+        while (std::getline(ss, strItem, ','))
+        {
+            int nLevel = 0;
+            if (!ParseLosslessLevel(strItem, nLevel))
+                return false;
+            vecLevel.push_back(nLevel);
+        }
+        return !vecLevel.empty();
+    }
+}
+
+int RunBenchLossless(const CliArgs& args)
+{
+    std::vector<std::string> vecPath;
+    std::vector<std::vector<uint8_t>> vecData;
+    LoadJpegFiles(CollectJpegInputs(args), vecPath, vecData);
+    if (vecData.empty())
+    {
+        std::cerr << "Error: 입력 JPEG 이 없습니다.\n";
+        return 2;
+    }
+
+    std::vector<int> vecLevel;
+    const std::string strLevels = args.GetString("levels", "0,1,3,6,9");
+    if (!ParseLevels(strLevels, vecLevel))
+    {
+        std::cerr << "Error: --levels 는 0-9 (또는 fast/default/max) 를 ',' 로 나열해야 합니다: " << strLevels << "\n";
+        return 2;
+    }
+    const int nRepeat = std::max(1, static_cast<int>(args.GetInt("repeat", 2)));
+
+    PipelineOption option;
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", 0));
+    option.bPreserveOrder = false;
+
+    ConvertOption baseOption;
+    baseOption.fQuality = static_cast<float>(args.GetDouble("quality", baseOption.fQuality));
+    if (!ApplyDecoderOption(args, baseOption))
+        return 2;
+
+    uint64_t nInputBytes = 0;
+    for (const auto& vecFile : vecData)
+        nInputBytes += vecFile.size();
+
+    std::vector<LosslessRow> vecRow;
+    {
+        LosslessRow row;
+        row.strName = "lossy_q" + std::to_string(static_cast<int>(baseOption.fQuality));
+        vecRow.push_back(row);
+    }
+    for (int nLevel : vecLevel)
+    {
+        LosslessRow row;
+        row.strName = "lossless_" + std::to_string(nLevel);
+        row.bLossless = true;
+        row.nLevel = nLevel;
+        vecRow.push_back(row);
+    }
+
+    for (auto& row : vecRow)
+    {
+        ConvertOption convertOption = baseOption;
+        convertOption.bLossless = row.bLossless;
+        convertOption.nLosslessLevel = row.nLevel;
+        ConvertEngine engine(convertOption);
+
+        for (int nIter = 0; nIter < nRepeat; ++nIter)
+        {
+            MemorySource source(vecPath, vecData);
+            DiscardSink sink;
+            BatchPipeline pipeline(engine, option);
+            const PipelineStats stats = pipeline.Run(source, sink);
+            if (nIter == 0 || stats.fElapsedSec < row.fBestSec)
+                row.fBestSec = stats.fElapsedSec;
+            row.nConverted = stats.nConverted;
+            row.nFailed = stats.nFailed;
+            row.nPixels = sink.GetPixelCount();
+            row.nOutputBytes = stats.nOutputBytes;
+        }
+    }
+
+    std::printf("%-12s %8s %6s %10s %10s %10s %12s %10s\n", "mode", "images", "fail", "best_s", "img/s", "MP/s", "out_bytes", "out/in");
+    bool bFailed = false;
+    for (const auto& row : vecRow)
+    {
+        const double fImgPerSec = (row.fBestSec > 0.0) ? static_cast<double>(row.nConverted + row.nFailed) / row.fBestSec : 0.0;
+        const double fMpPerSec = (row.fBestSec > 0.0) ? static_cast<double>(row.nPixels) / 1e6 / row.fBestSec : 0.0;
+        std::printf("%-12s %8llu %6llu %10.3f %10.1f %10.1f %12llu %10.3f\n", row.strName.c_str(),
+            static_cast<unsigned long long>(row.nConverted), static_cast<unsigned long long>(row.nFailed), row.fBestSec, fImgPerSec, fMpPerSec,
+            static_cast<unsigned long long>(row.nOutputBytes), nInputBytes > 0 ? static_cast<double>(row.nOutputBytes) / static_cast<double>(nInputBytes) : 0.0);
+        bFailed = bFailed || row.nFailed > 0;
+    }
+    std::printf("presets: fast=%d default=%d max=%d\n", LOSSLESS_LEVEL_FAST, LOSSLESS_LEVEL_DEFAULT, LOSSLESS_LEVEL_MAX);
+
+    return bFailed ? 1 : 0;
+}
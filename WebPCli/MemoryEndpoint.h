@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include "FileUtil.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 벤치마크용 메모리 원천/대상: 입력을 미리 메모리에 올리고 출력은 버려서 디스크 I/O 를 측정에서 뺀다.
+
+// 파일들을 메모리에 올린다. 읽지 못한 파일은 오류를 출력하고 건너뛴다.
+inline void LoadJpegFiles(const std::vector<std::string>& vecInput, std::vector<std::string>& vecPath, std::vector<std::vector<uint8_t>>& vecData)
+{
+    for (const auto& strPath : vecInput)
+    {
+        std::vector<uint8_t> vecFile;
+        if (!ReadFileToMemory(strPath, vecFile))
+        {
+            std::cerr << "Error: JPEG 파일을 읽지 못했습니다: " << strPath << "\n";
+            continue;
+        }
+        vecPath.push_back(strPath);
+        vecData.push_back(std::move(vecFile));
+    }
+}
+
+// 메모리에 올린 JPEG 을 차례로 내보내는 원천 (반복 실행마다 새로 만든다)
+class MemorySource : public IInputSource
+{
+public:
+    MemorySource(const std::vector<std::string>& vecPath, const std::vector<std::vector<uint8_t>>& vecData)
+        : m_vecPath(vecPath)
+        , m_vecData(vecData)
+    {
+    }
+
+    bool Next(InputItem& item) override
+    {
+        if (m_nIndex >= m_vecData.size())
+            return false;
+        item.strName = m_vecPath[m_nIndex];
+        item.vecData = m_vecData[m_nIndex];
+        ++m_nIndex;
+        return true;
+    }
+
+private:
+    const std::vector<std::string>& m_vecPath;
+    const std::vector<std::vector<uint8_t>>& m_vecData;
+    size_t m_nIndex = 0;
+};
+
+// 결과를 버리고 변환한 픽셀 수만 센다.
+class DiscardSink : public IOutputSink
+{
+public:
+    bool Write(OutputItem& item) override
+    {
+        if (item.bOk)
+            m_nPixels += static_cast<uint64_t>(item.result.nWidth) * static_cast<uint64_t>(item.result.nHeight);
+        return true;
+    }
+
+    uint64_t GetPixelCount() const { return m_nPixels; }
+
+private:
+    uint64_t m_nPixels = 0;
+};
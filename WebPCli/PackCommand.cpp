@@ -0,0 +1,185 @@
+﻿#include "Commands.h"
+#include "FileUtil.h"
+#include "PackFile.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// pack 조회 도구와 pack vs 파일별 출력 벤치마크
+
+namespace fs = std::filesystem;
+
+int RunPackGet(const CliArgs& args)
+{
+    const std::vector<std::string>& vecPositional = args.GetPositional();
+    if (vecPositional.size() < 2)
+    {
+        std::cerr << "usage: pack-get <base> <key> [--out file]\n";
+        return 1;
+    }
+
+    PackReader reader;
+    if (!reader.Open(vecPositional[0]))
+    {
+        std::cerr << "Error: pack 을 열지 못했습니다: " << vecPositional[0] << "\n";
+        return 2;
+    }
+
+    PackReader::Record record;
+    if (!reader.Find(vecPositional[1], record))
+    {
+        std::cerr << "not found: " << vecPositional[1] << "\n";
+        return 1;
+    }
+
+    std::cerr << vecPositional[1] << ": " << record.nWidth << "x" << record.nHeight << ", " << record.nSize << " bytes\n";
+    if (args.Has("out"))
+        return WriteMemoryToFile(args.GetString("out"), record.pData, record.nSize) ? 0 : 2;
+    return 0;
+}
+
+int RunBenchPack(const CliArgs& args)
+{
+    const fs::path dir = args.GetString("dir", "pack_bench");
+    const long long nCountArg = args.GetInt("count", 20000);
+    const long long nReadsArg = args.GetInt("reads", 100000);
+    const long long nMinKb = args.GetInt("min-kb", 2);
+    const long long nMaxKb = args.GetInt("max-kb", 32);
+    if (nCountArg < 1 || nReadsArg < 1 || nMinKb < 0 || nMaxKb < 0)
+    {
+        std::cerr << "Error: --count 와 --reads 는 1 이상, --min-kb / --max-kb 는 0 이상이어야 합니다.\n";
+        return 2;
+    }
+    const size_t nCount = static_cast<size_t>(nCountArg);
+    const size_t nMinBytes = static_cast<size_t>(nMinKb) << 10;
+    const size_t nMaxBytes = static_cast<size_t>(nMaxKb) << 10;
+    const size_t nReads = static_cast<size_t>(nReadsArg);
+    const uint32_t nSeed = static_cast<uint32_t>(args.GetInt("seed", 1));
+
+    // 사용자가 준 폴더는 지우지 않는다. 없거나 비어 있는 폴더만 받고, 끝나면 벤치마크가 만든 것만 지운다.
+    std::error_code ec;
+    const bool bDirExisted = fs::exists(dir, ec);
+    if (bDirExisted && (!fs::is_directory(dir, ec) || !fs::is_empty(dir, ec)))
+    {
+        std::cerr << "Error: --dir 는 없거나 비어 있는 폴더여야 합니다: " << dir.string() << "\n";
+        return 2;
+    }
+    auto cleanup = [&]()
+    {
+        if (bDirExisted)
+        {
+            fs::remove_all(dir / "files", ec);
+            fs::remove_all(dir / "pack", ec);
+        }
+        else
+        {
+            fs::remove_all(dir, ec);
+        }
+    };
+
+    fs::create_directories(dir / "files", ec);
+    fs::create_directories(dir / "pack", ec);
+
+    // 작은 WebP 크기 분포를 흉내 낸 의사 난수 페이로드 (인코딩 비용을 빼고 I/O 만 비교)
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<size_t> sizeDist(nMinBytes, std::max(nMinBytes, nMaxBytes));
+    std::vector<size_t> vecSize(nCount);
+    for (auto& nSize : vecSize)
+        nSize = sizeDist(rng);
+
+    std::vector<uint8_t> vecPayload(std::max(nMinBytes, nMaxBytes));
+    for (auto& b : vecPayload)
+        b = static_cast<uint8_t>(rng());
+
+    auto keyOf = [](size_t i)
+    {
+        char szKey[64];
+        std::snprintf(szKey, sizeof(szKey), "%03zu/%08zu.webp", i / 1000, i);
+        return std::string(szKey);
+    };
+
+    typedef std::chrono::steady_clock Clock;
+    uint64_t nTotalBytes = 0;
+    for (size_t nSize : vecSize)
+        nTotalBytes += nSize;
+
+    // 1) 파일별 쓰기
+    auto startTime = Clock::now();
+    for (size_t i = 0; i < nCount; ++i)
+    {
+        const fs::path path = dir / "files" / keyOf(i);
+        if (i % 1000 == 0)
+            fs::create_directories(path.parent_path(), ec);
+        WriteMemoryToFile(path.string(), vecPayload.data(), vecSize[i]);
+    }
+    const double fFileWrite = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    // 2) pack 쓰기 (색인 정렬/기록 포함)
+    startTime = Clock::now();
+    {
+        PackWriter writer((dir / "pack" / "bench").string());
+        for (size_t i = 0; i < nCount; ++i)
+            writer.Append(keyOf(i), vecPayload.data(), vecSize[i], 0, 0);
+        writer.Finish();
+    }
+    const double fPackWrite = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    // 3) 무작위 읽기
+    std::uniform_int_distribution<size_t> indexDist(0, nCount - 1);
+    std::vector<size_t> vecOrder(nReads);
+    for (auto& nIndex : vecOrder)
+        nIndex = indexDist(rng);
+
+    uint64_t nChecksum = 0;
+    std::vector<uint8_t> vecBuffer;
+    startTime = Clock::now();
+    for (size_t nIndex : vecOrder)
+    {
+        ReadFileToMemory((dir / "files" / keyOf(nIndex)).string(), vecBuffer);
+        for (size_t p = 0; p < vecBuffer.size(); p += 4096)
+            nChecksum += vecBuffer[p];
+    }
+    const double fFileRead = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    const double fOpenStart = std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+    PackReader reader;
+    if (!reader.Open((dir / "pack" / "bench").string()))
+    {
+        std::cerr << "Error: pack 을 열지 못했습니다.\n";
+        if (!args.Has("keep"))
+            cleanup();
+        return 2;
+    }
+    const double fPackOpen = std::chrono::duration<double>(Clock::now().time_since_epoch()).count() - fOpenStart;
+
+    uint64_t nMissing = 0;
+    startTime = Clock::now();
+    for (size_t nIndex : vecOrder)
+    {
+        PackReader::Record record;
+        if (!reader.Find(keyOf(nIndex), record))
+        {
+            ++nMissing;
+            continue;
+        }
+        for (size_t p = 0; p < record.nSize; p += 4096)
+            nChecksum += record.pData[p];
+    }
+    const double fPackRead = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    const double fMB = static_cast<double>(nTotalBytes) / (1 << 20);
+    std::cout << std::fixed << std::setprecision(3)
+        << "entries " << nCount << ", " << fMB << " MB, random reads " << nReads << "\n"
+        << "write  per-file : " << fFileWrite << " s (" << nCount / fFileWrite << " files/s)\n"
+        << "write  pack     : " << fPackWrite << " s (" << nCount / fPackWrite << " entries/s)\n"
+        << "read   per-file : " << fFileRead << " s (" << nReads / fFileRead << " reads/s)\n"
+        << "read   pack     : " << fPackRead << " s (" << nReads / fPackRead << " reads/s, open " << fPackOpen * 1000.0 << " ms)\n"
+        << "checksum " << nChecksum << (nMissing ? " MISSING " + std::to_string(nMissing) : std::string()) << "\n";
+
+    if (!args.Has("keep"))
+        cleanup();
+
+    return nMissing == 0 ? 0 : 1;
+}
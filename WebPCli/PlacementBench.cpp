@@ -0,0 +1,95 @@
+﻿#include "Commands.h"
+#include "CpuTopology.h"
+#include "MemoryEndpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+// 작업자 고정(CPU 토폴로지 배치) 유무에 따른 배치 처리량 비교
+//   WebPCli bench-placement photos/ [--threads N] [--repeat 3] [--quality 80]
+//   입력을 모두 메모리에 올린 뒤 같은 파이프라인을 고정 없이/고정하고 번갈아 --repeat 번 돌려 최선 img/s 를 비교한다.
+//   출력은 버리므로 디스크 I/O 는 측정에 들어가지 않는다.
+
+namespace
+{
+    struct PlacementResult
+    {
+        double fBestImgPerSec = 0.0;
+        double fBestSec = 0.0;
+        uint64_t nFailed = 0;
+        int nPinnedWorkers = 0;
+    };
+}
+
+int RunBenchPlacement(const CliArgs& args)
+{
+    std::vector<std::string> vecPath;
+    std::vector<std::vector<uint8_t>> vecData;
+    LoadJpegFiles(CollectJpegInputs(args), vecPath, vecData);
+
+    if (vecData.empty())
+    {
+        std::cerr << "Error: 입력 JPEG 이 없습니다.\n";
+        return 2;
+    }
+
+    const CpuTopology topology = CpuTopology::Detect();
+    const int nRepeat = std::max(1, static_cast<int>(args.GetInt("repeat", 3)));
+
+    PipelineOption option;
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", 0));
+    if (option.nWorkerCount <= 0)
+        option.nWorkerCount = static_cast<int>(topology.GetCpus().size());
+    option.bPreserveOrder = false;
+
+    ConvertOption convertOption;
+    convertOption.fQuality = static_cast<float>(args.GetDouble("quality", convertOption.fQuality));
+    if (!ApplyDecoderOption(args, convertOption) || !ApplyEncoderOption(args, convertOption))
+        return 2;
+    ConvertEngine engine(convertOption);
+
+    std::cout << "topology: " << topology.ToString() << "\n";
+    std::cout << "plan:";
+    for (const auto& cpu : topology.PlanWorkers(option.nWorkerCount))
+        std::cout << " " << cpu.nCpu << "(n" << cpu.nNode << ",l3=" << cpu.nL3 << (cpu.bPrimary ? "" : ",smt") << ")";
+    std::cout << "\n";
+
+    // 두 설정을 번갈아 돌려서 주파수/캐시 예열 차이가 한쪽으로 몰리지 않게 한다.
+    PlacementResult result[2];
+    for (int nIter = 0; nIter < nRepeat; ++nIter)
+    {
+        for (int nPinned = 0; nPinned < 2; ++nPinned)
+        {
+            option.bPinWorkers = nPinned != 0;
+            MemorySource source(vecPath, vecData);
+            DiscardSink sink;
+            BatchPipeline pipeline(engine, option);
+            const PipelineStats stats = pipeline.Run(source, sink);
+
+            const double fImgPerSec = (stats.fElapsedSec > 0.0) ? static_cast<double>(stats.nItems) / stats.fElapsedSec : 0.0;
+            PlacementResult& best = result[nPinned];
+            if (fImgPerSec > best.fBestImgPerSec)
+            {
+                best.fBestImgPerSec = fImgPerSec;
+                best.fBestSec = stats.fElapsedSec;
+            }
+            best.nFailed = stats.nFailed;
+            best.nPinnedWorkers = stats.nPinnedWorkers;
+        }
+    }
+
+    std::printf("%-10s %8s %8s %6s %10s %10s\n", "placement", "images", "threads", "fail", "best_s", "img/s");
+    for (int nPinned = 0; nPinned < 2; ++nPinned)
+    {
+        std::printf("%-10s %8zu %8d %6llu %10.3f %10.1f\n", nPinned ? "pinned" : "os", vecData.size(), option.nWorkerCount,
+            static_cast<unsigned long long>(result[nPinned].nFailed), result[nPinned].fBestSec, result[nPinned].fBestImgPerSec);
+    }
+
+    if (result[1].nPinnedWorkers < option.nWorkerCount)
+        std::cerr << "Warning: 작업자 " << option.nWorkerCount << "개 중 " << result[1].nPinnedWorkers << "개만 CPU 에 고정되었습니다.\n";
+
+    if (result[0].fBestImgPerSec > 0.0)
+        std::printf("speedup: %.3fx\n", result[1].fBestImgPerSec / result[0].fBestImgPerSec);
+
+    return (result[0].nFailed > 0 || result[1].nFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,521 @@
+﻿#include "Commands.h"
+#include "ArchiveSource.h"
+#include "CropList.h"
+#include "FileEndpoint.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "OutputWriter.h"
+#include "ProcessUtil.h"
+#include "RunReport.h"
+#include "ShardJob.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// 여러 프로세스 / 여러 노드로 나눠서 변환 (작업 폴더 하나를 공유)
+//   WebPCli shard-run photos/ --job job1 --shards 16 --workers 4 --out out/ --report run.csv   (계획 + 작업자 4개 + 병합)
+//   WebPCli shard-plan photos/ --job /mnt/shared/job1 --shards 64 --split size --out out/      (다른 노드에서 쓸 계획만)
+//   WebPCli shard-work --job /mnt/shared/job1   (노드마다 하나 이상. 남은 조각이 없을 때까지 임대 -> 변환 -> 완료)
+//   WebPCli shard-merge --job /mnt/shared/job1 --report run.csv
+//
+//   변환 설정(--quality, --out, --lossless ...)은 계획할 때 매니페스트에 기록되고 모든 작업자가 그대로 쓴다.
+//   작업자 자원 설정(--threads, --window, --pin-workers, --mem-budget, --writers ...)은 작업자 명령행 값이 우선한다.
+
+namespace
+{
+    const int DEFAULT_LEASE_SEC = 60;
+
+    // 매니페스트에 넣지 않는 옵션 (조각 실행 자체를 조정하거나 프로세스마다 다른 값)
+    const char* const SHARD_ONLY_OPTIONS[] =
+    {
+        "job", "shards", "split", "lease", "workers", "max-respawn", "crash-after", "report", "recursive",
+        "log-level", "log-format", "log-burst", "log-rate",
+    };
+
+    // 작업자 명령행에서 매니페스트 값을 덮어쓸 수 있는 자원 옵션
+    const char* const WORKER_OVERRIDE_OPTIONS[] =
+    {
+        "threads", "window", "pin-workers", "mem-budget", "writers", "stage", "scratch", "scratch-size", "durability", "sync-batch",
+    };
+
+    const char* const LOG_OPTIONS[] = { "log-level", "log-format", "log-burst", "log-rate" };
+
+    // 조각이 임대를 잃으면 남은 입력을 더 읽지 않는다.
+    class CancellableSource : public IInputSource
+    {
+    public:
+        CancellableSource(IInputSource& inner, const std::atomic<bool>& bCancel) : m_inner(inner), m_bCancel(bCancel) {}
+
+        bool Next(InputItem& item) override
+        {
+            return !m_bCancel.load(std::memory_order_relaxed) && m_inner.Next(item);
+        }
+
+    private:
+        IInputSource& m_inner;
+        const std::atomic<bool>& m_bCancel;
+    };
+
+    // --crash-after N: N 개를 쓴 뒤 임대를 남긴 채 바로 종료 (재할당 시험용)
+    class CrashAfterSink : public IOutputSink
+    {
+    public:
+        CrashAfterSink(IOutputSink& inner, long long nCrashAfter) : m_inner(inner), m_nCrashAfter(nCrashAfter) {}
+
+        bool Write(OutputItem& item) override
+        {
+            const bool bOk = m_inner.Write(item);
+            if (m_nCrashAfter > 0 && ++m_nWritten >= m_nCrashAfter)
+            {
+                std::cerr << "crash-after " << m_nCrashAfter << ": 임대를 정리하지 않고 종료합니다.\n";
+                std::cerr.flush();
+                std::_Exit(3);
+            }
+            return bOk;
+        }
+
+        bool Finish() override { return m_inner.Finish(); }
+
+    private:
+        IOutputSink& m_inner;
+        long long m_nCrashAfter;
+        long long m_nWritten = 0;
+    };
+
+    // 임대 갱신 스레드. 임대를 잃으면 취소 플래그를 세워서 변환을 멈춘다.
+    class LeaseHeartbeat
+    {
+    public:
+        LeaseHeartbeat(ShardJob& job, int nShard, int nGeneration, std::atomic<bool>& bCancel)
+            : m_job(job), m_nShard(nShard), m_nGeneration(nGeneration), m_bCancel(bCancel)
+        {
+            const int nIntervalMs = std::max(job.GetLeaseSec() * 1000 / 3, 200);
+            m_thread = std::thread([this, nIntervalMs]() { Run(std::chrono::milliseconds(nIntervalMs)); });
+        }
+
+        ~LeaseHeartbeat()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_bStop = true;
+            }
+            m_cv.notify_all();
+            m_thread.join();
+        }
+
+        bool IsLost() const { return m_bLost.load(); }
+
+    private:
+        void Run(std::chrono::milliseconds interval)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_cv.wait_for(lock, interval, [this]() { return m_bStop; }))
+            {
+                if (m_job.Renew(m_nShard, m_nGeneration))
+                    continue;
+
+                m_bLost = true;
+                m_bCancel = true;
+                LogWarn("shard", "조각 " + std::to_string(m_nShard) + " 의 임대를 잃었습니다. (다른 작업자가 넘겨받음) 이 조각을 멈춥니다.");
+                return;
+            }
+        }
+
+        ShardJob& m_job;
+        int m_nShard;
+        int m_nGeneration;
+        std::atomic<bool>& m_bCancel;
+        std::atomic<bool> m_bLost{ false };
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_bStop = false;
+        std::thread m_thread;
+    };
+
+    bool IsOneOf(const std::string& strKey, const char* const* ppszBegin, const char* const* ppszEnd)
+    {
+        return std::find_if(ppszBegin, ppszEnd, [&](const char* psz) { return strKey == psz; }) != ppszEnd;
+    }
+
+    std::string MakeOptionToken(const std::string& strKey, const std::string& strValue)
+    {
+        return "--" + strKey + "=" + strValue;
+    }
+
+    // "--key=value" 목록 -> CliArgs
+    CliArgs MakeCliArgs(const std::vector<std::string>& vecToken)
+    {
+        std::vector<char*> vecArgv;
+        for (const auto& strToken : vecToken)
+            vecArgv.push_back(const_cast<char*>(strToken.c_str()));
+        return CliArgs(static_cast<int>(vecArgv.size()), vecArgv.data(), 0);
+    }
+
+    // 위치 인자를 펼치고 매니페스트를 쓴다. 성공하면 작업 폴더 경로
+    bool PlanShardJob(const CliArgs& args, std::string& strJobDir)
+    {
+        strJobDir = args.GetString("job");
+        if (strJobDir.empty())
+        {
+            std::cerr << "Error: --job 작업 폴더를 지정하세요.\n";
+            return false;
+        }
+
+        for (const char* pszKey : { "pack", "trace", "index" })
+        {
+            if (args.Has(pszKey))
+            {
+                std::cerr << "Error: 조각 실행에서는 --" << pszKey << " 를 쓸 수 없습니다.\n";
+                return false;
+            }
+        }
+
+        SHARD_SPLIT eSplit = SHARD_SPLIT_HASH;
+        if (args.Has("split") && !ParseShardSplit(args.GetString("split"), eSplit))
+        {
+            std::cerr << "Error: --split 은 hash 또는 size 입니다: " << args.GetString("split") << "\n";
+            return false;
+        }
+
+        // 설정 오류는 작업자를 띄우기 전에 여기서 잡는다.
+        ConvertOption convertOption;
+        CropList cropList;
+        PipelineOption pipelineOption;
+        if (!ApplyDecoderOption(args, convertOption) || !ApplyEncoderOption(args, convertOption) || !ApplyCropOption(args, convertOption, cropList, pipelineOption)
+            || !ApplyAdaptiveQualityOption(args, convertOption) || !ApplyVerifyOption(args, convertOption))
+            return false;
+
+        std::vector<ShardFile> vecFile;
+        for (const auto& strPath : CollectJpegInputs(args))
+        {
+            if (strPath == "-" || IsArchiveFileName(strPath))
+            {
+                std::cerr << "Error: 조각 실행은 파일/폴더 입력만 나눕니다. (아카이브는 convert 로): " << strPath << "\n";
+                return false;
+            }
+            std::error_code ec;
+            ShardFile file;
+            file.strPath = strPath;
+            file.nSize = std::filesystem::file_size(strPath, ec);
+            if (ec)
+                file.nSize = 0;
+            vecFile.push_back(file);
+        }
+        if (vecFile.empty())
+        {
+            std::cerr << "Error: 변환할 JPEG 파일이 없습니다.\n";
+            return false;
+        }
+
+        std::vector<std::string> vecArgs;
+        for (const auto& option : args.GetOptions())
+        {
+            if (!IsOneOf(option.first, std::begin(SHARD_ONLY_OPTIONS), std::end(SHARD_ONLY_OPTIONS)))
+                vecArgs.push_back(MakeOptionToken(option.first, option.second));
+        }
+        // 조각마다 파일이 다르므로 출력 기준 폴더는 계획할 때 전체 입력으로 한 번 정한다.
+        if (args.Has("out"))
+            vecArgs.push_back(MakeOptionToken("input-root", FindJpegInputRoot(args)));
+
+        const int nShardCount = static_cast<int>(args.GetInt("shards", 8));
+        const int nLeaseSec = static_cast<int>(args.GetInt("lease", DEFAULT_LEASE_SEC));
+        std::string strError;
+        if (!ShardJob::Create(strJobDir, vecFile, nShardCount, eSplit, nLeaseSec, vecArgs, strError))
+        {
+            std::cerr << "Error: " << strError << "\n";
+            return false;
+        }
+
+        ShardJob job;
+        job.Open(strJobDir);
+        size_t nMinFiles = SIZE_MAX;
+        size_t nMaxFiles = 0;
+        for (int nShard = 0; nShard < job.GetShardCount(); ++nShard)
+        {
+            std::vector<std::string> vecPath;
+            job.LoadShardFiles(nShard, vecPath);
+            nMinFiles = std::min(nMinFiles, vecPath.size());
+            nMaxFiles = std::max(nMaxFiles, vecPath.size());
+        }
+        std::cout << "job=" << strJobDir << " files=" << vecFile.size() << " shards=" << nShardCount << " split=" << GetShardSplitString(eSplit)
+            << " files/shard=" << nMinFiles << ".." << nMaxFiles << " lease=" << nLeaseSec << "s\n";
+        return true;
+    }
+
+    // 조각 하나 변환. 보고서는 세대 보고서 경로에 쓴다.
+    bool ConvertShard(const CliArgs& convertArgs, const std::vector<std::string>& vecPath, const std::string& strReportPath,
+                      const std::atomic<bool>& bCancel, long long nCrashAfter, PipelineStats& stats, uint64_t& nWriteFail)
+    {
+        PipelineOption option;
+        option.nWorkerCount = static_cast<int>(convertArgs.GetInt("threads", 0));
+        option.nMaxInflight = static_cast<int>(convertArgs.GetInt("window", 0));
+        option.bPreserveOrder = false;
+        option.bPinWorkers = convertArgs.Has("pin-workers");
+
+        ConvertOption convertOption;
+        convertOption.fQuality = static_cast<float>(convertArgs.GetDouble("quality", convertOption.fQuality));
+        convertOption.pCancelFlag = &bCancel;
+        CropList cropList;
+        std::unique_ptr<MemoryBudget> pMemoryBudget;
+        if (!ApplyDecoderOption(convertArgs, convertOption) || !ApplyEncoderOption(convertArgs, convertOption) || !ApplyCropOption(convertArgs, convertOption, cropList, option)
+            || !ApplyAdaptiveQualityOption(convertArgs, convertOption) || !ApplyVerifyOption(convertArgs, convertOption)
+            || !ApplyMemoryBudgetOption(convertArgs, convertOption, pMemoryBudget))
+            return false;
+        ConvertEngine engine(convertOption);
+
+        DirectorySink directorySink(convertArgs.GetString("out"));
+        std::unique_ptr<OutputWriter> pOutputWriter;
+        if (!ApplyOutputWriterOption(convertArgs, pOutputWriter))
+            return false;
+        directorySink.SetOutputWriter(pOutputWriter.get());
+        ReportSink reportSink(directorySink);
+        if (!reportSink.Open(strReportPath))
+            return false;
+        CrashAfterSink sink(reportSink, nCrashAfter);
+
+        FileListSource fileSource(vecPath);
+        if (convertArgs.Has("out"))
+            fileSource.SetInputRoot(convertArgs.GetString("input-root"));
+        CancellableSource source(fileSource, bCancel);
+        BatchPipeline pipeline(engine, option);
+        stats = pipeline.Run(source, sink);
+        nWriteFail = directorySink.GetWriteFailCount();
+        return true;
+    }
+
+    void PrintShardProgress(std::ostream& os, const ShardJob& job)
+    {
+        const ShardProgress progress = job.GetProgress();
+        os << "shards=" << progress.nShards << " done=" << progress.nDone << " leased=" << progress.nLeased << " expired=" << progress.nExpired
+            << " pending=" << progress.nPending << " reassigned=" << progress.nReassigned << "\n";
+    }
+
+    // 병합 결과 한 줄. 빠진 조각이나 실패 항목이 있으면 false
+    bool MergeShardReports(std::ostream& os, const ShardJob& job, const std::string& strReportPath)
+    {
+        ShardMergeStats stats;
+        if (!job.MergeReports(strReportPath, stats))
+        {
+            std::cerr << "Error: 병합 보고서를 쓰지 못했습니다: " << strReportPath << "\n";
+            return false;
+        }
+
+        os << "report=" << strReportPath << " shards=" << stats.nReports << " missing=" << stats.nMissing << " rows=" << stats.nRows
+            << " failed=" << stats.nFailedRows << "\n";
+        if (stats.nMissing > 0)
+            std::cerr << "Error: 끝나지 않은 조각 " << stats.nMissing << "개\n";
+        return stats.nMissing == 0 && stats.nFailedRows == 0;
+    }
+}
+
+int RunShardPlan(const CliArgs& args)
+{
+    std::string strJobDir;
+    return PlanShardJob(args, strJobDir) ? 0 : 2;
+}
+
+int RunShardWork(const CliArgs& args)
+{
+    std::error_code ec;
+    const std::string strJobDir = std::filesystem::absolute(args.GetString("job"), ec).string();
+    ShardJob job;
+    if (args.GetString("job").empty() || !job.Open(strJobDir))
+    {
+        std::cerr << "Error: 작업 폴더의 매니페스트를 읽지 못했습니다: " << args.GetString("job") << "\n";
+        return 2;
+    }
+
+    // 계획한 곳과 같은 기준 폴더에서 실행해서 상대 경로 입력/출력을 똑같이 해석한다.
+    if (!job.GetBaseDir().empty())
+    {
+        std::filesystem::current_path(job.GetBaseDir(), ec);
+        if (ec)
+        {
+            std::cerr << "Error: 기준 폴더로 이동하지 못했습니다: " << job.GetBaseDir() << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<std::string> vecToken = job.GetArgs();
+    for (const char* pszKey : WORKER_OVERRIDE_OPTIONS)
+    {
+        if (args.Has(pszKey))
+            vecToken.push_back(MakeOptionToken(pszKey, args.GetString(pszKey)));
+    }
+    const CliArgs convertArgs = MakeCliArgs(vecToken);
+
+    const std::string strOwner = ShardJob::MakeOwnerName();
+    const long long nCrashAfter = args.GetInt("crash-after", 0);
+    const auto pollInterval = std::chrono::milliseconds(std::min(1000, job.GetLeaseSec() * 250));
+    int nShardsDone = 0;
+    bool bFailed = false;
+
+    for (;;)
+    {
+        int nGeneration = 0;
+        const int nShard = job.Claim(strOwner, nGeneration);
+        if (nShard < 0)
+        {
+            // 남은 조각은 다른 작업자가 가지고 있다. 그 작업자가 죽으면 넘겨받도록 끝날 때까지 기다린다.
+            if (job.GetProgress().nDone == job.GetShardCount())
+                break;
+            std::this_thread::sleep_for(pollInterval);
+            continue;
+        }
+
+        std::vector<std::string> vecPath;
+        if (!job.LoadShardFiles(nShard, vecPath))
+        {
+            std::cerr << "Error: 조각 목록을 읽지 못했습니다: " << nShard << "\n";
+            return 2;
+        }
+        if (nGeneration > 1)
+            LogInfo("shard", "만료된 조각 " + std::to_string(nShard) + " 을 넘겨받았습니다. (세대 " + std::to_string(nGeneration) + ")");
+
+        std::atomic<bool> bCancel{ false };
+        PipelineStats stats;
+        uint64_t nWriteFail = 0;
+        bool bLost = false;
+        {
+            LeaseHeartbeat heartbeat(job, nShard, nGeneration, bCancel);
+            if (!ConvertShard(convertArgs, vecPath, job.GetWorkReportPath(nShard, nGeneration), bCancel, nCrashAfter, stats, nWriteFail))
+                return 2;
+            bLost = heartbeat.IsLost();
+        }
+
+        const std::string strSummary = "owner=" + strOwner + " generation=" + std::to_string(nGeneration) + " converted=" + std::to_string(stats.nConverted)
+            + " failed=" + std::to_string(stats.nFailed) + " write_failed=" + std::to_string(nWriteFail);
+        if (bLost || !job.Complete(nShard, nGeneration, strSummary))
+        {
+            LogWarn("shard", "조각 " + std::to_string(nShard) + " 을 끝내기 전에 임대를 잃어서 결과를 버립니다.");
+            continue;
+        }
+
+        ++nShardsDone;
+        bFailed = bFailed || stats.nFailed > 0 || nWriteFail > 0 || stats.bSinkError || stats.nVerifyFailed > 0;
+        std::cout << "shard " << nShard << " (" << strOwner << ", gen " << nGeneration << "): files=" << vecPath.size() << " converted=" << stats.nConverted
+            << " failed=" << stats.nFailed << " write_failed=" << nWriteFail << " " << stats.fElapsedSec << "s\n";
+    }
+
+    std::cout << "worker " << strOwner << ": shards=" << nShardsDone << "\n";
+    return bFailed ? 1 : 0;
+}
+
+int RunShardRun(const CliArgs& args)
+{
+    std::string strJobDir;
+    if (!PlanShardJob(args, strJobDir))
+        return 2;
+
+    ShardJob job;
+    if (!job.Open(strJobDir))
+    {
+        std::cerr << "Error: 작업 폴더의 매니페스트를 읽지 못했습니다: " << strJobDir << "\n";
+        return 2;
+    }
+
+    const std::string strExe = ProcessUtil::GetExecutablePath();
+    if (strExe.empty())
+    {
+        std::cerr << "Error: 실행 파일 경로를 알 수 없습니다.\n";
+        return 2;
+    }
+
+    const int nCpu = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int nWorkers = std::max(1, static_cast<int>(args.GetInt("workers", std::min(job.GetShardCount(), nCpu))));
+    // 작업자마다 모든 코어만큼 스레드를 띄우지 않도록 나눠 준다.
+    const std::string strThreads = args.Has("threads") ? args.GetString("threads") : std::to_string(std::max(1, nCpu / nWorkers));
+    const int nMaxRespawn = static_cast<int>(args.GetInt("max-respawn", nWorkers * 2));
+
+    std::vector<std::string> vecWorkerArgs = { strExe, "shard-work", "--job", std::filesystem::absolute(strJobDir).string(), "--threads", strThreads };
+    for (const char* pszKey : LOG_OPTIONS)
+    {
+        if (args.Has(pszKey))
+            vecWorkerArgs.push_back(MakeOptionToken(pszKey, args.GetString(pszKey)));
+    }
+
+    std::cout.flush();
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<ProcessUtil::Process> vecProcess(static_cast<size_t>(nWorkers));
+    for (int i = 0; i < nWorkers; ++i)
+    {
+        std::vector<std::string> vecSpawnArgs = vecWorkerArgs;
+        if (i == 0 && args.Has("crash-after"))
+            vecSpawnArgs.push_back(MakeOptionToken("crash-after", args.GetString("crash-after")));
+        if (!ProcessUtil::Spawn(vecSpawnArgs, vecProcess[static_cast<size_t>(i)]))
+            std::cerr << "Error: 작업자를 띄우지 못했습니다.\n";
+    }
+
+    // 비정상 종료(죽었거나 --crash-after)한 작업자는 조각이 남아 있는 동안 다시 띄운다.
+    // 새 작업자는 죽은 작업자의 임대가 만료되면 그 조각을 넘겨받는다.
+    int nRespawned = 0;
+    bool bWorkerFailed = false;
+    for (;;)
+    {
+        bool bRunning = false;
+        for (auto& process : vecProcess)
+        {
+            int nExitCode = 0;
+            if (!process.IsValid())
+                continue;
+            if (!ProcessUtil::TryWait(process, nExitCode))
+            {
+                bRunning = true;
+                continue;
+            }
+
+            // 0 = 정상, 1 = 항목 실패, 2 = 작업 폴더/설정 오류 (다시 띄워도 같음)
+            // 나머지(신호, Windows 예외 코드처럼 음수로 보이는 값 포함)는 모두 비정상 종료
+            if (nExitCode == 1 || nExitCode == 2)
+                bWorkerFailed = true;
+            if (nExitCode == 0 || nExitCode == 1 || nExitCode == 2 || job.GetProgress().nDone == job.GetShardCount())
+                continue;
+
+            if (nRespawned >= nMaxRespawn)
+            {
+                LogError("shard", "작업자가 비정상 종료했습니다. (코드 " + std::to_string(nExitCode) + ", 다시 띄우기 한도 도달)");
+                bWorkerFailed = true;
+                continue;
+            }
+            LogWarn("shard", "작업자가 비정상 종료했습니다. (코드 " + std::to_string(nExitCode) + ") 새 작업자를 띄웁니다.");
+            ++nRespawned;
+            if (ProcessUtil::Spawn(vecWorkerArgs, process))
+                bRunning = true;
+            else
+                bWorkerFailed = true;
+        }
+        if (!bRunning)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    const double fElapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "workers=" << nWorkers << " respawned=" << nRespawned << " files=" << job.GetFileCount() << " " << fElapsedSec << "s ("
+        << (fElapsedSec > 0.0 ? static_cast<double>(job.GetFileCount()) / fElapsedSec : 0.0) << " img/s)\n";
+    PrintShardProgress(std::cout, job);
+
+    const std::string strReportPath = args.GetString("report", (std::filesystem::path(strJobDir) / "report.csv").string());
+    const bool bMerged = MergeShardReports(std::cout, job, strReportPath);
+    return (!bMerged || bWorkerFailed) ? 1 : 0;
+}
+
+int RunShardMerge(const CliArgs& args)
+{
+    ShardJob job;
+    if (!job.Open(args.GetString("job")))
+    {
+        std::cerr << "Error: 작업 폴더의 매니페스트를 읽지 못했습니다: " << args.GetString("job") << "\n";
+        return 2;
+    }
+
+    PrintShardProgress(std::cout, job);
+    const std::string strReportPath = args.GetString("report", (std::filesystem::path(args.GetString("job")) / "report.csv").string());
+    return MergeShardReports(std::cout, job, strReportPath) ? 0 : 1;
+}
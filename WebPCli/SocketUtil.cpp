@@ -0,0 +1,156 @@
+﻿#include "SocketUtil.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace SocketUtil
+{
+    bool Startup()
+    {
+#ifdef _WIN32
+        WSADATA wsaData;
+        return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+        signal(SIGPIPE, SIG_IGN); // 끊긴 연결에 send 해도 프로세스가 죽지 않게 함
+        return true;
+#endif
+    }
+
+    void Cleanup()
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    static bool MakeAddress(const std::string& strHost, uint16_t nPort, sockaddr_in& addr)
+    {
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(nPort);
+        return inet_pton(AF_INET, strHost.c_str(), &addr.sin_addr) == 1;
+    }
+
+    socket_t Listen(const std::string& strHost, uint16_t nPort, int nBacklog)
+    {
+        sockaddr_in addr;
+        if (!MakeAddress(strHost, nPort, addr))
+            return INVALID_SOCKET;
+
+        socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET)
+            return INVALID_SOCKET;
+
+        int nReuse = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&nReuse), sizeof(nReuse));
+
+        if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(sock, nBacklog) != 0)
+        {
+            Close(sock);
+            return INVALID_SOCKET;
+        }
+        return sock;
+    }
+
+    socket_t Accept(socket_t listenSocket)
+    {
+        return accept(listenSocket, nullptr, nullptr);
+    }
+
+    socket_t Connect(const std::string& strHost, uint16_t nPort)
+    {
+        sockaddr_in addr;
+        if (!MakeAddress(strHost, nPort, addr))
+            return INVALID_SOCKET;
+
+        socket_t sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (sock == INVALID_SOCKET)
+            return INVALID_SOCKET;
+
+        if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            Close(sock);
+            return INVALID_SOCKET;
+        }
+        return sock;
+    }
+
+    void Close(socket_t sock)
+    {
+        if (sock == INVALID_SOCKET)
+            return;
+#ifdef _WIN32
+        closesocket(sock);
+#else
+        close(sock);
+#endif
+    }
+
+    void ShutdownBoth(socket_t sock)
+    {
+#ifdef _WIN32
+        shutdown(sock, SD_BOTH);
+#else
+        shutdown(sock, SHUT_RDWR);
+#endif
+    }
+
+    void SetNoDelay(socket_t sock)
+    {
+        int nFlag = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nFlag), sizeof(nFlag));
+    }
+
+    void SetRecvTimeout(socket_t sock, int nMilliseconds)
+    {
+#ifdef _WIN32
+        DWORD dwTimeout = static_cast<DWORD>(nMilliseconds);
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&dwTimeout), sizeof(dwTimeout));
+#else
+        timeval tv;
+        tv.tv_sec = nMilliseconds / 1000;
+        tv.tv_usec = (nMilliseconds % 1000) * 1000;
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#endif
+    }
+
+    bool SendAll(socket_t sock, const void* pData, size_t nSize)
+    {
+        const char* p = static_cast<const char*>(pData);
+        while (nSize > 0)
+        {
+            const int nChunk = static_cast<int>(nSize > (1u << 30) ? (1u << 30) : nSize);
+            const int nSent = static_cast<int>(send(sock, p, nChunk, 0));
+            if (nSent <= 0)
+                return false;
+            p += nSent;
+            nSize -= static_cast<size_t>(nSent);
+        }
+        return true;
+    }
+
+    int Recv(socket_t sock, void* pBuffer, size_t nSize)
+    {
+        const int nChunk = static_cast<int>(nSize > (1u << 30) ? (1u << 30) : nSize);
+        return static_cast<int>(recv(sock, static_cast<char*>(pBuffer), nChunk, 0));
+    }
+
+    bool LastErrorIsTimeout()
+    {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAETIMEDOUT;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#else
+#include <sys/socket.h>
+typedef int socket_t;
+#ifndef INVALID_SOCKET
+#define INVALID_SOCKET (-1)
+#endif
+#endif
+
+// Winsock / BSD 소켓 차이를 감추는 최소 래퍼
+namespace SocketUtil
+{
+    bool Startup();   // WSAStartup (POSIX 에서는 SIGPIPE 무시)
+    void Cleanup();
+
+    socket_t Listen(const std::string& strHost, uint16_t nPort, int nBacklog);
+    socket_t Accept(socket_t listenSocket);
+    socket_t Connect(const std::string& strHost, uint16_t nPort);
+    void Close(socket_t sock);
+    void ShutdownBoth(socket_t sock);
+    void SetNoDelay(socket_t sock);
+    void SetRecvTimeout(socket_t sock, int nMilliseconds);
+
+    // 부분 송수신을 반복해서 처리
+    bool SendAll(socket_t sock, const void* pData, size_t nSize);
+    int Recv(socket_t sock, void* pBuffer, size_t nSize); // 0 = 연결 종료, <0 = 오류
+    bool LastErrorIsTimeout();  // 직전 Recv 실패가 SetRecvTimeout 에 의한 것인지
+}
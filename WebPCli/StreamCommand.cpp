@@ -0,0 +1,132 @@
+﻿#include "Commands.h"
+#include "CropList.h"
+#include "FileUtil.h"
+#include "MemoryBudget.h"
+#include "RunReport.h"
+#include "TraceRecorder.h"
+#include "StreamProtocol.h"
+#include <iostream>
+
+// stdin/stdout 프레이밍 스트림 변환 (파일 시스템을 전혀 사용하지 않음)
+//   producer | WebPCli stream | consumer
+// frame / unframe 은 셸 파이프라인에서 파일 <-> 레코드 변환용 보조 명령이다.
+
+namespace
+{
+    const size_t STDIO_BUFFER_BYTES = 1u << 20;
+}
+
+int RunStream(const CliArgs& args)
+{
+    PipelineOption option;
+    option.nWorkerCount = static_cast<int>(args.GetInt("threads", 0));
+    option.nMaxInflight = static_cast<int>(args.GetInt("window", 0));
+    option.bPreserveOrder = !args.Has("unordered");
+    option.bPinWorkers = args.Has("pin-workers");
+
+    ConvertOption convertOption;
+    convertOption.fQuality = static_cast<float>(args.GetDouble("quality", convertOption.fQuality));
+    if (!ApplyDecoderOption(args, convertOption) || !ApplyEncoderOption(args, convertOption))
+        return 2;
+
+    CropList cropList;
+    if (!ApplyCropOption(args, convertOption, cropList, option))
+        return 2;
+    std::unique_ptr<TraceRecorder> pTrace;
+    std::unique_ptr<MemoryBudget> pMemoryBudget;
+    if (!ApplyAdaptiveQualityOption(args, convertOption) || !ApplyVerifyOption(args, convertOption) || !ApplyTraceOption(args, convertOption, pTrace)
+        || !ApplyMemoryBudgetOption(args, convertOption, pMemoryBudget))
+        return 2;
+    ConvertEngine engine(convertOption);
+
+    StreamProtocol::SetBinaryMode(stdin);
+    StreamProtocol::SetBinaryMode(stdout);
+    std::setvbuf(stdin, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+    std::setvbuf(stdout, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+
+    StreamRecordSource source(stdin);
+    StreamRecordSink recordSink(stdout);
+    ReportSink reportSink(recordSink);
+    if (args.Has("report") && !reportSink.Open(args.GetString("report")))
+        return 2;
+
+    IOutputSink& sink = args.Has("report") ? static_cast<IOutputSink&>(reportSink) : recordSink;
+    BatchPipeline pipeline(engine, option);
+    const PipelineStats stats = pipeline.Run(source, sink);
+
+    // 진행 정보는 stdout 을 오염시키지 않도록 stderr 로만 출력
+    std::cerr << "stream: records=" << stats.nItems << " converted=" << stats.nConverted << " failed=" << stats.nFailed
+        << " in=" << stats.nInputBytes << "B out=" << stats.nOutputBytes << "B " << stats.fElapsedSec << "s ("
+        << (stats.fElapsedSec > 0.0 ? static_cast<double>(stats.nItems) / stats.fElapsedSec : 0.0) << " rec/s)\n";
+    PrintAdaptiveQualityStats(std::cerr, convertOption, stats);
+    PrintVerifyStats(std::cerr, stats);
+    PrintMemoryBudgetStats(std::cerr, pMemoryBudget.get());
+    const bool bTraceWritten = WriteTraceOption(std::cerr, args, pTrace.get());
+
+    if (stats.bSourceError)
+        std::cerr << "Error: 입력 스트림이 레코드 중간에서 끊겼습니다.\n";
+    if (stats.bSinkError)
+        std::cerr << "Error: 출력 스트림 기록 실패\n";
+
+    return (!bTraceWritten || stats.bSourceError || stats.bSinkError) ? 2 : ((stats.nFailed > 0 || stats.nVerifyFailed > 0) ? 1 : 0);
+}
+
+int RunFrame(const CliArgs& args)
+{
+    StreamProtocol::SetBinaryMode(stdout);
+    std::setvbuf(stdout, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+
+    std::vector<uint8_t> vecData;
+    for (const auto& strPath : args.GetPositional())
+    {
+        if (!ReadFileToMemory(strPath, vecData))
+        {
+            std::cerr << "Error: JPEG 파일을 읽지 못했습니다: " << strPath << "\n";
+            return 2;
+        }
+
+        if (!StreamProtocol::WriteInputRecord(stdout, strPath, vecData.data(), vecData.size()))
+            return 2;
+    }
+    return std::fflush(stdout) == 0 ? 0 : 2;
+}
+
+int RunUnframe(const CliArgs& args)
+{
+    const std::string strOutDir = args.GetString("out", ".");
+    StreamProtocol::SetBinaryMode(stdin);
+    std::setvbuf(stdin, nullptr, _IOFBF, STDIO_BUFFER_BYTES);
+
+    std::string strName;
+    uint32_t nStatus = 0;
+    std::vector<uint8_t> vecData;
+    bool bError = false;
+    int nRet = 0;
+
+    while (StreamProtocol::ReadOutputRecord(stdin, strName, nStatus, vecData, bError))
+    {
+        if (nStatus != CONVERT_OK)
+        {
+            std::cerr << "Error: 변환 실패 (" << GetConvertStatusString(static_cast<CONVERT_STATUS>(nStatus)) << "): " << strName << "\n";
+            nRet = 1;
+            continue;
+        }
+
+        // 레코드 ID 의 디렉터리 부분은 버리고 파일 이름만 사용
+        const size_t nSlash = strName.find_last_of("/\\");
+        const std::string strFile = ConvertEngine::MakeOutputPath(nSlash == std::string::npos ? strName : strName.substr(nSlash + 1));
+        const std::string strOutPath = strOutDir + "/" + strFile;
+        if (!WriteMemoryToFile(strOutPath, vecData.data(), vecData.size()))
+        {
+            std::cerr << "Error: 결과 파일 저장 실패: " << strOutPath << "\n";
+            nRet = 1;
+        }
+    }
+
+    if (bError)
+    {
+        std::cerr << "Error: 출력 스트림이 레코드 중간에서 끊겼습니다.\n";
+        return 2;
+    }
+    return nRet;
+}
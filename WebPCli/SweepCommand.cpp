@@ -0,0 +1,163 @@
+﻿#include "Commands.h"
+#include "CropList.h"
+#include "EncoderSweep.h"
+#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include "JobPool.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+// 인코더 설정 비교
+//   WebPCli sweep photos/ --grid "quality=75,85;method=2,4,6;sns_strength=50,80" [--csv sweep.csv] [--json sweep.json]
+//   코퍼스를 한 번만 디코딩해서 메모리에 두고 (--max-cache-mb 까지) 격자의 모든 설정으로 인코딩한다.
+//   stdout 에는 파레토 경계 (시간/크기/PSNR 어느 쪽으로도 더 나은 설정이 없는 것) 만 크기순으로 출력한다.
+
+namespace
+{
+    const char* const DEFAULT_GRID = "quality=75,80,85;method=0,2,4,6";
+}
+
+int RunSweep(const CliArgs& args)
+{
+    SweepGrid grid;
+    const std::string strGrid = args.GetString("grid", DEFAULT_GRID);
+    if (!grid.Parse(strGrid))
+    {
+        std::cerr << "Error: --grid 는 \"key=v1,v2;key=...\" 형식이어야 합니다: " << strGrid
+            << " (키: quality, method, filter_strength, sns_strength, segments, pass, thread_level)\n";
+        return 2;
+    }
+    const std::vector<SweepPoint> vecPoint = grid.Expand();
+
+    ConvertOption option;
+    if (!ApplyDecoderOption(args, option))
+        return 2;
+    if (args.Has("crop") && !CropList::ParseRegion(args.GetString("crop"), option.crop))
+    {
+        std::cerr << "Error: --crop 은 x,y,w,h 형식이어야 합니다: " << args.GetString("crop") << "\n";
+        return 2;
+    }
+
+    VerifyOption measure;
+    measure.nEvery = 1;
+    measure.nTileSize = static_cast<int>(args.GetInt("verify-tile", 0));
+    measure.nTileEvery = std::max(1, static_cast<int>(args.GetInt("verify-tile-every", measure.nTileEvery)));
+
+    std::vector<std::string> vecPath;
+    for (const auto& strInput : args.GetPositional())
+    {
+        std::error_code ec;
+        if (std::filesystem::is_directory(strInput, ec))
+        {
+            const std::vector<std::string> vecFiles = ListJpegFiles(strInput, args.Has("recursive"));
+            vecPath.insert(vecPath.end(), vecFiles.begin(), vecFiles.end());
+        }
+        else
+        {
+            vecPath.push_back(strInput);
+        }
+    }
+
+    const size_t nLimit = static_cast<size_t>(std::max(0LL, args.GetInt("limit", 0)));
+    if (nLimit > 0 && vecPath.size() > nLimit)
+        vecPath.resize(nLimit);
+
+    // 1) 코퍼스 디코딩 (한 번만). 평면 합이 --max-cache-mb 를 넘으면 나머지는 건너뛴다.
+    JobPool pool(static_cast<int>(args.GetInt("threads", 0)));
+    ConvertEngine engine(option);
+    const size_t nMaxCacheBytes = static_cast<size_t>(args.GetInt("max-cache-mb", 1024)) << 20;
+
+    std::mutex mutex;
+    std::vector<SweepImage> vecImage;
+    size_t nCacheBytes = 0;
+    uint64_t nSkipped = 0;
+    uint64_t nDecodeFailed = 0;
+    std::vector<std::future<void>> vecDone;
+    for (const auto& strPath : vecPath)
+    {
+        vecDone.push_back(pool.enqueue([&, strPath]()
+        {
+            std::vector<uint8_t> vecJpeg;
+            SweepImage image;
+            ConvertResult result;
+            if (!ReadFileToMemory(strPath, vecJpeg) || !engine.DecodeGray(vecJpeg.data(), vecJpeg.size(), option, image.vecY, result))
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++nDecodeFailed;
+                std::cerr << "Error: 디코딩 실패 (" << GetConvertStatusString(result.eStatus) << "): " << strPath << "\n";
+                return;
+            }
+
+            image.strName = strPath;
+            image.nWidth = result.nWidth;
+            image.nHeight = result.nHeight;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nCacheBytes + image.vecY.size() > nMaxCacheBytes)
+            {
+                ++nSkipped;
+                return;
+            }
+            nCacheBytes += image.vecY.size();
+            vecImage.push_back(std::move(image));
+        }));
+    }
+    for (auto& done : vecDone)
+        done.get();
+
+    if (vecImage.empty())
+    {
+        std::cerr << "Error: 비교할 이미지가 없습니다.\n";
+        return 2;
+    }
+
+    // 결과가 실행마다 같은 순서가 되도록 이름순 정렬
+    std::sort(vecImage.begin(), vecImage.end(), [](const SweepImage& a, const SweepImage& b) { return a.strName < b.strName; });
+
+    std::cout << "sweep: images=" << vecImage.size() << " cache=" << (nCacheBytes >> 20) << "MB skipped=" << nSkipped
+        << " decode_failed=" << nDecodeFailed << " configs=" << vecPoint.size() << " threads=" << pool.getTotalWorkerCount() << "\n";
+
+    // 2) 모든 설정 인코딩 + PSNR
+    const std::vector<SweepRow> vecRow = RunEncoderSweep(engine, vecImage, vecPoint, measure, pool);
+
+    if (args.Has("csv"))
+    {
+        std::ofstream file(args.GetString("csv"));
+        WriteSweepCsv(file, vecRow);
+        if (!file)
+        {
+            std::cerr << "Error: CSV 를 쓰지 못했습니다: " << args.GetString("csv") << "\n";
+            return 2;
+        }
+    }
+
+    if (args.Has("json"))
+    {
+        std::ofstream file(args.GetString("json"));
+        WriteSweepJson(file, vecRow);
+        if (!file)
+        {
+            std::cerr << "Error: JSON 을 쓰지 못했습니다: " << args.GetString("json") << "\n";
+            return 2;
+        }
+    }
+
+    // 3) 파레토 경계만 크기순 출력
+    std::vector<const SweepRow*> vecPareto;
+    for (const auto& row : vecRow)
+    {
+        if (row.bPareto)
+            vecPareto.push_back(&row);
+    }
+    std::sort(vecPareto.begin(), vecPareto.end(), [](const SweepRow* a, const SweepRow* b) { return a->nBytes < b->nBytes; });
+
+    std::cout << "pareto (" << vecPareto.size() << "/" << vecRow.size() << "): bytes, encode_ms, mean_psnr, config\n";
+    for (const SweepRow* pRow : vecPareto)
+        std::cout << "  " << pRow->nBytes << "  " << pRow->fEncodeMs << "  " << pRow->fMeanPsnr << "  " << pRow->point.ToString() << "\n";
+
+    const bool bAnyFailed = std::any_of(vecRow.begin(), vecRow.end(), [](const SweepRow& row) { return row.nFailed > 0; });
+    return bAnyFailed ? 1 : 0;
+}
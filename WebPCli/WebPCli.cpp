@@ -0,0 +1,76 @@
+﻿// WebPCli.cpp: MFC 없이 WebPEngine 을 사용하는 콘솔 도구
+//
+
+#include "Commands.h"
+#include "Logger.h"
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    struct CommandEntry
+    {
+        const char* pszName;
+        int (*pfnRun)(const CliArgs& args);
+        const char* pszUsage;
+    };
+
+    const CommandEntry g_commands[] =
+    {
+        { "convert",       RunConvert,      "convert <a.jpg | folder | a.tar | a.zip | -> ... [--out dir | --pack base] [--recursive] [--threads N] [--quality 80] [--encoder method=4;...] [--lossless fast|default|max|0-9] [--aq default | c:q,... [--aq-margin 10]] [--decoder turbojpeg] [--crop x,y,w,h | --crop-list list.csv] [--verify N [--verify-tile 64 [--verify-tile-every 4]] [--min-psnr dB] [--min-ssim 0.9]] [--report run.csv] [--trace trace.json [--trace-buffer 65536]] [--mem-budget 2G | auto] [--index corpus.wci [--order input|cost]] [--cost-model cost.txt] [--pin-workers] [--writers 2 [--stage 256M] [--scratch dir [--scratch-size 4G]] [--durability none|batch|each [--sync-batch 32]]]" },
+        { "animate",       RunAnimate,      "animate <a.jpg | folder> ... --out anim.webp [--recursive] [--fps 10 | --frame-ms 100] [--loop 0] [--threads N] [--window N] [--quality 80] [--encoder method=4;...] [--lossless fast|default|max|0-9] [--decoder turbojpeg] [--minimize-size]  (연속 프레임 -> 애니메이션 WebP)" },
+        { "shard-run",     RunShardRun,     "shard-run <a.jpg | folder> ... --job dir [--recursive] [--shards 8] [--split hash|size] [--workers N] [--lease 60] [--max-respawn N] [--report run.csv] [convert 옵션 ...] [--crash-after N]  (작업자 프로세스 N 개로 나눠 변환 + 보고서 병합)" },
+        { "shard-plan",    RunShardPlan,    "shard-plan <a.jpg | folder> ... --job dir [--recursive] [--shards 8] [--split hash|size] [--lease 60] [convert 옵션 ...]  (공유 폴더에 조각 계획만 기록)" },
+        { "shard-work",    RunShardWork,    "shard-work --job dir [--threads N] [--window N] [--pin-workers] [--mem-budget 2G] [--writers N ...] [--crash-after N]  (남은 조각이 없을 때까지 임대 -> 변환, 만료된 조각은 넘겨받음)" },
+        { "shard-merge",   RunShardMerge,   "shard-merge --job dir [--report run.csv]  (진행 상황 + 조각 보고서 병합)" },
+        { "serve",         RunServe,        "serve [--host 127.0.0.1] [--port 8080] [--threads N] [--reserved-high 1] [--lane-policy strict|weighted [--high-weight 4]] [--max-connections 256] [--connection-threads 64] [--max-inflight-mb 256] [--batch 16] [--batch-window-us 2000] [--small-kb 256] [--quality 80] [--encoder method=4;...] [--lossless fast|default|max|0-9] [--aq default | c:q,...] [--decoder turbojpeg] [--root dir] [--cache-mb 256 [--cache-shards 16]] [--cache-dir dir [--cache-disk-mb 4096]]" },
+        { "bench-http",    RunBenchHttp,    "bench-http [--host 127.0.0.1] [--port 8080] --file a.jpg [--concurrency 16] [--duration 10] [--quality Q] [--priority high]" },
+        { "stream",        RunStream,       "stream [--threads N] [--window N] [--unordered] [--quality 80] [--encoder method=4;...] [--lossless fast|default|max|0-9] [--aq default | c:q,...] [--decoder turbojpeg] [--crop x,y,w,h | --crop-list list.csv] [--verify N ...] [--report run.csv] [--trace trace.json] [--mem-budget 2G | auto] [--pin-workers]  (stdin 레코드 -> stdout 레코드)" },
+        { "frame",         RunFrame,        "frame a.jpg b.jpg ...  (파일 -> stdout 입력 레코드)" },
+        { "unframe",       RunUnframe,      "unframe [--out dir]  (stdin 출력 레코드 -> .webp 파일)" },
+        { "pack-get",      RunPackGet,      "pack-get <base> <key> [--out file]" },
+        { "bench-pack",    RunBenchPack,    "bench-pack [--dir pack_bench (없거나 빈 폴더)] [--count 20000] [--min-kb 2] [--max-kb 32] [--reads 100000] [--keep]" },
+        { "bench-decode",  RunBenchDecode,  "bench-decode <a.jpg | folder> ... [--decoder turbojpeg,nvjpeg] [--iterations 3] [--crop x,y,w,h]  (등록된 디코더 백엔드 비교)" },
+        { "sweep",         RunSweep,        "sweep <a.jpg | folder> ... [--grid \"quality=75,85;method=2,4,6;sns_strength=50,80\"] [--threads N] [--limit N] [--max-cache-mb 1024] [--verify-tile 64] [--csv out.csv] [--json out.json]  (인코더 설정 비교 + 파레토 경계)" },
+        { "gen-corpus",    RunGenCorpus,    "gen-corpus [--out corpus] [--count 100] [--seed 1] [--sizes 640x480:4,1920x1080:1] [--subsamp gray:6,420:1,444:1] [--progressive 0.2] [--restart 0:3,4:1] [--complexity 0.1,0.5,0.9] [--quality 75,90] [--threads N] [--verify manifest.csv]  (재현 가능한 합성 JPEG 코퍼스)" },
+        { "index",         RunIndex,        "index <a.jpg | folder> ... [--index corpus.wci] [--recursive] [--threads N]  (헤더만 읽어서 크기/서브샘플링/손상 여부 색인 + 요약)" },
+        { "bench-placement", RunBenchPlacement, "bench-placement <a.jpg | folder> ... [--recursive] [--threads N] [--repeat 3] [--quality 80] [--decoder turbojpeg]  (작업자 CPU 고정 유무 처리량 비교)" },
+        { "bench-kernels", RunBenchKernels, "bench-kernels [--sizes 640x480,1920x1080,4000x3000] [--iterations 20]  (기준 평면 루프 vs 특수화 파이프라인)" },
+        { "bench-lossless", RunBenchLossless, "bench-lossless <a.jpg | folder> ... [--recursive] [--levels 0,1,3,6,9] [--threads N] [--repeat 2] [--quality 80] [--decoder turbojpeg]  (무손실 수준별 처리량/크기, 손실 기준 포함)" },
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: WebPCli <command> [options]\n";
+        for (const auto& command : g_commands)
+            std::cerr << "  " << command.pszUsage << "\n";
+        std::cerr << "common: [--log-level debug|info|warn|error|off] [--log-format text|kv] [--log-burst 10] [--log-rate 1]\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    for (const auto& command : g_commands)
+    {
+        if (std::strcmp(argv[1], command.pszName) != 0)
+            continue;
+
+        const CliArgs args(argc, argv, 2);
+        if (!ApplyLogOption(args))
+            return 2;
+
+        const int nExitCode = command.pfnRun(args);
+        Logger::PrintSummary(std::cerr);
+        return nExitCode;
+    }
+
+    std::cerr << "unknown command: " << argv[1] << "\n";
+    PrintUsage();
+    return 1;
+}
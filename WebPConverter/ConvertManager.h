@@ -1,12 +1,16 @@
 ﻿#pragma once
 
 #include "TemplateManager.h"
+#include "JobManager.h"
+#include <memory>
 #include <vector>
-#include <nvjpeg.h>
-#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG API
 
 #define CONVERT_MGR ConvertManager::GetInstance()
 
+// ConvertAsync() 가 알림 창으로 보내는 메시지 (wParam = job id)
+#define WM_CONVERT_PROGRESS (WM_APP + 1)
+#define WM_CONVERT_DONE     (WM_APP + 2)
+
 enum LOAD_MODE
 {
     LOAD_MODE_FILE = 0,
@@ -39,16 +43,25 @@ private:
     
     float m_fQuality = 80.0f;
 
+    std::unique_ptr<JobManager> m_pJobManager;
+    JobHandle m_currentJob;
+
     void LoadImagePathInDirectory(const std::string &strImgFolder);
+    ConvertOption MakeConvertOption() const;
 
 public:
     void Load(LOAD_MODE eLoadMode);
     void Convert();
-    void Convert_CPU();
-    void Convert_GPU();
-    bool DecodeGrayJpegNvJpeg(nvjpegHandle_t handle, nvjpegJpegState_t state, cudaStream_t stream, const uint8_t* jpegData, size_t jpegSize, uint8_t** outYPlane, int& width, int& height);
+
+    // 선택한 디코더 백엔드로 공유 작업자 풀에서 비동기로 변환한다. 진행/완료는 hNotifyWnd 로 PostMessage.
+    bool ConvertAsync(HWND hNotifyWnd);
+    void CancelConvert();
+    bool IsConverting() const { return m_currentJob.IsValid() && !m_currentJob.IsDone(); }
+    JobProgress GetConvertProgress() const { return m_currentJob.GetProgress(); }
+    bool GetConvertResult(JobResult& result) const;
 
     void SetJpegDecodeModule(JPEG_DECODE_MODULE val) { m_eJpegDecodeModule = val; }
+    JPEG_DECODE_MODULE GetJpegDecodeModule() const { return m_eJpegDecodeModule; }
     void SetDecodeColor(DECODE_COLOR val) { m_eDecodeColor = val; }
     void SetQuality(float val) { m_fQuality = val; }
 
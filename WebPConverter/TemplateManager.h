@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "JobPool.h"
 #include <memory>
 #include <mutex>
 #include <functional>
@@ -40,6 +41,7 @@ protected:
     int m_nClassIdx;
 
     std::map<int, TemplateManager*> m_mapDependentMgr; // m_mapDependentMgr[manager index] -> TemplateManager pointer
+    std::shared_ptr<JobPool> m_pJobPool; // 매니저가 작업자 스레드를 쓰면 생성 (GetCurrentJobQueueSize() 등이 참조)
 
 private:
     static std::shared_ptr<T> m_pInstance;
@@ -45,6 +45,9 @@ BEGIN_MESSAGE_MAP(CWebPConverterDlg, CDialogEx)
 	ON_BN_CLICKED(IDC_BTN_WEBP_CONFIG_APPLY, &CWebPConverterDlg::OnBnClickedBtnWebpConfigApply)
 	ON_BN_CLICKED(IDC_RADIO_DECODE_TURBO_JPEG, &CWebPConverterDlg::OnBnClickedRadioDecodeTurboJpeg)
 	ON_BN_CLICKED(IDC_RADIO_DECODE_NV_JPEG, &CWebPConverterDlg::OnBnClickedRadioDecodeNvJpeg)
+	ON_BN_CLICKED(IDC_BTN_CANCEL, &CWebPConverterDlg::OnBnClickedBtnCancel)
+	ON_MESSAGE(WM_CONVERT_PROGRESS, &CWebPConverterDlg::OnConvertProgress)
+	ON_MESSAGE(WM_CONVERT_DONE, &CWebPConverterDlg::OnConvertDone)
 END_MESSAGE_MAP()
 
 
@@ -80,6 +83,7 @@ BOOL CWebPConverterDlg::OnInitDialog()
 	SetIcon(m_hIcon, FALSE);		// 작은 아이콘을 설정합니다.
 
 	// TODO: 여기에 추가 초기화 작업을 추가합니다.
+	GetDlgItem(IDC_BTN_CANCEL)->EnableWindow(FALSE);
 
 	return TRUE;  // 포커스를 컨트롤에 설정하지 않으면 TRUE를 반환합니다.
 }
@@ -134,7 +138,58 @@ void CWebPConverterDlg::OnBnClickedBtnLoad()
 
 void CWebPConverterDlg::OnBnClickedBtnConvert()
 {
-	CONVERT_MGR->Convert();
+	if (!CONVERT_MGR->ConvertAsync(GetSafeHwnd()))
+		return;
+
+	GetDlgItem(IDC_BTN_CONVERT)->EnableWindow(FALSE);
+	GetDlgItem(IDC_BTN_CANCEL)->EnableWindow(TRUE);
+	SetDlgItemText(IDC_STATIC_CONVERT_PROGRESS, _T("변환 대기 중..."));
+}
+
+void CWebPConverterDlg::OnBnClickedBtnCancel()
+{
+	CONVERT_MGR->CancelConvert();
+	GetDlgItem(IDC_BTN_CANCEL)->EnableWindow(FALSE);
+}
+
+LRESULT CWebPConverterDlg::OnConvertProgress(WPARAM wParam, LPARAM lParam)
+{
+	const JobProgress progress = CONVERT_MGR->GetConvertProgress();
+
+	CString strProgress;
+	if (progress.eState == JOB_QUEUED && progress.fEtaSec < 0.0)
+		strProgress.Format(_T("파일 %zu개 헤더 확인 중... - %.1f 초"), progress.nTotal, progress.fElapsedSec);
+	else if (progress.fEtaSec >= 0.0)
+		strProgress.Format(_T("%zu / %zu (실패 %zu) - %.1f 초, 남은 시간 약 %.0f 초"), progress.nProcessed, progress.nTotal, progress.nFailed, progress.fElapsedSec, progress.fEtaSec);
+	else
+		strProgress.Format(_T("%zu / %zu (실패 %zu) - %.1f 초"), progress.nProcessed, progress.nTotal, progress.nFailed, progress.fElapsedSec);
+	SetDlgItemText(IDC_STATIC_CONVERT_PROGRESS, strProgress);
+	return 0;
+}
+
+LRESULT CWebPConverterDlg::OnConvertDone(WPARAM wParam, LPARAM lParam)
+{
+	JobResult result;
+	if (!CONVERT_MGR->GetConvertResult(result))
+		return 0;
+
+	const JobProgress& progress = result.progress;
+
+	CString strSummary;
+	strSummary.Format(_T("%S: 성공 %zu, 실패 %zu, 건너뜀 %zu / %zu (%.1f 초)"), GetJobStateString(progress.eState),
+		progress.nConverted, progress.nFailed, progress.nDropped, progress.nTotal, progress.fElapsedSec);
+	SetDlgItemText(IDC_STATIC_CONVERT_PROGRESS, strSummary);
+
+	for (const JobFailure& failure : result.vecFailure)
+	{
+		CString strLog;
+		strLog.Format(_T("실패 (%S): %S"), GetConvertStatusString(failure.eStatus), failure.strPath.c_str());
+		m_listLog.AddString(strLog);
+	}
+
+	GetDlgItem(IDC_BTN_CONVERT)->EnableWindow(TRUE);
+	GetDlgItem(IDC_BTN_CANCEL)->EnableWindow(FALSE);
+	return 0;
 }
 
 void CWebPConverterDlg::OnBnClickedBtnWebpConfigApply()
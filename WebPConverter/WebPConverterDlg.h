@@ -43,4 +43,7 @@ public:
 	afx_msg void OnBnClickedBtnWebpConfigApply();
 	afx_msg void OnBnClickedRadioDecodeTurboJpeg();
 	afx_msg void OnBnClickedRadioDecodeNvJpeg();
+	afx_msg void OnBnClickedBtnCancel();
+	afx_msg LRESULT OnConvertProgress(WPARAM wParam, LPARAM lParam);
+	afx_msg LRESULT OnConvertDone(WPARAM wParam, LPARAM lParam);
 };
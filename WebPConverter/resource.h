@@ -18,6 +18,8 @@
 #define IDC_LIST_LOG                    1007
 #define IDC_EDIT_WEBP_CONFIG_QUALITY    1008
 #define IDC_BTN_WEBP_CONFIG_APPLY       1009
+#define IDC_BTN_CANCEL                  1010
+#define IDC_STATIC_CONVERT_PROGRESS     1011
 
 // Next default values for new objects
 // 
@@ -25,7 +27,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        130
 #define _APS_NEXT_COMMAND_VALUE         32771
-#define _APS_NEXT_CONTROL_VALUE         1010
+#define _APS_NEXT_CONTROL_VALUE         1012
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
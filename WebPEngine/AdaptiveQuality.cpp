@@ -0,0 +1,281 @@
+﻿#include "AdaptiveQuality.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG API (tjTransform + customFilter)
+
+const char* const AdaptiveQuality::DEFAULT_CURVE = "0:65,2:72,6:80,15:86,30:90";
+
+namespace
+{
+    // 지그재그 순번 -> 블록 내 자연 순서 위치 (DQT 는 지그재그, 계수 배열은 자연 순서)
+    const int g_naturalOrder[64] =
+    {
+         0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+        12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+    };
+
+    // IJG 표준 휘도 양자화 테이블 (품질 50, 자연 순서)
+    const int g_stdLumaQuant[64] =
+    {
+        16, 11, 10, 16,  24,  40,  51,  61,
+        12, 12, 14, 19,  26,  58,  60,  55,
+        14, 13, 16, 24,  40,  57,  69,  56,
+        14, 17, 22, 29,  51,  87,  80,  62,
+        18, 22, 37, 56,  68, 109, 103,  77,
+        24, 35, 55, 64,  81, 104, 113,  92,
+        49, 64, 78, 87, 103, 121, 120, 101,
+        72, 92, 95, 98, 112, 100, 103,  99
+    };
+
+    // SOS 전까지 마커를 훑어서 첫 번째 성분(루마)이 쓰는 양자화 테이블을 자연 순서로 얻는다.
+    bool ReadLumaQuantTable(const uint8_t* pData, size_t nSize, uint16_t quant[64])
+    {
+        uint16_t tables[4][64] = {};
+        bool bHasTable[4] = {};
+        int nLumaTable = -1;
+
+        if (nSize < 4 || pData[0] != 0xFF || pData[1] != 0xD8)
+            return false;
+
+        size_t nPos = 2;
+        while (nPos + 4 <= nSize)
+        {
+            if (pData[nPos] != 0xFF)
+                return false;
+
+            const uint8_t marker = pData[nPos + 1];
+            if (marker == 0xFF) // 채움 바이트
+            {
+                ++nPos;
+                continue;
+            }
+            if (marker == 0xDA) // SOS: 헤더 끝
+                break;
+
+            const size_t nLength = (static_cast<size_t>(pData[nPos + 2]) << 8) | pData[nPos + 3];
+            if (nLength < 2 || nPos + 2 + nLength > nSize)
+                return false;
+
+            const uint8_t* pSeg = pData + nPos + 4;
+            const size_t nSegSize = nLength - 2;
+
+            if (marker == 0xDB) // DQT: 여러 테이블이 이어질 수 있음
+            {
+                size_t i = 0;
+                while (i < nSegSize)
+                {
+                    const int nPrecision = pSeg[i] >> 4;
+                    const int nId = pSeg[i] & 0x0F;
+                    const size_t nEntryBytes = nPrecision ? 2 : 1;
+                    if (nId > 3 || i + 1 + 64 * nEntryBytes > nSegSize)
+                        return false;
+
+                    for (int k = 0; k < 64; ++k)
+                    {
+                        const uint8_t* pEntry = pSeg + i + 1 + k * nEntryBytes;
+                        tables[nId][g_naturalOrder[k]] = nPrecision ? static_cast<uint16_t>((pEntry[0] << 8) | pEntry[1]) : pEntry[0];
+                    }
+                    bHasTable[nId] = true;
+                    i += 1 + 64 * nEntryBytes;
+                }
+            }
+            else if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) // SOFn
+            {
+                // P(1) Y(2) X(2) Nf(1) 다음 첫 성분: C(1) H/V(1) Tq(1)
+                if (nSegSize >= 9)
+                    nLumaTable = pSeg[8] & 0x03;
+            }
+
+            nPos += 2 + nLength;
+        }
+
+        if (nLumaTable < 0 || !bHasTable[nLumaTable])
+            return false;
+
+        std::copy(tables[nLumaTable], tables[nLumaTable] + 64, quant);
+        return true;
+    }
+
+    // 양자화 테이블을 IJG 표준 테이블과 비교해서 libjpeg 품질 값으로 환산
+    float EstimateSourceQuality(const uint16_t quant[64])
+    {
+        double fSum = 0.0, fStdSum = 0.0;
+        for (int k = 0; k < 64; ++k)
+        {
+            fSum += quant[k];
+            fStdSum += g_stdLumaQuant[k];
+        }
+
+        const double fScale = fSum * 100.0 / fStdSum;
+        const double fQuality = (fScale <= 100.0) ? (200.0 - fScale) / 2.0 : 5000.0 / fScale;
+        return static_cast<float>(std::max(1.0, std::min(100.0, fQuality)));
+    }
+
+    struct CoefficientStats
+    {
+        const uint16_t* pQuant = nullptr;
+        const JpegRegion* pRegion = nullptr;
+        double fAcSum = 0.0;
+        uint64_t nNonZeroAc = 0;
+        uint64_t nBlocks = 0;
+    };
+
+    // tjTransform 이 성분/행 묶음마다 호출. coeffs 는 블록(64개, 자연 순서) 이 행 우선으로 이어진 배열
+    int CoefficientFilter(short* coeffs, tjregion arrayRegion, tjregion /*planeRegion*/, int componentIndex, int /*transformIndex*/, tjtransform* transform)
+    {
+        if (componentIndex != 0)
+            return 0;
+
+        CoefficientStats& stats = *static_cast<CoefficientStats*>(transform->data);
+        const int nBlocksW = arrayRegion.w / 8;
+        const int nBlocksH = arrayRegion.h / 8;
+        const JpegRegion* pRegion = stats.pRegion;
+
+        for (int by = 0; by < nBlocksH; ++by)
+        {
+            const int nY = arrayRegion.y + by * 8;
+            if (pRegion && (nY + 8 <= pRegion->nY || nY >= pRegion->nY + pRegion->nHeight))
+                continue;
+
+            for (int bx = 0; bx < nBlocksW; ++bx)
+            {
+                const int nX = arrayRegion.x + bx * 8;
+                if (pRegion && (nX + 8 <= pRegion->nX || nX >= pRegion->nX + pRegion->nWidth))
+                    continue;
+
+                const short* pBlock = coeffs + (static_cast<size_t>(by) * nBlocksW + bx) * 64;
+                // |계수| (최대 32768) x 양자화 값 (최대 65535) 이 63 개면 32 비트를 넘는다.
+                uint64_t nAcSum = 0;
+                for (int k = 1; k < 64; ++k)
+                {
+                    if (pBlock[k] != 0)
+                    {
+                        nAcSum += static_cast<uint64_t>(std::abs(pBlock[k])) * stats.pQuant[k];
+                        ++stats.nNonZeroAc;
+                    }
+                }
+                stats.fAcSum += static_cast<double>(nAcSum);
+                ++stats.nBlocks;
+            }
+        }
+        return 0;
+    }
+
+    struct ThreadTransformer
+    {
+        tjhandle tj = tjInitTransform();
+        ~ThreadTransformer()
+        {
+            if (tj)
+                tjDestroy(tj);
+        }
+    };
+}
+
+bool AnalyzeJpegComplexity(const uint8_t* pJpegData, size_t nJpegSize, const JpegRegion* pRegion, JpegComplexity& complexity)
+{
+    complexity = JpegComplexity();
+
+    uint16_t quant[64];
+    if (!ReadLumaQuantTable(pJpegData, nJpegSize, quant))
+        return false;
+
+    thread_local ThreadTransformer transformer;
+    if (!transformer.tj)
+        return false;
+
+    CoefficientStats stats;
+    stats.pQuant = quant;
+    stats.pRegion = (pRegion && !pRegion->IsFull()) ? pRegion : nullptr;
+
+    tjtransform transform = {};
+    transform.op = TJXOP_NONE;
+    transform.options = TJXOPT_NOOUTPUT; // 계수만 받고 JPEG 은 다시 만들지 않음
+    transform.data = &stats;
+    transform.customFilter = CoefficientFilter;
+
+    unsigned char* pDst = nullptr;
+    unsigned long nDstSize = 0;
+    if (tjTransform(transformer.tj, pJpegData, static_cast<unsigned long>(nJpegSize), 1, &pDst, &nDstSize, &transform, 0) != 0)
+        return false;
+    if (pDst)
+        tjFree(pDst);
+
+    if (stats.nBlocks == 0)
+        return false;
+
+    complexity.fComplexity = stats.fAcSum / static_cast<double>(stats.nBlocks) / 64.0;
+    complexity.fNonZeroAcRatio = static_cast<double>(stats.nNonZeroAc) / (static_cast<double>(stats.nBlocks) * 63.0);
+    complexity.fSourceQuality = EstimateSourceQuality(quant);
+    complexity.nBlocks = stats.nBlocks;
+    return true;
+}
+
+AdaptiveQuality::AdaptiveQuality()
+{
+    Parse(DEFAULT_CURVE);
+}
+
+bool AdaptiveQuality::Parse(const std::string& strCurve)
+{
+    std::vector<std::pair<double, float>> vecPoint;
+    std::stringstream ss(strCurve);
+    std::string strPoint;
+    while (std::getline(ss, strPoint, ','))
+    {
+        double fComplexity = 0.0;
+        float fQuality = 0.0f;
+        char chExtra = 0;
+        if (std::sscanf(strPoint.c_str(), "%lf:%f%c", &fComplexity, &fQuality, &chExtra) != 2 || fQuality < 0.0f || fQuality > 100.0f)
+            return false;
+        vecPoint.emplace_back(fComplexity, fQuality);
+    }
+
+    if (vecPoint.empty())
+        return false;
+
+    std::sort(vecPoint.begin(), vecPoint.end());
+    m_vecPoint = std::move(vecPoint);
+    return true;
+}
+
+std::string AdaptiveQuality::ToString() const
+{
+    std::ostringstream os;
+    for (size_t i = 0; i < m_vecPoint.size(); ++i)
+        os << (i ? "," : "") << m_vecPoint[i].first << ":" << m_vecPoint[i].second;
+    return os.str();
+}
+
+float AdaptiveQuality::Map(double fComplexity) const
+{
+    if (fComplexity <= m_vecPoint.front().first)
+        return m_vecPoint.front().second;
+    if (fComplexity >= m_vecPoint.back().first)
+        return m_vecPoint.back().second;
+
+    for (size_t i = 1; i < m_vecPoint.size(); ++i)
+    {
+        const auto& lo = m_vecPoint[i - 1];
+        const auto& hi = m_vecPoint[i];
+        if (fComplexity <= hi.first)
+        {
+            const double t = (fComplexity - lo.first) / (hi.first - lo.first);
+            return static_cast<float>(lo.second + t * (hi.second - lo.second));
+        }
+    }
+    return m_vecPoint.back().second;
+}
+
+float AdaptiveQuality::ChooseQuality(const JpegComplexity& complexity) const
+{
+    float fQuality = Map(complexity.fComplexity);
+    if (m_fSourceMargin >= 0.0f && complexity.fSourceQuality > 0.0f)
+        fQuality = std::min(fQuality, complexity.fSourceQuality + m_fSourceMargin);
+    return std::max(0.0f, std::min(100.0f, fQuality));
+}
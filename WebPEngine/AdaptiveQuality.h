@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include "DecoderBackend.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 이미지별 적응형 품질
+//   JPEG 을 디코딩하지 않고 양자화 테이블(DQT)과 DCT 계수 통계만으로 복잡도를 추정해서 품질 곡선으로 매핑한다.
+//   계수는 TurboJPEG 변환 API 의 customFilter 로 받는다. (TJXOPT_NOOUTPUT: 허프만 디코딩만 하고 IDCT/출력 없음)
+
+struct JpegComplexity
+{
+    double fComplexity = 0.0;       // 블록당 평균 |역양자화 AC 계수| 합 / 64 (평탄 ~0, 세밀한 텍스처 수십)
+    double fNonZeroAcRatio = 0.0;   // 0 이 아닌 AC 계수 비율
+    float fSourceQuality = 0.0f;    // DQT 로 추정한 원본 JPEG 품질 (IJG 기준 1..100, 모르면 0)
+    uint64_t nBlocks = 0;
+};
+
+// 루마 성분의 복잡도를 계산한다. pRegion 이 있으면 그 영역에 걸친 블록만 센다. (스레드 안전)
+bool AnalyzeJpegComplexity(const uint8_t* pJpegData, size_t nJpegSize, const JpegRegion* pRegion, JpegComplexity& complexity);
+
+// 복잡도 -> 품질 곡선
+//   "복잡도:품질" 점을 ',' 로 이은 문자열 (예: "0:65,2:72,6:80,15:86,30:90"). 점 사이는 선형 보간, 바깥은 끝값.
+class AdaptiveQuality
+{
+public:
+    static const char* const DEFAULT_CURVE;
+
+    AdaptiveQuality();
+
+    bool Parse(const std::string& strCurve);
+    std::string ToString() const;
+
+    // 원본 품질 + fSourceMargin 보다 높게 올리지 않는다. (JPEG 블록 노이즈까지 비싸게 보존하지 않도록) 음수면 상한 없음
+    void SetSourceMargin(float fMargin) { m_fSourceMargin = fMargin; }
+    float GetSourceMargin() const { return m_fSourceMargin; }
+
+    float Map(double fComplexity) const;
+    float ChooseQuality(const JpegComplexity& complexity) const;
+
+private:
+    std::vector<std::pair<double, float>> m_vecPoint;  // 복잡도 오름차순
+    float m_fSourceMargin = 10.0f;
+};
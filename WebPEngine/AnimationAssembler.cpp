@@ -0,0 +1,320 @@
+﻿#include "AnimationAssembler.h"
+#include "JobPool.h"
+#include "Logger.h"
+#include "PlanePipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <webp/encode.h>
+#include <webp/mux.h>
+
+namespace
+{
+    struct PictureDeleter
+    {
+        void operator()(WebPPicture* pPicture) const
+        {
+            WebPPictureFree(pPicture);
+            delete pPicture;
+        }
+    };
+
+    typedef std::unique_ptr<WebPPicture, PictureDeleter> PicturePtr;
+
+    // 작업자가 인코더에 넣을 수 있게 만들어 둔 프레임
+    struct PreparedFrame
+    {
+        std::string strName;
+        ConvertResult result;
+        PicturePtr pPicture;    // 실패하면 null
+        uint64_t nBytes = 0;    // ARGB 캔버스 크기
+    };
+
+    // 디코딩한 Y 평면 -> ARGB
+    //   애니메이션 인코더는 프레임 차이를 ARGB 캔버스에서 계산하므로, 단일 이미지 경로처럼 YUV 평면을 바로 넘기지 않고
+    //   작업자에서 미리 바꿔 둔다.
+    //   손실: limited-range Y + 중성 크로마를 libwebp 의 YUV -> RGB 로 바꾼다. (인코더가 다시 YUV 로 바꾸면 원래 평면이 된다)
+    //   무손실: 원래 값의 그레이를 그대로 R=G=B 로 펼친다.
+    PicturePtr MakeArgbFrame(const uint8_t* pY, int nWidth, int nHeight, bool bLossless)
+    {
+        PicturePtr pPicture(new WebPPicture());
+        if (!WebPPictureInit(pPicture.get()))
+            return PicturePtr();
+
+        const PlanePipeline& pipeline = *SelectPlanePipeline(JPEG_SUBSAMP_GRAY, bLossless);
+        if (pipeline.bArgbInput)
+        {
+            pPicture->width = nWidth;
+            pPicture->height = nHeight;
+            pPicture->use_argb = 1;
+            if (!WebPPictureAlloc(pPicture.get()))
+                return PicturePtr();
+            pipeline.pfnExpandArgb(pY, nWidth, nWidth, nHeight, pPicture->argb);
+            return pPicture;
+        }
+
+        const int nUVWidth = pipeline.pfnGetChromaWidth(nWidth);
+        const size_t nUVSize = static_cast<size_t>(nUVWidth) * static_cast<size_t>(pipeline.pfnGetChromaHeight(nHeight));
+        thread_local std::vector<uint8_t> vecUV;
+        vecUV.resize(nUVSize);
+        pipeline.pfnPrepareChroma(vecUV.data(), nUVSize);
+
+        pPicture->width = nWidth;
+        pPicture->height = nHeight;
+        pPicture->use_argb = 0;
+        pPicture->colorspace = WEBP_YUV420;
+        pPicture->y = const_cast<uint8_t*>(pY);
+        pPicture->y_stride = nWidth;
+        pPicture->u = vecUV.data();
+        pPicture->v = vecUV.data();
+        pPicture->uv_stride = nUVWidth;
+        if (!WebPPictureYUVAToARGB(pPicture.get()))
+            return PicturePtr();
+
+        // 스레드 버퍼를 가리키는 평면은 떼어 낸다. (이후에는 ARGB 만 쓴다)
+        pPicture->y = nullptr;
+        pPicture->u = nullptr;
+        pPicture->v = nullptr;
+        return pPicture;
+    }
+
+    bool IsCancelled(const ConvertOption& option)
+    {
+        return option.pCancelFlag && option.pCancelFlag->load(std::memory_order_relaxed);
+    }
+}
+
+AnimationAssembler::AnimationAssembler(const ConvertEngine& engine, const AnimationOption& option)
+    : m_engine(engine)
+    , m_option(option)
+{
+}
+
+bool AnimationAssembler::Run(IInputSource& source, std::vector<uint8_t>& vecWebpOut, AnimationStats& stats)
+{
+    stats = AnimationStats();
+    vecWebpOut.clear();
+    const auto startTime = std::chrono::steady_clock::now();
+    const ConvertOption& convertOption = m_engine.GetOption();
+
+    WebPConfig config;
+    if (!WebPConfigInit(&config))
+    {
+        stats.strError = "libwebp 버전이 맞지 않습니다.";
+        return false;
+    }
+    if (convertOption.bLossless)
+    {
+        if (!WebPConfigLosslessPreset(&config, convertOption.nLosslessLevel))
+        {
+            stats.strError = "무손실 수준이 잘못되었습니다.";
+            return false;
+        }
+    }
+    else
+    {
+        config.lossless = 0;
+        config.quality = convertOption.fQuality;
+    }
+    convertOption.encoder.ApplyTo(config);
+    if (!WebPValidateConfig(&config))
+    {
+        stats.strError = "인코더 설정이 잘못되었습니다.";
+        return false;
+    }
+
+    std::mutex mutex;
+    std::condition_variable cvDone;
+    std::map<uint64_t, PreparedFrame> mapDone;     // 준비됐지만 아직 인코더에 넣지 않은 프레임
+    uint64_t nDoneBytes = 0;
+    std::atomic<bool> bAbort{ false };
+    std::atomic<int64_t> nPrepareUs{ 0 };
+
+    JobPool pool(m_option.nWorkerCount);
+    const int nWindow = (m_option.nWindow > 0) ? m_option.nWindow : pool.getTotalWorkerCount() * 2;
+    stats.nWindow = nWindow;
+
+    int nHeld = 0;          // 읽었고 아직 인코더에 넣지 않은 프레임 (작업 중 포함, 호출 스레드만 바꾼다)
+    uint64_t nRead = 0;
+    bool bReadDone = false;
+
+    // 창에 빈자리가 있는 만큼 원천에서 읽어 작업자에게 넘긴다. (원천은 호출 스레드에서만 읽는다)
+    auto fill = [&]()
+    {
+        while (!bReadDone && nHeld < nWindow)
+        {
+            auto pItem = std::make_shared<InputItem>();
+            if (!source.Next(*pItem))
+            {
+                bReadDone = true;
+                break;
+            }
+            pItem->nSeq = nRead++;
+            stats.nInputBytes += pItem->vecData.size();
+            ++nHeld;
+            stats.nPeakFrames = std::max(stats.nPeakFrames, nHeld);
+
+            pool.push([&, pItem]()
+            {
+                PreparedFrame frame;
+                frame.strName = std::move(pItem->strName);
+                if (!bAbort.load(std::memory_order_relaxed))
+                {
+                    const auto prepareStartTime = std::chrono::steady_clock::now();
+                    thread_local std::vector<uint8_t> vecY;
+                    if (m_engine.DecodeGray(pItem->vecData.data(), pItem->vecData.size(), convertOption, vecY, frame.result))
+                    {
+                        frame.pPicture = MakeArgbFrame(vecY.data(), frame.result.nWidth, frame.result.nHeight, convertOption.bLossless);
+                        if (frame.pPicture)
+                            frame.nBytes = static_cast<uint64_t>(frame.pPicture->argb_stride) * static_cast<uint64_t>(frame.pPicture->height) * 4;
+                        else
+                            frame.result.eStatus = CONVERT_ERR_ALLOC;
+                    }
+                    nPrepareUs += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - prepareStartTime).count();
+                }
+                else
+                {
+                    frame.result.eStatus = CONVERT_ERR_CANCELLED;
+                }
+                pItem->vecData = std::vector<uint8_t>();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    nDoneBytes += frame.nBytes;
+                    stats.nPeakFrameBytes = std::max(stats.nPeakFrameBytes, nDoneBytes);
+                    mapDone.emplace(pItem->nSeq, std::move(frame));
+                }
+                cvDone.notify_one();
+            });
+        }
+    };
+
+    WebPAnimEncoder* pEncoder = nullptr;
+    int nTimestampMs = 0;
+    bool bOk = true;
+
+    fill();
+    for (uint64_t nSeq = 0; nSeq < nRead; ++nSeq)
+    {
+        PreparedFrame frame;
+        {
+            const auto waitStartTime = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex);
+            cvDone.wait(lock, [&]() { return mapDone.count(nSeq) != 0; });
+            auto it = mapDone.find(nSeq);
+            frame = std::move(it->second);
+            mapDone.erase(it);
+            nDoneBytes -= frame.nBytes;
+            stats.durationWait += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStartTime);
+        }
+
+        // 이 프레임을 인코딩하는 동안 작업자가 다음 프레임을 준비하도록 먼저 채운다.
+        --nHeld;
+        fill();
+
+        if (IsCancelled(convertOption))
+        {
+            stats.strError = GetConvertStatusString(CONVERT_ERR_CANCELLED);
+            bOk = false;
+            break;
+        }
+
+        if (!frame.pPicture)
+        {
+            ++stats.nSkipped;
+            LogWarn("animate", std::string(GetConvertStatusString(frame.result.eStatus)) + ": " + frame.strName);
+            continue;
+        }
+
+        // 캔버스 크기는 첫 프레임으로 정한다.
+        if (!pEncoder)
+        {
+            WebPAnimEncoderOptions animOption;
+            if (!WebPAnimEncoderOptionsInit(&animOption))
+            {
+                stats.strError = "libwebpmux 버전이 맞지 않습니다.";
+                bOk = false;
+                break;
+            }
+            animOption.anim_params.loop_count = m_option.nLoopCount;
+            animOption.minimize_size = m_option.bMinimizeSize ? 1 : 0;
+            animOption.allow_mixed = 0;
+
+            pEncoder = WebPAnimEncoderNew(frame.pPicture->width, frame.pPicture->height, &animOption);
+            if (!pEncoder)
+            {
+                stats.strError = "애니메이션 인코더를 만들지 못했습니다.";
+                bOk = false;
+                break;
+            }
+            stats.nWidth = frame.pPicture->width;
+            stats.nHeight = frame.pPicture->height;
+        }
+        else if (frame.pPicture->width != stats.nWidth || frame.pPicture->height != stats.nHeight)
+        {
+            ++stats.nSkipped;
+            LogWarn("animate", "첫 프레임(" + std::to_string(stats.nWidth) + "x" + std::to_string(stats.nHeight) + ")과 크기가 달라 건너뜁니다 ("
+                + std::to_string(frame.pPicture->width) + "x" + std::to_string(frame.pPicture->height) + "): " + frame.strName);
+            continue;
+        }
+
+        const auto encodeStartTime = std::chrono::steady_clock::now();
+        const bool bAdded = WebPAnimEncoderAdd(pEncoder, frame.pPicture.get(), nTimestampMs, &config) != 0;
+        stats.durationEncode += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - encodeStartTime);
+        if (!bAdded)
+        {
+            stats.strError = WebPAnimEncoderGetError(pEncoder);
+            bOk = false;
+            break;
+        }
+        nTimestampMs += m_option.nFrameMs;
+        ++stats.nEncoded;
+    }
+
+    // 중간에 멈췄으면 남은 작업은 디코딩하지 않고 끝낸다.
+    bAbort = true;
+    pool.stop();
+    mapDone.clear();
+
+    stats.nFrames = nRead;
+    stats.bSourceError = source.HasError();
+    stats.durationPrepare = std::chrono::microseconds(nPrepareUs.load());
+
+    if (bOk && !pEncoder)
+    {
+        stats.strError = "애니메이션에 넣을 프레임이 없습니다.";
+        bOk = false;
+    }
+
+    if (bOk)
+    {
+        // 마지막 프레임의 표시 시간은 끝 타임스탬프로 정해진다.
+        const auto assembleStartTime = std::chrono::steady_clock::now();
+        WebPData data;
+        WebPDataInit(&data);
+        if (WebPAnimEncoderAdd(pEncoder, nullptr, nTimestampMs, nullptr) && WebPAnimEncoderAssemble(pEncoder, &data))
+        {
+            vecWebpOut.assign(data.bytes, data.bytes + data.size);
+            stats.nOutputBytes = vecWebpOut.size();
+        }
+        else
+        {
+            stats.strError = WebPAnimEncoderGetError(pEncoder);
+            bOk = false;
+        }
+        WebPDataClear(&data);
+        stats.durationEncode += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - assembleStartTime);
+    }
+
+    if (pEncoder)
+        WebPAnimEncoderDelete(pEncoder);
+
+    stats.fElapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // 프레임별 경고가 호출자의 요약 출력보다 먼저 나오도록 비운다.
+    Logger::Flush();
+    return bOk;
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include "ConvertEngine.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// JPEG 연속 프레임(연사, 타임랩스 폴더) -> 애니메이션 WebP
+//   작업자들이 프레임을 병렬로 디코딩/범위 변환하고 ARGB 캔버스까지 만들어 두면, 호출 스레드가 입력 순서대로
+//   libwebp 애니메이션 인코더(WebPAnimEncoder, libwebpmux)에 넣는다. 인코더 자체는 프레임 사이 차이를 계산하므로
+//   순서대로 한 스레드에서만 불러야 한다.
+//
+//   읽었지만 아직 인코더에 넣지 않은 프레임은 nWindow 장을 넘지 않는다. 인코더에 넣은 프레임은 바로 반납하므로
+//   최대 메모리는 시퀀스 길이가 아니라 창 크기 x 프레임 크기에 비례한다.
+
+struct AnimationOption
+{
+    int nWorkerCount = 0;       // 0 = 하드웨어 스레드 수
+    int nWindow = 0;            // 동시에 메모리에 있는 프레임 수 상한 (0 = 작업자 수 * 2)
+    int nFrameMs = 100;         // 프레임 표시 시간
+    int nLoopCount = 0;         // 0 = 무한 반복
+    bool bMinimizeSize = false; // 프레임마다 키프레임/차분 프레임을 모두 시도해서 작은 쪽을 고른다. (느림)
+};
+
+struct AnimationStats
+{
+    uint64_t nFrames = 0;       // 원천에서 읽은 프레임
+    uint64_t nEncoded = 0;      // 애니메이션에 들어간 프레임
+    uint64_t nSkipped = 0;      // 디코딩 실패 / 첫 프레임과 크기가 다름
+    uint64_t nInputBytes = 0;
+    uint64_t nOutputBytes = 0;
+    int nWidth = 0;             // 캔버스 크기 (첫 프레임)
+    int nHeight = 0;
+    int nWindow = 0;
+    int nPeakFrames = 0;        // 동시에 메모리에 있던 최대 프레임 수
+    uint64_t nPeakFrameBytes = 0;
+    std::chrono::microseconds durationPrepare{ 0 };    // 작업자 합계: 디코딩 + 범위 변환 + ARGB 변환
+    std::chrono::microseconds durationEncode{ 0 };     // 호출 스레드: 프레임 추가 + 마지막 조립
+    std::chrono::microseconds durationWait{ 0 };       // 호출 스레드가 다음 프레임을 기다린 시간
+    double fElapsedSec = 0.0;
+    bool bSourceError = false;
+    std::string strError;       // Run 이 false 일 때 이유
+
+    double GetFramesPerSec() const { return fElapsedSec > 0.0 ? static_cast<double>(nEncoded) / fElapsedSec : 0.0; }
+};
+
+class AnimationAssembler
+{
+public:
+    AnimationAssembler(const ConvertEngine& engine, const AnimationOption& option);
+
+    // source 의 프레임을 순서대로 이어 붙인 애니메이션 WebP 를 vecWebpOut 에 담는다.
+    //   디코딩할 수 없거나 첫 프레임과 크기가 다른 프레임은 경고를 남기고 건너뛴다.
+    //   넣을 프레임이 하나도 없거나 인코더가 실패하면 false (이유는 stats.strError)
+    bool Run(IInputSource& source, std::vector<uint8_t>& vecWebpOut, AnimationStats& stats);
+
+private:
+    const ConvertEngine& m_engine;
+    AnimationOption m_option;
+};
@@ -0,0 +1,502 @@
+﻿#include "ArchiveSource.h"
+#include "FileEndpoint.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <zlib.h>
+
+#ifdef _WIN32
+#define ARCHIVE_FSEEK _fseeki64
+#define ARCHIVE_FTELL _ftelli64
+#else
+#define ARCHIVE_FSEEK fseeko
+#define ARCHIVE_FTELL ftello
+#endif
+
+namespace
+{
+    const size_t TAR_BLOCK = 512;
+    const uint64_t MAX_MEMBER_BYTES = 1ull << 31; // 멤버 하나가 2GB 를 넘으면 JPEG 이 아니라고 본다. (zlib uInt 한계 이내)
+
+    uint16_t LoadU16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    uint32_t LoadU32(const uint8_t* p) { return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+    uint64_t LoadU64(const uint8_t* p) { return static_cast<uint64_t>(LoadU32(p)) | (static_cast<uint64_t>(LoadU32(p + 4)) << 32); }
+
+    // tar 숫자 필드: 8진수 ASCII 또는 (최상위 비트가 켜진) base-256
+    uint64_t ParseTarNumber(const uint8_t* p, size_t nLen)
+    {
+        if (p[0] & 0x80)
+        {
+            uint64_t nValue = p[0] & 0x7F;
+            for (size_t i = 1; i < nLen; ++i)
+                nValue = (nValue << 8) | p[i];
+            return nValue;
+        }
+
+        uint64_t nValue = 0;
+        for (size_t i = 0; i < nLen && p[i]; ++i)
+        {
+            if (p[i] >= '0' && p[i] <= '7')
+                nValue = nValue * 8 + (p[i] - '0');
+        }
+        return nValue;
+    }
+
+    std::string ParseTarString(const uint8_t* p, size_t nLen)
+    {
+        size_t n = 0;
+        while (n < nLen && p[n])
+            ++n;
+        return std::string(reinterpret_cast<const char*>(p), n);
+    }
+
+    bool IsZeroBlock(const uint8_t* p)
+    {
+        for (size_t i = 0; i < TAR_BLOCK; ++i)
+        {
+            if (p[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool VerifyTarChecksum(const uint8_t* p)
+    {
+        const uint64_t nStored = ParseTarNumber(p + 148, 8);
+        uint64_t nSum = 0;
+        for (size_t i = 0; i < TAR_BLOCK; ++i)
+            nSum += (i >= 148 && i < 156) ? ' ' : p[i];
+        return nSum == nStored;
+    }
+
+    // pax 확장 헤더 ("len key=value\n" 반복) 에서 path 값 찾기
+    bool FindPaxPath(const std::vector<uint8_t>& vecPax, std::string& strPath)
+    {
+        size_t nPos = 0;
+        bool bFound = false;
+        while (nPos < vecPax.size())
+        {
+            size_t nSpace = nPos;
+            size_t nLen = 0;
+            while (nSpace < vecPax.size() && vecPax[nSpace] >= '0' && vecPax[nSpace] <= '9')
+                nLen = nLen * 10 + (vecPax[nSpace++] - '0');
+
+            if (nLen == 0 || nSpace >= vecPax.size() || vecPax[nSpace] != ' ' || nPos + nLen > vecPax.size())
+                break;
+
+            const std::string strRecord(reinterpret_cast<const char*>(&vecPax[nSpace + 1]), nPos + nLen - nSpace - 2);
+            if (strRecord.compare(0, 5, "path=") == 0)
+            {
+                strPath = strRecord.substr(5);
+                bFound = true;
+            }
+            nPos += nLen;
+        }
+        return bFound;
+    }
+}
+
+bool IsArchiveFileName(const std::string& strPath)
+{
+    std::string strLower = strPath;
+    std::transform(strLower.begin(), strLower.end(), strLower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    auto endsWith = [&](const char* pszSuffix)
+    {
+        const size_t n = std::strlen(pszSuffix);
+        return strLower.size() >= n && strLower.compare(strLower.size() - n, n, pszSuffix) == 0;
+    };
+    return endsWith(".tar") || endsWith(".zip");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TarArchiveSource
+
+TarArchiveSource::TarArchiveSource(std::FILE* pFile, bool bOwnFile /*= false*/)
+    : m_pFile(pFile)
+    , m_bOwnFile(bOwnFile)
+{
+}
+
+TarArchiveSource::~TarArchiveSource()
+{
+    if (m_bOwnFile && m_pFile)
+        std::fclose(m_pFile);
+}
+
+bool TarArchiveSource::Skip(uint64_t nBytes)
+{
+    // 파이프는 seek 가 안 되므로 읽어서 버린다.
+    if (nBytes > 0 && ARCHIVE_FSEEK(m_pFile, static_cast<long long>(nBytes), SEEK_CUR) == 0)
+        return true;
+
+    uint8_t buf[65536];
+    while (nBytes > 0)
+    {
+        const size_t nChunk = static_cast<size_t>(std::min<uint64_t>(nBytes, sizeof(buf)));
+        if (std::fread(buf, 1, nChunk, m_pFile) != nChunk)
+            return false;
+        nBytes -= nChunk;
+    }
+    return true;
+}
+
+bool TarArchiveSource::Next(InputItem& item)
+{
+    std::string strLongName;
+    uint8_t header[TAR_BLOCK];
+
+    while (!m_bEnd && !m_bError)
+    {
+        if (std::fread(header, 1, TAR_BLOCK, m_pFile) != TAR_BLOCK)
+        {
+            // 끝 표시(0 블록 2개) 없이 끝난 아카이브도 헤더 경계에서 끝났다면 허용
+            m_bEnd = true;
+            m_bError = !std::feof(m_pFile);
+            break;
+        }
+
+        if (IsZeroBlock(header))
+        {
+            m_bEnd = true;
+            break;
+        }
+
+        if (!VerifyTarChecksum(header))
+        {
+            LogError("tar", "tar 헤더 체크섬 불일치");
+            m_bError = true;
+            break;
+        }
+
+        const uint64_t nSize = ParseTarNumber(header + 124, 12);
+        const uint64_t nPadded = (nSize + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK;
+        const char cType = static_cast<char>(header[156]);
+
+        // GNU longname / pax 헤더: 다음 멤버의 이름을 담고 있다.
+        if (cType == 'L' || cType == 'x')
+        {
+            if (nSize > (1u << 20))
+            {
+                m_bError = true;
+                break;
+            }
+
+            std::vector<uint8_t> vecMeta(static_cast<size_t>(nPadded));
+            if (!vecMeta.empty() && std::fread(vecMeta.data(), 1, vecMeta.size(), m_pFile) != vecMeta.size())
+            {
+                m_bError = true;
+                break;
+            }
+            vecMeta.resize(static_cast<size_t>(nSize));
+
+            if (cType == 'L')
+                strLongName = ParseTarString(vecMeta.data(), vecMeta.size());
+            else
+                FindPaxPath(vecMeta, strLongName);
+            continue;
+        }
+
+        std::string strName = strLongName;
+        strLongName.clear();
+        if (strName.empty())
+        {
+            strName = ParseTarString(header, 100);
+            if (std::memcmp(header + 257, "ustar", 5) == 0)
+            {
+                const std::string strPrefix = ParseTarString(header + 345, 155);
+                if (!strPrefix.empty())
+                    strName = strPrefix + "/" + strName;
+            }
+        }
+
+        const bool bRegular = (cType == '0' || cType == '\0' || cType == '7');
+        if (!bRegular || !IsJpegFileName(strName) || nSize > MAX_MEMBER_BYTES)
+        {
+            if (!Skip(nPadded))
+                m_bError = true;
+            continue;
+        }
+
+        // "../x.jpg", "/etc/x.jpg" 같은 멤버 이름은 출력 폴더 밖을 가리키므로 내보내지 않는다.
+        const std::string strSafeName = MakeSafeRelativePath(strName);
+        if (strSafeName.empty())
+        {
+            LogWarn("tar", "허용되지 않는 멤버 경로 건너뜀: " + strName);
+            if (!Skip(nPadded))
+                m_bError = true;
+            continue;
+        }
+
+        item.strName = strSafeName;
+        item.vecData.resize(static_cast<size_t>(nSize));
+        if ((nSize > 0 && std::fread(item.vecData.data(), 1, static_cast<size_t>(nSize), m_pFile) != nSize) || !Skip(nPadded - nSize))
+        {
+            m_bError = true;
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ZipArchiveSource
+
+ZipArchiveSource::~ZipArchiveSource()
+{
+    if (m_pFile)
+        std::fclose(m_pFile);
+}
+
+bool ZipArchiveSource::Open(const std::string& strPath)
+{
+    m_pFile = std::fopen(strPath.c_str(), "rb");
+    if (!m_pFile)
+        return false;
+
+    if (!ReadCentralDirectory())
+    {
+        std::cerr << "Error: zip 중앙 디렉터리를 읽지 못했습니다: " << strPath << "\n";
+        m_bError = true;
+        return false;
+    }
+
+    // 로컬 헤더 오프셋 순으로 읽어서 디스크를 앞으로만 훑게 한다.
+    std::sort(m_vecEntry.begin(), m_vecEntry.end(), [](const Entry& a, const Entry& b) { return a.nLocalHeaderOffset < b.nLocalHeaderOffset; });
+    return true;
+}
+
+bool ZipArchiveSource::ReadCentralDirectory()
+{
+    if (ARCHIVE_FSEEK(m_pFile, 0, SEEK_END) != 0)
+        return false;
+
+    const long long nFileSize = ARCHIVE_FTELL(m_pFile);
+    if (nFileSize < 22)
+        return false;
+    m_nFileSize = static_cast<uint64_t>(nFileSize);
+
+    // End of central directory 는 마지막 22 + 65535(주석) 바이트 안에 있다.
+    const long long nTail = std::min<long long>(nFileSize, 22 + 65535 + 20);
+    std::vector<uint8_t> vecTail(static_cast<size_t>(nTail));
+    if (ARCHIVE_FSEEK(m_pFile, nFileSize - nTail, SEEK_SET) != 0 || std::fread(vecTail.data(), 1, vecTail.size(), m_pFile) != vecTail.size())
+        return false;
+
+    long long nEocd = -1;
+    for (long long i = nTail - 22; i >= 0; --i)
+    {
+        if (LoadU32(&vecTail[static_cast<size_t>(i)]) == 0x06054b50)
+        {
+            nEocd = i;
+            break;
+        }
+    }
+    if (nEocd < 0)
+        return false;
+
+    const uint8_t* pEocd = &vecTail[static_cast<size_t>(nEocd)];
+    uint64_t nEntryCount = LoadU16(pEocd + 10);
+    uint64_t nCdSize = LoadU32(pEocd + 12);
+    uint64_t nCdOffset = LoadU32(pEocd + 16);
+
+    // zip64: EOCD 바로 앞의 locator 가 zip64 EOCD 레코드를 가리킨다.
+    if (nEocd >= 20 && LoadU32(&vecTail[static_cast<size_t>(nEocd - 20)]) == 0x07064b50)
+    {
+        const uint64_t nZip64Offset = LoadU64(&vecTail[static_cast<size_t>(nEocd - 20) + 8]);
+        uint8_t zip64[56];
+        if (ARCHIVE_FSEEK(m_pFile, static_cast<long long>(nZip64Offset), SEEK_SET) != 0 || std::fread(zip64, 1, sizeof(zip64), m_pFile) != sizeof(zip64) || LoadU32(zip64) != 0x06064b50)
+            return false;
+
+        nEntryCount = LoadU64(zip64 + 32);
+        nCdSize = LoadU64(zip64 + 40);
+        nCdOffset = LoadU64(zip64 + 48);
+    }
+
+    if (nCdOffset + nCdSize > static_cast<uint64_t>(nFileSize))
+        return false;
+
+    std::vector<uint8_t> vecCd(static_cast<size_t>(nCdSize));
+    if (ARCHIVE_FSEEK(m_pFile, static_cast<long long>(nCdOffset), SEEK_SET) != 0 || (!vecCd.empty() && std::fread(vecCd.data(), 1, vecCd.size(), m_pFile) != vecCd.size()))
+        return false;
+
+    m_vecEntry.reserve(static_cast<size_t>(std::min<uint64_t>(nEntryCount, 1u << 20)));
+    size_t nPos = 0;
+    for (uint64_t n = 0; n < nEntryCount; ++n)
+    {
+        if (nPos + 46 > vecCd.size() || LoadU32(&vecCd[nPos]) != 0x02014b50)
+            return false;
+
+        const uint8_t* p = &vecCd[nPos];
+        const uint16_t nFlags = LoadU16(p + 8);
+        const uint16_t nNameLen = LoadU16(p + 28);
+        const uint16_t nExtraLen = LoadU16(p + 30);
+        const uint16_t nCommentLen = LoadU16(p + 32);
+        if (nPos + 46 + nNameLen + nExtraLen + nCommentLen > vecCd.size())
+            return false;
+
+        Entry entry;
+        entry.nMethod = LoadU16(p + 10);
+        entry.nCrc32 = LoadU32(p + 16);
+        entry.nCompressedSize = LoadU32(p + 20);
+        entry.nUncompressedSize = LoadU32(p + 24);
+        entry.nLocalHeaderOffset = LoadU32(p + 42);
+        entry.strName.assign(reinterpret_cast<const char*>(p + 46), nNameLen);
+
+        // zip64 확장 필드 (0x0001): 0xFFFFFFFF 로 표시된 값만 순서대로 들어 있다.
+        const uint8_t* pExtra = p + 46 + nNameLen;
+        size_t nExtraPos = 0;
+        while (nExtraPos + 4 <= nExtraLen)
+        {
+            const uint16_t nId = LoadU16(pExtra + nExtraPos);
+            const uint16_t nSize = LoadU16(pExtra + nExtraPos + 2);
+            if (nExtraPos + 4 + nSize > nExtraLen)
+                break;
+
+            if (nId == 0x0001)
+            {
+                const uint8_t* pField = pExtra + nExtraPos + 4;
+                size_t nField = 0;
+                if (entry.nUncompressedSize == 0xFFFFFFFFu && nField + 8 <= nSize) { entry.nUncompressedSize = LoadU64(pField + nField); nField += 8; }
+                if (entry.nCompressedSize == 0xFFFFFFFFu && nField + 8 <= nSize) { entry.nCompressedSize = LoadU64(pField + nField); nField += 8; }
+                if (entry.nLocalHeaderOffset == 0xFFFFFFFFu && nField + 8 <= nSize) { entry.nLocalHeaderOffset = LoadU64(pField + nField); nField += 8; }
+            }
+            nExtraPos += 4 + nSize;
+        }
+
+        nPos += 46 + nNameLen + nExtraLen + nCommentLen;
+
+        const bool bDirectory = !entry.strName.empty() && entry.strName.back() == '/';
+        const bool bEncrypted = (nFlags & 0x0001) != 0;
+        if (bDirectory || !IsJpegFileName(entry.strName))
+            continue;
+
+        const std::string strSafeName = MakeSafeRelativePath(entry.strName);
+        if (strSafeName.empty())
+        {
+            LogWarn("zip", "허용되지 않는 멤버 경로 건너뜀: " + entry.strName);
+            continue;
+        }
+        entry.strName = strSafeName;
+
+        if (bEncrypted || (entry.nMethod != 0 && entry.nMethod != 8) || entry.nUncompressedSize > MAX_MEMBER_BYTES)
+        {
+            LogWarn("zip", "지원하지 않는 zip 멤버 건너뜀 (method=" + std::to_string(entry.nMethod) + (bEncrypted ? ", encrypted" : "") + "): " + entry.strName);
+            continue;
+        }
+
+        // 크기/오프셋은 중앙 디렉터리 값을 그대로 믿지 않는다. 파일 밖을 가리키면 읽기 버퍼를 키우기 전에 손상으로 처리한다.
+        if (entry.nCompressedSize > MAX_MEMBER_BYTES || entry.nLocalHeaderOffset > m_nFileSize
+            || entry.nCompressedSize + 30 > m_nFileSize - entry.nLocalHeaderOffset)
+        {
+            LogError("zip", "크기나 위치가 파일 밖을 가리키는 zip 멤버 건너뜀: " + entry.strName);
+            m_bError = true;
+            continue;
+        }
+
+        m_vecEntry.push_back(entry);
+    }
+    return true;
+}
+
+bool ZipArchiveSource::ReadEntry(const Entry& entry, std::vector<uint8_t>& vecOut)
+{
+    uint8_t local[30];
+    if (ARCHIVE_FSEEK(m_pFile, static_cast<long long>(entry.nLocalHeaderOffset), SEEK_SET) != 0
+        || std::fread(local, 1, sizeof(local), m_pFile) != sizeof(local)
+        || LoadU32(local) != 0x04034b50)
+        return false;
+
+    const long long nDataOffset = static_cast<long long>(entry.nLocalHeaderOffset) + 30 + LoadU16(local + 26) + LoadU16(local + 28);
+    if (static_cast<uint64_t>(nDataOffset) + entry.nCompressedSize > m_nFileSize || ARCHIVE_FSEEK(m_pFile, nDataOffset, SEEK_SET) != 0)
+        return false;
+
+    vecOut.resize(static_cast<size_t>(entry.nUncompressedSize));
+
+    if (entry.nMethod == 0)
+    {
+        if (entry.nCompressedSize != entry.nUncompressedSize)
+            return false;
+        if (!vecOut.empty() && std::fread(vecOut.data(), 1, vecOut.size(), m_pFile) != vecOut.size())
+            return false;
+    }
+    else
+    {
+        // deflate: 압축 데이터를 한 번에 읽고 raw inflate (wbits 음수 = zlib 헤더 없음)
+        //   두 크기 모두 MAX_MEMBER_BYTES 이하로 걸렀으므로 uInt 로 줄여도 잘리지 않는다.
+        m_vecCompressed.resize(static_cast<size_t>(entry.nCompressedSize));
+        if (!m_vecCompressed.empty() && std::fread(m_vecCompressed.data(), 1, m_vecCompressed.size(), m_pFile) != m_vecCompressed.size())
+            return false;
+
+        z_stream zs;
+        std::memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+            return false;
+
+        zs.next_in = m_vecCompressed.data();
+        zs.avail_in = static_cast<uInt>(m_vecCompressed.size());
+        zs.next_out = vecOut.data();
+        zs.avail_out = static_cast<uInt>(vecOut.size());
+        const int nRet = inflate(&zs, Z_FINISH);
+        const bool bOk = (nRet == Z_STREAM_END) && zs.total_out == vecOut.size();
+        inflateEnd(&zs);
+        if (!bOk)
+            return false;
+    }
+
+    const uLong nCrc = crc32(crc32(0L, Z_NULL, 0), vecOut.data(), static_cast<uInt>(vecOut.size()));
+    return nCrc == entry.nCrc32;
+}
+
+bool ZipArchiveSource::Next(InputItem& item)
+{
+    while (m_nIndex < m_vecEntry.size())
+    {
+        const Entry& entry = m_vecEntry[m_nIndex++];
+        if (ReadEntry(entry, item.vecData))
+        {
+            item.strName = entry.strName;
+            return true;
+        }
+
+        // 멤버 하나가 깨졌어도 나머지는 계속 읽는다.
+        LogError("zip", "zip 멤버를 읽지 못했습니다: " + entry.strName);
+        m_bError = true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<IInputSource> OpenArchiveSource(const std::string& strPath)
+{
+    if (strPath == "-")
+        return std::unique_ptr<IInputSource>(new TarArchiveSource(stdin));
+
+    std::FILE* pFile = std::fopen(strPath.c_str(), "rb");
+    if (!pFile)
+        return nullptr;
+
+    uint8_t header[TAR_BLOCK] = { 0 };
+    const size_t nRead = std::fread(header, 1, sizeof(header), pFile);
+
+    if (nRead >= 4 && LoadU32(header) == 0x04034b50)
+    {
+        std::fclose(pFile);
+        std::unique_ptr<ZipArchiveSource> pZip(new ZipArchiveSource());
+        if (!pZip->Open(strPath))
+            return nullptr;
+        return pZip;
+    }
+
+    if (nRead == TAR_BLOCK && VerifyTarChecksum(header))
+    {
+        std::rewind(pFile);
+        return std::unique_ptr<IInputSource>(new TarArchiveSource(pFile, true));
+    }
+
+    std::fclose(pFile);
+    return nullptr;
+}
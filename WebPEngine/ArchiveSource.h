@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include <cstdio>
+#include <memory>
+
+// 압축을 풀지 않고 tar / zip 아카이브의 JPEG 멤버를 바로 파이프라인에 공급하는 원천
+// 멤버 이름이 *.jpg / *.jpeg 인 일반 파일만 내보낸다.
+// 멤버 이름은 MakeSafeRelativePath 로 정리해서 내보내고, 루트 밖을 가리키는 (".." 포함) 멤버는 건너뛴다.
+
+// tar (ustar / GNU longname / pax path) 를 앞에서부터 순차로 읽는다. 탐색(seek)이 필요 없으므로 stdin 파이프도 가능.
+class TarArchiveSource : public IInputSource
+{
+public:
+    explicit TarArchiveSource(std::FILE* pFile, bool bOwnFile = false);
+    ~TarArchiveSource();
+
+    bool Next(InputItem& item) override;
+    bool HasError() const override { return m_bError; }
+
+private:
+    bool Skip(uint64_t nBytes);
+
+    std::FILE* m_pFile;
+    bool m_bOwnFile;
+    bool m_bError = false;
+    bool m_bEnd = false;
+};
+
+// zip 은 중앙 디렉터리를 먼저 읽고, 로컬 헤더 오프셋 순서대로 멤버를 읽는다. (stored / deflate, zip64 지원)
+class ZipArchiveSource : public IInputSource
+{
+public:
+    ZipArchiveSource() {}
+    ~ZipArchiveSource();
+
+    bool Open(const std::string& strPath);
+    bool Next(InputItem& item) override;
+    bool HasError() const override { return m_bError; }
+
+    size_t GetMemberCount() const { return m_vecEntry.size(); }
+
+private:
+    struct Entry
+    {
+        std::string strName;
+        uint16_t nMethod = 0;
+        uint32_t nCrc32 = 0;
+        uint64_t nCompressedSize = 0;
+        uint64_t nUncompressedSize = 0;
+        uint64_t nLocalHeaderOffset = 0;
+    };
+
+    bool ReadCentralDirectory();
+    bool ReadEntry(const Entry& entry, std::vector<uint8_t>& vecOut);
+
+    std::FILE* m_pFile = nullptr;
+    std::vector<Entry> m_vecEntry;
+    std::vector<uint8_t> m_vecCompressed;
+    uint64_t m_nFileSize = 0;
+    size_t m_nIndex = 0;
+    bool m_bError = false;
+};
+
+// 경로의 시그니처/확장자로 tar 또는 zip 원천을 만든다. "-" 는 stdin tar. 아카이브가 아니면 nullptr
+std::unique_ptr<IInputSource> OpenArchiveSource(const std::string& strPath);
+
+bool IsArchiveFileName(const std::string& strPath);
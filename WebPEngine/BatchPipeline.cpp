@@ -0,0 +1,229 @@
+﻿#include "BatchPipeline.h"
+#include "CropList.h"
+#include "JobPool.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+BatchPipeline::BatchPipeline(const ConvertEngine& engine, const PipelineOption& option)
+    : m_engine(engine)
+    , m_option(option)
+{
+}
+
+PipelineStats BatchPipeline::Run(IInputSource& source, IOutputSink& sink)
+{
+    PipelineStats stats;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    TraceRecorder* pTrace = m_engine.GetOption().pTrace;
+    JobPoolOption poolOption;
+    poolOption.nWorkerCount = m_option.nWorkerCount;
+    poolOption.bPinWorkers = m_option.bPinWorkers;
+    JobPool pool(poolOption);
+    const int nMaxInflight = (m_option.nMaxInflight > 0) ? m_option.nMaxInflight : pool.getTotalWorkerCount() * 4;
+
+    std::mutex mutex;
+    std::condition_variable cvReader;   // 창(window)에 빈자리가 생김
+    std::condition_variable cvWriter;   // 완료 항목 도착 / 읽기 종료
+    std::deque<OutputItem> queDone;
+    int nInflight = 0;
+    uint64_t nRead = 0;
+    bool bReadDone = false;
+    bool bAbort = false;
+
+    // 1) 읽기 스레드: 원천에서 항목을 꺼내 작업자에게 넘긴다. 변환과 병렬로 진행됨.
+    //    추적 중이면 창이 찰 때까지 기다린 시간(window_wait)과 원천 읽기(read)를 남긴다.
+    std::thread reader([&]()
+    {
+        if (pTrace)
+            pTrace->SetThreadName("reader");
+
+        while (true)
+        {
+            {
+                TraceScope windowWaitSpan(pTrace, "window_wait");
+                std::unique_lock<std::mutex> lock(mutex);
+                cvReader.wait(lock, [&]() { return nInflight < nMaxInflight || bAbort; });
+                if (bAbort)
+                    break;
+            }
+
+            const int64_t nReadStartNs = pTrace ? pTrace->Now() : 0;
+            auto pItem = std::make_shared<InputItem>();
+            if (!source.Next(*pItem))
+                break;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pItem->nSeq = nRead++;
+                ++nInflight;
+                stats.nInputBytes += pItem->vecData.size();
+            }
+
+            // 작업자가 꺼낼 때까지의 시간은 작업자 쪽에 queue_wait 로 남긴다.
+            int64_t nQueuedNs = 0;
+            if (pTrace)
+            {
+                nQueuedNs = pTrace->Now();
+                pTrace->SetItemName(pItem->nSeq, pItem->strName);
+                pTrace->BeginItem(pItem->nSeq);
+                pTrace->Record("read", nReadStartNs, nQueuedNs);
+                pTrace->EndItem();
+            }
+
+            pool.push([&, pItem, nQueuedNs]()
+            {
+                if (pTrace)
+                {
+                    pTrace->BeginItem(pItem->nSeq);
+                    pTrace->Record("queue_wait", nQueuedNs, pTrace->Now());
+                }
+                TraceScope convertSpan(pTrace, "convert");
+
+                OutputItem out;
+                out.nSeq = pItem->nSeq;
+                out.strName = std::move(pItem->strName);
+                out.strOutputName = std::move(pItem->strOutputName);
+                JpegRegion crop;
+                if (m_option.pCropList && m_option.pCropList->Find(out.strName, crop))
+                {
+                    ConvertOption option = m_engine.GetOption();
+                    option.crop = crop;
+                    out.bOk = m_engine.ConvertMemory(pItem->vecData.data(), pItem->vecData.size(), option, out.vecWebp, out.result);
+                }
+                else
+                {
+                    out.bOk = m_engine.ConvertMemory(pItem->vecData.data(), pItem->vecData.size(), out.vecWebp, out.result);
+                }
+                pItem->vecData = std::vector<uint8_t>(); // 입력 버퍼는 바로 반환
+                convertSpan.End();
+                if (pTrace)
+                    pTrace->EndItem();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queDone.emplace_back(std::move(out));
+                }
+                cvWriter.notify_one();
+            });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bReadDone = true;
+        }
+        cvWriter.notify_one();
+    });
+
+    // 2) 출력: 호출 스레드가 완료 항목을 (필요하면 순서를 맞춰) sink 에 기록한다.
+    std::map<uint64_t, OutputItem> mapReorder;
+    uint64_t nNextSeq = 0;
+    uint64_t nWritten = 0;
+
+    auto emit = [&](OutputItem& item)
+    {
+        ++stats.nItems;
+        if (item.bOk)
+        {
+            ++stats.nConverted;
+            stats.nOutputBytes += item.vecWebp.size();
+            stats.fQualitySum += item.result.fQuality;
+            stats.durationAnalyze += item.result.durationAnalyze;
+            stats.durationDecode += item.result.durationDecode;
+            stats.durationEncode += item.result.durationEncode;
+
+            if (item.result.bVerified)
+            {
+                const QualityScore& score = item.result.score;
+                stats.fMinPsnr = (stats.nVerified == 0) ? score.fPsnr : std::min(stats.fMinPsnr, score.fPsnr);
+                stats.fMinSsim = (stats.nVerified == 0) ? score.fSsim : std::min(stats.fMinSsim, score.fSsim);
+                ++stats.nVerified;
+                stats.nVerifyFailed += item.result.bVerifyFailed ? 1 : 0;
+                stats.fPsnrSum += score.fPsnr;
+                stats.fSsimSum += score.fSsim;
+                stats.durationVerify += item.result.durationVerify;
+            }
+        }
+        else
+        {
+            ++stats.nFailed;
+        }
+
+        if (pTrace)
+            pTrace->BeginItem(item.nSeq);
+        {
+            TraceScope writeSpan(pTrace, "write");
+            if (!stats.bSinkError && !sink.Write(item))
+                stats.bSinkError = true;
+        }
+        if (pTrace)
+            pTrace->EndItem();
+
+        ++nWritten;
+    };
+
+    if (pTrace)
+        pTrace->SetThreadName("writer");
+
+    while (true)
+    {
+        std::deque<OutputItem> queBatch;
+        {
+            TraceScope outputWaitSpan(pTrace, "output_wait");
+            std::unique_lock<std::mutex> lock(mutex);
+            cvWriter.wait(lock, [&]() { return !queDone.empty() || (bReadDone && nWritten == nRead); });
+            if (queDone.empty())
+                break;
+            queBatch.swap(queDone);
+        }
+
+        int nReleased = 0;
+        for (auto& item : queBatch)
+        {
+            if (!m_option.bPreserveOrder)
+            {
+                emit(item);
+                ++nReleased;
+                continue;
+            }
+
+            mapReorder.emplace(item.nSeq, std::move(item));
+            while (!mapReorder.empty() && mapReorder.begin()->first == nNextSeq)
+            {
+                emit(mapReorder.begin()->second);
+                mapReorder.erase(mapReorder.begin());
+                ++nNextSeq;
+                ++nReleased;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            nInflight -= nReleased;
+            if (stats.bSinkError)
+                bAbort = true; // 출력이 막히면 더 읽지 않는다.
+        }
+        cvReader.notify_one();
+    }
+
+    reader.join();
+    pool.stop();
+    stats.nPinnedWorkers = pool.getPinnedWorkerCount();
+
+    if (!sink.Finish())
+        stats.bSinkError = true;
+
+    stats.bSourceError = source.HasError();
+    stats.fElapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // 항목별 오류 기록이 호출자의 요약 출력보다 먼저 나오도록 비운다.
+    Logger::Flush();
+    return stats;
+}
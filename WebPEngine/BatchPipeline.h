@@ -0,0 +1,123 @@
+﻿#pragma once
+
+#include "ConvertEngine.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CropList;
+
+// 입력 원천(파일 목록, stdin 스트림, 아카이브 ...) -> 작업자 변환 -> 출력 대상 으로 이어지는 배치 파이프라인
+
+struct InputItem
+{
+    uint64_t nSeq = 0;              // 파이프라인이 부여하는 입력 순번
+    std::string strName;            // 파일 경로 / 레코드 ID / 아카이브 멤버 이름
+    std::string strOutputName;      // 출력 폴더 아래에 쓸 상대 경로 (비어 있으면 strName 을 정리해서 쓴다)
+    std::vector<uint8_t> vecData;   // JPEG 바이트
+};
+
+struct OutputItem
+{
+    uint64_t nSeq = 0;
+    std::string strName;
+    std::string strOutputName;
+    bool bOk = false;
+    ConvertResult result;
+    std::vector<uint8_t> vecWebp;
+};
+
+class IInputSource
+{
+public:
+    virtual ~IInputSource() {}
+
+    // 다음 항목을 채운다. 더 이상 없으면 false. (파이프라인의 읽기 스레드 하나에서만 호출됨)
+    virtual bool Next(InputItem& item) = 0;
+
+    // 입력이 손상되어 중간에 끝났는지
+    virtual bool HasError() const { return false; }
+};
+
+class IOutputSink
+{
+public:
+    virtual ~IOutputSink() {}
+
+    // 변환 결과 하나를 기록한다. (파이프라인의 출력 스레드 하나에서만 호출됨)
+    virtual bool Write(OutputItem& item) = 0;
+    virtual bool Finish() { return true; }
+};
+
+// 여러 원천을 차례로 이어 붙인 원천 (파일 목록 + 아카이브 여러 개 등)
+class ChainedSource : public IInputSource
+{
+public:
+    void Add(std::unique_ptr<IInputSource> pSource) { m_vecSource.push_back(std::move(pSource)); }
+
+    bool Next(InputItem& item) override
+    {
+        while (m_nIndex < m_vecSource.size())
+        {
+            if (m_vecSource[m_nIndex]->Next(item))
+                return true;
+            m_bError = m_bError || m_vecSource[m_nIndex]->HasError();
+            ++m_nIndex;
+        }
+        return false;
+    }
+
+    bool HasError() const override { return m_bError; }
+
+private:
+    std::vector<std::unique_ptr<IInputSource>> m_vecSource;
+    size_t m_nIndex = 0;
+    bool m_bError = false;
+};
+
+struct PipelineOption
+{
+    int nWorkerCount = 0;           // 0 = 하드웨어 스레드 수
+    int nMaxInflight = 0;           // 동시에 메모리에 있는 항목 수 상한 (0 = 작업자 수 * 4)
+    bool bPreserveOrder = true;     // true 면 입력 순서대로 출력, false 면 완료 순서대로 출력
+    const CropList* pCropList = nullptr;    // 항목 이름별 잘라내기 영역 (목록에 없는 항목은 엔진 옵션의 crop 사용)
+    bool bPinWorkers = false;       // 작업자를 CPU 토폴로지에 맞춰 코어 하나씩에 고정 (JobPoolOption::bPinWorkers)
+};
+
+struct PipelineStats
+{
+    uint64_t nItems = 0;
+    uint64_t nConverted = 0;
+    uint64_t nFailed = 0;
+    uint64_t nInputBytes = 0;
+    uint64_t nOutputBytes = 0;
+    double fQualitySum = 0.0;                           // 변환 성공 항목이 실제로 쓴 품질 합 (평균 = / nConverted)
+    std::chrono::microseconds durationAnalyze{ 0 };     // 변환 성공 항목의 단계별 누적 시간 (작업자 시간 합)
+    std::chrono::microseconds durationDecode{ 0 };
+    std::chrono::microseconds durationEncode{ 0 };
+    uint64_t nVerified = 0;                             // 품질 검증 표본 수 / 그중 기준 미달
+    uint64_t nVerifyFailed = 0;
+    double fPsnrSum = 0.0;
+    double fSsimSum = 0.0;
+    double fMinPsnr = 0.0;                              // 검증 표본 중 최저값 (nVerified == 0 이면 의미 없음)
+    double fMinSsim = 0.0;
+    std::chrono::microseconds durationVerify{ 0 };
+    bool bSourceError = false;
+    bool bSinkError = false;
+    int nPinnedWorkers = 0;                             // 실제로 CPU 에 고정된 작업자 수
+    double fElapsedSec = 0.0;
+};
+
+class BatchPipeline
+{
+public:
+    BatchPipeline(const ConvertEngine& engine, const PipelineOption& option);
+
+    // 원천이 끝날 때까지 읽기/변환/출력을 병렬로 수행한다.
+    PipelineStats Run(IInputSource& source, IOutputSink& sink);
+
+private:
+    const ConvertEngine& m_engine;
+    PipelineOption m_option;
+};
@@ -0,0 +1,421 @@
+﻿#include "ConversionCache.h"
+#include "AdaptiveQuality.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <zlib.h>
+
+namespace
+{
+    // 항목 하나의 메모리 계층 부담 (WebP 바이트 + 키 + 목록/맵 노드 대략치)
+    const uint64_t ENTRY_OVERHEAD_BYTES = 128;
+
+    const char* const DISK_EXTENSION = ".webp";
+
+    uint64_t HashFnv1a(const void* pData, size_t nSize, uint64_t nHash = 14695981039346656037ull)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(pData);
+        for (size_t i = 0; i < nSize; ++i)
+        {
+            nHash ^= p[i];
+            nHash *= 1099511628211ull;
+        }
+        return nHash;
+    }
+
+    uint32_t HashCrc32(const void* pData, size_t nSize)
+    {
+        uLong nCrc = crc32(0L, Z_NULL, 0);
+        const Bytef* p = static_cast<const Bytef*>(pData);
+        while (nSize > 0)
+        {
+            const uInt nChunk = static_cast<uInt>(std::min<size_t>(nSize, 1u << 30));
+            nCrc = crc32(nCrc, p, nChunk);
+            p += nChunk;
+            nSize -= nChunk;
+        }
+        return static_cast<uint32_t>(nCrc);
+    }
+
+    // FNV-1a 64 + CRC32 + 길이: 서로 다른 두 해시를 함께 써서 충돌로 다른 이미지를 돌려줄 가능성을 사실상 없앤다.
+    std::string MakeHexKey(const void* pData, size_t nSize, const std::string& strSettings)
+    {
+        char szKey[64];
+        std::snprintf(szKey, sizeof(szKey), "%016llx%08x%010llx-%016llx",
+            static_cast<unsigned long long>(HashFnv1a(pData, nSize)), HashCrc32(pData, nSize),
+            static_cast<unsigned long long>(nSize & 0xFFFFFFFFFFull),
+            static_cast<unsigned long long>(HashFnv1a(strSettings.data(), strSettings.size())));
+        return szKey;
+    }
+}
+
+const char* GetCacheTierString(CACHE_TIER eTier)
+{
+    switch (eTier)
+    {
+    case CACHE_TIER_MEMORY:     return "memory";
+    case CACHE_TIER_DISK:       return "disk";
+    case CACHE_TIER_SHARED:     return "shared";
+    case CACHE_TIER_CONVERTED:  return "miss";
+    default:                    return "unknown";
+    }
+}
+
+ConversionCache::ConversionCache(const ConversionCacheOption& option)
+    : m_option(option)
+{
+    m_option.nShardCount = std::max(1, m_option.nShardCount);
+    m_nShardBytes = m_option.nMemoryBytes / static_cast<uint64_t>(m_option.nShardCount);
+    for (int i = 0; i < m_option.nShardCount; ++i)
+        m_vecShard.emplace_back(new MemoryShard());
+}
+
+bool ConversionCache::Open()
+{
+    if (m_option.strDiskDir.empty())
+        return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_option.strDiskDir, ec);
+    if (!std::filesystem::is_directory(m_option.strDiskDir, ec))
+    {
+        std::cerr << "Error: 캐시 폴더를 만들 수 없습니다: " << m_option.strDiskDir << "\n";
+        return false;
+    }
+
+    // 이전 실행의 항목: 수정 시각(마지막 사용 시각) 오래된 것부터 넣어서 최근 것이 LRU 앞쪽에 오게 한다.
+    struct Existing
+    {
+        std::filesystem::file_time_type time;
+        std::string strKey;
+        uint64_t nBytes;
+    };
+    std::vector<Existing> vecExisting;
+    for (const auto& entry : std::filesystem::directory_iterator(m_option.strDiskDir, ec))
+    {
+        std::error_code ecEntry;
+        if (!entry.is_regular_file(ecEntry) || entry.path().extension() != DISK_EXTENSION)
+            continue;
+
+        Existing existing;
+        existing.time = entry.last_write_time(ecEntry);
+        existing.strKey = entry.path().stem().string();
+        existing.nBytes = entry.file_size(ecEntry);
+        if (!ecEntry)
+            vecExisting.push_back(existing);
+    }
+    std::sort(vecExisting.begin(), vecExisting.end(), [](const Existing& a, const Existing& b) { return a.time < b.time; });
+
+    std::vector<std::string> vecRemove;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDisk);
+        for (const auto& existing : vecExisting)
+        {
+            m_lstDiskLru.push_front(existing.strKey);
+            m_mapDisk[existing.strKey] = DiskEntry{ existing.nBytes, m_lstDiskLru.begin() };
+            m_nDiskBytes += existing.nBytes;
+        }
+        EvictDiskLocked(vecRemove);
+    }
+    for (const auto& strKey : vecRemove)
+        std::filesystem::remove(GetDiskPath(strKey), ec);
+    return true;
+}
+
+CacheLookup ConversionCache::GetOrConvert(const std::string& strKey, const ConvertFunc& convert)
+{
+    CacheLookup lookup;
+    Blob pWebp;
+    if (FindMemory(strKey, pWebp))
+    {
+        ++m_nMemoryHits;
+        lookup.eTier = CACHE_TIER_MEMORY;
+        lookup.bOk = true;
+        lookup.result.nOutputSize = pWebp->size();
+        lookup.pWebp = pWebp;
+        return lookup;
+    }
+
+    // 같은 키가 변환 중이면 합류하고, 아니면 이 요청이 변환을 맡는다.
+    std::promise<CacheLookup> promise;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexFlight);
+        auto it = m_mapFlight.find(strKey);
+        if (it != m_mapFlight.end())
+        {
+            std::shared_future<CacheLookup> future = it->second;
+            lock.unlock();
+
+            ++m_nSharedHits;
+            lookup = future.get();
+            lookup.eTier = CACHE_TIER_SHARED;
+            return lookup;
+        }
+
+        // 메모리 확인과 이 잠금 사이에 다른 요청이 변환을 끝냈을 수 있다. (결과를 메모리에 넣은 뒤에 m_mapFlight 에서 지운다)
+        if (FindMemory(strKey, pWebp))
+        {
+            lock.unlock();
+            ++m_nMemoryHits;
+            lookup.eTier = CACHE_TIER_MEMORY;
+            lookup.bOk = true;
+            lookup.result.nOutputSize = pWebp->size();
+            lookup.pWebp = pWebp;
+            return lookup;
+        }
+        m_mapFlight.emplace(strKey, promise.get_future().share());
+    }
+
+    // 변환 함수가 예외를 던져도 기다리는 요청이 영원히 막히지 않도록, 어느 경로로 끝나든 promise 를 채우고 m_mapFlight 에서 지운다.
+    auto endFlight = [&]()
+    {
+        std::lock_guard<std::mutex> lock(m_mutexFlight);
+        m_mapFlight.erase(strKey);
+    };
+
+    try
+    {
+        if (FindDisk(strKey, pWebp))
+        {
+            ++m_nDiskHits;
+            lookup.eTier = CACHE_TIER_DISK;
+            lookup.bOk = true;
+            lookup.result.nOutputSize = pWebp->size();
+            lookup.pWebp = pWebp;
+            InsertMemory(strKey, pWebp);
+        }
+        else
+        {
+            ++m_nMisses;
+            std::shared_ptr<std::vector<uint8_t>> pOut = std::make_shared<std::vector<uint8_t>>();
+            lookup.eTier = CACHE_TIER_CONVERTED;
+            lookup.bOk = convert(*pOut, lookup.result);
+            if (lookup.bOk)
+            {
+                lookup.pWebp = pOut;
+                InsertMemory(strKey, pOut);
+                InsertDisk(strKey, *pOut);
+            }
+            else
+            {
+                ++m_nFailed;
+            }
+        }
+    }
+    catch (...)
+    {
+        // 합류한 요청도 같은 예외를 받는다.
+        ++m_nFailed;
+        promise.set_exception(std::current_exception());
+        endFlight();
+        throw;
+    }
+
+    promise.set_value(lookup);
+    endFlight();
+    return lookup;
+}
+
+ConversionCacheStats ConversionCache::GetStats() const
+{
+    ConversionCacheStats stats;
+    stats.nMemoryHits = m_nMemoryHits.load();
+    stats.nDiskHits = m_nDiskHits.load();
+    stats.nSharedHits = m_nSharedHits.load();
+    stats.nMisses = m_nMisses.load();
+    stats.nFailed = m_nFailed.load();
+    stats.nMemoryEvictions = m_nMemoryEvictions.load();
+    stats.nDiskEvictions = m_nDiskEvictions.load();
+    stats.nDiskWriteFailed = m_nDiskWriteFailed.load();
+
+    for (const auto& pShard : m_vecShard)
+    {
+        std::lock_guard<std::mutex> lock(pShard->mutex);
+        stats.nMemoryEntries += pShard->mapEntry.size();
+        stats.nMemoryBytes += pShard->nBytes;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDisk);
+        stats.nDiskEntries = m_mapDisk.size();
+        stats.nDiskBytes = m_nDiskBytes;
+    }
+    return stats;
+}
+
+std::string ConversionCache::MakeSettingsKey(const ConvertOption& option)
+{
+    std::ostringstream oss;
+    oss << "q=" << option.fQuality << ";enc=" << option.encoder.ToString() << ";dec=" << option.strDecoder;
+    if (!option.crop.IsFull())
+        oss << ";crop=" << option.crop.nX << "," << option.crop.nY << "," << option.crop.nWidth << "," << option.crop.nHeight;
+    if (option.pAdaptiveQuality)
+        oss << ";aq=" << option.pAdaptiveQuality->ToString();
+    if (option.bLossless)
+        oss << ";lossless=" << option.nLosslessLevel;
+    return oss.str();
+}
+
+std::string ConversionCache::MakeContentKey(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option)
+{
+    return "c" + MakeHexKey(pJpegData, nJpegSize, MakeSettingsKey(option));
+}
+
+std::string ConversionCache::MakePathKey(const std::string& strPath, uint64_t nFileSize, int64_t nModifiedTime, const ConvertOption& option)
+{
+    // 파일이 바뀌면 (크기나 수정 시각) 다른 키가 되어 예전 결과는 LRU 에서 자연히 밀려난다.
+    std::ostringstream oss;
+    oss << strPath << '\n' << nFileSize << '\n' << nModifiedTime;
+    const std::string strSource = oss.str();
+    return "p" + MakeHexKey(strSource.data(), strSource.size(), MakeSettingsKey(option));
+}
+
+ConversionCache::MemoryShard& ConversionCache::GetShard(const std::string& strKey)
+{
+    return *m_vecShard[std::hash<std::string>()(strKey) % m_vecShard.size()];
+}
+
+bool ConversionCache::FindMemory(const std::string& strKey, Blob& pWebp)
+{
+    if (m_nShardBytes == 0)
+        return false;
+
+    MemoryShard& shard = GetShard(strKey);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.mapEntry.find(strKey);
+    if (it == shard.mapEntry.end())
+        return false;
+
+    shard.lstLru.splice(shard.lstLru.begin(), shard.lstLru, it->second);
+    pWebp = it->second->second;
+    return true;
+}
+
+void ConversionCache::InsertMemory(const std::string& strKey, const Blob& pWebp)
+{
+    const uint64_t nBytes = pWebp->size() + strKey.size() + ENTRY_OVERHEAD_BYTES;
+    if (nBytes > m_nShardBytes)
+        return; // 샤드보다 큰 항목은 디스크 계층에만 둔다.
+
+    MemoryShard& shard = GetShard(strKey);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.mapEntry.count(strKey) != 0)
+        return;
+
+    shard.lstLru.emplace_front(strKey, pWebp);
+    shard.mapEntry[strKey] = shard.lstLru.begin();
+    shard.nBytes += nBytes;
+
+    while (shard.nBytes > m_nShardBytes && !shard.lstLru.empty())
+    {
+        const auto& last = shard.lstLru.back();
+        shard.nBytes -= last.second->size() + last.first.size() + ENTRY_OVERHEAD_BYTES;
+        shard.mapEntry.erase(last.first);
+        shard.lstLru.pop_back();
+        ++m_nMemoryEvictions;
+    }
+}
+
+std::string ConversionCache::GetDiskPath(const std::string& strKey) const
+{
+    return (std::filesystem::path(m_option.strDiskDir) / (strKey + DISK_EXTENSION)).string();
+}
+
+bool ConversionCache::FindDisk(const std::string& strKey, Blob& pWebp)
+{
+    if (m_option.strDiskDir.empty())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDisk);
+        auto it = m_mapDisk.find(strKey);
+        if (it == m_mapDisk.end())
+            return false;
+        m_lstDiskLru.splice(m_lstDiskLru.begin(), m_lstDiskLru, it->second.itLru);
+    }
+
+    // 읽는 사이에 축출되어 지워졌거나, 밖에서 지우거나 깨진 파일이면 색인에서 빼고 다시 변환한다.
+    // (같은 키의 디스크 읽기/쓰기는 singleflight 로 한 요청만 하므로 그사이 다시 쓰인 항목을 빼는 일은 없다)
+    std::shared_ptr<std::vector<uint8_t>> pData = std::make_shared<std::vector<uint8_t>>();
+    const std::string strPath = GetDiskPath(strKey);
+    if (!ReadFileToMemory(strPath, *pData) || pData->empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutexDisk);
+            auto it = m_mapDisk.find(strKey);
+            if (it != m_mapDisk.end())
+            {
+                m_nDiskBytes -= it->second.nBytes;
+                m_lstDiskLru.erase(it->second.itLru);
+                m_mapDisk.erase(it);
+            }
+        }
+        std::error_code ec;
+        std::filesystem::remove(strPath, ec);
+        return false;
+    }
+
+    // 다시 열 때 LRU 순서를 복원할 수 있도록 사용 시각을 수정 시각에 남긴다.
+    std::error_code ec;
+    std::filesystem::last_write_time(strPath, std::filesystem::file_time_type::clock::now(), ec);
+    pWebp = pData;
+    return true;
+}
+
+void ConversionCache::InsertDisk(const std::string& strKey, const std::vector<uint8_t>& vecWebp)
+{
+    if (m_option.strDiskDir.empty() || vecWebp.size() > m_option.nDiskBytes)
+        return;
+
+    // 임시 파일에 다 쓴 뒤 이름을 바꿔서, 다른 요청이 덜 쓴 파일을 읽지 않게 한다.
+    const std::string strPath = GetDiskPath(strKey);
+    const std::string strTemp = strPath + ".tmp";
+    std::error_code ec;
+    if (!WriteMemoryToFile(strTemp, vecWebp.data(), vecWebp.size()))
+    {
+        ++m_nDiskWriteFailed;
+        std::filesystem::remove(strTemp, ec);
+        return;
+    }
+    std::filesystem::rename(strTemp, strPath, ec);
+    if (ec)
+    {
+        ++m_nDiskWriteFailed;
+        std::filesystem::remove(strTemp, ec);
+        return;
+    }
+
+    std::vector<std::string> vecRemove;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDisk);
+        auto it = m_mapDisk.find(strKey);
+        if (it != m_mapDisk.end())
+        {
+            m_nDiskBytes -= it->second.nBytes;
+            m_lstDiskLru.erase(it->second.itLru);
+            m_mapDisk.erase(it);
+        }
+        m_lstDiskLru.push_front(strKey);
+        m_mapDisk[strKey] = DiskEntry{ vecWebp.size(), m_lstDiskLru.begin() };
+        m_nDiskBytes += vecWebp.size();
+        EvictDiskLocked(vecRemove);
+    }
+    for (const auto& strRemove : vecRemove)
+        std::filesystem::remove(GetDiskPath(strRemove), ec);
+}
+
+void ConversionCache::EvictDiskLocked(std::vector<std::string>& vecRemove)
+{
+    while (m_nDiskBytes > m_option.nDiskBytes && !m_lstDiskLru.empty())
+    {
+        const std::string& strKey = m_lstDiskLru.back();
+        auto it = m_mapDisk.find(strKey);
+        m_nDiskBytes -= it->second.nBytes;
+        vecRemove.push_back(strKey);
+        m_mapDisk.erase(it);
+        m_lstDiskLru.pop_back();
+        ++m_nDiskEvictions;
+    }
+}
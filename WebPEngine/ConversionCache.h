@@ -0,0 +1,142 @@
+﻿#pragma once
+
+#include "ConvertEngine.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 변환 결과 캐시 (요청 시 변환 + 재사용)
+//   키 = (원본 내용 해시 또는 원본 경로/크기/수정 시각) + 인코더 설정. 적중하면 디코딩/인코딩을 전혀 하지 않는다.
+//   - 메모리: 키 해시로 나눈 샤드마다 LRU (샤드별 잠금이라 적중 경로가 서로 막히지 않음)
+//   - 디스크: <dir>/<key>.webp, 전체 크기 상한을 넘으면 오래 쓰지 않은 파일부터 지운다. 다시 열면 수정 시각 순으로 LRU 를 복원한다.
+//   - 같은 키를 동시에 요청하면 변환은 한 번만 하고 나머지는 그 결과를 기다린다. (singleflight)
+//   실패한 변환은 저장하지 않는다. (기다리던 요청에는 같은 실패 결과를 돌려준다)
+
+enum CACHE_TIER
+{
+    CACHE_TIER_MEMORY = 0,  // 메모리 적중
+    CACHE_TIER_DISK,        // 디스크 적중 (메모리로 올림)
+    CACHE_TIER_SHARED,      // 같은 키의 진행 중 변환을 기다려서 받음
+    CACHE_TIER_CONVERTED    // 없어서 변환함
+};
+
+const char* GetCacheTierString(CACHE_TIER eTier);
+
+struct ConversionCacheOption
+{
+    uint64_t nMemoryBytes = 256ull << 20;   // 0 이면 메모리 계층 없음
+    int nShardCount = 16;
+    std::string strDiskDir;                 // 비어 있으면 디스크 계층 없음
+    uint64_t nDiskBytes = 4ull << 30;
+};
+
+struct ConversionCacheStats
+{
+    uint64_t nMemoryHits = 0;
+    uint64_t nDiskHits = 0;
+    uint64_t nSharedHits = 0;       // 진행 중 변환에 합류한 요청
+    uint64_t nMisses = 0;           // 실제로 변환한 요청
+    uint64_t nFailed = 0;           // 그중 변환 실패
+    uint64_t nMemoryEvictions = 0;
+    uint64_t nDiskEvictions = 0;
+    uint64_t nDiskWriteFailed = 0;
+    uint64_t nMemoryEntries = 0;
+    uint64_t nMemoryBytes = 0;
+    uint64_t nDiskEntries = 0;
+    uint64_t nDiskBytes = 0;
+
+    // 변환 없이 응답한 비율 (메모리 + 디스크 + 합류)
+    double GetHitRatio() const
+    {
+        const uint64_t nHits = nMemoryHits + nDiskHits + nSharedHits;
+        return (nHits + nMisses > 0) ? static_cast<double>(nHits) / static_cast<double>(nHits + nMisses) : 0.0;
+    }
+};
+
+struct CacheLookup
+{
+    CACHE_TIER eTier = CACHE_TIER_CONVERTED;
+    bool bOk = false;
+    ConvertResult result;       // 변환(또는 합류)했으면 그 결과, 캐시 적중이면 eStatus 와 크기만
+    std::shared_ptr<const std::vector<uint8_t>> pWebp;
+};
+
+class ConversionCache
+{
+public:
+    // 캐시에 없을 때 한 번만 불린다. 성공하면 vecWebp 를 채우고 true
+    // 예외를 던지면 그 요청과 합류해 기다리던 요청 모두에 같은 예외가 전달되고, 다음 요청은 다시 변환한다.
+    using ConvertFunc = std::function<bool(std::vector<uint8_t>& vecWebp, ConvertResult& result)>;
+
+    explicit ConversionCache(const ConversionCacheOption& option);
+
+    // 디스크 계층 폴더를 만들고 이미 있는 항목을 색인한다. 폴더를 만들 수 없으면 false
+    bool Open();
+
+    // 메모리 -> 진행 중 변환 -> 디스크 -> convert 순으로 찾는다. (스레드 안전)
+    CacheLookup GetOrConvert(const std::string& strKey, const ConvertFunc& convert);
+
+    ConversionCacheStats GetStats() const;
+    const ConversionCacheOption& GetOption() const { return m_option; }
+
+    // 결과에 영향을 주는 설정 (품질, 인코더 세부 설정, 디코더, 잘라내기, 적응형 품질 곡선)
+    static std::string MakeSettingsKey(const ConvertOption& option);
+
+    // 파일 이름으로 쓸 수 있는 16 진수 키
+    static std::string MakeContentKey(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option);
+    static std::string MakePathKey(const std::string& strPath, uint64_t nFileSize, int64_t nModifiedTime, const ConvertOption& option);
+
+private:
+    using Blob = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct MemoryShard
+    {
+        std::mutex mutex;
+        std::list<std::pair<std::string, Blob>> lstLru;     // 앞쪽이 최근
+        std::unordered_map<std::string, std::list<std::pair<std::string, Blob>>::iterator> mapEntry;
+        uint64_t nBytes = 0;
+    };
+
+    struct DiskEntry
+    {
+        uint64_t nBytes = 0;
+        std::list<std::string>::iterator itLru;
+    };
+
+    MemoryShard& GetShard(const std::string& strKey);
+    bool FindMemory(const std::string& strKey, Blob& pWebp);
+    void InsertMemory(const std::string& strKey, const Blob& pWebp);
+
+    std::string GetDiskPath(const std::string& strKey) const;
+    bool FindDisk(const std::string& strKey, Blob& pWebp);
+    void InsertDisk(const std::string& strKey, const std::vector<uint8_t>& vecWebp);
+    void EvictDiskLocked(std::vector<std::string>& vecRemove);
+
+    ConversionCacheOption m_option;
+    uint64_t m_nShardBytes = 0;
+    std::vector<std::unique_ptr<MemoryShard>> m_vecShard;
+
+    mutable std::mutex m_mutexDisk;
+    std::list<std::string> m_lstDiskLru;                    // 앞쪽이 최근
+    std::unordered_map<std::string, DiskEntry> m_mapDisk;
+    uint64_t m_nDiskBytes = 0;
+
+    std::mutex m_mutexFlight;
+    std::unordered_map<std::string, std::shared_future<CacheLookup>> m_mapFlight;
+
+    std::atomic<uint64_t> m_nMemoryHits{ 0 };
+    std::atomic<uint64_t> m_nDiskHits{ 0 };
+    std::atomic<uint64_t> m_nSharedHits{ 0 };
+    std::atomic<uint64_t> m_nMisses{ 0 };
+    std::atomic<uint64_t> m_nFailed{ 0 };
+    std::atomic<uint64_t> m_nMemoryEvictions{ 0 };
+    std::atomic<uint64_t> m_nDiskEvictions{ 0 };
+    std::atomic<uint64_t> m_nDiskWriteFailed{ 0 };
+};
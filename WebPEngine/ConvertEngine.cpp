@@ -0,0 +1,586 @@
+﻿#include "ConvertEngine.h"
+#include "AdaptiveQuality.h"
+#include "DecoderBackend.h"
+#include "FileUtil.h"
+#include "MemoryBudget.h"
+#include "PlanePipeline.h"
+#include "TraceRecorder.h"
+#include <cstdlib>
+#include <cstring>
+#include <webp/decode.h>  // libwebp 디코더 (품질 검증)
+#include <webp/encode.h>  // libwebp 인코더
+
+namespace
+{
+    // 평면 버퍼도 스레드마다 재사용 (이미지마다 malloc/free 하지 않음)
+    struct ThreadPlaneBuffer
+    {
+        std::vector<uint8_t> vecY;
+        std::vector<uint8_t> vecUV;
+        std::vector<uint32_t> vecArgb;      // 무손실 인코더 입력
+        std::vector<uint8_t> vecVerifyY;    // 검증용으로 다시 디코딩한 평면
+        std::vector<uint8_t> vecVerifyUV;   // (무손실이면 다시 디코딩한 RGBA)
+    };
+
+    ThreadPlaneBuffer& GetThreadPlaneBuffer()
+    {
+        thread_local ThreadPlaneBuffer buffer;
+        return buffer;
+    }
+
+    // 지금 작업이 쓰는 평면 크기 (이전 작업에서 남은 여유 용량은 제외)
+    size_t GetPlaneBufferBytes(const ThreadPlaneBuffer& planes, bool bVerified)
+    {
+        size_t nBytes = planes.vecY.size() + planes.vecUV.size() + planes.vecArgb.size() * sizeof(uint32_t);
+        if (bVerified)
+            nBytes += planes.vecVerifyY.size() + planes.vecVerifyUV.size();
+        return nBytes;
+    }
+
+    // 메모리 예산을 쓰는 경우 큰 이미지의 평면을 스레드에 계속 붙잡아 두지 않는다.
+    void TrimPlaneBuffer(ThreadPlaneBuffer& planes, uint64_t nRetainLimit)
+    {
+        const size_t nCapacity = planes.vecY.capacity() + planes.vecUV.capacity() + planes.vecArgb.capacity() * sizeof(uint32_t)
+                               + planes.vecVerifyY.capacity() + planes.vecVerifyUV.capacity();
+        if (nCapacity > nRetainLimit)
+            planes = ThreadPlaneBuffer();
+    }
+
+    // WebP 인코딩 결과를 std::vector 에 바로 이어 붙이는 writer (WebPMemoryWriter 복사 생략)
+    int VectorWriter(const uint8_t* data, size_t data_size, const WebPPicture* picture)
+    {
+        auto* pOut = static_cast<std::vector<uint8_t>*>(picture->custom_ptr);
+        pOut->insert(pOut->end(), data, data + data_size);
+        return 1;
+    }
+
+    bool IsCancelled(const ConvertOption& option)
+    {
+        return option.pCancelFlag && option.pCancelFlag->load(std::memory_order_relaxed);
+    }
+
+    // WebPEncode 진행 중 취소: 0 을 반환하면 인코더가 VP8_ENC_ERROR_USER_ABORT 로 멈춘다.
+    int CancelProgressHook(int /*percent*/, const WebPPicture* picture)
+    {
+        const auto* pCancelFlag = static_cast<const std::atomic<bool>*>(picture->user_data);
+        return pCancelFlag->load(std::memory_order_relaxed) ? 0 : 1;
+    }
+
+    struct EncoderParamField
+    {
+        const char* pszKey;
+        int EncoderParams::* pField;
+        int nMin;
+        int nMax;
+    };
+
+    // 키 이름은 libwebp WebPConfig 필드 이름을 따른다.
+    const EncoderParamField g_encoderParamFields[] =
+    {
+        { "method",          &EncoderParams::nMethod,         0, 6 },
+        { "filter_strength", &EncoderParams::nFilterStrength, 0, 100 },
+        { "sns_strength",    &EncoderParams::nSnsStrength,    0, 100 },
+        { "segments",        &EncoderParams::nSegments,       1, 4 },
+        { "pass",            &EncoderParams::nPass,           1, 10 },
+        { "thread_level",    &EncoderParams::nThreadLevel,    0, 1 },
+    };
+}
+
+bool EncoderParams::Set(const std::string& strKey, int nValue)
+{
+    for (const auto& field : g_encoderParamFields)
+    {
+        if (strKey == field.pszKey)
+        {
+            if (nValue < field.nMin || nValue > field.nMax)
+                return false;
+            this->*field.pField = nValue;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EncoderParams::Parse(const std::string& strText)
+{
+    EncoderParams params;
+    size_t nPos = 0;
+    while (nPos < strText.size())
+    {
+        size_t nEnd = strText.find_first_of(";,", nPos);
+        if (nEnd == std::string::npos)
+            nEnd = strText.size();
+
+        const std::string strItem = strText.substr(nPos, nEnd - nPos);
+        nPos = nEnd + 1;
+        if (strItem.empty())
+            continue;
+
+        const size_t nEq = strItem.find('=');
+        if (nEq == std::string::npos)
+            return false;
+
+        char* pszEnd = nullptr;
+        const std::string strValue = strItem.substr(nEq + 1);
+        const long nValue = std::strtol(strValue.c_str(), &pszEnd, 10);
+        if (strValue.empty() || *pszEnd != '\0' || !params.Set(strItem.substr(0, nEq), static_cast<int>(nValue)))
+            return false;
+    }
+
+    *this = params;
+    return true;
+}
+
+std::string EncoderParams::ToString() const
+{
+    std::string strText;
+    for (const auto& field : g_encoderParamFields)
+    {
+        const int nValue = this->*field.pField;
+        if (nValue < 0)
+            continue;
+        if (!strText.empty())
+            strText += ';';
+        strText += field.pszKey;
+        strText += '=';
+        strText += std::to_string(nValue);
+    }
+    return strText;
+}
+
+bool ParseLosslessLevel(const std::string& strText, int& nLevel)
+{
+    if (strText == "fast")
+        nLevel = LOSSLESS_LEVEL_FAST;
+    else if (strText == "default")
+        nLevel = LOSSLESS_LEVEL_DEFAULT;
+    else if (strText == "max")
+        nLevel = LOSSLESS_LEVEL_MAX;
+    else if (strText.size() == 1 && strText[0] >= '0' && strText[0] <= '9')
+        nLevel = strText[0] - '0';
+    else
+        return false;
+    return true;
+}
+
+void EncoderParams::ApplyTo(WebPConfig& config) const
+{
+    if (nMethod >= 0)
+        config.method = nMethod;
+    if (nFilterStrength >= 0)
+        config.filter_strength = nFilterStrength;
+    if (nSnsStrength >= 0)
+        config.sns_strength = nSnsStrength;
+    if (nSegments >= 0)
+        config.segments = nSegments;
+    if (nPass >= 0)
+        config.pass = nPass;
+    if (nThreadLevel >= 0)
+        config.thread_level = nThreadLevel;
+}
+
+const char* GetConvertStatusString(CONVERT_STATUS eStatus)
+{
+    switch (eStatus)
+    {
+    case CONVERT_OK:            return "ok";
+    case CONVERT_ERR_READ:      return "read failed";
+    case CONVERT_ERR_HEADER:    return "invalid jpeg header";
+    case CONVERT_ERR_NOT_GRAY:  return "not a grayscale jpeg";
+    case CONVERT_ERR_ALLOC:     return "allocation failed";
+    case CONVERT_ERR_DECODE:    return "jpeg decode failed";
+    case CONVERT_ERR_ENCODE:    return "webp encode failed";
+    case CONVERT_ERR_WRITE:     return "write failed";
+    case CONVERT_ERR_CANCELLED: return "cancelled";
+    case CONVERT_ERR_DECODER:   return "decoder backend unavailable";
+    case CONVERT_ERR_CROP:      return "crop region outside image";
+    default:                    return "unknown";
+    }
+}
+
+ConvertEngine::ConvertEngine(const ConvertOption& option /*= ConvertOption()*/)
+    : m_option(option)
+{
+}
+
+bool ConvertEngine::ConvertMemory(const uint8_t* pJpegData, size_t nJpegSize, std::vector<uint8_t>& vecWebpOut, ConvertResult& result) const
+{
+    return ConvertMemory(pJpegData, nJpegSize, m_option, vecWebpOut, result);
+}
+
+bool ConvertEngine::ConvertMemory(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option, std::vector<uint8_t>& vecWebpOut, ConvertResult& result) const
+{
+    vecWebpOut.clear();
+
+    // 1~3) 디코딩 + limited-range 매핑. 평면 버퍼는 스레드마다 재사용
+    ThreadPlaneBuffer& planes = GetThreadPlaneBuffer();
+    MemoryReservation reservation;
+    if (!DecodeGray(pJpegData, nJpegSize, option, planes.vecY, result, &reservation))
+        return false;
+
+    const int nWidth = result.nWidth;
+    const int nHeight = result.nHeight;
+    const uint8_t* pszYPlane = planes.vecY.data();
+
+    // 4~6) 인코딩. 결과는 vecWebpOut 으로 바로 받는다.
+    vecWebpOut.reserve(nJpegSize / 2);
+    const auto encodeStartTime = std::chrono::high_resolution_clock::now();
+    const bool bEncoded = EncodeGray(pszYPlane, nWidth, nWidth, nHeight, result.fQuality, option, vecWebpOut, result.eStatus);
+    result.durationEncode = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - encodeStartTime);
+
+    if (reservation.IsHeld())
+        reservation.SetActual(GetPlaneBufferBytes(planes, false) + vecWebpOut.capacity());
+
+    if (!bEncoded)
+        return false;
+
+    result.nOutputSize = vecWebpOut.size();
+
+    // 7) 표본 검증: WebP 를 다시 디코딩해서 인코더에 넣은 Y 평면 (손실이면 limited-range, 무손실이면 원래 값) 과 비교
+    if (option.verify.IsEnabled() && m_nEncodedCount.fetch_add(1, std::memory_order_relaxed) % static_cast<uint64_t>(option.verify.nEvery) == 0)
+    {
+        TraceScope verifySpan(option.pTrace, "verify");
+        const auto verifyStartTime = std::chrono::high_resolution_clock::now();
+        if (MeasureWebp(vecWebpOut.data(), vecWebpOut.size(), pszYPlane, nWidth, nHeight, option.verify, result.score, option.bLossless))
+        {
+            result.bVerifyFailed = (option.verify.fMinPsnr > 0.0 && result.score.fPsnr < option.verify.fMinPsnr)
+                                || (option.verify.fMinSsim > 0.0 && result.score.fSsim < option.verify.fMinSsim);
+        }
+        else
+        {
+            result.bVerifyFailed = true; // 자기가 만든 WebP 를 디코딩하지 못함
+        }
+        result.bVerified = true;
+        result.durationVerify = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - verifyStartTime);
+
+        if (reservation.IsHeld())
+            reservation.SetActual(GetPlaneBufferBytes(planes, true) + vecWebpOut.capacity());
+    }
+
+    if (reservation.IsHeld())
+        TrimPlaneBuffer(planes, reservation.GetBudget()->GetRetainLimit());
+    return true;
+}
+
+bool ConvertEngine::DecodeGray(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option, std::vector<uint8_t>& vecY, ConvertResult& result, MemoryReservation* pReservation /*= nullptr*/) const
+{
+    result = ConvertResult();
+    result.nInputSize = nJpegSize;
+
+    // 디코더 백엔드는 스레드마다 하나씩 만들어 재사용한다.
+    IDecoderBackend* pDecoder = GetThreadDecoder(option.strDecoder);
+    if (!pDecoder)
+    {
+        result.eStatus = CONVERT_ERR_DECODER;
+        return false;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // 1) 헤더 파싱
+    TraceScope headerSpan(option.pTrace, "header");
+    JpegHeader header;
+    if (!pDecoder->Probe(pJpegData, nJpegSize, header))
+    {
+        result.eStatus = CONVERT_ERR_HEADER;
+        return false;
+    }
+    headerSpan.End();
+
+    result.nWidth = header.nWidth;
+    result.nHeight = header.nHeight;
+    result.nSubSampling = header.nSubSampling;
+
+    if (header.nWidth <= 0 || header.nHeight <= 0)
+    {
+        result.eStatus = CONVERT_ERR_HEADER;
+        return false;
+    }
+
+    // 헤더로 이 이미지의 평면 루프를 한 번 고른다. (현재 코드 경로는 Gray 전용)
+    const PlanePipeline* pPipeline = SelectPlanePipeline(header.nSubSampling, option.bLossless);
+    if (!pPipeline)
+    {
+        result.eStatus = CONVERT_ERR_NOT_GRAY;
+        return false;
+    }
+
+    // 잘라낼 영역 확인. 이후 평면/인코딩 크기는 영역 크기 (평면도 영역 크기만큼만 할당)
+    const bool bCrop = !option.crop.IsFull();
+    if (bCrop)
+    {
+        const JpegRegion& crop = option.crop;
+        if (crop.nX < 0 || crop.nY < 0 || crop.nWidth > header.nWidth - crop.nX || crop.nHeight > header.nHeight - crop.nY)
+        {
+            result.eStatus = CONVERT_ERR_CROP;
+            return false;
+        }
+    }
+
+    const int nWidth = bCrop ? option.crop.nWidth : header.nWidth;
+    const int nHeight = bCrop ? option.crop.nHeight : header.nHeight;
+    result.nWidth = nWidth;
+    result.nHeight = nHeight;
+
+    // 평면을 잡기 전에 이 이미지의 최대 사용량을 예약한다. (기다린 시간은 디코딩 시간에서 뺀다)
+    if (option.pMemoryBudget && pReservation)
+    {
+        TraceScope memoryWaitSpan(option.pTrace, "mem_wait");
+        const auto waitStartTime = std::chrono::high_resolution_clock::now();
+        const uint64_t nEstimate = MemoryBudget::EstimateConvertBytes(nWidth, nHeight, nJpegSize, option.verify.IsEnabled(), option.bLossless);
+        if (!pReservation->Acquire(option.pMemoryBudget, nEstimate, option.pCancelFlag))
+        {
+            result.eStatus = CONVERT_ERR_CANCELLED;
+            return false;
+        }
+        startTime += std::chrono::high_resolution_clock::now() - waitStartTime;
+    }
+
+    // 이미지별 품질 선택. 분석은 허프만 디코딩만 하므로 IDCT 까지 하는 본 디코딩보다 싸다. (무손실은 품질이 없으므로 분석하지 않음)
+    result.fQuality = option.fQuality;
+    if (option.pAdaptiveQuality && !option.bLossless)
+    {
+        TraceScope analyzeSpan(option.pTrace, "analyze");
+        JpegComplexity complexity;
+        if (AnalyzeJpegComplexity(pJpegData, nJpegSize, bCrop ? &option.crop : nullptr, complexity))
+        {
+            result.fQuality = option.pAdaptiveQuality->ChooseQuality(complexity);
+            result.fComplexity = complexity.fComplexity;
+        }
+
+        const auto analyzeEndTime = std::chrono::high_resolution_clock::now();
+        result.durationAnalyze = std::chrono::duration_cast<std::chrono::microseconds>(analyzeEndTime - startTime);
+        startTime = analyzeEndTime;
+    }
+
+    if (IsCancelled(option))
+    {
+        result.eStatus = CONVERT_ERR_CANCELLED;
+        return false;
+    }
+
+    // 2) Y 평면 디코딩 (crop 이면 필요한 MCU 만)
+    const size_t nYSize = static_cast<size_t>(nWidth) * static_cast<size_t>(nHeight);
+    try
+    {
+        vecY.resize(nYSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        result.eStatus = CONVERT_ERR_ALLOC;
+        return false;
+    }
+
+    if (pReservation && pReservation->IsHeld())
+        pReservation->SetActual(vecY.size());
+
+    TraceScope decodeSpan(option.pTrace, "decode");
+    uint8_t* pszYPlane = vecY.data();
+    DecodePlanes decodePlanes;
+    decodePlanes.pY = pszYPlane;
+    decodePlanes.nYStride = nWidth;
+    const bool bDecoded = bCrop ? pDecoder->DecodeRegion(pJpegData, nJpegSize, header, option.crop, decodePlanes)
+                                : pDecoder->DecodeInto(pJpegData, nJpegSize, header, decodePlanes);
+    decodeSpan.End();
+    if (!bDecoded)
+    {
+        result.eStatus = CONVERT_ERR_DECODE;
+        return false;
+    }
+
+    result.durationDecode = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - startTime);
+
+    if (IsCancelled(option))
+    {
+        result.eStatus = CONVERT_ERR_CANCELLED;
+        return false;
+    }
+
+    // 3) Full-range -> Limited-range 매핑 (무손실 파이프라인은 아무것도 하지 않음)
+    TraceScope rangeMapSpan(option.pTrace, "range_map");
+    pPipeline->pfnMapRange(pszYPlane, nYSize);
+
+    return true;
+}
+
+bool ConvertEngine::EncodeGray(const uint8_t* pY, int nYStride, int nWidth, int nHeight, float fQuality, const ConvertOption& option, std::vector<uint8_t>& vecWebpOut, CONVERT_STATUS& eStatus) const
+{
+    TraceScope encodeSpan(option.pTrace, "encode");
+
+    // 4) 인코더 입력 준비
+    //    손실: U/V 평면 (4:2:0, 중성값 128). 그레이 입력이므로 U/V 는 같은 버퍼를 공유해도 된다.
+    //    무손실: 그레이를 R=G=B 로 펼친 ARGB (무손실 인코더는 ARGB 만 받는다)
+    ThreadPlaneBuffer& planes = GetThreadPlaneBuffer();
+    const PlanePipeline& pipeline = *SelectPlanePipeline(JPEG_SUBSAMP_GRAY, option.bLossless);
+    const int nUVWidth = pipeline.bArgbInput ? 0 : pipeline.pfnGetChromaWidth(nWidth);
+    const size_t nUVSize = pipeline.bArgbInput ? 0 : static_cast<size_t>(nUVWidth) * static_cast<size_t>(pipeline.pfnGetChromaHeight(nHeight));
+    try
+    {
+        if (pipeline.bArgbInput)
+            planes.vecArgb.resize(static_cast<size_t>(nWidth) * static_cast<size_t>(nHeight));
+        else
+            planes.vecUV.resize(nUVSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        eStatus = CONVERT_ERR_ALLOC;
+        return false;
+    }
+
+    if (pipeline.bArgbInput)
+        pipeline.pfnExpandArgb(pY, nYStride, nWidth, nHeight, planes.vecArgb.data());
+    else
+        pipeline.pfnPrepareChroma(planes.vecUV.data(), nUVSize);
+
+    // 5) WebPPicture 설정 (손실: planar YUV 직접 제공, 무손실: ARGB)
+    WebPPicture picture;
+    WebPConfig config;
+    if (!WebPPictureInit(&picture) || !WebPConfigInit(&config))
+    {
+        eStatus = CONVERT_ERR_ENCODE;
+        return false;
+    }
+
+    picture.width = nWidth;
+    picture.height = nHeight;
+    if (pipeline.bArgbInput)
+    {
+        picture.use_argb = 1;
+        picture.argb = planes.vecArgb.data();
+        picture.argb_stride = nWidth;
+    }
+    else
+    {
+        picture.use_argb = 0; // 0 = YUV 입력, 1 = ARGB 입력
+        picture.y = const_cast<uint8_t*>(pY);   // 외부 평면은 읽기만 한다.
+        picture.y_stride = nYStride;
+        picture.u = planes.vecUV.data();
+        picture.v = planes.vecUV.data();
+        picture.uv_stride = nUVWidth;
+    }
+
+    picture.writer = VectorWriter;
+    picture.custom_ptr = &vecWebpOut;
+
+    if (option.pCancelFlag)
+    {
+        picture.progress_hook = CancelProgressHook;
+        picture.user_data = const_cast<std::atomic<bool>*>(option.pCancelFlag);
+    }
+
+    if (pipeline.bArgbInput)
+    {
+        // 알파가 모두 255 라 exact (투명 픽셀의 RGB 보존) 는 켤 필요가 없다.
+        if (!WebPConfigLosslessPreset(&config, option.nLosslessLevel))
+        {
+            WebPPictureFree(&picture);
+            eStatus = CONVERT_ERR_ENCODE;
+            return false;
+        }
+    }
+    else
+    {
+        config.lossless = 0;
+        config.quality = fQuality;
+    }
+    option.encoder.ApplyTo(config);
+
+    if (!WebPValidateConfig(&config))
+    {
+        WebPPictureFree(&picture);
+        eStatus = CONVERT_ERR_ENCODE;
+        return false;
+    }
+
+    // 6) 인코딩 실행
+    const bool bEncoded = WebPEncode(&config, &picture) != 0;
+    WebPPictureFree(&picture);
+
+    if (!bEncoded)
+    {
+        vecWebpOut.clear();
+        eStatus = IsCancelled(option) ? CONVERT_ERR_CANCELLED : CONVERT_ERR_ENCODE;
+        return false;
+    }
+
+    eStatus = CONVERT_OK;
+    return true;
+}
+
+bool ConvertEngine::MeasureWebp(const uint8_t* pWebpData, size_t nWebpSize, const uint8_t* pRefY, int nWidth, int nHeight, const VerifyOption& option, QualityScore& score, bool bLossless /*= false*/)
+{
+    ThreadPlaneBuffer& planes = GetThreadPlaneBuffer();
+    const size_t nYSize = static_cast<size_t>(nWidth) * static_cast<size_t>(nHeight);
+    planes.vecVerifyY.resize(nYSize);
+
+    if (bLossless)
+    {
+        // R=G=B 로 인코딩했으므로 G 채널이 원래 그레이 값
+        planes.vecVerifyUV.resize(nYSize * 4);
+        if (!WebPDecodeRGBAInto(pWebpData, nWebpSize, planes.vecVerifyUV.data(), planes.vecVerifyUV.size(), nWidth * 4))
+            return false;
+        for (size_t p = 0; p < nYSize; ++p)
+            planes.vecVerifyY[p] = planes.vecVerifyUV[p * 4 + 1];
+    }
+    else
+    {
+        const int nUVWidth = (nWidth + 1) / 2;
+        const size_t nUVSize = static_cast<size_t>(nUVWidth) * static_cast<size_t>((nHeight + 1) / 2);
+        planes.vecVerifyUV.resize(nUVSize * 2);
+        uint8_t* pVerifyU = planes.vecVerifyUV.data();
+        uint8_t* pVerifyV = pVerifyU + nUVSize;
+        if (!WebPDecodeYUVInto(pWebpData, nWebpSize, planes.vecVerifyY.data(), nYSize, nWidth, pVerifyU, nUVSize, nUVWidth, pVerifyV, nUVSize, nUVWidth))
+            return false;
+    }
+
+    score = MeasureQuality(pRefY, nWidth, planes.vecVerifyY.data(), nWidth, nWidth, nHeight, option);
+    return true;
+}
+
+bool ConvertEngine::ConvertFile(const std::string& strInPath, const std::string& strOutPath, ConvertResult& result) const
+{
+    return ConvertFile(strInPath, strOutPath, m_option, result);
+}
+
+bool ConvertEngine::ConvertFile(const std::string& strInPath, const std::string& strOutPath, const ConvertOption& option, ConvertResult& result) const
+{
+    TraceScope readSpan(option.pTrace, "read");
+    std::vector<uint8_t> vecJpegData;
+    if (!ReadFileToMemory(strInPath, vecJpegData))
+    {
+        result = ConvertResult();
+        result.eStatus = CONVERT_ERR_READ;
+        return false;
+    }
+    readSpan.End();
+
+    std::vector<uint8_t> vecWebpData;
+    if (!ConvertMemory(vecJpegData.data(), vecJpegData.size(), option, vecWebpData, result))
+        return false;
+
+    if (IsCancelled(option))
+    {
+        result.eStatus = CONVERT_ERR_CANCELLED;
+        return false;
+    }
+
+    TraceScope writeSpan(option.pTrace, "write");
+    if (!WriteMemoryToFile(strOutPath, vecWebpData.data(), vecWebpData.size()))
+    {
+        result.eStatus = CONVERT_ERR_WRITE;
+        return false;
+    }
+
+    return true;
+}
+
+std::string ConvertEngine::MakeOutputPath(const std::string& strInPath)
+{
+    const size_t nSlash = strInPath.find_last_of("/\\");
+    const size_t nDot = strInPath.rfind('.');
+
+    if (nDot == std::string::npos || (nSlash != std::string::npos && nDot < nSlash))
+        return strInPath + ".webp";
+
+    return strInPath.substr(0, nDot) + ".webp";
+}
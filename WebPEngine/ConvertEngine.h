@@ -0,0 +1,166 @@
+﻿#pragma once
+
+#include "DecoderBackend.h"
+#include "QualityMetrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class AdaptiveQuality;
+class MemoryBudget;
+class MemoryReservation;
+class TraceRecorder;
+struct WebPConfig;
+
+// MFC 에 의존하지 않는 JPEG -> WebP 변환 엔진
+// 대화상자(ConvertManager)와 콘솔 도구(WebPCli)가 같은 변환 경로를 공유한다.
+
+enum CONVERT_STATUS
+{
+    CONVERT_OK = 0,
+    CONVERT_ERR_READ,       // 입력 파일 읽기 실패
+    CONVERT_ERR_HEADER,     // JPEG 헤더 파싱 실패 / 잘못된 크기
+    CONVERT_ERR_NOT_GRAY,   // 그레이스케일 JPEG 가 아님
+    CONVERT_ERR_ALLOC,      // 평면 버퍼 할당 실패
+    CONVERT_ERR_DECODE,     // JPEG 디코딩 실패
+    CONVERT_ERR_ENCODE,     // WebP 설정/인코딩 실패
+    CONVERT_ERR_WRITE,      // 결과 파일 저장 실패
+    CONVERT_ERR_CANCELLED,  // 단계 사이에서 취소 요청을 확인하고 중단
+    CONVERT_ERR_DECODER,    // 요청한 디코더 백엔드가 없거나 초기화 실패
+    CONVERT_ERR_CROP        // 잘라낼 영역이 이미지 밖으로 나감
+};
+
+const char* GetConvertStatusString(CONVERT_STATUS eStatus);
+
+// libwebp WebPConfig 세부 설정. -1 인 항목은 libwebp 기본값을 그대로 둔다.
+struct EncoderParams
+{
+    int nMethod = -1;           // 0 (빠름) .. 6 (느림, 작음)
+    int nFilterStrength = -1;   // 0..100
+    int nSnsStrength = -1;      // 0..100
+    int nSegments = -1;         // 1..4
+    int nPass = -1;             // 1..10
+    int nThreadLevel = -1;      // 0/1 (1 이면 인코더 내부에서 스레드를 더 쓴다)
+
+    // 키는 WebPConfig 필드 이름 (method, filter_strength, sns_strength, segments, pass, thread_level). 범위 밖이면 false
+    bool Set(const std::string& strKey, int nValue);
+
+    // "method=4;sns_strength=50" <-> 설정. 모르는 키나 범위 밖 값이면 false 이고 그대로 둔다.
+    bool Parse(const std::string& strText);
+    std::string ToString() const;
+
+    // 설정된 (-1 이 아닌) 항목만 config 에 덮어쓴다.
+    void ApplyTo(WebPConfig& config) const;
+};
+
+// 무손실 압축 수준 (WebPConfigLosslessPreset 0 = 빠름 .. 9 = 작음) 의 이름 붙은 프리셋
+//   bench-lossless --threads 1 측정값 (libwebp 1.2.4, x86-64 코어 1 개)
+//     A: 그레이 항공 사진 (Crater.jpg 를 1536x1536 이하로 잘라 JPEG q90, 10 장, 23.9 MP)  --repeat 1
+//     B: 글자가 많은 기판 사진 (720x477, 그레이로 바꿔 JPEG q90, 2 장)                    --repeat 3
+//     수준  method  quality |  A 시간(s)  A 바이트   A 크기비 |  B 시간(s)  B 바이트   B 크기비
+//       0      0       0    |    3.07     12067286   1.445   |   0.075      544714    1.490
+//       1      1      20    |    8.73      8455414   1.012   |   0.222      383952    1.050
+//       2      2      25    |    8.66      8445166   1.011   |   0.206      383344    1.049
+//       3      3      30    |   11.59      8434006   1.010   |   0.317      380938    1.042
+//       4      3      50    |   10.81      8433896   1.010   |   0.342      380868    1.042
+//       5      4      50    |   11.93      8421018   1.008   |   0.365      377194    1.032
+//       6      4      75    |   15.89      8421022   1.008   |   0.506      377194    1.032
+//       7      4      90    |   22.41      8399394   1.005   |   0.653      376686    1.030
+//       8      5      90    |   22.47      8359648   1.001   |   0.666      367056    1.004
+//       9      6     100    |  253.18      8353910   1.000   |  18.234      365604    1.000
+//   fast: 수준 0 은 크기가 45% 늘고, 2 는 1 보다 느리지 않으면서 조금 작다.
+//   default: 5 와 6 (cwebp -z 기본값) 은 출력이 같고 6 이 30% 이상 느리다.
+//   max: 9 는 8 보다 11 ~ 27 배 느리고 0.4% 이하로만 작아서 8 을 쓴다. 9 는 "9" 로 직접 고를 수 있다.
+const int LOSSLESS_LEVEL_FAST = 2;
+const int LOSSLESS_LEVEL_DEFAULT = 5;
+const int LOSSLESS_LEVEL_MAX = 8;
+
+// "fast" | "default" | "max" | "0".."9" -> 수준. 모르는 값이면 false
+bool ParseLosslessLevel(const std::string& strText, int& nLevel);
+
+struct ConvertOption
+{
+    float fQuality = 80.0f;
+    EncoderParams encoder;
+
+    // 설정되면 손실 경로(limited-range Y + 4:2:0 크로마) 대신 디코딩한 그레이 값을 그대로 무손실 인코딩한다. (보관용)
+    //   fQuality 와 적응형 품질은 쓰지 않고 nLosslessLevel 로 속도/크기를 고른다. encoder 의 설정은 프리셋 위에 덮어쓴다.
+    bool bLossless = false;
+    int nLosslessLevel = LOSSLESS_LEVEL_DEFAULT;
+    std::string strDecoder = "turbojpeg";   // DecoderRegistry 에 등록된 백엔드 이름
+    JpegRegion crop;                        // 비어 있지 않으면 이 영역만 디코딩해서 인코딩한다.
+
+    // 설정되면 이미지마다 DCT 계수 복잡도로 품질을 고른다. (fQuality 는 분석 실패 시의 기본값)
+    std::shared_ptr<const AdaptiveQuality> pAdaptiveQuality;
+
+    // 설정되면 표본 이미지의 WebP 를 다시 디코딩해서 인코더 입력 Y 평면과 PSNR/SSIM 을 비교한다.
+    VerifyOption verify;
+
+    // 설정되면 읽기/헤더/디코딩/인코딩/쓰기 단계 사이와 인코딩 진행 중에 확인해서 CONVERT_ERR_CANCELLED 로 중단한다.
+    const std::atomic<bool>* pCancelFlag = nullptr;
+
+    // 설정되면 단계별(header/analyze/decode/range_map/encode/verify, 파일 변환이면 read/write) 구간을 기록한다.
+    TraceRecorder* pTrace = nullptr;
+
+    // 설정되면 헤더로 추정한 최대 사용량을 디코딩 전에 예약하고, 예산이 모자라면 반납될 때까지 기다린다.
+    MemoryBudget* pMemoryBudget = nullptr;
+};
+
+struct ConvertResult
+{
+    CONVERT_STATUS eStatus = CONVERT_OK;
+    int nWidth = 0;            // 인코딩한 크기 (crop 이면 잘라낸 크기)
+    int nHeight = 0;
+    int nSubSampling = -1;     // JPEG_SUBSAMP_* (= TJSAMP_*)
+    float fQuality = 0.0f;     // 실제로 인코딩에 쓴 품질
+    double fComplexity = -1.0; // 적응형 품질 분석 결과 (분석하지 않았으면 -1)
+    size_t nInputSize = 0;
+    size_t nOutputSize = 0;
+    std::chrono::microseconds durationAnalyze{ 0 };  // 적응형 품질 분석 (디코딩 시간과 별도)
+    std::chrono::microseconds durationDecode{ 0 };
+    std::chrono::microseconds durationEncode{ 0 };
+
+    bool bVerified = false;     // 표본으로 뽑혀서 검증했는지
+    bool bVerifyFailed = false; // 검증했고 PSNR/SSIM 이 기준 미달 (변환 자체는 성공으로 둔다)
+    QualityScore score;
+    std::chrono::microseconds durationVerify{ 0 };
+};
+
+class ConvertEngine
+{
+public:
+    explicit ConvertEngine(const ConvertOption& option = ConvertOption());
+
+    const ConvertOption& GetOption() const { return m_option; }
+    void SetOption(const ConvertOption& option) { m_option = option; }
+
+    // 메모리의 JPEG 을 WebP 로 변환. 결과는 vecWebpOut 에 담긴다. (스레드 안전)
+    bool ConvertMemory(const uint8_t* pJpegData, size_t nJpegSize, std::vector<uint8_t>& vecWebpOut, ConvertResult& result) const;
+    bool ConvertMemory(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option, std::vector<uint8_t>& vecWebpOut, ConvertResult& result) const;
+
+    // ConvertMemory 의 단계를 따로 쓰는 경우 (인코더 설정 비교처럼 디코딩한 평면을 여러 번 인코딩할 때)
+    //   DecodeGray: JPEG -> limited-range Y 평면 (result 의 크기/품질/디코딩 시간을 채운다)
+    //               pReservation 을 주고 option.pMemoryBudget 이 설정되어 있으면 디코딩 전에 예산을 예약한다.
+    //               option.bLossless 면 범위 변환 없이 디코딩한 값 그대로
+    //   EncodeGray: limited-range Y 평면 -> WebP (option 의 fQuality 대신 fQuality 사용)
+    //               option.bLossless 면 원래 값의 그레이 평면 -> 무손실 WebP (fQuality 는 쓰지 않음)
+    //   MeasureWebp: WebP 를 다시 디코딩해서 기준 평면(stride = nWidth)과 PSNR/SSIM 비교
+    //                bLossless 면 ARGB 로 디코딩해서 G 채널을 비교한다. (같으면 PSNR 이 상한값)
+    bool DecodeGray(const uint8_t* pJpegData, size_t nJpegSize, const ConvertOption& option, std::vector<uint8_t>& vecY, ConvertResult& result, MemoryReservation* pReservation = nullptr) const;
+    bool EncodeGray(const uint8_t* pY, int nYStride, int nWidth, int nHeight, float fQuality, const ConvertOption& option, std::vector<uint8_t>& vecWebpOut, CONVERT_STATUS& eStatus) const;
+    static bool MeasureWebp(const uint8_t* pWebpData, size_t nWebpSize, const uint8_t* pRefY, int nWidth, int nHeight, const VerifyOption& option, QualityScore& score, bool bLossless = false);
+
+    // 파일 -> 파일 변환
+    bool ConvertFile(const std::string& strInPath, const std::string& strOutPath, ConvertResult& result) const;
+    bool ConvertFile(const std::string& strInPath, const std::string& strOutPath, const ConvertOption& option, ConvertResult& result) const;
+
+    // "a/b/c.jpg" -> "a/b/c.webp"
+    static std::string MakeOutputPath(const std::string& strInPath);
+
+private:
+    ConvertOption m_option;
+    mutable std::atomic<uint64_t> m_nEncodedCount{ 0 };  // 검증 표본 (N 장마다 한 장) 선택용
+};
@@ -0,0 +1,412 @@
+﻿#include "CorpusGenerator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG 3 API (tj3Compress8)
+
+namespace
+{
+    // SplitMix64: 플랫폼과 표준 라이브러리 구현에 상관없이 같은 수열
+    class SplitMix64
+    {
+    public:
+        explicit SplitMix64(uint64_t nSeed) : m_nState(nSeed) {}
+
+        uint64_t Next()
+        {
+            uint64_t z = (m_nState += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        // [0, 1)
+        double NextUnit() { return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0); }
+
+        // [nMin, nMax]
+        int NextInt(int nMin, int nMax) { return nMin + static_cast<int>(Next() % static_cast<uint64_t>(nMax - nMin + 1)); }
+
+    private:
+        uint64_t m_nState;
+    };
+
+    // 이미지별 / 용도별 독립 난수열
+    enum RNG_STREAM
+    {
+        RNG_ATTRIBUTE = 1,  // 크기/서브샘플링/... 선택
+        RNG_CONTENT         // 픽셀 내용
+    };
+
+    uint64_t MakeStreamSeed(uint64_t nSeed, int nIndex, RNG_STREAM eStream)
+    {
+        SplitMix64 mix(nSeed ^ (static_cast<uint64_t>(nIndex) << 8) ^ static_cast<uint64_t>(eStream));
+        mix.Next();
+        return mix.Next();
+    }
+
+    // 좌표 -> 잡음 (위치만으로 정해지므로 행 순서와 무관)
+    inline uint32_t HashNoise(uint32_t x, uint32_t y, uint32_t nSalt)
+    {
+        uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ nSalt * 0xCB1AB31Fu;
+        h ^= h >> 13;
+        h *= 0x5BD1E995u;
+        h ^= h >> 15;
+        return h;
+    }
+
+    // 주기 nPeriod 의 삼각파 (0..nPeriod) - sin 대신 정수 연산만 써서 결과가 libm 에 의존하지 않음
+    inline int TriangleWave(int t, int nPeriod)
+    {
+        const int nTwice = nPeriod * 2;
+        int m = t % nTwice;
+        if (m < 0)
+            m += nTwice;
+        return m < nPeriod ? m : nTwice - m;
+    }
+
+    inline uint8_t ClampByte(int v)
+    {
+        return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    struct Wave
+    {
+        int nDirX;
+        int nDirY;
+        int nPeriod;
+        int nAmplitude;
+    };
+
+    struct Rect
+    {
+        int nX, nY, nWidth, nHeight;
+        int nValue;
+    };
+
+    template <typename T>
+    const T& PickWeighted(const std::vector<WeightedValue<T>>& vecList, double fUnit)
+    {
+        double fTotal = 0.0;
+        for (const auto& item : vecList)
+            fTotal += item.fWeight;
+
+        double fTarget = fUnit * fTotal;
+        for (const auto& item : vecList)
+        {
+            if (fTarget < item.fWeight)
+                return item.value;
+            fTarget -= item.fWeight;
+        }
+        return vecList.back().value;
+    }
+
+    // "값:가중치,값,..." (가중치 생략 = 1). parseValue(문자열, 값&) 가 false 면 전체 실패
+    template <typename T, typename F>
+    bool ParseWeighted(const std::string& strText, std::vector<WeightedValue<T>>& vecOut, F parseValue)
+    {
+        std::vector<WeightedValue<T>> vecList;
+        std::stringstream ss(strText);
+        std::string strItem;
+        while (std::getline(ss, strItem, ','))
+        {
+            if (strItem.empty())
+                continue;
+
+            WeightedValue<T> item;
+            item.fWeight = 1.0;
+            const size_t nColon = strItem.rfind(':');
+            std::string strValue = strItem;
+            if (nColon != std::string::npos)
+            {
+                char* pszEnd = nullptr;
+                const std::string strWeight = strItem.substr(nColon + 1);
+                item.fWeight = std::strtod(strWeight.c_str(), &pszEnd);
+                if (strWeight.empty() || *pszEnd != '\0' || !(item.fWeight > 0.0))
+                    return false;
+                strValue = strItem.substr(0, nColon);
+            }
+
+            if (!parseValue(strValue, item.value))
+                return false;
+            vecList.push_back(item);
+        }
+
+        if (vecList.empty())
+            return false;
+
+        vecOut = std::move(vecList);
+        return true;
+    }
+
+    bool ParseIntValue(const std::string& strValue, int nMin, int nMax, int& nValue)
+    {
+        char* pszEnd = nullptr;
+        const long n = std::strtol(strValue.c_str(), &pszEnd, 10);
+        if (strValue.empty() || *pszEnd != '\0' || n < nMin || n > nMax)
+            return false;
+        nValue = static_cast<int>(n);
+        return true;
+    }
+
+    template <typename T, typename F>
+    void WriteWeighted(std::ostream& os, const std::vector<WeightedValue<T>>& vecList, F writeValue)
+    {
+        for (size_t i = 0; i < vecList.size(); ++i)
+        {
+            if (i)
+                os << ',';
+            writeValue(vecList[i].value);
+            os << ':' << vecList[i].fWeight;
+        }
+    }
+
+    // 압축 핸들은 스레드마다 하나
+    struct ThreadCompressor
+    {
+        tjhandle tj = tj3Init(TJINIT_COMPRESS);
+        ~ThreadCompressor()
+        {
+            if (tj)
+                tj3Destroy(tj);
+        }
+    };
+
+    const int SUBSAMP_IDS[] = { TJSAMP_GRAY, TJSAMP_420, TJSAMP_422, TJSAMP_444, TJSAMP_440, TJSAMP_411 };
+}
+
+bool CorpusSpec::ParseSizes(const std::string& strText)
+{
+    return ParseWeighted(strText, vecSize, [](const std::string& strValue, CorpusSize& size)
+    {
+        int nWidth = 0, nHeight = 0;
+        char chExtra = 0;
+        if (std::sscanf(strValue.c_str(), "%dx%d%c", &nWidth, &nHeight, &chExtra) != 2)
+            return false;
+        if (nWidth <= 0 || nHeight <= 0 || nWidth > 16384 || nHeight > 16384)
+            return false;
+        size.nWidth = nWidth;
+        size.nHeight = nHeight;
+        return true;
+    });
+}
+
+bool CorpusSpec::ParseSubsamp(const std::string& strText)
+{
+    return ParseWeighted(strText, vecSubsamp, [](const std::string& strValue, int& nSubsamp)
+    {
+        for (int nId : SUBSAMP_IDS)
+        {
+            if (strValue == CorpusGenerator::GetSubsampName(nId))
+            {
+                nSubsamp = nId;
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+bool CorpusSpec::ParseRestartRows(const std::string& strText)
+{
+    return ParseWeighted(strText, vecRestartRows, [](const std::string& strValue, int& nRows) { return ParseIntValue(strValue, 0, 65535, nRows); });
+}
+
+bool CorpusSpec::ParseComplexity(const std::string& strText)
+{
+    return ParseWeighted(strText, vecComplexity, [](const std::string& strValue, double& fComplexity)
+    {
+        char* pszEnd = nullptr;
+        fComplexity = std::strtod(strValue.c_str(), &pszEnd);
+        return !strValue.empty() && *pszEnd == '\0' && fComplexity >= 0.0 && fComplexity <= 1.0;
+    });
+}
+
+bool CorpusSpec::ParseQuality(const std::string& strText)
+{
+    return ParseWeighted(strText, vecQuality, [](const std::string& strValue, int& nQuality) { return ParseIntValue(strValue, 1, 100, nQuality); });
+}
+
+std::string CorpusSpec::ToString() const
+{
+    std::ostringstream os;
+    os << "seed=" << nSeed << " count=" << nCount << " sizes=";
+    WriteWeighted(os, vecSize, [&](const CorpusSize& size) { os << size.nWidth << 'x' << size.nHeight; });
+    os << " subsamp=";
+    WriteWeighted(os, vecSubsamp, [&](int nSubsamp) { os << CorpusGenerator::GetSubsampName(nSubsamp); });
+    os << " progressive=" << fProgressive << " restart=";
+    WriteWeighted(os, vecRestartRows, [&](int nRows) { os << nRows; });
+    os << " complexity=";
+    WriteWeighted(os, vecComplexity, [&](double fComplexity) { os << fComplexity; });
+    os << " quality=";
+    WriteWeighted(os, vecQuality, [&](int nQuality) { os << nQuality; });
+    return os.str();
+}
+
+const char* CorpusGenerator::GetSubsampName(int nSubSampling)
+{
+    switch (nSubSampling)
+    {
+    case TJSAMP_GRAY:   return "gray";
+    case TJSAMP_420:    return "420";
+    case TJSAMP_422:    return "422";
+    case TJSAMP_444:    return "444";
+    case TJSAMP_440:    return "440";
+    case TJSAMP_411:    return "411";
+    default:            return "unknown";
+    }
+}
+
+CorpusImage CorpusGenerator::Describe(int nIndex) const
+{
+    // 항목마다 난수를 정해진 순서로 하나씩 쓴다. (목록이 하나뿐이어도 소비해서 다른 속성이 흔들리지 않게)
+    SplitMix64 rng(MakeStreamSeed(m_spec.nSeed, nIndex, RNG_ATTRIBUTE));
+
+    CorpusImage image;
+    image.nIndex = nIndex;
+    char szName[32];
+    std::snprintf(szName, sizeof(szName), "img_%06d.jpg", nIndex);
+    image.strName = szName;
+
+    const CorpusSize& size = PickWeighted(m_spec.vecSize, rng.NextUnit());
+    image.nWidth = size.nWidth;
+    image.nHeight = size.nHeight;
+    image.nSubSampling = PickWeighted(m_spec.vecSubsamp, rng.NextUnit());
+    image.bProgressive = rng.NextUnit() < m_spec.fProgressive;
+    image.nRestartRows = PickWeighted(m_spec.vecRestartRows, rng.NextUnit());
+    image.fComplexity = PickWeighted(m_spec.vecComplexity, rng.NextUnit());
+    image.nQuality = PickWeighted(m_spec.vecQuality, rng.NextUnit());
+    return image;
+}
+
+bool CorpusGenerator::Generate(CorpusImage& image, std::vector<uint8_t>& vecJpeg) const
+{
+    const int nWidth = image.nWidth;
+    const int nHeight = image.nHeight;
+    const double c = image.fComplexity;
+    SplitMix64 rng(MakeStreamSeed(m_spec.nSeed, image.nIndex, RNG_CONTENT));
+
+    // 1) 내용 요소: 그라디언트 + 삼각파 + 사각형 + 잡음. 복잡도가 높을수록 파동/사각형/잡음이 늘어난다.
+    const int nBase = rng.NextInt(32, 224);
+    const int nGradX = rng.NextInt(-96, 96);
+    const int nGradY = rng.NextInt(-96, 96);
+
+    std::vector<Wave> vecWave(1 + static_cast<int>(c * 6.0));
+    for (auto& wave : vecWave)
+    {
+        wave.nDirX = rng.NextInt(-4, 4);
+        wave.nDirY = rng.NextInt(-4, 4);
+        const int nMaxPeriod = std::max(4, static_cast<int>((1.0 - c) * std::max(nWidth, nHeight) / 2));
+        wave.nPeriod = rng.NextInt(4, nMaxPeriod);
+        wave.nAmplitude = rng.NextInt(8, 16 + static_cast<int>(c * 48.0));
+    }
+
+    std::vector<Rect> vecRect(2 + static_cast<int>(c * 40.0));
+    for (auto& rect : vecRect)
+    {
+        rect.nWidth = rng.NextInt(1, std::max(1, nWidth / 3));
+        rect.nHeight = rng.NextInt(1, std::max(1, nHeight / 3));
+        rect.nX = rng.NextInt(0, nWidth - rect.nWidth);
+        rect.nY = rng.NextInt(0, nHeight - rect.nHeight);
+        rect.nValue = rng.NextInt(0, 255);
+    }
+
+    const int nNoise = static_cast<int>(c * 80.0);
+    const uint32_t nNoiseSalt = static_cast<uint32_t>(rng.Next());
+
+    std::vector<uint8_t> vecGray(static_cast<size_t>(nWidth) * static_cast<size_t>(nHeight));
+    for (int y = 0; y < nHeight; ++y)
+    {
+        uint8_t* pRow = vecGray.data() + static_cast<size_t>(y) * nWidth;
+        for (int x = 0; x < nWidth; ++x)
+        {
+            int v = nBase + nGradX * x / nWidth + nGradY * y / nHeight;
+            for (const auto& wave : vecWave)
+                v += (TriangleWave(x * wave.nDirX + y * wave.nDirY, wave.nPeriod) * 2 - wave.nPeriod) * wave.nAmplitude / (2 * wave.nPeriod);
+            if (nNoise > 0)
+                v += static_cast<int>(HashNoise(static_cast<uint32_t>(x), static_cast<uint32_t>(y), nNoiseSalt) % static_cast<uint32_t>(2 * nNoise + 1)) - nNoise;
+            pRow[x] = ClampByte(v);
+        }
+    }
+
+    for (const auto& rect : vecRect)
+    {
+        for (int y = rect.nY; y < rect.nY + rect.nHeight; ++y)
+        {
+            uint8_t* pRow = vecGray.data() + static_cast<size_t>(y) * nWidth;
+            for (int x = rect.nX; x < rect.nX + rect.nWidth; ++x)
+                pRow[x] = static_cast<uint8_t>((pRow[x] + rect.nValue) / 2);
+        }
+    }
+
+    // 2) 컬러 서브샘플링이면 저주파 색조를 더해서 RGB 로 만든다. (크로마 채널도 내용이 있도록)
+    const bool bGray = image.nSubSampling == TJSAMP_GRAY;
+    std::vector<uint8_t> vecRgb;
+    if (!bGray)
+    {
+        const int nTintPeriodX = std::max(8, nWidth / rng.NextInt(1, 4));
+        const int nTintPeriodY = std::max(8, nHeight / rng.NextInt(1, 4));
+        vecRgb.resize(vecGray.size() * 3);
+        for (int y = 0; y < nHeight; ++y)
+        {
+            const int nTintY = TriangleWave(y, nTintPeriodY) * 80 / nTintPeriodY - 40;
+            for (int x = 0; x < nWidth; ++x)
+            {
+                const size_t nPos = static_cast<size_t>(y) * nWidth + x;
+                const int v = vecGray[nPos];
+                const int nTintX = TriangleWave(x, nTintPeriodX) * 80 / nTintPeriodX - 40;
+                vecRgb[nPos * 3 + 0] = ClampByte(v + nTintX);
+                vecRgb[nPos * 3 + 1] = ClampByte(v);
+                vecRgb[nPos * 3 + 2] = ClampByte(v + nTintY);
+            }
+        }
+    }
+
+    const std::vector<uint8_t>& vecSource = bGray ? vecGray : vecRgb;
+    uint64_t nHash = 1469598103934665603ULL; // FNV-1a
+    for (uint8_t b : vecSource)
+    {
+        nHash ^= b;
+        nHash *= 1099511628211ULL;
+    }
+    image.nPixelHash = nHash;
+
+    // 3) JPEG 압축
+    thread_local ThreadCompressor compressor;
+    if (!compressor.tj)
+        return false;
+
+    tj3Set(compressor.tj, TJPARAM_QUALITY, image.nQuality);
+    tj3Set(compressor.tj, TJPARAM_SUBSAMP, image.nSubSampling);
+    tj3Set(compressor.tj, TJPARAM_PROGRESSIVE, image.bProgressive ? 1 : 0);
+    tj3Set(compressor.tj, TJPARAM_RESTARTROWS, image.nRestartRows);
+
+    unsigned char* pJpeg = nullptr;
+    size_t nJpegSize = 0;
+    const int nPitch = nWidth * (bGray ? 1 : 3);
+    if (tj3Compress8(compressor.tj, vecSource.data(), nWidth, nPitch, nHeight, bGray ? TJPF_GRAY : TJPF_RGB, &pJpeg, &nJpegSize) != 0)
+    {
+        tj3Free(pJpeg);
+        return false;
+    }
+
+    vecJpeg.assign(pJpeg, pJpeg + nJpegSize);
+    tj3Free(pJpeg);
+    image.nBytes = nJpegSize;
+    return true;
+}
+
+void CorpusGenerator::WriteManifestHeader(std::ostream& os, const CorpusSpec& spec)
+{
+    os << "# " << spec.ToString() << "\n";
+    os << "name,width,height,subsamp,progressive,restart_rows,complexity,quality,pixel_hash,bytes\n";
+}
+
+void CorpusGenerator::WriteManifestRow(std::ostream& os, const CorpusImage& image)
+{
+    os << image.strName << ',' << image.nWidth << ',' << image.nHeight << ',' << GetSubsampName(image.nSubSampling) << ','
+        << (image.bProgressive ? 1 : 0) << ',' << image.nRestartRows << ',' << image.fComplexity << ',' << image.nQuality << ','
+        << std::hex << std::setw(16) << std::setfill('0') << image.nPixelHash << std::dec << std::setfill(' ') << ',' << image.nBytes << '\n';
+}
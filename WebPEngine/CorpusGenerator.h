@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// 재현 가능한 합성 JPEG 코퍼스 생성기
+//   같은 시드와 분포면 어느 머신/스레드 수에서도 같은 이미지 목록과 같은 픽셀이 나온다.
+//   (표준 라이브러리 분포 대신 자체 난수/정수 연산만 사용. JPEG 바이트는 libjpeg-turbo 버전에 따라 다를 수 있다.)
+//   이미지 i 의 속성과 픽셀은 (시드, i) 로만 정해지므로 병렬로 만들어도 결과가 같다.
+
+// "값:가중치,값:가중치" 목록 한 항목 (가중치를 생략하면 1)
+template <typename T>
+struct WeightedValue
+{
+    T value;
+    double fWeight;
+};
+
+struct CorpusSize
+{
+    int nWidth;
+    int nHeight;
+};
+
+struct CorpusSpec
+{
+    uint64_t nSeed = 1;
+    int nCount = 100;
+    std::vector<WeightedValue<CorpusSize>> vecSize{ { { 640, 480 }, 1.0 } };
+    std::vector<WeightedValue<int>> vecSubsamp{ { 3 /* JPEG_SUBSAMP_GRAY */, 1.0 } };
+    double fProgressive = 0.0;                                      // progressive 로 만들 비율 (0..1)
+    std::vector<WeightedValue<int>> vecRestartRows{ { 0, 1.0 } };   // restart 간격 (MCU 행 단위, 0 = 없음)
+    std::vector<WeightedValue<double>> vecComplexity{ { 0.5, 1.0 } };   // 내용 복잡도 0 (평탄) .. 1 (잡음 많음)
+    std::vector<WeightedValue<int>> vecQuality{ { 85, 1.0 } };
+
+    // 명령행 문자열 -> 목록. 형식이 틀리면 false
+    //   크기 "640x480:4,1920x1080:1"  서브샘플링 "gray:6,420:2,422:1,444:1"
+    //   restart "0:3,1:1,16:1"  복잡도 "0.1:1,0.5:2,0.9:1"  품질 "75,90"
+    bool ParseSizes(const std::string& strText);
+    bool ParseSubsamp(const std::string& strText);
+    bool ParseRestartRows(const std::string& strText);
+    bool ParseComplexity(const std::string& strText);
+    bool ParseQuality(const std::string& strText);
+
+    std::string ToString() const;   // manifest 머리글용
+};
+
+// 이미지 하나의 속성 (manifest 한 줄)
+struct CorpusImage
+{
+    int nIndex = 0;
+    std::string strName;            // "img_000000.jpg"
+    int nWidth = 0;
+    int nHeight = 0;
+    int nSubSampling = 3;           // JPEG_SUBSAMP_*
+    bool bProgressive = false;
+    int nRestartRows = 0;
+    double fComplexity = 0.0;
+    int nQuality = 85;
+    uint64_t nPixelHash = 0;        // 원본 픽셀 FNV-1a (JPEG 라이브러리와 무관하게 재현성 확인용)
+    size_t nBytes = 0;              // 생성된 JPEG 크기
+};
+
+class CorpusGenerator
+{
+public:
+    explicit CorpusGenerator(const CorpusSpec& spec) : m_spec(spec) {}
+
+    // (시드, nIndex) 로 속성만 정한다. (픽셀 생성/압축 없음)
+    CorpusImage Describe(int nIndex) const;
+
+    // 속성대로 픽셀을 만들어 JPEG 으로 압축한다. image.nPixelHash / nBytes 를 채운다. (스레드 안전)
+    bool Generate(CorpusImage& image, std::vector<uint8_t>& vecJpeg) const;
+
+    static const char* GetSubsampName(int nSubSampling);
+    static void WriteManifestHeader(std::ostream& os, const CorpusSpec& spec);
+    static void WriteManifestRow(std::ostream& os, const CorpusImage& image);
+
+private:
+    CorpusSpec m_spec;
+};
@@ -0,0 +1,370 @@
+﻿#include "CorpusIndex.h"
+#include "DecoderBackend.h"
+#include "JobPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <memory>
+
+namespace
+{
+    const size_t SCAN_CHUNK_FILES = 64;    // 작업자에게 한 번에 넘기는 파일 수
+
+    struct FileCloser
+    {
+        void operator()(std::FILE* pFile) const { std::fclose(pFile); }
+    };
+
+    bool ReadBytes(std::FILE* pFile, uint8_t* pBuffer, size_t nSize)
+    {
+        return std::fread(pBuffer, 1, nSize, pFile) == nSize;
+    }
+
+    // 성분별 샘플링 계수 -> TurboJPEG 와 같은 서브샘플링 분류
+    int ClassifySubSampling(int nComponents, const int (&factors)[4][2])
+    {
+        if (nComponents == 1)
+            return JPEG_SUBSAMP_GRAY;
+        if (nComponents != 3)
+            return JPEG_SUBSAMP_UNKNOWN;
+
+        for (int c = 1; c < 3; ++c)
+        {
+            if (factors[c][0] != 1 || factors[c][1] != 1)
+                return JPEG_SUBSAMP_UNKNOWN;
+        }
+
+        const int nH = factors[0][0];
+        const int nV = factors[0][1];
+        if (nH == 1 && nV == 1) return JPEG_SUBSAMP_444;
+        if (nH == 2 && nV == 1) return JPEG_SUBSAMP_422;
+        if (nH == 2 && nV == 2) return JPEG_SUBSAMP_420;
+        if (nH == 1 && nV == 2) return JPEG_SUBSAMP_440;
+        if (nH == 4 && nV == 1) return JPEG_SUBSAMP_411;
+        return JPEG_SUBSAMP_UNKNOWN;
+    }
+
+    bool ParseFrameHeader(const uint8_t* pSeg, size_t nSegSize, uint8_t marker, JpegScanInfo& info)
+    {
+        // P(1) Y(2) X(2) Nf(1) 다음 성분마다 C(1) H/V(1) Tq(1)
+        if (nSegSize < 6)
+            return false;
+
+        info.nHeight = (pSeg[1] << 8) | pSeg[2];
+        info.nWidth = (pSeg[3] << 8) | pSeg[4];
+        info.nComponents = pSeg[5];
+        if (nSegSize < 6 + static_cast<size_t>(info.nComponents) * 3)
+            return false;
+
+        int factors[4][2] = {};
+        for (int c = 0; c < std::min(info.nComponents, 4); ++c)
+        {
+            factors[c][0] = pSeg[6 + c * 3 + 1] >> 4;
+            factors[c][1] = pSeg[6 + c * 3 + 1] & 0x0F;
+        }
+        info.nSubSampling = ClassifySubSampling(info.nComponents, factors);
+
+        // SOF1/5/9/13 ... 의 하위 비트: 2 = progressive, 8 = arithmetic
+        info.bProgressive = (marker & 0x03) == 0x02;
+        info.bArithmetic = (marker & 0x08) != 0;
+        return true;
+    }
+}
+
+JpegScanInfo ScanJpegFile(const std::string& strPath)
+{
+    JpegScanInfo info;
+    std::unique_ptr<std::FILE, FileCloser> pFile(std::fopen(strPath.c_str(), "rb"));
+    if (!pFile)
+    {
+        info.eStatus = JPEG_SCAN_UNREADABLE;
+        return info;
+    }
+
+    uint8_t header[4];
+    if (!ReadBytes(pFile.get(), header, 2) || header[0] != 0xFF || header[1] != 0xD8)
+        return info;
+
+    bool bFrame = false;
+    std::vector<uint8_t> vecSeg;
+    while (true)
+    {
+        // 마커 앞 채움 바이트(0xFF 반복)는 건너뛴다.
+        if (!ReadBytes(pFile.get(), header, 2) || header[0] != 0xFF)
+            return info;
+
+        uint8_t marker = header[1];
+        while (marker == 0xFF)
+        {
+            if (!ReadBytes(pFile.get(), &marker, 1))
+                return info;
+        }
+
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) // TEM / RSTn: 길이 없음
+            continue;
+        if (marker == 0xD9) // SOS 전에 EOI
+            return info;
+        if (!ReadBytes(pFile.get(), header, 2))
+            return info;
+
+        const size_t nLength = (static_cast<size_t>(header[0]) << 8) | header[1];
+        if (nLength < 2)
+            return info;
+        const size_t nSegSize = nLength - 2;
+
+        if (marker == 0xDA) // SOS: 엔트로피 데이터 시작. 프레임 헤더를 봤으면 정상
+        {
+            if (bFrame && info.nWidth > 0 && info.nHeight > 0)
+                info.eStatus = JPEG_SCAN_OK;
+            return info;
+        }
+
+        const bool bSof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (bSof || marker == 0xDD)
+        {
+            vecSeg.resize(nSegSize);
+            if (!ReadBytes(pFile.get(), vecSeg.data(), nSegSize))
+                return info;
+
+            if (bSof)
+            {
+                if (!ParseFrameHeader(vecSeg.data(), nSegSize, marker, info))
+                    return info;
+                bFrame = true;
+            }
+            else if (nSegSize >= 2) // DRI
+            {
+                info.nRestartInterval = (vecSeg[0] << 8) | vecSeg[1];
+            }
+        }
+        else if (std::fseek(pFile.get(), static_cast<long>(nSegSize), SEEK_CUR) != 0)
+        {
+            return info;
+        }
+    }
+}
+
+bool CorpusIndex::Load(const std::string& strPath)
+{
+    m_vecFile.clear();
+    m_mapLookup.clear();
+
+    std::unique_ptr<std::FILE, FileCloser> pFile(std::fopen(strPath.c_str(), "rb"));
+    if (!pFile)
+        return false;
+
+    CorpusIndexHeader header;
+    if (std::fread(&header, sizeof(header), 1, pFile.get()) != 1 || std::memcmp(header.szMagic, "WCIX", 4) != 0 || header.nVersion != VERSION)
+        return false;
+
+    std::vector<CorpusIndexEntry> vecEntry;
+    std::vector<char> vecPath;
+    try
+    {
+        vecEntry.resize(static_cast<size_t>(header.nEntryCount));
+        vecPath.resize(static_cast<size_t>(header.nPathSize));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return false;
+    }
+
+    if ((!vecEntry.empty() && std::fread(vecEntry.data(), sizeof(CorpusIndexEntry), vecEntry.size(), pFile.get()) != vecEntry.size())
+        || std::fseek(pFile.get(), static_cast<long>(header.nPathOffset), SEEK_SET) != 0
+        || (!vecPath.empty() && std::fread(vecPath.data(), 1, vecPath.size(), pFile.get()) != vecPath.size()))
+        return false;
+
+    m_vecFile.reserve(vecEntry.size());
+    for (const auto& entry : vecEntry)
+    {
+        if (static_cast<uint64_t>(entry.nPathOffset) + entry.nPathLength > vecPath.size())
+        {
+            m_vecFile.clear();
+            return false;
+        }
+
+        CorpusFileInfo file;
+        file.strPath.assign(vecPath.data() + entry.nPathOffset, entry.nPathLength);
+        file.nFileSize = entry.nFileSize;
+        file.nModifiedTime = entry.nModifiedTime;
+        file.info.eStatus = static_cast<JPEG_SCAN_STATUS>(entry.nStatus);
+        file.info.nWidth = static_cast<int>(entry.nWidth);
+        file.info.nHeight = static_cast<int>(entry.nHeight);
+        file.info.nSubSampling = entry.nSubSampling;
+        file.info.nComponents = entry.nComponents;
+        file.info.bProgressive = (entry.nFlags & CORPUS_FLAG_PROGRESSIVE) != 0;
+        file.info.bArithmetic = (entry.nFlags & CORPUS_FLAG_ARITHMETIC) != 0;
+        file.info.nRestartInterval = entry.nRestartInterval;
+        m_vecFile.push_back(std::move(file));
+    }
+
+    RebuildLookup();
+    return true;
+}
+
+bool CorpusIndex::Save(const std::string& strPath) const
+{
+    std::vector<CorpusIndexEntry> vecEntry(m_vecFile.size());
+    std::string strPathBlob;
+    for (size_t i = 0; i < m_vecFile.size(); ++i)
+    {
+        const CorpusFileInfo& file = m_vecFile[i];
+        CorpusIndexEntry& entry = vecEntry[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.nFileSize = file.nFileSize;
+        entry.nModifiedTime = file.nModifiedTime;
+        entry.nWidth = static_cast<uint32_t>(file.info.nWidth);
+        entry.nHeight = static_cast<uint32_t>(file.info.nHeight);
+        entry.nPathOffset = static_cast<uint32_t>(strPathBlob.size());
+        entry.nPathLength = static_cast<uint32_t>(file.strPath.size());
+        entry.nRestartInterval = static_cast<uint16_t>(file.info.nRestartInterval);
+        entry.nSubSampling = static_cast<int8_t>(file.info.nSubSampling);
+        entry.nComponents = static_cast<uint8_t>(file.info.nComponents);
+        entry.nStatus = static_cast<uint8_t>(file.info.eStatus);
+        entry.nFlags = static_cast<uint8_t>((file.info.bProgressive ? CORPUS_FLAG_PROGRESSIVE : 0) | (file.info.bArithmetic ? CORPUS_FLAG_ARITHMETIC : 0));
+        strPathBlob += file.strPath;
+    }
+
+    CorpusIndexHeader header;
+    std::memcpy(header.szMagic, "WCIX", 4);
+    header.nVersion = VERSION;
+    header.nEntryCount = vecEntry.size();
+    header.nPathOffset = sizeof(CorpusIndexHeader) + vecEntry.size() * sizeof(CorpusIndexEntry);
+    header.nPathSize = strPathBlob.size();
+
+    // 쓰다가 끊겨도 이전 색인이 남도록 임시 파일에 쓴 뒤 바꾼다.
+    const std::string strTempPath = strPath + ".tmp";
+    {
+        std::unique_ptr<std::FILE, FileCloser> pFile(std::fopen(strTempPath.c_str(), "wb"));
+        if (!pFile)
+            return false;
+
+        bool bOk = std::fwrite(&header, sizeof(header), 1, pFile.get()) == 1;
+        bOk = bOk && (vecEntry.empty() || std::fwrite(vecEntry.data(), sizeof(CorpusIndexEntry), vecEntry.size(), pFile.get()) == vecEntry.size());
+        bOk = bOk && (strPathBlob.empty() || std::fwrite(strPathBlob.data(), 1, strPathBlob.size(), pFile.get()) == strPathBlob.size());
+        bOk = (std::fclose(pFile.release()) == 0) && bOk;
+        if (!bOk)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(strTempPath, strPath, ec);
+    return !ec;
+}
+
+CorpusScanStats CorpusIndex::Update(const std::vector<std::string>& vecPath, int nThreads)
+{
+    CorpusScanStats stats;
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // 크기/수정 시각이 색인과 같으면 재사용, 아니면 다시 읽을 목록에 넣는다.
+    std::vector<CorpusFileInfo> vecFile(vecPath.size());
+    std::vector<size_t> vecStale;
+    uint64_t nKept = 0;
+    for (size_t i = 0; i < vecPath.size(); ++i)
+    {
+        CorpusFileInfo& file = vecFile[i];
+        file.strPath = vecPath[i];
+
+        std::error_code ec;
+        file.nFileSize = std::filesystem::file_size(file.strPath, ec);
+        if (ec)
+            file.nFileSize = 0;
+        const auto modifiedTime = std::filesystem::last_write_time(file.strPath, ec);
+        file.nModifiedTime = ec ? 0 : static_cast<int64_t>(modifiedTime.time_since_epoch().count());
+
+        const CorpusFileInfo* pOld = Find(file.strPath);
+        if (pOld && !ec && pOld->nFileSize == file.nFileSize && pOld->nModifiedTime == file.nModifiedTime)
+        {
+            file.info = pOld->info;
+            ++stats.nReused;
+        }
+        else
+        {
+            vecStale.push_back(i);
+        }
+        if (pOld)
+            ++nKept;
+    }
+    stats.nRemoved = m_vecFile.size() - std::min<uint64_t>(nKept, m_vecFile.size());
+
+    if (!vecStale.empty())
+    {
+        JobPool pool(nThreads);
+        std::vector<std::future<void>> vecFuture;
+        for (size_t nBegin = 0; nBegin < vecStale.size(); nBegin += SCAN_CHUNK_FILES)
+        {
+            const size_t nEnd = std::min(vecStale.size(), nBegin + SCAN_CHUNK_FILES);
+            vecFuture.push_back(pool.enqueue([&vecFile, &vecStale, nBegin, nEnd]()
+            {
+                for (size_t n = nBegin; n < nEnd; ++n)
+                {
+                    CorpusFileInfo& file = vecFile[vecStale[n]];
+                    file.info = ScanJpegFile(file.strPath);
+                }
+            }));
+        }
+        for (auto& future : vecFuture)
+            future.get();
+        stats.nScanned = vecStale.size();
+    }
+
+    m_vecFile = std::move(vecFile);
+    RebuildLookup();
+    stats.fElapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
+}
+
+const CorpusFileInfo* CorpusIndex::Find(const std::string& strPath) const
+{
+    auto it = m_mapLookup.find(strPath);
+    return (it != m_mapLookup.end()) ? &m_vecFile[it->second] : nullptr;
+}
+
+CorpusSummary CorpusIndex::Summarize() const
+{
+    CorpusSummary summary;
+    for (const auto& file : m_vecFile)
+    {
+        ++summary.nFiles;
+        summary.nBytes += file.nFileSize;
+
+        const JpegScanInfo& info = file.info;
+        if (info.eStatus == JPEG_SCAN_UNREADABLE)
+        {
+            ++summary.nUnreadable;
+            continue;
+        }
+        if (info.eStatus != JPEG_SCAN_OK)
+        {
+            ++summary.nCorrupt;
+            continue;
+        }
+
+        summary.nPixels += info.GetPixels();
+        if (info.GetPixels() > summary.nMaxPixels)
+        {
+            summary.nMaxPixels = info.GetPixels();
+            summary.nMaxWidth = info.nWidth;
+            summary.nMaxHeight = info.nHeight;
+        }
+        const int nSlot = (info.nSubSampling >= JPEG_SUBSAMP_444 && info.nSubSampling <= JPEG_SUBSAMP_411) ? info.nSubSampling + 1 : 0;
+        ++summary.nSubSampling[nSlot];
+        if (info.bProgressive)
+            ++summary.nProgressive;
+        if (info.nRestartInterval > 0)
+            ++summary.nRestart;
+    }
+    return summary;
+}
+
+void CorpusIndex::RebuildLookup()
+{
+    m_mapLookup.clear();
+    m_mapLookup.reserve(m_vecFile.size());
+    for (size_t i = 0; i < m_vecFile.size(); ++i)
+        m_mapLookup[m_vecFile[i].strPath] = i;
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 헤더만 읽은 코퍼스 색인
+//   배치를 시작하기 전에 파일마다 JPEG 마커(SOI ~ SOS 직전)만 읽어서 크기/서브샘플링/progressive/restart 간격과
+//   손상 여부를 모은다. 엔트로피 데이터는 읽지 않으므로 파일 전체를 읽는 변환보다 훨씬 싸다.
+//   결과는 작은 바이너리 색인(.wci)으로 저장하고, 다시 검사할 때는 크기/수정 시각이 바뀐 파일만 읽는다.
+//
+//   <index>.wci : CorpusIndexHeader | CorpusIndexEntry[count] | 경로 문자열 blob (little-endian)
+
+enum JPEG_SCAN_STATUS
+{
+    JPEG_SCAN_OK = 0,
+    JPEG_SCAN_UNREADABLE,   // 파일을 열 수 없음
+    JPEG_SCAN_CORRUPT       // SOI 없음, 마커 구조 깨짐, SOS 전에 끝남, 크기 0
+};
+
+enum CORPUS_FLAG
+{
+    CORPUS_FLAG_PROGRESSIVE = 0x01,
+    CORPUS_FLAG_ARITHMETIC = 0x02
+};
+
+#pragma pack(push, 1)
+struct CorpusIndexHeader
+{
+    char szMagic[4];            // "WCIX"
+    uint32_t nVersion;
+    uint64_t nEntryCount;
+    uint64_t nPathOffset;
+    uint64_t nPathSize;
+};
+
+struct CorpusIndexEntry
+{
+    uint64_t nFileSize;
+    int64_t nModifiedTime;      // 파일 시스템 시각 (같은 플랫폼에서만 비교)
+    uint32_t nWidth;
+    uint32_t nHeight;
+    uint32_t nPathOffset;       // 경로 blob 안의 위치
+    uint32_t nPathLength;
+    uint16_t nRestartInterval;  // DRI (MCU 단위, 0 = 없음)
+    int8_t nSubSampling;        // JPEG_SUBSAMP_*
+    uint8_t nComponents;
+    uint8_t nStatus;            // JPEG_SCAN_STATUS
+    uint8_t nFlags;             // CORPUS_FLAG_*
+    uint8_t nReserved[2];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(CorpusIndexHeader) == 32, "CorpusIndexHeader layout");
+static_assert(sizeof(CorpusIndexEntry) == 40, "CorpusIndexEntry layout");
+
+// tjDecompressHeader3 이 주는 값 + progressive/restart (파일 이름/크기/시각 제외)
+struct JpegScanInfo
+{
+    JPEG_SCAN_STATUS eStatus = JPEG_SCAN_CORRUPT;
+    int nWidth = 0;
+    int nHeight = 0;
+    int nSubSampling = -1;      // JPEG_SUBSAMP_*
+    int nComponents = 0;
+    bool bProgressive = false;
+    bool bArithmetic = false;
+    int nRestartInterval = 0;
+
+    uint64_t GetPixels() const { return static_cast<uint64_t>(nWidth) * static_cast<uint64_t>(nHeight); }
+};
+
+// 파일에서 SOS 직전까지 마커만 읽는다. 세그먼트 본문은 SOF/DRI 외에는 건너뛴다.
+JpegScanInfo ScanJpegFile(const std::string& strPath);
+
+struct CorpusFileInfo
+{
+    std::string strPath;
+    uint64_t nFileSize = 0;
+    int64_t nModifiedTime = 0;
+    JpegScanInfo info;
+};
+
+struct CorpusSummary
+{
+    uint64_t nFiles = 0;
+    uint64_t nBytes = 0;
+    uint64_t nPixels = 0;               // 정상 파일 픽셀 합
+    uint64_t nMaxPixels = 0;            // 가장 큰 이미지 (메모리 예산 검토용)
+    int nMaxWidth = 0;
+    int nMaxHeight = 0;
+    uint64_t nSubSampling[7] = {};      // [JPEG_SUBSAMP_* + 1] (0 = 알 수 없음)
+    uint64_t nProgressive = 0;
+    uint64_t nRestart = 0;
+    uint64_t nCorrupt = 0;
+    uint64_t nUnreadable = 0;
+};
+
+struct CorpusScanStats
+{
+    uint64_t nReused = 0;       // 크기/시각이 같아서 색인 값을 그대로 쓴 파일
+    uint64_t nScanned = 0;      // 새로 헤더를 읽은 파일
+    uint64_t nRemoved = 0;      // 색인에 있었지만 이번 목록에 없는 파일
+    double fElapsedSec = 0.0;
+};
+
+class CorpusIndex
+{
+public:
+    static const uint32_t VERSION = 1;
+
+    // 색인 파일이 없거나 형식이 다르면 false (빈 색인으로 시작)
+    bool Load(const std::string& strPath);
+    bool Save(const std::string& strPath) const;
+
+    // 색인을 vecPath 목록과 같게 만든다. 바뀐 파일만 nThreads 개 스레드로 다시 읽는다. (0 = 하드웨어 스레드 수)
+    CorpusScanStats Update(const std::vector<std::string>& vecPath, int nThreads);
+
+    const CorpusFileInfo* Find(const std::string& strPath) const;
+    const std::vector<CorpusFileInfo>& GetFiles() const { return m_vecFile; }
+    CorpusSummary Summarize() const;
+
+private:
+    void RebuildLookup();
+
+    std::vector<CorpusFileInfo> m_vecFile;
+    std::unordered_map<std::string, size_t> m_mapLookup;
+};
@@ -0,0 +1,292 @@
+﻿#include "CostModel.h"
+#include "ConvertEngine.h"
+#include "CorpusIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+const double CostModel::DECAY = 0.998;
+const double CostModel::RIDGE = 2.0;
+
+namespace
+{
+    const char* const COST_MODEL_MAGIC = "webp-cost 1";
+
+    double ToSec(std::chrono::microseconds duration)
+    {
+        return static_cast<double>(duration.count()) * 1e-6;
+    }
+
+    void MakeFeatureVector(const CostFeatures& features, double (&x)[CostCoefficients::FEATURE_COUNT])
+    {
+        x[0] = 1.0;
+        x[1] = features.fMegapixels;
+        x[2] = features.bProgressive ? features.fMegapixels : 0.0;
+        x[3] = features.fInputMB;
+    }
+
+    // 작은 대칭 양의 정부호 계 (A + RIDGE·I) β = rhs. 부분 피벗 가우스 소거
+    template <int N>
+    bool SolveLinear(double (&a)[N][N], double (&rhs)[N], double (&beta)[N])
+    {
+        for (int col = 0; col < N; ++col)
+        {
+            int nPivot = col;
+            for (int row = col + 1; row < N; ++row)
+            {
+                if (std::fabs(a[row][col]) > std::fabs(a[nPivot][col]))
+                    nPivot = row;
+            }
+            if (std::fabs(a[nPivot][col]) < 1e-12)
+                return false;
+            if (nPivot != col)
+            {
+                std::swap(a[nPivot], a[col]);
+                std::swap(rhs[nPivot], rhs[col]);
+            }
+
+            for (int row = col + 1; row < N; ++row)
+            {
+                const double fFactor = a[row][col] / a[col][col];
+                for (int k = col; k < N; ++k)
+                    a[row][k] -= fFactor * a[col][k];
+                rhs[row] -= fFactor * rhs[col];
+            }
+        }
+
+        for (int row = N - 1; row >= 0; --row)
+        {
+            double fSum = rhs[row];
+            for (int k = row + 1; k < N; ++k)
+                fSum -= a[row][k] * beta[k];
+            beta[row] = fSum / a[row][row];
+        }
+        return true;
+    }
+}
+
+const char* GetCostStageString(COST_STAGE eStage)
+{
+    switch (eStage)
+    {
+    case COST_STAGE_DECODE: return "decode";
+    case COST_STAGE_ENCODE: return "encode";
+    case COST_STAGE_OTHER:  return "other";
+    default:                return "unknown";
+    }
+}
+
+CostFeatures CostFeatures::FromScan(const JpegScanInfo& info, uint64_t nFileSize)
+{
+    CostFeatures features;
+    features.bConvertible = (info.eStatus == JPEG_SCAN_OK && info.nSubSampling == JPEG_SUBSAMP_GRAY);
+    features.fMegapixels = static_cast<double>(info.GetPixels()) * 1e-6;
+    features.fInputMB = static_cast<double>(nFileSize) / (1024.0 * 1024.0);
+    features.bProgressive = info.bProgressive;
+    return features;
+}
+
+CostFeatures CostFeatures::FromResult(const ConvertResult& result)
+{
+    CostFeatures features;
+    features.bConvertible = (result.eStatus == CONVERT_OK);
+    features.fMegapixels = static_cast<double>(result.nWidth) * static_cast<double>(result.nHeight) * 1e-6;
+    features.fInputMB = static_cast<double>(result.nInputSize) / (1024.0 * 1024.0);
+    return features;
+}
+
+CostPrediction CostCoefficients::Predict(const CostFeatures& features) const
+{
+    CostPrediction prediction;
+    if (!features.bConvertible)
+        return prediction;
+
+    double x[FEATURE_COUNT];
+    MakeFeatureVector(features, x);
+    for (int s = 0; s < COST_STAGE_COUNT; ++s)
+    {
+        double fSec = 0.0;
+        for (int i = 0; i < FEATURE_COUNT; ++i)
+            fSec += fBeta[s][i] * x[i];
+        prediction.fStageSec[s] = std::max(fSec, 0.0);
+    }
+    return prediction;
+}
+
+RemainingEstimate EstimateRemaining(double fRemainingWorkSec, double fDoneWorkSec, double fElapsedSec, int nWorkers)
+{
+    RemainingEstimate estimate;
+    estimate.fRemainingWorkSec = fRemainingWorkSec;
+    if (fDoneWorkSec > 0.0 && fElapsedSec > 0.0)
+        estimate.fEtaSec = fRemainingWorkSec * fElapsedSec / fDoneWorkSec;
+    else if (nWorkers > 0)
+        estimate.fEtaSec = fRemainingWorkSec / nWorkers;
+    return estimate;
+}
+
+CostModel::CostModel()
+{
+    // 사전값: 4000x3000 그레이 기준으로 잰 대략적인 MP 당 시간 (관측 몇 개면 실제 값으로 바뀐다)
+    const double fPrior[COST_STAGE_COUNT][N] =
+    {
+        { 0.0003, 0.004, 0.004, 0.0 },  // decode: progressive 는 여러 번 훑는다.
+        { 0.0005, 0.030, 0.0, 0.0 },    // encode
+        { 0.0, 0.0, 0.0, 0.0 },         // 분석/검증은 켰을 때만
+    };
+    for (int s = 0; s < COST_STAGE_COUNT; ++s)
+    {
+        for (int i = 0; i < N; ++i)
+            m_prior.fBeta[s][i] = fPrior[s][i];
+    }
+    m_coefficients = m_prior;
+}
+
+CostPrediction CostModel::Predict(const CostFeatures& features) const
+{
+    return GetCoefficients().Predict(features);
+}
+
+CostCoefficients CostModel::GetCoefficients() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_coefficients;
+}
+
+void CostModel::Observe(const CostFeatures& features, const ConvertResult& result)
+{
+    if (result.eStatus != CONVERT_OK || !features.bConvertible)
+        return;
+
+    double y[COST_STAGE_COUNT];
+    y[COST_STAGE_DECODE] = ToSec(result.durationDecode);
+    y[COST_STAGE_ENCODE] = ToSec(result.durationEncode);
+    y[COST_STAGE_OTHER] = ToSec(result.durationAnalyze) + ToSec(result.durationVerify);
+
+    double x[N];
+    MakeFeatureVector(features, x);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const double fPredicted = m_coefficients.Predict(features).GetTotalSec();
+    const double fActual = y[COST_STAGE_DECODE] + y[COST_STAGE_ENCODE] + y[COST_STAGE_OTHER];
+    ++m_stats.nObserved;
+    m_stats.fAbsErrorSec += std::fabs(fPredicted - fActual);
+    m_stats.fActualSec += fActual;
+
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < N; ++j)
+            m_fGram[i][j] = m_fGram[i][j] * DECAY + x[i] * x[j];
+    }
+    for (int s = 0; s < COST_STAGE_COUNT; ++s)
+    {
+        for (int i = 0; i < N; ++i)
+            m_fMoment[s][i] = m_fMoment[s][i] * DECAY + x[i] * y[s];
+    }
+    Solve();
+}
+
+void CostModel::Solve()
+{
+    // 사전값 쪽으로 당기는 리지: (G + RIDGE·I) β = m + RIDGE·β0
+    for (int s = 0; s < COST_STAGE_COUNT; ++s)
+    {
+        double a[N][N];
+        double rhs[N];
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+                a[i][j] = m_fGram[i][j] + ((i == j) ? RIDGE : 0.0);
+            rhs[i] = m_fMoment[s][i] + RIDGE * m_prior.fBeta[s][i];
+        }
+
+        double beta[N] = {};
+        if (SolveLinear(a, rhs, beta))
+        {
+            for (int i = 0; i < N; ++i)
+                m_coefficients.fBeta[s][i] = beta[i];
+        }
+    }
+}
+
+CostModelStats CostModel::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool CostModel::Load(const std::string& strPath, const std::string& strSettings)
+{
+    std::ifstream ifs(strPath);
+    std::string strLine;
+    if (!ifs || !std::getline(ifs, strLine) || strLine != COST_MODEL_MAGIC)
+        return false;
+    if (!std::getline(ifs, strLine) || strLine != "settings " + strSettings)
+        return false;
+
+    double fGram[N][N] = {};
+    double fMoment[COST_STAGE_COUNT][N] = {};
+    std::string strKey;
+    ifs >> strKey;
+    if (strKey != "gram")
+        return false;
+    for (int i = 0; i < N; ++i)
+    {
+        for (int j = 0; j < N; ++j)
+            ifs >> fGram[i][j];
+    }
+    for (int s = 0; s < COST_STAGE_COUNT; ++s)
+    {
+        ifs >> strKey;
+        if (strKey != GetCostStageString(static_cast<COST_STAGE>(s)))
+            return false;
+        for (int i = 0; i < N; ++i)
+            ifs >> fMoment[s][i];
+    }
+    if (!ifs)
+        return false;
+
+    // 이전 실행의 오차는 이어서 세지 않는다. (이번 실행의 예측 정확도만 보고)
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::copy(&fGram[0][0], &fGram[0][0] + N * N, &m_fGram[0][0]);
+    std::copy(&fMoment[0][0], &fMoment[0][0] + COST_STAGE_COUNT * N, &m_fMoment[0][0]);
+    Solve();
+    return true;
+}
+
+bool CostModel::Save(const std::string& strPath, const std::string& strSettings) const
+{
+    std::ostringstream oss;
+    oss.precision(17);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        oss << COST_MODEL_MAGIC << "\n" << "settings " << strSettings << "\n" << "gram";
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+                oss << ' ' << m_fGram[i][j];
+        }
+        oss << "\n";
+        for (int s = 0; s < COST_STAGE_COUNT; ++s)
+        {
+            oss << GetCostStageString(static_cast<COST_STAGE>(s));
+            for (int i = 0; i < N; ++i)
+                oss << ' ' << m_fMoment[s][i];
+            oss << "\n";
+        }
+    }
+
+    const std::string strTempPath = strPath + ".tmp";
+    {
+        std::ofstream ofs(strTempPath, std::ios::out | std::ios::trunc);
+        if (!ofs)
+            return false;
+        ofs << oss.str();
+        ofs.flush();
+        if (!ofs)
+            return false;
+    }
+    std::remove(strPath.c_str());
+    return std::rename(strTempPath.c_str(), strPath.c_str()) == 0;
+}
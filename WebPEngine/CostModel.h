@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct ConvertResult;
+struct JpegScanInfo;
+
+// 파일별 변환 비용 모델 (온라인 학습)
+//   헤더에서 얻는 특징(픽셀 수, progressive, 압축 크기)으로 단계별 작업 시간(초)을 선형 예측한다.
+//   변환이 끝날 때마다 실제 단계 시간으로 갱신하는 리지 회귀이고, 오래된 관측은 조금씩 잊어서 (DECAY)
+//   설정/기계 상태가 바뀌어도 따라간다. 관측이 없을 때는 사전값(대략적인 MP 당 시간)으로 예측한다.
+//
+//   예측은 같은 설정(품질, 인코더, 무손실 ...) 안에서만 의미가 있다. 저장 파일에는 설정 키를 함께 남기고
+//   키가 다르면 불러오지 않는다.
+//   그레이가 아닌 JPEG 와 헤더가 깨진 파일은 헤더만 읽고 실패하므로 비용 0 으로 예측한다.
+
+enum COST_STAGE
+{
+    COST_STAGE_DECODE = 0,
+    COST_STAGE_ENCODE,
+    COST_STAGE_OTHER,       // 적응형 품질 분석 + 품질 검증
+    COST_STAGE_COUNT
+};
+
+const char* GetCostStageString(COST_STAGE eStage);
+
+struct CostFeatures
+{
+    bool bConvertible = true;   // 정상 그레이 JPEG (아니면 비용 0)
+    double fMegapixels = 0.0;
+    double fInputMB = 0.0;      // 압축 크기: 엔트로피 디코딩 양, 내용 복잡도의 대리값
+    bool bProgressive = false;
+
+    static CostFeatures FromScan(const JpegScanInfo& info, uint64_t nFileSize);
+    // 헤더 색인이 없을 때 변환 결과로 (progressive 여부는 모름)
+    static CostFeatures FromResult(const ConvertResult& result);
+};
+
+struct CostPrediction
+{
+    double fStageSec[COST_STAGE_COUNT] = {};
+
+    double GetTotalSec() const { return fStageSec[COST_STAGE_DECODE] + fStageSec[COST_STAGE_ENCODE] + fStageSec[COST_STAGE_OTHER]; }
+};
+
+// 특정 시점의 계수 사본. 잠금 없이 여러 파일을 예측할 때 (남은 작업 합산 등)
+struct CostCoefficients
+{
+    static const int FEATURE_COUNT = 4;     // 1, MP, MP(progressive), MB
+    double fBeta[COST_STAGE_COUNT][FEATURE_COUNT] = {};
+
+    CostPrediction Predict(const CostFeatures& features) const;
+};
+
+struct CostModelStats
+{
+    uint64_t nObserved = 0;
+    double fAbsErrorSec = 0.0;  // 관측 직전 예측과 실제 작업 시간의 차이 합
+    double fActualSec = 0.0;
+
+    // 실제 작업 시간 대비 예측 오차 (가중 평균 절대 백분율 오차, 0.1 = 10%)
+    double GetRelativeError() const { return (fActualSec > 0.0) ? fAbsErrorSec / fActualSec : 0.0; }
+};
+
+// 남은 작업과 도착 예정 시간
+//   fEtaSec = 남은 예측 작업 × (경과 시간 / 끝난 항목의 예측 작업). 같은 모델로 끝난 쪽과 남은 쪽을 재므로
+//   모델이 전체적으로 빠르거나 느리게 예측해도 상쇄되고, 병렬도/입출력 대기도 실측 비율에 들어간다.
+//   아직 끝난 항목이 없으면 남은 작업을 작업자 수로 나눈다.
+struct RemainingEstimate
+{
+    double fRemainingWorkSec = 0.0;     // 남은 파일의 예측 작업 시간 합 (작업자 시간)
+    double fEtaSec = -1.0;              // 남은 벽시계 시간 (-1 = 모름)
+};
+
+RemainingEstimate EstimateRemaining(double fRemainingWorkSec, double fDoneWorkSec, double fElapsedSec, int nWorkers);
+
+class CostModel
+{
+public:
+    static const double DECAY;      // 관측마다 이전 통계에 곱하는 값 (유효 표본 수 ≒ 1 / (1 - DECAY))
+    static const double RIDGE;      // 사전값 쪽으로 당기는 세기 (관측 몇 개 분량)
+
+    CostModel();
+
+    // 스레드 안전
+    CostPrediction Predict(const CostFeatures& features) const;
+    CostCoefficients GetCoefficients() const;
+
+    // 변환에 성공한 항목의 단계 시간으로 갱신한다. (실패 항목은 무시)
+    void Observe(const CostFeatures& features, const ConvertResult& result);
+
+    CostModelStats GetStats() const;
+
+    // 설정 키가 같은 저장 파일만 불러온다. 없거나 다르면 false (사전값으로 시작)
+    bool Load(const std::string& strPath, const std::string& strSettings);
+    bool Save(const std::string& strPath, const std::string& strSettings) const;
+
+private:
+    void Solve();   // m_mutex 를 잡은 상태에서 계수를 다시 계산
+
+    static const int N = CostCoefficients::FEATURE_COUNT;
+
+    mutable std::mutex m_mutex;
+    double m_fGram[N][N] = {};                      // Σ decay^k · x xᵀ (특징은 단계와 무관해서 하나)
+    double m_fMoment[COST_STAGE_COUNT][N] = {};     // Σ decay^k · x y
+    CostCoefficients m_prior;
+    CostCoefficients m_coefficients;
+    CostModelStats m_stats;
+};
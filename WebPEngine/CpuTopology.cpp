@@ -0,0 +1,311 @@
+﻿#include "CpuTopology.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    template <typename F>
+    int CountDistinct(const std::vector<CpuInfo>& vecCpu, F getKey)
+    {
+        std::set<int> setKey;
+        for (const auto& cpu : vecCpu)
+            setKey.insert(getKey(cpu));
+        return static_cast<int>(setKey.size());
+    }
+
+    // 읽지 못했을 때: 노드/소켓/L3 하나, 코어마다 스레드 하나
+    std::vector<CpuInfo> MakeFlatTopology()
+    {
+        const int nCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<CpuInfo> vecCpu(static_cast<size_t>(nCount));
+        for (int i = 0; i < nCount; ++i)
+        {
+            vecCpu[i].nCpu = i;
+            vecCpu[i].nGroupCpu = i;
+            vecCpu[i].nCore = i;
+        }
+        return vecCpu;
+    }
+
+#ifdef _WIN32
+    // 그룹 마스크의 각 비트 -> (그룹, 그룹 안 번호) 를 키로 CPU 를 찾는다.
+    template <typename F>
+    void ForEachCpuInMask(const GROUP_AFFINITY& mask, F func)
+    {
+        for (int nBit = 0; nBit < static_cast<int>(sizeof(KAFFINITY) * 8); ++nBit)
+        {
+            if (mask.Mask & (static_cast<KAFFINITY>(1) << nBit))
+                func(static_cast<int>(mask.Group), nBit);
+        }
+    }
+
+    std::vector<CpuInfo> ReadTopology()
+    {
+        DWORD nLength = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &nLength);
+        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || nLength == 0)
+            return std::vector<CpuInfo>();
+
+        std::vector<uint8_t> vecBuffer(nLength);
+        auto* pFirst = reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(vecBuffer.data());
+        if (!GetLogicalProcessorInformationEx(RelationAll, pFirst, &nLength))
+            return std::vector<CpuInfo>();
+
+        std::map<std::pair<int, int>, CpuInfo> mapCpu;   // (그룹, 그룹 안 번호) -> CPU
+        int nCore = 0, nPackage = 0, nL3 = 0;
+
+        for (DWORD nOffset = 0; nOffset < nLength;)
+        {
+            const auto* pInfo = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(vecBuffer.data() + nOffset);
+            switch (pInfo->Relationship)
+            {
+            case RelationProcessorCore:
+            {
+                bool bFirst = true;
+                ForEachCpuInMask(pInfo->Processor.GroupMask[0], [&](int nGroup, int nGroupCpu)
+                {
+                    CpuInfo& cpu = mapCpu[{ nGroup, nGroupCpu }];
+                    cpu.nGroup = nGroup;
+                    cpu.nGroupCpu = nGroupCpu;
+                    cpu.nCore = nCore;
+                    cpu.bPrimary = bFirst;
+                    bFirst = false;
+                });
+                ++nCore;
+                break;
+            }
+            case RelationProcessorPackage:
+                for (WORD g = 0; g < pInfo->Processor.GroupCount; ++g)
+                    ForEachCpuInMask(pInfo->Processor.GroupMask[g], [&](int nGroup, int nGroupCpu) { mapCpu[{ nGroup, nGroupCpu }].nPackage = nPackage; });
+                ++nPackage;
+                break;
+            case RelationNumaNode:
+                ForEachCpuInMask(pInfo->NumaNode.GroupMask, [&](int nGroup, int nGroupCpu) { mapCpu[{ nGroup, nGroupCpu }].nNode = static_cast<int>(pInfo->NumaNode.NodeNumber); });
+                break;
+            case RelationCache:
+                if (pInfo->Cache.Level == 3)
+                {
+                    ForEachCpuInMask(pInfo->Cache.GroupMask, [&](int nGroup, int nGroupCpu) { mapCpu[{ nGroup, nGroupCpu }].nL3 = nL3; });
+                    ++nL3;
+                }
+                break;
+            default:
+                break;
+            }
+            nOffset += pInfo->Size;
+        }
+
+        std::vector<CpuInfo> vecCpu;
+        for (auto& item : mapCpu)
+        {
+            item.second.nCpu = static_cast<int>(vecCpu.size());
+            vecCpu.push_back(item.second);
+        }
+        return vecCpu;
+    }
+#else
+    // "0-3,8-11" -> { 0, 1, 2, 3, 8, 9, 10, 11 }
+    std::vector<int> ParseCpuList(const std::string& strList)
+    {
+        std::vector<int> vecCpu;
+        std::stringstream ss(strList);
+        std::string strRange;
+        while (std::getline(ss, strRange, ','))
+        {
+            if (strRange.empty())
+                continue;
+            const size_t nDash = strRange.find('-');
+            const int nFirst = std::atoi(strRange.c_str());
+            const int nLast = (nDash == std::string::npos) ? nFirst : std::atoi(strRange.c_str() + nDash + 1);
+            for (int nCpu = nFirst; nCpu <= nLast; ++nCpu)
+                vecCpu.push_back(nCpu);
+        }
+        return vecCpu;
+    }
+
+    bool ReadLine(const std::string& strPath, std::string& strLine)
+    {
+        std::ifstream file(strPath);
+        return file && std::getline(file, strLine);
+    }
+
+    std::vector<CpuInfo> ReadTopology()
+    {
+        const std::string strBase = "/sys/devices/system/cpu/";
+        std::string strLine;
+        if (!ReadLine(strBase + "online", strLine))
+            return std::vector<CpuInfo>();
+
+        std::map<int, CpuInfo> mapCpu;
+        std::map<std::pair<int, int>, int> mapCore;     // (소켓, core_id) -> 전체 코어 번호
+        for (int nCpu : ParseCpuList(strLine))
+        {
+            const std::string strCpu = strBase + "cpu" + std::to_string(nCpu) + "/";
+            CpuInfo cpu;
+            cpu.nCpu = nCpu;
+            cpu.nGroupCpu = nCpu;
+            cpu.nL3 = -1;
+
+            if (ReadLine(strCpu + "topology/physical_package_id", strLine))
+                cpu.nPackage = std::max(0, std::atoi(strLine.c_str()));
+
+            int nCoreId = nCpu;
+            if (ReadLine(strCpu + "topology/core_id", strLine))
+                nCoreId = std::atoi(strLine.c_str());
+            auto itCore = mapCore.find({ cpu.nPackage, nCoreId });
+            cpu.bPrimary = itCore == mapCore.end();
+            cpu.nCore = cpu.bPrimary ? static_cast<int>(mapCore.size()) : itCore->second;
+            if (cpu.bPrimary)
+                mapCore[{ cpu.nPackage, nCoreId }] = cpu.nCore;
+
+            // L3 영역 번호 = 그 캐시를 공유하는 CPU 중 가장 작은 번호
+            for (int nIndex = 0; nIndex < 8; ++nIndex)
+            {
+                const std::string strCache = strCpu + "cache/index" + std::to_string(nIndex) + "/";
+                if (!ReadLine(strCache + "level", strLine))
+                    break;
+                if (std::atoi(strLine.c_str()) == 3 && ReadLine(strCache + "shared_cpu_list", strLine))
+                {
+                    const std::vector<int> vecShared = ParseCpuList(strLine);
+                    cpu.nL3 = vecShared.empty() ? nCpu : *std::min_element(vecShared.begin(), vecShared.end());
+                }
+            }
+            mapCpu[nCpu] = cpu;
+        }
+
+        // NUMA 노드 (없으면 모두 0)
+        for (int nNode = 0; nNode < 1024; ++nNode)
+        {
+            if (!ReadLine("/sys/devices/system/node/node" + std::to_string(nNode) + "/cpulist", strLine))
+            {
+                if (nNode > 0)
+                    break;
+                continue;
+            }
+            for (int nCpu : ParseCpuList(strLine))
+            {
+                auto it = mapCpu.find(nCpu);
+                if (it != mapCpu.end())
+                    it->second.nNode = nNode;
+            }
+        }
+
+        // L3 정보가 없으면 소켓 단위로 본다.
+        std::vector<CpuInfo> vecCpu;
+        for (auto& item : mapCpu)
+        {
+            if (item.second.nL3 < 0)
+                item.second.nL3 = -1 - item.second.nPackage;
+            vecCpu.push_back(item.second);
+        }
+        return vecCpu;
+    }
+#endif
+}
+
+CpuTopology CpuTopology::Detect()
+{
+    std::vector<CpuInfo> vecCpu = ReadTopology();
+    if (vecCpu.empty())
+        vecCpu = MakeFlatTopology();
+    return CpuTopology(std::move(vecCpu));
+}
+
+int CpuTopology::GetNodeCount() const
+{
+    return CountDistinct(m_vecCpu, [](const CpuInfo& cpu) { return cpu.nNode; });
+}
+
+int CpuTopology::GetPackageCount() const
+{
+    return CountDistinct(m_vecCpu, [](const CpuInfo& cpu) { return cpu.nPackage; });
+}
+
+int CpuTopology::GetCoreCount() const
+{
+    return CountDistinct(m_vecCpu, [](const CpuInfo& cpu) { return cpu.nCore; });
+}
+
+int CpuTopology::GetL3Count() const
+{
+    return CountDistinct(m_vecCpu, [](const CpuInfo& cpu) { return cpu.nL3; });
+}
+
+std::vector<CpuInfo> CpuTopology::PlanWorkers(int nWorkerCount) const
+{
+    // L3 영역별 CPU 목록 (물리 코어의 첫 스레드 먼저, SMT 형제는 뒤에)
+    std::map<int, std::vector<CpuInfo>> mapDomain;
+    std::map<int, int> mapDomainNode;
+    for (const auto& cpu : m_vecCpu)
+    {
+        mapDomain[cpu.nL3].push_back(cpu);
+        mapDomainNode[cpu.nL3] = cpu.nNode;
+    }
+    for (auto& item : mapDomain)
+        std::stable_sort(item.second.begin(), item.second.end(), [](const CpuInfo& a, const CpuInfo& b) { return a.bPrimary && !b.bPrimary; });
+
+    // 노드가 번갈아 나오도록 영역 순서를 정한다. (노드 0 의 첫 영역, 노드 1 의 첫 영역, 노드 0 의 두 번째 영역 ...)
+    std::map<int, std::vector<int>> mapNodeDomains;
+    for (const auto& item : mapDomainNode)
+        mapNodeDomains[item.second].push_back(item.first);
+
+    std::vector<const std::vector<CpuInfo>*> vecDomain;
+    for (size_t nRound = 0; vecDomain.size() < mapDomain.size(); ++nRound)
+    {
+        for (const auto& item : mapNodeDomains)
+        {
+            if (nRound < item.second.size())
+                vecDomain.push_back(&mapDomain[item.second[nRound]]);
+        }
+    }
+
+    // 영역을 차례로 돌며 하나씩 배정 (영역 안 다음 CPU)
+    std::vector<CpuInfo> vecPlan;
+    std::vector<size_t> vecNext(vecDomain.size(), 0);
+    for (int i = 0; i < nWorkerCount && !vecDomain.empty(); ++i)
+    {
+        const size_t nDomain = static_cast<size_t>(i) % vecDomain.size();
+        const std::vector<CpuInfo>& vecCpu = *vecDomain[nDomain];
+        vecPlan.push_back(vecCpu[vecNext[nDomain]++ % vecCpu.size()]);
+    }
+    return vecPlan;
+}
+
+std::string CpuTopology::ToString() const
+{
+    std::ostringstream oss;
+    oss << "nodes=" << GetNodeCount() << " packages=" << GetPackageCount() << " cores=" << GetCoreCount()
+        << " cpus=" << m_vecCpu.size() << " l3=" << GetL3Count();
+    return oss.str();
+}
+
+bool PinCurrentThread(const CpuInfo& cpu)
+{
+#ifdef _WIN32
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = static_cast<WORD>(cpu.nGroup);
+    affinity.Mask = static_cast<KAFFINITY>(1) << cpu.nGroupCpu;
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu.nCpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
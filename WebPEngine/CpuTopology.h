@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+// CPU 토폴로지 (NUMA 노드 / 소켓 / 물리 코어 / L3 공유 영역) 와 작업자 고정(pinning)
+//   Linux 는 sysfs(/sys/devices/system/{cpu,node}), Windows 는 GetLogicalProcessorInformationEx 로 읽는다.
+//   읽지 못하면 노드 하나, L3 하나에 하드웨어 스레드 수만큼의 CPU 로 본다.
+//
+//   작업자는 이미지 하나를 헤더 -> 디코딩 -> 인코딩까지 한 스레드에서 처리하므로, 작업자를 코어 하나에 고정하면
+//   한 이미지의 단계가 같은 L2/L3 에 머문다. 스레드별 평면 버퍼는 고정된 뒤 그 스레드가 처음 쓰면서 할당되므로
+//   (first-touch) 작업자가 있는 노드의 메모리에 잡힌다.
+
+struct CpuInfo
+{
+    int nCpu = 0;           // OS 의 논리 CPU 번호 (Windows: 그룹 안 번호는 nGroupCpu)
+    int nGroup = 0;         // Windows 프로세서 그룹 (Linux 는 0)
+    int nGroupCpu = 0;
+    int nNode = 0;          // NUMA 노드
+    int nPackage = 0;       // 소켓
+    int nCore = 0;          // 물리 코어 (전체에서 고유)
+    int nL3 = 0;            // L3 를 공유하는 CPU 묶음 (전체에서 고유)
+    bool bPrimary = true;   // 코어의 첫 번째 하드웨어 스레드 (SMT 형제가 아님)
+};
+
+class CpuTopology
+{
+public:
+    CpuTopology() {}
+    explicit CpuTopology(std::vector<CpuInfo> vecCpu) : m_vecCpu(std::move(vecCpu)) {}   // 테스트/고정 배치용
+
+    static CpuTopology Detect();
+
+    const std::vector<CpuInfo>& GetCpus() const { return m_vecCpu; }
+    int GetNodeCount() const;
+    int GetPackageCount() const;
+    int GetCoreCount() const;
+    int GetL3Count() const;
+
+    // 작업자 nWorkerCount 개를 놓을 CPU 순서
+    //   L3 영역들을 노드가 번갈아 나오게 늘어놓고 작업자를 차례로 나눈다. 영역 안에서는 물리 코어를 먼저 쓰고
+    //   SMT 형제는 코어가 모자랄 때만 쓴다. CPU 보다 작업자가 많으면 처음부터 다시 돈다.
+    std::vector<CpuInfo> PlanWorkers(int nWorkerCount) const;
+
+    // "nodes=2 packages=2 cores=32 cpus=64 l3=4"
+    std::string ToString() const;
+
+private:
+    std::vector<CpuInfo> m_vecCpu;
+};
+
+// 현재 스레드를 그 CPU 하나에서만 돌게 한다. 실패하면 false (권한/컨테이너 제한 등)
+bool PinCurrentThread(const CpuInfo& cpu);
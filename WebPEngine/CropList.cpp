@@ -0,0 +1,84 @@
+﻿#include "CropList.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // '\\' 와 '/' 를 같은 구분자로 보고 마지막 경로 요소를 돌려준다.
+    std::string GetFileName(const std::string& strName)
+    {
+        const size_t nSlash = strName.find_last_of("/\\");
+        return (nSlash == std::string::npos) ? strName : strName.substr(nSlash + 1);
+    }
+}
+
+bool CropList::ParseRegion(const std::string& strText, JpegRegion& region)
+{
+    int nX = 0, nY = 0, nWidth = 0, nHeight = 0;
+    char chExtra = 0;
+    if (std::sscanf(strText.c_str(), "%d,%d,%d,%d%c", &nX, &nY, &nWidth, &nHeight, &chExtra) != 4)
+        return false;
+
+    if (nX < 0 || nY < 0 || nWidth <= 0 || nHeight <= 0)
+        return false;
+
+    region.nX = nX;
+    region.nY = nY;
+    region.nWidth = nWidth;
+    region.nHeight = nHeight;
+    return true;
+}
+
+bool CropList::Load(const std::string& strPath)
+{
+    std::ifstream file(strPath);
+    if (!file)
+    {
+        std::cerr << "Error: crop 목록을 열지 못했습니다: " << strPath << "\n";
+        return false;
+    }
+
+    std::string strLine;
+    int nLine = 0;
+    while (std::getline(file, strLine))
+    {
+        ++nLine;
+        if (!strLine.empty() && strLine.back() == '\r')
+            strLine.pop_back();
+        if (strLine.empty() || strLine[0] == '#')
+            continue;
+
+        // 이름에 ',' 가 들어갈 수 있으므로 뒤에서 네 번째 ',' 로 나눈다.
+        size_t nComma = strLine.size();
+        for (int i = 0; i < 4 && nComma != std::string::npos && nComma > 0; ++i)
+            nComma = strLine.rfind(',', nComma - 1);
+
+        JpegRegion region;
+        if (nComma == std::string::npos || nComma == 0 || !ParseRegion(strLine.substr(nComma + 1), region))
+        {
+            std::cerr << "Error: crop 목록 형식 오류 (" << strPath << ":" << nLine << "): " << strLine << "\n";
+            return false;
+        }
+
+        Add(strLine.substr(0, nComma), region);
+    }
+    return true;
+}
+
+void CropList::Add(const std::string& strName, const JpegRegion& region)
+{
+    m_mapRegion[strName] = region;
+}
+
+bool CropList::Find(const std::string& strName, JpegRegion& region) const
+{
+    auto it = m_mapRegion.find(strName);
+    if (it == m_mapRegion.end())
+        it = m_mapRegion.find(GetFileName(strName));
+    if (it == m_mapRegion.end())
+        return false;
+
+    region = it->second;
+    return true;
+}
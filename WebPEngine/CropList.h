@@ -0,0 +1,25 @@
+﻿#pragma once
+
+#include "DecoderBackend.h"
+#include <string>
+#include <unordered_map>
+
+// 파일별 잘라내기 영역 목록
+//   텍스트 한 줄에 "이름,x,y,w,h". '#' 으로 시작하는 줄과 빈 줄은 무시한다.
+//   이름은 입력 항목 이름(경로/아카이브 멤버)과 정확히 같거나 파일 이름만 같으면 일치한다.
+class CropList
+{
+public:
+    bool Load(const std::string& strPath);
+
+    void Add(const std::string& strName, const JpegRegion& region);
+    bool Find(const std::string& strName, JpegRegion& region) const;
+
+    size_t GetCount() const { return m_mapRegion.size(); }
+
+    // "x,y,w,h" -> region
+    static bool ParseRegion(const std::string& strText, JpegRegion& region);
+
+private:
+    std::unordered_map<std::string, JpegRegion> m_mapRegion;
+};
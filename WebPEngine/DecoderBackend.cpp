@@ -0,0 +1,99 @@
+﻿#include "DecoderBackend.h"
+#include <cstring>
+#include <map>
+#include <mutex>
+
+const char* const DecoderRegistry::DEFAULT_DECODER = "turbojpeg";
+
+namespace
+{
+    struct RegistryData
+    {
+        std::mutex mutex;
+        std::map<std::string, DecoderFactory> mapFactory;
+
+        RegistryData()
+        {
+            mapFactory[DecoderRegistry::DEFAULT_DECODER] = CreateTurboJpegDecoder;
+#ifdef WEBP_USE_NVJPEG
+            mapFactory["nvjpeg"] = CreateNvJpegDecoder;
+#endif
+        }
+    };
+
+    RegistryData& GetRegistry()
+    {
+        static RegistryData registry;
+        return registry;
+    }
+}
+
+bool IDecoderBackend::DecodeRegion(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, const JpegRegion& region, DecodePlanes& planes)
+{
+    // 전체 프레임 임시 버퍼는 스레드마다 재사용
+    thread_local std::vector<uint8_t> vecFrame;
+    vecFrame.resize(static_cast<size_t>(header.nWidth) * static_cast<size_t>(header.nHeight));
+
+    DecodePlanes framePlanes;
+    framePlanes.pY = vecFrame.data();
+    framePlanes.nYStride = header.nWidth;
+    if (!DecodeInto(pJpegData, nJpegSize, header, framePlanes))
+        return false;
+
+    for (int y = 0; y < region.nHeight; ++y)
+    {
+        const uint8_t* pSrc = vecFrame.data() + static_cast<size_t>(region.nY + y) * header.nWidth + region.nX;
+        std::memcpy(planes.pY + static_cast<size_t>(y) * planes.nYStride, pSrc, static_cast<size_t>(region.nWidth));
+    }
+    return true;
+}
+
+void DecoderRegistry::Register(const std::string& strName, DecoderFactory pfnFactory)
+{
+    RegistryData& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.mapFactory[strName] = pfnFactory;
+}
+
+bool DecoderRegistry::Has(const std::string& strName)
+{
+    RegistryData& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.mapFactory.count(strName) != 0;
+}
+
+std::vector<std::string> DecoderRegistry::GetNames()
+{
+    RegistryData& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::vector<std::string> vecName;
+    for (const auto& entry : registry.mapFactory)
+        vecName.push_back(entry.first);
+    return vecName;
+}
+
+std::unique_ptr<IDecoderBackend> DecoderRegistry::Create(const std::string& strName)
+{
+    DecoderFactory pfnFactory = nullptr;
+    {
+        RegistryData& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto it = registry.mapFactory.find(strName);
+        if (it != registry.mapFactory.end())
+            pfnFactory = it->second;
+    }
+
+    return pfnFactory ? pfnFactory() : nullptr;
+}
+
+IDecoderBackend* GetThreadDecoder(const std::string& strName)
+{
+    // 생성에 실패한 이름도 nullptr 로 기억해서 매번 다시 초기화하지 않는다.
+    thread_local std::map<std::string, std::unique_ptr<IDecoderBackend>> mapDecoder;
+
+    auto it = mapDecoder.find(strName);
+    if (it == mapDecoder.end())
+        it = mapDecoder.emplace(strName, DecoderRegistry::Create(strName)).first;
+    return it->second.get();
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// JPEG 디코더 백엔드 인터페이스와 등록부
+//   변환 경로(ConvertEngine)는 Probe() 로 헤더를 읽고 DecodeInto() 로 미리 준비한 평면에 디코딩한다.
+//   백엔드마다 변환 루프를 복사하지 않고, 여기 등록만 하면 모든 경로(GUI/CLI/서버)에서 선택할 수 있다.
+
+// 크로마 서브샘플링 (값은 TurboJPEG 의 TJSAMP_* 와 같다)
+enum JPEG_SUBSAMP
+{
+    JPEG_SUBSAMP_444 = 0,
+    JPEG_SUBSAMP_422,
+    JPEG_SUBSAMP_420,
+    JPEG_SUBSAMP_GRAY,
+    JPEG_SUBSAMP_440,
+    JPEG_SUBSAMP_411,
+    JPEG_SUBSAMP_UNKNOWN = -1
+};
+
+struct JpegHeader
+{
+    int nWidth = 0;
+    int nHeight = 0;
+    int nSubSampling = JPEG_SUBSAMP_UNKNOWN;
+};
+
+// 원본 좌표계의 사각 영역. 폭이나 높이가 0 이면 전체 이미지
+struct JpegRegion
+{
+    int nX = 0;
+    int nY = 0;
+    int nWidth = 0;
+    int nHeight = 0;
+
+    bool IsFull() const { return nWidth <= 0 || nHeight <= 0; }
+};
+
+// 디코딩 대상 평면 (호출자가 할당). 지금 변환 경로는 Y(그레이) 평면만 사용한다.
+struct DecodePlanes
+{
+    uint8_t* pY = nullptr;
+    int nYStride = 0;
+};
+
+// 백엔드 인스턴스는 한 스레드에서만 사용된다. (GetThreadDecoder 가 스레드마다 만든다)
+class IDecoderBackend
+{
+public:
+    virtual ~IDecoderBackend() {}
+
+    virtual const char* GetName() const = 0;
+
+    // 헤더만 파싱해서 크기/서브샘플링을 얻는다.
+    virtual bool Probe(const uint8_t* pJpegData, size_t nJpegSize, JpegHeader& header) = 0;
+
+    // header 크기의 full-range Y 평면을 planes 에 디코딩한다.
+    virtual bool DecodeInto(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, DecodePlanes& planes) = 0;
+
+    // 이미지 안쪽으로 검증된 region 만 planes 에 디코딩한다. (planes 는 region 크기)
+    // 기본 구현은 전체를 디코딩한 뒤 잘라낸다. 부분 디코딩을 지원하는 백엔드는 재정의해서 필요한 MCU 만 디코딩한다.
+    virtual bool DecodeRegion(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, const JpegRegion& region, DecodePlanes& planes);
+};
+
+using DecoderFactory = std::unique_ptr<IDecoderBackend>(*)();
+
+class DecoderRegistry
+{
+public:
+    static const char* const DEFAULT_DECODER;   // "turbojpeg" (항상 등록됨)
+
+    // 같은 이름으로 다시 등록하면 덮어쓴다.
+    static void Register(const std::string& strName, DecoderFactory pfnFactory);
+    static bool Has(const std::string& strName);
+    static std::vector<std::string> GetNames();
+
+    // 등록되지 않은 이름이거나 백엔드 초기화(예: GPU 없음)에 실패하면 nullptr
+    static std::unique_ptr<IDecoderBackend> Create(const std::string& strName);
+};
+
+// 현재 스레드 전용 백엔드 인스턴스 (처음 요청할 때 생성해서 스레드가 끝날 때까지 재사용). 실패하면 nullptr
+IDecoderBackend* GetThreadDecoder(const std::string& strName);
+
+// 기본 제공 백엔드
+std::unique_ptr<IDecoderBackend> CreateTurboJpegDecoder();
+
+#ifdef WEBP_USE_NVJPEG
+// nvJPEG 백엔드는 CUDA 가 있는 빌드에서만 컴파일된다. (NvJpegDecoder.cpp + nvjpeg.lib/cudart.lib 링크)
+std::unique_ptr<IDecoderBackend> CreateNvJpegDecoder();
+#endif
@@ -0,0 +1,239 @@
+﻿#include "EncoderSweep.h"
+#include "JobPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <ostream>
+#include <sstream>
+
+namespace
+{
+    // (설정, 이미지) 하나의 측정값
+    struct SweepSample
+    {
+        bool bOk = false;
+        size_t nBytes = 0;
+        double fEncodeMs = 0.0;
+        QualityScore score;
+    };
+
+    void WriteJsonString(std::ostream& os, const std::string& strValue)
+    {
+        os << '"';
+        for (char ch : strValue)
+        {
+            if (ch == '"' || ch == '\\')
+                os << '\\';
+            os << ch;
+        }
+        os << '"';
+    }
+
+    // a 가 b 를 지배: 모든 축에서 같거나 낫고 한 축 이상에서 엄격히 낫다.
+    bool Dominates(const SweepRow& a, const SweepRow& b)
+    {
+        const bool bNoWorse = a.fEncodeMs <= b.fEncodeMs && a.nBytes <= b.nBytes && a.fMeanPsnr >= b.fMeanPsnr;
+        const bool bBetter = a.fEncodeMs < b.fEncodeMs || a.nBytes < b.nBytes || a.fMeanPsnr > b.fMeanPsnr;
+        return bNoWorse && bBetter;
+    }
+}
+
+std::string SweepPoint::ToString() const
+{
+    std::ostringstream os;
+    os << "quality=" << fQuality;
+    const std::string strParams = params.ToString();
+    if (!strParams.empty())
+        os << ';' << strParams;
+    return os.str();
+}
+
+bool SweepGrid::Parse(const std::string& strGrid)
+{
+    std::vector<std::pair<std::string, std::vector<double>>> vecAxis;
+    std::stringstream ssAxis(strGrid);
+    std::string strAxis;
+    while (std::getline(ssAxis, strAxis, ';'))
+    {
+        if (strAxis.empty())
+            continue;
+
+        const size_t nEq = strAxis.find('=');
+        if (nEq == std::string::npos || nEq == 0)
+            return false;
+
+        const std::string strKey = strAxis.substr(0, nEq);
+        std::vector<double> vecValue;
+        std::stringstream ssValue(strAxis.substr(nEq + 1));
+        std::string strValue;
+        while (std::getline(ssValue, strValue, ','))
+        {
+            char* pszEnd = nullptr;
+            const double fValue = std::strtod(strValue.c_str(), &pszEnd);
+            if (strValue.empty() || *pszEnd != '\0')
+                return false;
+
+            // 값 범위는 여기서 확인해서 잘못된 격자를 실행 전에 거른다.
+            EncoderParams check;
+            if (strKey == "quality" ? (fValue < 0.0 || fValue > 100.0) : !check.Set(strKey, static_cast<int>(fValue)))
+                return false;
+            vecValue.push_back(fValue);
+        }
+
+        if (vecValue.empty())
+            return false;
+        vecAxis.emplace_back(strKey, std::move(vecValue));
+    }
+
+    if (vecAxis.empty())
+        return false;
+
+    m_vecAxis = std::move(vecAxis);
+    return true;
+}
+
+std::vector<SweepPoint> SweepGrid::Expand() const
+{
+    std::vector<SweepPoint> vecPoint(1);
+    for (const auto& axis : m_vecAxis)
+    {
+        std::vector<SweepPoint> vecNext;
+        vecNext.reserve(vecPoint.size() * axis.second.size());
+        for (const auto& point : vecPoint)
+        {
+            for (double fValue : axis.second)
+            {
+                SweepPoint next = point;
+                if (axis.first == "quality")
+                    next.fQuality = static_cast<float>(fValue);
+                else
+                    next.params.Set(axis.first, static_cast<int>(fValue));
+                vecNext.push_back(next);
+            }
+        }
+        vecPoint.swap(vecNext);
+    }
+    return vecPoint;
+}
+
+std::vector<SweepRow> RunEncoderSweep(const ConvertEngine& engine, const std::vector<SweepImage>& vecImage, const std::vector<SweepPoint>& vecPoint,
+                                      const VerifyOption& measure, JobPool& pool)
+{
+    const size_t nImages = vecImage.size();
+    const size_t nTasks = nImages * vecPoint.size();
+    std::vector<SweepSample> vecSample(nTasks);
+    std::atomic<size_t> nNext{ 0 };
+
+    // 작업자마다 공유 인덱스에서 다음 (설정, 이미지) 를 가져간다. 조합마다 작업을 만들지 않음
+    auto worker = [&]()
+    {
+        ConvertOption option = engine.GetOption();
+        std::vector<uint8_t> vecWebp;
+        for (size_t nTask = nNext.fetch_add(1); nTask < nTasks; nTask = nNext.fetch_add(1))
+        {
+            const SweepPoint& point = vecPoint[nTask / nImages];
+            const SweepImage& image = vecImage[nTask % nImages];
+            option.encoder = point.params;
+
+            vecWebp.clear();
+            CONVERT_STATUS eStatus = CONVERT_OK;
+            const auto startTime = std::chrono::steady_clock::now();
+            const bool bEncoded = engine.EncodeGray(image.vecY.data(), image.nWidth, image.nWidth, image.nHeight, point.fQuality, option, vecWebp, eStatus);
+            const auto endTime = std::chrono::steady_clock::now();
+
+            SweepSample& sample = vecSample[nTask];
+            if (!bEncoded)
+                continue;
+
+            sample.nBytes = vecWebp.size();
+            sample.fEncodeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+            sample.bOk = ConvertEngine::MeasureWebp(vecWebp.data(), vecWebp.size(), image.vecY.data(), image.nWidth, image.nHeight, measure, sample.score);
+        }
+    };
+
+    std::vector<std::future<void>> vecDone;
+    for (int i = 0; i < pool.getTotalWorkerCount(); ++i)
+        vecDone.push_back(pool.enqueue(worker));
+    for (auto& done : vecDone)
+        done.get();
+
+    std::vector<SweepRow> vecRow(vecPoint.size());
+    for (size_t p = 0; p < vecPoint.size(); ++p)
+    {
+        SweepRow& row = vecRow[p];
+        row.point = vecPoint[p];
+        double fPsnrSum = 0.0, fSsimSum = 0.0;
+        for (size_t i = 0; i < nImages; ++i)
+        {
+            const SweepSample& sample = vecSample[p * nImages + i];
+            if (!sample.bOk)
+            {
+                ++row.nFailed;
+                continue;
+            }
+
+            row.fMinPsnr = (row.nImages == 0) ? sample.score.fPsnr : std::min(row.fMinPsnr, sample.score.fPsnr);
+            ++row.nImages;
+            row.nBytes += sample.nBytes;
+            row.fEncodeMs += sample.fEncodeMs;
+            fPsnrSum += sample.score.fPsnr;
+            fSsimSum += sample.score.fSsim;
+        }
+
+        if (row.nImages > 0)
+        {
+            row.fMeanPsnr = fPsnrSum / static_cast<double>(row.nImages);
+            row.fMeanSsim = fSsimSum / static_cast<double>(row.nImages);
+        }
+    }
+
+    MarkParetoFrontier(vecRow);
+    return vecRow;
+}
+
+void MarkParetoFrontier(std::vector<SweepRow>& vecRow)
+{
+    // 실패가 있는 설정은 크기/시간 합이 작게 나와 유리해 보이므로 경계 후보에서 뺀다.
+    for (auto& row : vecRow)
+    {
+        row.bPareto = row.nFailed == 0 && row.nImages > 0;
+        for (const auto& other : vecRow)
+        {
+            if (!row.bPareto)
+                break;
+            if (&other != &row && other.nFailed == 0 && other.nImages > 0 && Dominates(other, row))
+                row.bPareto = false;
+        }
+    }
+}
+
+void WriteSweepCsv(std::ostream& os, const std::vector<SweepRow>& vecRow)
+{
+    os << "quality,method,filter_strength,sns_strength,segments,pass,thread_level,images,failed,bytes,encode_ms,mean_psnr,min_psnr,mean_ssim,pareto\n";
+    for (const auto& row : vecRow)
+    {
+        const EncoderParams& params = row.point.params;
+        os << row.point.fQuality << ',' << params.nMethod << ',' << params.nFilterStrength << ',' << params.nSnsStrength << ','
+            << params.nSegments << ',' << params.nPass << ',' << params.nThreadLevel << ',' << row.nImages << ',' << row.nFailed << ','
+            << row.nBytes << ',' << row.fEncodeMs << ',' << row.fMeanPsnr << ',' << row.fMinPsnr << ',' << row.fMeanSsim << ','
+            << (row.bPareto ? 1 : 0) << '\n';
+    }
+}
+
+void WriteSweepJson(std::ostream& os, const std::vector<SweepRow>& vecRow)
+{
+    os << "[\n";
+    for (size_t i = 0; i < vecRow.size(); ++i)
+    {
+        const SweepRow& row = vecRow[i];
+        os << "  {\"config\": ";
+        WriteJsonString(os, row.point.ToString());
+        os << ", \"images\": " << row.nImages << ", \"failed\": " << row.nFailed << ", \"bytes\": " << row.nBytes
+            << ", \"encode_ms\": " << row.fEncodeMs << ", \"mean_psnr\": " << row.fMeanPsnr << ", \"min_psnr\": " << row.fMinPsnr
+            << ", \"mean_ssim\": " << row.fMeanSsim << ", \"pareto\": " << (row.bPareto ? "true" : "false") << "}"
+            << (i + 1 < vecRow.size() ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "ConvertEngine.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class JobPool;
+
+// 인코더 설정 비교 (파라미터 격자 x 코퍼스)
+//   JPEG 은 한 번만 디코딩해서 평면을 보관하고, 격자의 모든 설정을 같은 평면으로 병렬 인코딩한다.
+//   설정마다 인코딩 시간 합 / 출력 크기 합 / 평균 PSNR 을 모으고, 세 축의 파레토 경계를 표시한다.
+
+// 격자 한 점 = 인코더 설정 + 품질
+struct SweepPoint
+{
+    EncoderParams params;
+    float fQuality = 80.0f;
+
+    std::string ToString() const;   // "quality=80;method=4;..."
+};
+
+// "quality=75,85;method=2,4,6;sns_strength=50,80" 형식의 격자
+//   ';' 로 축을 나누고 ',' 로 값을 나열한다. 키는 quality 와 EncoderParams 의 키. 점 개수 = 값 개수의 곱
+class SweepGrid
+{
+public:
+    bool Parse(const std::string& strGrid);
+    std::vector<SweepPoint> Expand() const;
+
+private:
+    std::vector<std::pair<std::string, std::vector<double>>> m_vecAxis;
+};
+
+// 디코딩해 둔 limited-range Y 평면 (stride = nWidth)
+struct SweepImage
+{
+    std::string strName;
+    int nWidth = 0;
+    int nHeight = 0;
+    std::vector<uint8_t> vecY;
+};
+
+struct SweepRow
+{
+    SweepPoint point;
+    uint64_t nImages = 0;       // 인코딩 성공 수
+    uint64_t nFailed = 0;
+    uint64_t nBytes = 0;        // 출력 크기 합
+    double fEncodeMs = 0.0;     // 이미지별 인코딩 시간 합 (작업자 시간)
+    double fMeanPsnr = 0.0;
+    double fMinPsnr = 0.0;
+    double fMeanSsim = 0.0;
+    bool bPareto = false;       // 시간/크기/PSNR 어느 축으로도 더 나은 다른 설정이 없음
+};
+
+// 모든 (설정, 이미지) 조합을 pool 에서 인코딩하고 설정별로 모은다. measure 로 PSNR 표본 타일을 줄일 수 있다.
+std::vector<SweepRow> RunEncoderSweep(const ConvertEngine& engine, const std::vector<SweepImage>& vecImage, const std::vector<SweepPoint>& vecPoint,
+                                      const VerifyOption& measure, JobPool& pool);
+
+// 시간 최소 / 크기 최소 / PSNR 최대 기준으로 지배되지 않는 행에 bPareto 를 표시한다.
+void MarkParetoFrontier(std::vector<SweepRow>& vecRow);
+
+void WriteSweepCsv(std::ostream& os, const std::vector<SweepRow>& vecRow);
+void WriteSweepJson(std::ostream& os, const std::vector<SweepRow>& vecRow);
@@ -0,0 +1,189 @@
+﻿#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include "Logger.h"
+#include "OutputWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+bool IsJpegFileName(const std::string& strName)
+{
+    const size_t nDot = strName.rfind('.');
+    if (nDot == std::string::npos)
+        return false;
+
+    std::string strExt = strName.substr(nDot + 1);
+    std::transform(strExt.begin(), strExt.end(), strExt.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return strExt == "jpg" || strExt == "jpeg";
+}
+
+std::vector<std::string> ListJpegFiles(const std::string& strFolder, bool bRecursive)
+{
+    std::vector<std::string> vecPath;
+    std::error_code ec;
+
+    auto add = [&](const fs::directory_entry& entry)
+    {
+        if (entry.is_regular_file(ec) && IsJpegFileName(entry.path().filename().string()))
+            vecPath.push_back(entry.path().string());
+    };
+
+    if (bRecursive)
+    {
+        for (fs::recursive_directory_iterator it(strFolder, ec), end; !ec && it != end; it.increment(ec))
+            add(*it);
+    }
+    else
+    {
+        for (fs::directory_iterator it(strFolder, ec), end; !ec && it != end; it.increment(ec))
+            add(*it);
+    }
+
+    std::sort(vecPath.begin(), vecPath.end());
+    return vecPath;
+}
+
+bool FileListSource::Next(InputItem& item)
+{
+    while (m_nIndex < m_vecPath.size())
+    {
+        const std::string& strPath = m_vecPath[m_nIndex++];
+        if (ReadFileToMemory(strPath, item.vecData))
+        {
+            item.strName = strPath;
+            if (!m_strInputRoot.empty())
+                item.strOutputName = MakeInputRelativePath(m_strInputRoot, strPath);
+            return true;
+        }
+
+        ++m_nReadFail;
+        LogError("read", "JPEG 파일을 읽지 못했습니다: " + strPath);
+    }
+    return false;
+}
+
+std::string MakeSafeRelativePath(const std::string& strName)
+{
+    // 루트("/", "C:\")를 떼고 "." 은 건너뛴다. ".." 이 하나라도 있으면 거부
+    fs::path relative;
+    for (const auto& part : fs::path(strName).relative_path())
+    {
+        const std::string strPart = part.string();
+        if (strPart.empty() || strPart == ".")
+            continue;
+        if (strPart == "..")
+            return std::string();
+        relative /= part;
+    }
+    return relative.string();
+}
+
+namespace
+{
+    fs::path GetAbsoluteInputPath(const std::string& strPath)
+    {
+        std::error_code ec;
+        const fs::path absolute = fs::absolute(strPath, ec);
+        return (ec ? fs::path(strPath) : absolute).lexically_normal();
+    }
+}
+
+std::string FindInputRoot(const std::vector<std::string>& vecDirectory)
+{
+    fs::path root;
+    bool bFirst = true;
+    for (const auto& strDirectory : vecDirectory)
+    {
+        fs::path directory = GetAbsoluteInputPath(strDirectory);
+        if (directory.filename().empty())
+            directory = directory.parent_path(); // "in/" -> "in"
+
+        if (bFirst)
+        {
+            root = directory;
+            bFirst = false;
+            continue;
+        }
+
+        fs::path common;
+        for (auto itRoot = root.begin(), itDir = directory.begin(); itRoot != root.end() && itDir != directory.end() && *itRoot == *itDir; ++itRoot, ++itDir)
+            common /= *itRoot;
+        root = common;
+    }
+    return root.string();
+}
+
+std::string MakeInputRelativePath(const std::string& strRoot, const std::string& strPath)
+{
+    fs::path relative;
+    if (!strRoot.empty())
+        relative = GetAbsoluteInputPath(strPath).lexically_relative(strRoot);
+    if (relative.empty() || *relative.begin() == "..")
+        relative = fs::path(strPath).filename();
+    return relative.string();
+}
+
+std::string DirectorySink::MakeOutputPath(const std::string& strName) const
+{
+    // 원본 옆에 쓰는 것은 사용자가 준 경로(FileListSource)일 때만 의미가 있다. 아카이브 멤버는 원천에서 이미 정리되고,
+    // 명령행에서는 아카이브 입력에 --out 을 요구한다.
+    if (m_strOutDir.empty())
+        return ConvertEngine::MakeOutputPath(strName);
+
+    const std::string strRelative = MakeSafeRelativePath(strName);
+    if (strRelative.empty())
+        return std::string();
+
+    return ConvertEngine::MakeOutputPath((fs::path(m_strOutDir) / strRelative).string());
+}
+
+bool DirectorySink::Write(OutputItem& item)
+{
+    if (!item.bOk)
+    {
+        LogError("convert", std::string("변환 실패 (") + GetConvertStatusString(item.result.eStatus) + "): " + item.strName);
+        return true; // 항목 실패는 출력 오류가 아님
+    }
+
+    const std::string strOutPath = MakeOutputPath((m_strOutDir.empty() || item.strOutputName.empty()) ? item.strName : item.strOutputName);
+    if (strOutPath.empty())
+    {
+        ++m_nWriteFail;
+        LogError("write", "허용되지 않는 출력 경로: " + item.strName);
+        return true;
+    }
+
+    // 뒤쓰기: 폴더 생성과 쓰기 모두 쓰기 스레드에서 한다.
+    if (m_pWriter)
+    {
+        m_pWriter->Submit(strOutPath, std::move(item.vecWebp));
+        return true;
+    }
+
+    if (!m_strOutDir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(fs::path(strOutPath).parent_path(), ec);
+    }
+
+    if (!WriteMemoryToFile(strOutPath, item.vecWebp.data(), item.vecWebp.size()))
+    {
+        ++m_nWriteFail;
+        LogError("write", "결과 파일 저장 실패: " + strOutPath);
+    }
+    return true;
+}
+
+bool DirectorySink::Finish()
+{
+    if (m_pWriter)
+        m_pWriter->Finish();
+    return true; // 파일별 쓰기 실패는 GetWriteFailCount 로 따로 센다.
+}
+
+uint64_t DirectorySink::GetWriteFailCount() const
+{
+    return m_nWriteFail + (m_pWriter ? m_pWriter->GetStats().nFailed : 0);
+}
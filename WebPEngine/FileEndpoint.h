@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+
+class OutputWriter;
+
+// 파일 시스템 기반 파이프라인 원천/대상
+
+// 경로 목록을 순서대로 읽는 원천
+//   SetInputRoot 로 입력 기준 폴더를 주면 출력 이름(strOutputName)을 그 기준 상대 경로로 채운다.
+//   (사용자가 준 경로에는 "../" 나 절대 경로가 들어 있어서 그대로 출력 폴더 아래에 붙일 수 없다)
+class FileListSource : public IInputSource
+{
+public:
+    explicit FileListSource(const std::vector<std::string>& vecPath) : m_vecPath(vecPath) {}
+
+    void SetInputRoot(const std::string& strRoot) { m_strInputRoot = strRoot; }
+
+    bool Next(InputItem& item) override;
+
+    uint64_t GetReadFailCount() const { return m_nReadFail; }
+
+private:
+    std::vector<std::string> m_vecPath;
+    std::string m_strInputRoot;
+    size_t m_nIndex = 0;
+    uint64_t m_nReadFail = 0;
+};
+
+// 결과를 .webp 파일로 쓰는 대상
+//   strOutDir 가 비어 있으면 원본 옆에 "<이름>.webp" 로 쓰고,
+//   지정되면 strOutDir 아래에 출력 이름(없으면 아카이브 멤버 경로 등 항목 이름)을 상대 경로로 유지해서 쓴다.
+//   SetOutputWriter 로 뒤쓰기를 연결하면 Write 는 버퍼를 넘기기만 하고, Finish 에서 남은 파일을 모두 쓴다.
+class DirectorySink : public IOutputSink
+{
+public:
+    explicit DirectorySink(const std::string& strOutDir = std::string()) : m_strOutDir(strOutDir) {}
+
+    void SetOutputWriter(OutputWriter* pWriter) { m_pWriter = pWriter; }
+
+    bool Write(OutputItem& item) override;
+    bool Finish() override;
+
+    // 뒤쓰기를 쓰면 Finish 이후에 쓰기 스레드의 실패까지 합친 값
+    uint64_t GetWriteFailCount() const;
+
+    // 항목 이름 -> 출력 경로. ".." 이나 절대 경로로 strOutDir 밖에 쓰는 것을 막는다. 실패 시 빈 문자열
+    std::string MakeOutputPath(const std::string& strName) const;
+
+private:
+    std::string m_strOutDir;
+    OutputWriter* m_pWriter = nullptr;
+    uint64_t m_nWriteFail = 0;
+};
+
+// 폴더에서 *.jpg / *.jpeg 파일 목록 수집 (bRecursive 면 하위 폴더 포함, 이름순 정렬)
+std::vector<std::string> ListJpegFiles(const std::string& strFolder, bool bRecursive);
+
+bool IsJpegFileName(const std::string& strName);
+
+// 항목 이름(아카이브 멤버 경로 등)을 출력 폴더 아래에 붙일 수 있는 상대 경로로 정리한다.
+// 루트/드라이브는 떼고, ".." 이 들어 있거나 남는 것이 없으면 빈 문자열
+std::string MakeSafeRelativePath(const std::string& strName);
+
+// 입력 폴더들(파일 입력이면 그 상위 폴더)의 공통 상위 폴더를 절대 경로로. 드라이브가 다르면 빈 문자열
+std::string FindInputRoot(const std::vector<std::string>& vecDirectory);
+
+// strPath 의 strRoot 기준 상대 경로. strRoot 가 비었거나 그 밖에 있으면 파일 이름만
+std::string MakeInputRelativePath(const std::string& strRoot, const std::string& strPath);
@@ -0,0 +1,468 @@
+﻿#include "JobManager.h"
+#include "CorpusIndex.h"
+#include "FileEndpoint.h"
+#include "JobPool.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <numeric>
+
+namespace fs = std::filesystem;
+
+struct JobState
+{
+    uint64_t nJobId = 0;
+    JobRequest request;
+    ConvertEngine engine;
+    std::chrono::steady_clock::time_point startTime;
+    std::string strInputRoot; // strOutDir 이면 입력들의 공통 상위 폴더. 출력은 여기 기준 상대 경로를 유지한다.
+
+    std::atomic<bool> bCancel{ false };
+    std::atomic<bool> bExpired{ false };
+    std::atomic<bool> bDone{ false };
+    std::atomic<int> eFinalState{ JOB_DONE };
+
+    std::atomic<size_t> nNextIndex{ 0 };    // 다음에 가져갈 파일 번호
+    std::atomic<size_t> nRemaining{ 0 };    // 아직 결과가 정해지지 않은 파일 수 (0 이 되면 작업 종료)
+    std::atomic<size_t> nConverted{ 0 };
+    std::atomic<size_t> nFailed{ 0 };
+    std::atomic<size_t> nDropped{ 0 };
+    std::atomic<uint64_t> nInputBytes{ 0 };
+    std::atomic<uint64_t> nOutputBytes{ 0 };
+    std::atomic<int64_t> nLastReportNs{ 0 };
+
+    // bEstimateCost: 헤더는 묶음별로 여러 작업자가 나눠 읽어서 vecFeature 의 자기 구간을 채우고,
+    // 마지막 묶음이 정렬한 뒤 bPlanned. 그 뒤로 vecFeature 는 바뀌지 않는다. (vecPath 와 같은 순서)
+    std::shared_ptr<CostModel> pCostModel;
+    int nWorkerCount = 1;
+    std::atomic<size_t> nPlanChunksLeft{ 0 };
+    std::atomic<bool> bPlanned{ false };
+    std::vector<CostFeatures> vecFeature;
+    std::unique_ptr<std::atomic<bool>[]> pFinished;     // 파일별 처리 완료 (성공/실패/취소)
+    std::chrono::steady_clock::time_point runStartTime; // 헤더 읽기가 끝나고 변환을 시작한 시각
+
+    std::mutex mutexReport;     // 진행 콜백은 한 번에 하나씩만 호출
+    std::mutex mutexFailure;
+    std::vector<JobFailure> vecFailure;
+
+    std::promise<JobResult> promise;
+    std::shared_future<JobResult> future;
+
+    JobProgress Snapshot() const
+    {
+        JobProgress progress;
+        progress.nJobId = nJobId;
+        progress.nTotal = request.vecPath.size();
+        progress.nConverted = nConverted.load();
+        progress.nFailed = nFailed.load();
+        progress.nDropped = nDropped.load();
+        progress.nProcessed = progress.nConverted + progress.nFailed;
+        progress.nInputBytes = nInputBytes.load();
+        progress.nOutputBytes = nOutputBytes.load();
+        progress.fElapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        if (bDone.load())
+            progress.eState = static_cast<JOB_STATE>(eFinalState.load());
+        else if (progress.nProcessed + progress.nDropped == 0 && nNextIndex.load() == 0)
+            progress.eState = JOB_QUEUED;
+        else
+            progress.eState = JOB_RUNNING;
+
+        if (bPlanned.load(std::memory_order_acquire))
+            FillEstimate(progress);
+        return progress;
+    }
+
+    // 지금 계수로 끝난 파일과 남은 파일의 예측 작업을 다시 합산한다. (파일당 내적 몇 번이라 진행 보고마다 해도 싸다)
+    void FillEstimate(JobProgress& progress) const
+    {
+        if (progress.eState >= JOB_DONE)
+        {
+            progress.fRemainingWorkSec = 0.0;
+            progress.fEtaSec = 0.0;
+            return;
+        }
+
+        const CostCoefficients coefficients = pCostModel->GetCoefficients();
+        double fDoneSec = 0.0;
+        double fRemainingSec = 0.0;
+        for (size_t i = 0; i < vecFeature.size(); ++i)
+        {
+            const double fSec = coefficients.Predict(vecFeature[i]).GetTotalSec();
+            if (pFinished[i].load(std::memory_order_relaxed))
+                fDoneSec += fSec;
+            else
+                fRemainingSec += fSec;
+        }
+
+        const double fRunSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStartTime).count();
+        const RemainingEstimate estimate = EstimateRemaining(fRemainingSec, fDoneSec, fRunSec, nWorkerCount);
+        progress.fRemainingWorkSec = estimate.fRemainingWorkSec;
+        progress.fEtaSec = estimate.fEtaSec;
+    }
+};
+
+namespace
+{
+    const size_t PLAN_CHUNK_FILES = 64;    // 헤더 읽기를 작업자에게 한 번에 넘기는 파일 수 (CorpusIndex 와 같은 단위)
+
+    int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 진행 콜백 간격 제한: 간격이 지났고 CAS 에 이긴 스레드 하나만 보고한다.
+    void ReportProgress(JobState& state)
+    {
+        if (!state.request.onProgress)
+            return;
+
+        const int64_t nNow = NowNs();
+        int64_t nLast = state.nLastReportNs.load(std::memory_order_relaxed);
+        const int64_t nInterval = std::chrono::duration_cast<std::chrono::nanoseconds>(state.request.progressInterval).count();
+        if (nNow - nLast < nInterval)
+            return;
+        if (!state.nLastReportNs.compare_exchange_strong(nLast, nNow, std::memory_order_relaxed))
+            return;
+
+        std::lock_guard<std::mutex> lock(state.mutexReport);
+        if (!state.bDone.load()) // 마지막 보고 뒤에 중간 보고가 오지 않도록
+            state.request.onProgress(state.Snapshot());
+    }
+
+    void Finalize(JobState& state)
+    {
+        JOB_STATE eState = JOB_DONE;
+        if (state.bCancel.load())
+            eState = JOB_CANCELLED;
+        else if (state.bExpired.load())
+            eState = JOB_EXPIRED;
+
+        state.eFinalState = eState;
+        {
+            std::lock_guard<std::mutex> lock(state.mutexReport);
+            state.bDone = true;
+        }
+
+        JobResult result;
+        result.progress = state.Snapshot();
+        {
+            std::lock_guard<std::mutex> lock(state.mutexFailure);
+            result.vecFailure = state.vecFailure;
+        }
+
+        // 마지막 보고는 간격과 관계없이 항상 호출
+        if (state.request.onProgress)
+        {
+            std::lock_guard<std::mutex> lock(state.mutexReport);
+            state.request.onProgress(result.progress);
+        }
+
+        state.promise.set_value(std::move(result));
+    }
+
+    void CompleteItems(JobState& state, size_t nCount)
+    {
+        if (nCount > 0 && state.nRemaining.fetch_sub(nCount) == nCount)
+            Finalize(state);
+    }
+
+    // 아직 시작하지 않은 파일을 모두 버린다. (취소 / 마감 초과)
+    void DropRemaining(JobState& state)
+    {
+        const size_t nTotal = state.request.vecPath.size();
+        const size_t nIndex = state.nNextIndex.exchange(nTotal);
+        if (nIndex >= nTotal)
+            return;
+
+        state.nDropped += nTotal - nIndex;
+        CompleteItems(state, nTotal - nIndex);
+    }
+
+    // 파일 이름만 쓰면 a/x.jpg 와 b/x.jpg 가 같은 출력이 되므로 입력 공통 폴더 기준 상대 경로를 유지한다.
+    std::string MakeJobOutputPath(const std::string& strOutDir, const std::string& strInputRoot, const std::string& strInPath)
+    {
+        const std::string strOutPath = ConvertEngine::MakeOutputPath(strInPath);
+        if (strOutDir.empty())
+            return strOutPath;
+
+        return (fs::path(strOutDir) / MakeInputRelativePath(strInputRoot, strOutPath)).string();
+    }
+}
+
+const char* GetJobStateString(JOB_STATE eState)
+{
+    switch (eState)
+    {
+    case JOB_QUEUED:    return "queued";
+    case JOB_RUNNING:   return "running";
+    case JOB_DONE:      return "done";
+    case JOB_CANCELLED: return "cancelled";
+    case JOB_EXPIRED:   return "expired";
+    default:            return "unknown";
+    }
+}
+
+uint64_t JobHandle::GetId() const
+{
+    return m_pState ? m_pState->nJobId : 0;
+}
+
+void JobHandle::Cancel()
+{
+    if (m_pState)
+        m_pState->bCancel = true;
+}
+
+JobProgress JobHandle::GetProgress() const
+{
+    return m_pState ? m_pState->Snapshot() : JobProgress();
+}
+
+bool JobHandle::IsDone() const
+{
+    return m_pState && m_pState->bDone.load();
+}
+
+std::shared_future<JobResult> JobHandle::GetFuture() const
+{
+    return m_pState ? m_pState->future : std::shared_future<JobResult>();
+}
+
+JobManager::JobManager(std::shared_ptr<JobPool> pJobPool)
+    : m_pJobPool(std::move(pJobPool)), m_pCostModel(std::make_shared<CostModel>())
+{
+}
+
+JobManager::~JobManager()
+{
+    CancelAll();
+}
+
+JobHandle JobManager::Submit(JobRequest request)
+{
+    auto pState = std::make_shared<JobState>();
+    pState->request = std::move(request);
+    pState->request.option.pCancelFlag = &pState->bCancel;
+    pState->engine.SetOption(pState->request.option);
+    pState->startTime = std::chrono::steady_clock::now();
+    pState->nRemaining = pState->request.vecPath.size();
+    pState->future = pState->promise.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pState->nJobId = m_nNextJobId++;
+
+        // 끝난 작업은 목록에서 정리
+        m_vecJob.erase(std::remove_if(m_vecJob.begin(), m_vecJob.end(), [](const std::weak_ptr<JobState>& pJob) { return pJob.expired(); }), m_vecJob.end());
+        m_vecJob.push_back(pState);
+    }
+
+    if (pState->request.vecPath.empty())
+    {
+        Finalize(*pState);
+        return JobHandle(pState);
+    }
+
+    if (!pState->request.strOutDir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(pState->request.strOutDir, ec);
+        std::vector<std::string> vecDirectory;
+        for (const auto& strPath : pState->request.vecPath)
+        {
+            std::string strDirectory = fs::path(strPath).parent_path().string();
+            if (vecDirectory.empty() || vecDirectory.back() != strDirectory)
+                vecDirectory.push_back(std::move(strDirectory));
+        }
+        pState->strInputRoot = FindInputRoot(vecDirectory);
+    }
+
+    // 비용 예측은 헤더를 모두 읽은 뒤에 조각을 넣는다. 헤더 읽기도 작업자들이 묶음으로 나눠 해서 Submit 은 바로 반환한다.
+    if (pState->request.bEstimateCost)
+    {
+        pState->pCostModel = m_pCostModel;
+        pState->nWorkerCount = std::max(m_pJobPool->getTotalWorkerCount(), 1);
+
+        const size_t nCount = pState->request.vecPath.size();
+        pState->vecFeature.resize(nCount);
+        pState->nPlanChunksLeft = (nCount + PLAN_CHUNK_FILES - 1) / PLAN_CHUNK_FILES;
+        std::vector<std::function<void()>> vecJob;
+        for (size_t nBegin = 0; nBegin < nCount; nBegin += PLAN_CHUNK_FILES)
+        {
+            const size_t nEnd = std::min(nCount, nBegin + PLAN_CHUNK_FILES);
+            vecJob.push_back([this, pState, nBegin, nEnd]() { ScanHeaders(pState, nBegin, nEnd); });
+        }
+        m_pJobPool->pushBatch(std::move(vecJob), pState->request.ePriority);
+        return JobHandle(pState);
+    }
+
+    ScheduleSlices(pState);
+    return JobHandle(pState);
+}
+
+void JobManager::CancelAll()
+{
+    std::vector<std::shared_ptr<JobState>> vecLive;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& pJob : m_vecJob)
+        {
+            if (auto pState = pJob.lock())
+                vecLive.push_back(pState);
+        }
+        m_vecJob.clear();
+    }
+
+    for (const auto& pState : vecLive)
+        pState->bCancel = true;
+
+    for (const auto& pState : vecLive)
+        pState->future.wait();
+}
+
+void JobManager::ScanHeaders(const std::shared_ptr<JobState>& pState, size_t nBegin, size_t nEnd)
+{
+    JobState& state = *pState;
+    for (size_t i = nBegin; i < nEnd && !state.bCancel.load(); ++i)
+    {
+        const std::string& strPath = state.request.vecPath[i];
+        std::error_code ec;
+        const uint64_t nFileSize = fs::file_size(strPath, ec);
+        state.vecFeature[i] = CostFeatures::FromScan(ScanJpegFile(strPath), ec ? 0 : nFileSize);
+    }
+
+    // 마지막으로 끝난 묶음이 정렬과 조각 배치를 맡는다. (acq_rel: 다른 묶음이 채운 vecFeature 가 보인다)
+    if (state.nPlanChunksLeft.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        PlanJob(pState);
+}
+
+void JobManager::PlanJob(const std::shared_ptr<JobState>& pState)
+{
+    JobState& state = *pState;
+    if (state.bCancel.load())
+    {
+        DropRemaining(state);
+        return;
+    }
+
+    std::vector<std::string>& vecPath = state.request.vecPath;
+    std::vector<CostFeatures> vecFeature;
+    vecFeature.swap(state.vecFeature);
+
+    if (state.request.bLargestFirst)
+    {
+        // 예측 비용 내림차순 (같으면 입력 순서 유지)
+        const CostCoefficients coefficients = state.pCostModel->GetCoefficients();
+        std::vector<double> vecCost(vecFeature.size());
+        for (size_t i = 0; i < vecFeature.size(); ++i)
+            vecCost[i] = coefficients.Predict(vecFeature[i]).GetTotalSec();
+
+        std::vector<size_t> vecOrder(vecFeature.size());
+        std::iota(vecOrder.begin(), vecOrder.end(), 0);
+        std::stable_sort(vecOrder.begin(), vecOrder.end(), [&](size_t a, size_t b) { return vecCost[a] > vecCost[b]; });
+
+        std::vector<std::string> vecSortedPath;
+        std::vector<CostFeatures> vecSortedFeature;
+        vecSortedPath.reserve(vecOrder.size());
+        vecSortedFeature.reserve(vecOrder.size());
+        for (size_t nIndex : vecOrder)
+        {
+            vecSortedPath.push_back(std::move(vecPath[nIndex]));
+            vecSortedFeature.push_back(vecFeature[nIndex]);
+        }
+        vecPath.swap(vecSortedPath);
+        vecFeature.swap(vecSortedFeature);
+    }
+
+    state.vecFeature.swap(vecFeature);
+    state.pFinished.reset(new std::atomic<bool>[vecPath.size()]);
+    for (size_t i = 0; i < vecPath.size(); ++i)
+        state.pFinished[i] = false;
+    state.runStartTime = std::chrono::steady_clock::now();
+    state.bPlanned.store(true, std::memory_order_release);
+
+    ScheduleSlices(pState);
+}
+
+void JobManager::ScheduleSlices(const std::shared_ptr<JobState>& pState)
+{
+    // 작업자 수만큼 조각(slice)을 넣는다. 조각은 파일 몇 개를 처리하고 큐 뒤로 다시 들어간다.
+    const size_t nSlice = std::min(pState->request.vecPath.size(), static_cast<size_t>(m_pJobPool->getTotalWorkerCount()));
+    for (size_t i = 0; i < nSlice; ++i)
+        ScheduleSlice(pState);
+}
+
+void JobManager::ScheduleSlice(const std::shared_ptr<JobState>& pState)
+{
+    m_pJobPool->push([this, pState]() { RunSlice(pState); }, pState->request.ePriority);
+}
+
+void JobManager::RunSlice(const std::shared_ptr<JobState>& pState)
+{
+    JobState& state = *pState;
+    const std::vector<std::string>& vecPath = state.request.vecPath;
+
+    for (size_t n = 0; n < FILES_PER_SLICE; ++n)
+    {
+        // 취소되었거나 마감이 지난 작업의 남은 파일은 시작하지 않고 버린다.
+        if (state.bCancel.load())
+        {
+            DropRemaining(state);
+            return;
+        }
+        if (std::chrono::steady_clock::now() >= state.request.deadline)
+        {
+            state.bExpired = true;
+            DropRemaining(state);
+            return;
+        }
+
+        const size_t nIndex = state.nNextIndex.fetch_add(1);
+        if (nIndex >= vecPath.size())
+            return;
+
+        const std::string& strInPath = vecPath[nIndex];
+        ConvertResult result;
+        const std::string strOutPath = MakeJobOutputPath(state.request.strOutDir, state.strInputRoot, strInPath);
+        if (!state.request.strOutDir.empty())
+        {
+            std::error_code ec;
+            fs::create_directories(fs::path(strOutPath).parent_path(), ec);
+        }
+
+        const bool bConverted = state.engine.ConvertFile(strInPath, strOutPath, result);
+        if (state.pCostModel)
+        {
+            state.pCostModel->Observe(state.vecFeature[nIndex], result);
+            state.pFinished[nIndex].store(true, std::memory_order_relaxed);
+        }
+
+        if (bConverted)
+        {
+            ++state.nConverted;
+            state.nInputBytes += result.nInputSize;
+            state.nOutputBytes += result.nOutputSize;
+        }
+        else if (result.eStatus == CONVERT_ERR_CANCELLED)
+        {
+            ++state.nDropped;
+        }
+        else
+        {
+            ++state.nFailed;
+            std::lock_guard<std::mutex> lock(state.mutexFailure);
+            if (state.vecFailure.size() < MAX_FAILURE_RECORDS)
+                state.vecFailure.push_back(JobFailure{ strInPath, result.eStatus });
+        }
+
+        CompleteItems(state, 1);
+        if (state.bDone.load())
+            return;
+
+        ReportProgress(state);
+    }
+
+    if (state.nNextIndex.load() < vecPath.size())
+        ScheduleSlice(pState);
+}
@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include "ConvertEngine.h"
+#include "CostModel.h"
+#include "JobPool.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 비동기 변환 작업(job) API
+//   Submit() 은 바로 반환하고, 작업은 공유 JobPool 에서 파일 단위로 진행된다.
+//   GUI 는 진행 콜백과 Cancel() 을, 헤드리스 호출자는 future 를 사용한다.
+
+enum JOB_STATE
+{
+    JOB_QUEUED = 0,     // 아직 처리된 파일 없음
+    JOB_RUNNING,
+    JOB_DONE,           // 모든 파일 처리 (일부 실패 포함)
+    JOB_CANCELLED,      // Cancel() 로 중단
+    JOB_EXPIRED         // 마감 시각이 지나 남은 파일을 버림
+};
+
+const char* GetJobStateString(JOB_STATE eState);
+
+struct JobProgress
+{
+    uint64_t nJobId = 0;
+    JOB_STATE eState = JOB_QUEUED;
+    size_t nTotal = 0;
+    size_t nProcessed = 0;      // 변환 시도를 마친 파일 수 (성공 + 실패)
+    size_t nConverted = 0;
+    size_t nFailed = 0;
+    size_t nDropped = 0;        // 취소/마감으로 시작도 하지 않은 파일 수
+    uint64_t nInputBytes = 0;
+    uint64_t nOutputBytes = 0;
+    double fElapsedSec = 0.0;
+    double fRemainingWorkSec = -1.0;    // 남은 파일의 예측 작업 시간 합 (bEstimateCost 가 아니거나 헤더를 읽는 중이면 -1)
+    double fEtaSec = -1.0;              // 남은 벽시계 시간 예측 (-1 = 모름)
+};
+
+struct JobFailure
+{
+    std::string strPath;
+    CONVERT_STATUS eStatus = CONVERT_OK;
+};
+
+struct JobResult
+{
+    JobProgress progress;                 // 최종 진행 상태 (eState 는 JOB_DONE/CANCELLED/EXPIRED)
+    std::vector<JobFailure> vecFailure;   // 실패 파일 (최대 MAX_FAILURE_RECORDS 개)
+};
+
+// 진행 콜백은 작업자 스레드에서 한 번에 하나씩 호출된다. (GUI 는 PostMessage 등으로 UI 스레드에 넘겨야 함)
+using JobProgressCallback = std::function<void(const JobProgress&)>;
+
+struct JobRequest
+{
+    std::vector<std::string> vecPath;
+    std::string strOutDir;                                  // 비어 있으면 원본 옆에 .webp 저장. 있으면 입력들의 공통 상위 폴더 기준 하위 경로를 유지
+    ConvertOption option;                                   // pCancelFlag 는 작업이 자체 플래그로 덮어씀
+
+    JobProgressCallback onProgress;
+    std::chrono::milliseconds progressInterval{ 100 };      // 콜백 최소 간격 (마지막 보고는 항상 호출)
+
+    // 이 시각이 지나면 아직 시작하지 않은 파일은 버린다. 기본값 = 마감 없음
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    // 대화형 단건 변환은 HIGH 로 넣어서 진행 중인 대량 작업 뒤에서 기다리지 않게 한다.
+    JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL;
+
+    // 시작 전에 파일 헤더만 읽어서 파일별 비용을 예측하고 (JobManager 의 비용 모델), 진행 상황에 남은 작업/ETA 를 채운다.
+    // 변환이 끝날 때마다 실제 단계 시간으로 모델을 갱신하므로 같은 JobManager 의 다음 작업일수록 예측이 맞는다.
+    bool bEstimateCost = false;
+    // bEstimateCost 일 때 예측 비용이 큰 파일부터 처리한다. (큰 파일 하나가 마지막에 혼자 남아 끝을 늘어뜨리는 것을 줄임)
+    bool bLargestFirst = false;
+};
+
+struct JobState;
+
+class JobHandle
+{
+public:
+    JobHandle() {}
+
+    bool IsValid() const { return m_pState != nullptr; }
+    uint64_t GetId() const;
+
+    // 협조적 취소: 큐에 남은 파일은 버리고, 진행 중인 파일은 다음 단계 경계(또는 인코더 진행 훅)에서 멈춘다.
+    void Cancel();
+
+    JobProgress GetProgress() const;
+    bool IsDone() const;
+
+    std::shared_future<JobResult> GetFuture() const;
+    JobResult Wait() const { return GetFuture().get(); }
+
+private:
+    friend class JobManager;
+    explicit JobHandle(std::shared_ptr<JobState> pState) : m_pState(std::move(pState)) {}
+
+    std::shared_ptr<JobState> m_pState;
+};
+
+class JobManager
+{
+public:
+    static const size_t MAX_FAILURE_RECORDS = 1000;
+    static const size_t FILES_PER_SLICE = 8;    // 작업자가 한 번에 처리하는 파일 수. 끝나면 큐 뒤로 다시 들어가서 작업 간에 번갈아 돈다.
+
+    explicit JobManager(std::shared_ptr<JobPool> pJobPool);
+    ~JobManager();
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    JobHandle Submit(JobRequest request);
+
+    // 진행 중인 모든 작업을 취소하고 끝날 때까지 기다린다.
+    void CancelAll();
+
+    // bEstimateCost 작업이 함께 학습하는 비용 모델
+    const CostModel& GetCostModel() const { return *m_pCostModel; }
+
+private:
+    void ScanHeaders(const std::shared_ptr<JobState>& pState, size_t nBegin, size_t nEnd);
+    void PlanJob(const std::shared_ptr<JobState>& pState);
+    void ScheduleSlices(const std::shared_ptr<JobState>& pState);
+    void ScheduleSlice(const std::shared_ptr<JobState>& pState);
+    void RunSlice(const std::shared_ptr<JobState>& pState);
+
+    std::shared_ptr<JobPool> m_pJobPool;
+    std::mutex m_mutex;
+    std::vector<std::weak_ptr<JobState>> m_vecJob;
+    uint64_t m_nNextJobId = 1;
+    std::shared_ptr<CostModel> m_pCostModel;   // 작업이 JobHandle 을 통해 JobManager 보다 오래 남을 수 있어서 공유
+};
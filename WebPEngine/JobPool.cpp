@@ -0,0 +1,202 @@
+﻿#include "JobPool.h"
+#include "Logger.h"
+#include <algorithm>
+
+const char* GetJobPriorityString(JOB_PRIORITY ePriority)
+{
+    switch (ePriority)
+    {
+    case JOB_PRIORITY_HIGH:   return "high";
+    case JOB_PRIORITY_NORMAL: return "normal";
+    default:                  return "unknown";
+    }
+}
+
+JobPool::JobPool(int nWorkerCount /*= 0*/)
+    : m_nActivatedWorkerCount(0)
+    , m_bStop(false)
+{
+    JobPoolOption option;
+    option.nWorkerCount = nWorkerCount;
+    start(option);
+}
+
+JobPool::JobPool(const JobPoolOption& option)
+    : m_nActivatedWorkerCount(0)
+    , m_bStop(false)
+{
+    start(option);
+}
+
+JobPool::~JobPool()
+{
+    stop();
+}
+
+void JobPool::start(const JobPoolOption& option)
+{
+    int nWorkerCount = option.nWorkerCount;
+    if (nWorkerCount <= 0)
+        nWorkerCount = static_cast<int>(std::thread::hardware_concurrency());
+
+    if (nWorkerCount <= 0)
+        nWorkerCount = 1;
+
+    m_ePolicy = option.ePolicy;
+    m_nHighWeight = std::max(1, option.nHighWeight);
+    m_nReservedHighWorkers = std::max(0, std::min(option.nReservedHighWorkers, nWorkerCount - 1));
+
+    if (option.bPinWorkers)
+        m_vecPlacement = CpuTopology::Detect().PlanWorkers(nWorkerCount);
+
+    m_vecWorkers.reserve(static_cast<size_t>(nWorkerCount));
+    for (int i = 0; i < nWorkerCount; ++i)
+    {
+        const CpuInfo* pCpu = (static_cast<size_t>(i) < m_vecPlacement.size()) ? &m_vecPlacement[i] : nullptr;
+        m_vecWorkers.emplace_back(&JobPool::workerLoop, this, i < m_nReservedHighWorkers, pCpu);
+    }
+}
+
+void JobPool::push(std::function<void()> job, JOB_PRIORITY ePriority /*= JOB_PRIORITY_NORMAL*/)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Lane& lane = m_lane[ePriority];
+        lane.queJob.push_back(QueuedJob{ std::move(job), std::chrono::steady_clock::now() });
+        ++lane.nSubmitted;
+    }
+
+    // HIGH 는 전용 작업자와 일반 작업자 중 먼저 깨어난 쪽이 가져간다. (못 가져간 쪽은 다시 잔다)
+    if (ePriority == JOB_PRIORITY_HIGH && m_nReservedHighWorkers > 0)
+        m_cvHigh.notify_one();
+    m_cvJob.notify_one();
+}
+
+void JobPool::pushBatch(std::vector<std::function<void()>> vecJob, JOB_PRIORITY ePriority /*= JOB_PRIORITY_NORMAL*/)
+{
+    if (vecJob.empty())
+        return;
+
+    const size_t nCount = vecJob.size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Lane& lane = m_lane[ePriority];
+        const auto enqueueTime = std::chrono::steady_clock::now();
+        for (auto& job : vecJob)
+            lane.queJob.push_back(QueuedJob{ std::move(job), enqueueTime });
+        lane.nSubmitted += nCount;
+    }
+
+    if (ePriority == JOB_PRIORITY_HIGH && m_nReservedHighWorkers > 0)
+        m_cvHigh.notify_all();
+    if (nCount == 1)
+        m_cvJob.notify_one();
+    else
+        m_cvJob.notify_all();
+}
+
+void JobPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_bStop)
+            return;
+        m_bStop = true;
+    }
+    m_cvJob.notify_all();
+    m_cvHigh.notify_all();
+
+    for (auto& worker : m_vecWorkers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+int JobPool::getCurrentQueueSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t nSize = 0;
+    for (const auto& lane : m_lane)
+        nSize += lane.queJob.size();
+    return static_cast<int>(nSize);
+}
+
+JobLaneStats JobPool::getLaneStats(JOB_PRIORITY ePriority) const
+{
+    const Lane& lane = m_lane[ePriority];
+    JobLaneStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.nSubmitted = lane.nSubmitted;
+        stats.nQueued = static_cast<int>(lane.queJob.size());
+    }
+    stats.nCompleted = lane.nCompleted.load();
+    stats.queueWait = lane.queueWait.Summarize();
+    stats.total = lane.total.Summarize();
+    return stats;
+}
+
+bool JobPool::hasRunnableLocked(bool bHighOnly) const
+{
+    return !m_lane[JOB_PRIORITY_HIGH].queJob.empty() || (!bHighOnly && !m_lane[JOB_PRIORITY_NORMAL].queJob.empty());
+}
+
+void JobPool::workerLoop(bool bHighOnly, const CpuInfo* pCpu)
+{
+    // 작업 전에 고정해야 이 스레드의 thread_local 버퍼가 처음 쓰일 때 이 CPU 의 노드 메모리에 잡힌다.
+    if (pCpu != nullptr && PinCurrentThread(*pCpu))
+        ++m_nPinnedWorkers;
+
+    std::condition_variable& cvWake = bHighOnly ? m_cvHigh : m_cvJob;
+
+    while (true)
+    {
+        QueuedJob queued;
+        JOB_PRIORITY ePriority = JOB_PRIORITY_HIGH;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            cvWake.wait(lock, [this, bHighOnly]() { return m_bStop || hasRunnableLocked(bHighOnly); });
+
+            if (!hasRunnableLocked(bHighOnly))
+                return; // m_bStop 이고 남은 작업 없음
+
+            // HIGH 를 먼저 꺼낸다. WEIGHTED 이면 NORMAL 이 기다리는 동안 HIGH 를 nHighWeight 개 꺼낼 때마다 NORMAL 하나
+            std::deque<QueuedJob>& queHigh = m_lane[JOB_PRIORITY_HIGH].queJob;
+            std::deque<QueuedJob>& queNormal = m_lane[JOB_PRIORITY_NORMAL].queJob;
+            const bool bTakeHigh = !queHigh.empty()
+                && (bHighOnly || queNormal.empty() || m_ePolicy == LANE_POLICY_STRICT || m_nHighStreak < m_nHighWeight);
+            ePriority = bTakeHigh ? JOB_PRIORITY_HIGH : JOB_PRIORITY_NORMAL;
+
+            if (!bHighOnly)
+                m_nHighStreak = (bTakeHigh && !queNormal.empty()) ? m_nHighStreak + 1 : 0;
+
+            std::deque<QueuedJob>& queJob = bTakeHigh ? queHigh : queNormal;
+            queued = std::move(queJob.front());
+            queJob.pop_front();
+        }
+
+        Lane& lane = m_lane[ePriority];
+        const auto startTime = std::chrono::steady_clock::now();
+        lane.queueWait.Record(std::chrono::duration_cast<std::chrono::microseconds>(startTime - queued.enqueueTime));
+
+        // 작업의 예외가 작업자 밖으로 나가면 std::terminate 로 프로세스가 끝난다. 결과 전달은 작업 쪽 책임이고 여기서는 기록만 한다.
+        ++m_nActivatedWorkerCount;
+        try
+        {
+            queued.job();
+        }
+        catch (const std::exception& e)
+        {
+            LogError("pool", std::string("작업에서 처리되지 않은 예외: ") + e.what());
+        }
+        catch (...)
+        {
+            LogError("pool", "작업에서 처리되지 않은 예외");
+        }
+        --m_nActivatedWorkerCount;
+
+        lane.total.Record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued.enqueueTime));
+        ++lane.nCompleted;
+    }
+}
@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include "CpuTopology.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 작업 우선순위 줄(lane). 대화형 단건 요청은 HIGH, 대량 배치는 NORMAL
+enum JOB_PRIORITY
+{
+    JOB_PRIORITY_HIGH = 0,
+    JOB_PRIORITY_NORMAL,
+    JOB_PRIORITY_COUNT
+};
+
+const char* GetJobPriorityString(JOB_PRIORITY ePriority);
+
+// 두 줄 모두 대기 중일 때 일반 작업자가 고르는 방법
+enum LANE_POLICY
+{
+    LANE_POLICY_STRICT = 0,     // HIGH 가 비어 있을 때만 NORMAL
+    LANE_POLICY_WEIGHTED        // HIGH nHighWeight 개마다 NORMAL 1 개 (NORMAL 기아 방지)
+};
+
+struct JobPoolOption
+{
+    int nWorkerCount = 0;               // 0 이하이면 하드웨어 스레드 수
+    int nReservedHighWorkers = 0;       // HIGH 작업만 처리하는 작업자 수 (NORMAL 용으로 최소 1 개는 남긴다)
+    LANE_POLICY ePolicy = LANE_POLICY_STRICT;
+    int nHighWeight = 4;
+    bool bPinWorkers = false;           // 작업자를 CpuTopology::PlanWorkers 순서대로 CPU 하나씩에 고정
+};
+
+struct JobLaneStats
+{
+    uint64_t nSubmitted = 0;
+    uint64_t nCompleted = 0;
+    int nQueued = 0;
+    LatencySummary queueWait;           // 넣은 시점 -> 작업자가 꺼낸 시점
+    LatencySummary total;               // 넣은 시점 -> 작업 완료
+};
+
+// 고정 크기 작업자 스레드 풀
+// TemplateManager 의 GetCurrentJobQueueSize()/GetActivatedWorkerCount()/GetTotalWorkerCount() 가 이 인터페이스를 사용한다.
+// 큐는 우선순위별로 따로 있고, 줄마다 대기/완료 지연 시간을 기록한다.
+class JobPool
+{
+public:
+    explicit JobPool(int nWorkerCount = 0); // 0 이하이면 하드웨어 스레드 수만큼 생성
+    explicit JobPool(const JobPoolOption& option);
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // 작업을 큐에 넣고 결과 future 를 반환
+    template <typename F>
+    auto enqueue(F&& func, JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL) -> std::future<decltype(func())>
+    {
+        using R = decltype(func());
+        auto pTask = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+        std::future<R> future = pTask->get_future();
+        push([pTask]() { (*pTask)(); }, ePriority);
+        return future;
+    }
+
+    void push(std::function<void()> job, JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL);
+    // 여러 작업을 한 번의 잠금으로 넣고 작업자를 한 번에 깨운다. (micro-batch 처럼 한꺼번에 모인 작업)
+    void pushBatch(std::vector<std::function<void()>> vecJob, JOB_PRIORITY ePriority = JOB_PRIORITY_NORMAL);
+    void stop(); // 남은 작업을 모두 처리한 뒤 작업자 종료
+
+    int getCurrentQueueSize() const;
+    int getActivatedWorkerCount() const { return m_nActivatedWorkerCount.load(); }
+    int getTotalWorkerCount() const { return static_cast<int>(m_vecWorkers.size()); }
+    int getReservedHighWorkerCount() const { return m_nReservedHighWorkers; }
+    int getPinnedWorkerCount() const { return m_nPinnedWorkers.load(); }
+
+    JobLaneStats getLaneStats(JOB_PRIORITY ePriority) const;
+
+private:
+    struct QueuedJob
+    {
+        std::function<void()> job;
+        std::chrono::steady_clock::time_point enqueueTime;
+    };
+
+    struct Lane
+    {
+        std::deque<QueuedJob> queJob;
+        uint64_t nSubmitted = 0;
+        std::atomic<uint64_t> nCompleted{ 0 };
+        LatencyHistogram queueWait;
+        LatencyHistogram total;
+    };
+
+    void start(const JobPoolOption& option);
+    void workerLoop(bool bHighOnly, const CpuInfo* pCpu);
+    bool hasRunnableLocked(bool bHighOnly) const;
+
+    std::vector<std::thread> m_vecWorkers;
+    Lane m_lane[JOB_PRIORITY_COUNT];
+    LANE_POLICY m_ePolicy = LANE_POLICY_STRICT;
+    int m_nHighWeight = 4;
+    int m_nReservedHighWorkers = 0;
+    int m_nHighStreak = 0;              // WEIGHTED: NORMAL 이 기다리는 동안 연속으로 꺼낸 HIGH 수
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvJob;    // 일반 작업자
+    std::condition_variable m_cvHigh;   // HIGH 전용 작업자
+    std::vector<CpuInfo> m_vecPlacement;    // bPinWorkers 일 때 작업자 i 의 CPU
+    std::atomic<int> m_nActivatedWorkerCount;
+    std::atomic<int> m_nPinnedWorkers{ 0 };
+    bool m_bStop;
+};
@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+// 잠금 없는 지연 시간 히스토그램 (µs, 로그 간격 버킷)
+//   버킷 경계가 약 19% 씩 커지므로 백분위 값은 그 정도 오차 안에서 위쪽 경계로 나온다.
+//   Record 는 여러 스레드에서 동시에 불러도 되고, 읽기는 대략적인 스냅샷이다.
+
+struct LatencySummary
+{
+    uint64_t nCount = 0;
+    double fP50Ms = 0.0;
+    double fP99Ms = 0.0;
+    double fMaxMs = 0.0;
+};
+
+class LatencyHistogram
+{
+public:
+    static const int BUCKET_COUNT = 128;    // 1µs .. 약 1시간
+
+    void Record(std::chrono::microseconds duration)
+    {
+        const uint64_t nUs = static_cast<uint64_t>(std::max<int64_t>(0, duration.count()));
+        m_nBucket[GetBucket(nUs)].fetch_add(1, std::memory_order_relaxed);
+        m_nCount.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t nMax = m_nMaxUs.load(std::memory_order_relaxed);
+        while (nUs > nMax && !m_nMaxUs.compare_exchange_weak(nMax, nUs, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    LatencySummary Summarize() const
+    {
+        uint64_t nBucket[BUCKET_COUNT];
+        uint64_t nCount = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i)
+        {
+            nBucket[i] = m_nBucket[i].load(std::memory_order_relaxed);
+            nCount += nBucket[i];
+        }
+
+        LatencySummary summary;
+        summary.nCount = nCount;
+        summary.fMaxMs = static_cast<double>(m_nMaxUs.load(std::memory_order_relaxed)) / 1000.0;
+        summary.fP50Ms = std::min(summary.fMaxMs, GetPercentileUs(nBucket, nCount, 0.50) / 1000.0);
+        summary.fP99Ms = std::min(summary.fMaxMs, GetPercentileUs(nBucket, nCount, 0.99) / 1000.0);
+        return summary;
+    }
+
+private:
+    // 버킷 i 의 위쪽 경계 = 1.1892^i µs (2 의 1/4 제곱씩)
+    static int GetBucket(uint64_t nUs)
+    {
+        if (nUs <= 1)
+            return 0;
+        const int nBucket = static_cast<int>(std::ceil(std::log2(static_cast<double>(nUs)) * 4.0));
+        return std::min(nBucket, BUCKET_COUNT - 1);
+    }
+
+    static double GetPercentileUs(const uint64_t (&nBucket)[BUCKET_COUNT], uint64_t nCount, double fPercentile)
+    {
+        if (nCount == 0)
+            return 0.0;
+
+        const uint64_t nRank = static_cast<uint64_t>(std::ceil(fPercentile * static_cast<double>(nCount)));
+        uint64_t nSeen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i)
+        {
+            nSeen += nBucket[i];
+            if (nSeen >= nRank)
+                return std::pow(2.0, i / 4.0);
+        }
+        return std::pow(2.0, (BUCKET_COUNT - 1) / 4.0);
+    }
+
+    std::atomic<uint64_t> m_nBucket[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> m_nCount{ 0 };
+    std::atomic<uint64_t> m_nMaxUs{ 0 };
+};
@@ -0,0 +1,427 @@
+﻿#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct LogRecord
+    {
+        int64_t nTimeNs = 0;
+        LOG_LEVEL eLevel = LOG_LEVEL_INFO;
+        const char* pszCategory = "";
+        uint32_t nThread = 0;
+        std::string strMessage;
+    };
+
+    // 단일 생산자(소유 스레드) / 단일 소비자(출력 스레드) 링. 가득 차면 생산자는 기다리지 않고 버린다.
+    class LogRing
+    {
+    public:
+        LogRing(size_t nSize, uint32_t nThread) : m_vecSlot(std::max<size_t>(2, nSize)), m_nThread(nThread) {}
+
+        uint32_t GetThread() const { return m_nThread; }
+
+        bool TryPush(LogRecord& record)
+        {
+            const uint64_t nHead = m_nHead.load(std::memory_order_relaxed);
+            if (nHead - m_nTail.load(std::memory_order_acquire) >= m_vecSlot.size())
+            {
+                nDropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_vecSlot[static_cast<size_t>(nHead % m_vecSlot.size())] = std::move(record);
+            m_nHead.store(nHead + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool TryPop(LogRecord& record)
+        {
+            const uint64_t nTail = m_nTail.load(std::memory_order_relaxed);
+            if (nTail == m_nHead.load(std::memory_order_acquire))
+                return false;
+            record = std::move(m_vecSlot[static_cast<size_t>(nTail % m_vecSlot.size())]);
+            m_nTail.store(nTail + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::atomic<bool> bOrphaned{ false };   // 소유 스레드가 끝남 (비면 소비자가 정리)
+        std::atomic<uint64_t> nDropped{ 0 };
+
+    private:
+        std::vector<LogRecord> m_vecSlot;
+        const uint32_t m_nThread;
+        alignas(64) std::atomic<uint64_t> m_nHead{ 0 };    // 생산자만 쓴다
+        alignas(64) std::atomic<uint64_t> m_nTail{ 0 };    // 소비자만 쓴다
+    };
+
+    // 분류별 빈도 제한 (토큰 버킷: 용량 nBurst, 초당 fPerSecond 충전)
+    struct RateBucket
+    {
+        bool bStarted = false;
+        double fTokens = 0.0;
+        int64_t nLastNs = 0;
+        uint64_t nSuppressed = 0;   // 마지막 출력 이후 생략한 수
+    };
+
+    const char* GetLevelName(LOG_LEVEL eLevel)
+    {
+        switch (eLevel)
+        {
+        case LOG_LEVEL_DEBUG:   return "debug";
+        case LOG_LEVEL_INFO:    return "info";
+        case LOG_LEVEL_WARN:    return "warn";
+        case LOG_LEVEL_ERROR:   return "error";
+        default:                return "off";
+        }
+    }
+
+    const char* GetTextPrefix(LOG_LEVEL eLevel)
+    {
+        switch (eLevel)
+        {
+        case LOG_LEVEL_DEBUG:   return "Debug: ";
+        case LOG_LEVEL_INFO:    return "Info: ";
+        case LOG_LEVEL_WARN:    return "Warning: ";
+        default:                return "Error: ";
+        }
+    }
+
+    class LoggerCore
+    {
+    public:
+        static LoggerCore& Get()
+        {
+            static LoggerCore core;
+            return core;
+        }
+
+        std::atomic<int> m_nLevel{ LOG_LEVEL_INFO };
+
+        void Push(LOG_LEVEL eLevel, const char* pszCategory, std::string&& strMessage);
+        void Configure(const LogOption& option);
+        void Flush();
+        LogSummary GetSummary();
+        std::vector<std::pair<std::string, uint64_t>> GetCategoryCounts();
+
+    private:
+        LoggerCore();
+        ~LoggerCore();
+
+        int64_t Now() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+        }
+
+        LogRing* GetThreadRing();
+        void Run();
+        void Drain(const LogOption& option);
+        void Emit(const LogOption& option, const LogRecord& record);
+
+        const std::chrono::steady_clock::time_point m_startTime;
+
+        // 링 목록 (등록/정리할 때만 잠금. 생산자는 스레드마다 한 번만 등록한다)
+        std::mutex m_ringMutex;
+        std::vector<std::unique_ptr<LogRing>> m_vecRing;
+        uint32_t m_nNextThread = 1;
+        size_t m_nRingSize = 1024;
+        uint64_t m_nRetiredDropped = 0;
+
+        // 출력 스레드 제어
+        std::mutex m_mutex;
+        std::condition_variable m_cvWake;
+        std::condition_variable m_cvFlushed;
+        uint64_t m_nFlushRequest = 0;
+        uint64_t m_nFlushDone = 0;
+        bool m_bStop = false;
+        LogOption m_option;
+
+        // 출력 스레드 전용
+        std::map<std::string, RateBucket> m_mapBucket;
+        std::vector<LogRecord> m_vecBatch;
+
+        // 요약 (출력 스레드가 갱신)
+        std::mutex m_summaryMutex;
+        LogSummary m_summary;
+        std::map<std::string, uint64_t> m_mapCategoryCount;   // 경고/오류만
+
+        std::thread m_thread;
+    };
+
+    // 스레드가 끝나면 링을 정리 대상으로 표시한다.
+    struct ThreadRingHandle
+    {
+        LogRing* pRing = nullptr;
+        ~ThreadRingHandle()
+        {
+            if (pRing)
+                pRing->bOrphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadRingHandle t_ring;
+
+    LoggerCore::LoggerCore()
+        : m_startTime(std::chrono::steady_clock::now())
+    {
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    LoggerCore::~LoggerCore()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvWake.notify_one();
+        m_thread.join();
+    }
+
+    LogRing* LoggerCore::GetThreadRing()
+    {
+        if (t_ring.pRing)
+            return t_ring.pRing;
+
+        std::lock_guard<std::mutex> lock(m_ringMutex);
+        std::unique_ptr<LogRing> pRing(new LogRing(m_nRingSize, m_nNextThread++));
+        t_ring.pRing = pRing.get();
+        m_vecRing.push_back(std::move(pRing));
+        return t_ring.pRing;
+    }
+
+    void LoggerCore::Push(LOG_LEVEL eLevel, const char* pszCategory, std::string&& strMessage)
+    {
+        LogRing* pRing = GetThreadRing();
+
+        LogRecord record;
+        record.nTimeNs = Now();
+        record.eLevel = eLevel;
+        record.pszCategory = pszCategory ? pszCategory : "";
+        record.nThread = pRing->GetThread();
+        record.strMessage = std::move(strMessage);
+        pRing->TryPush(record);
+    }
+
+    void LoggerCore::Configure(const LogOption& option)
+    {
+        Flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_option = option;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            m_nRingSize = option.nRingSize;
+        }
+        m_nLevel.store(option.eLevel, std::memory_order_relaxed);
+    }
+
+    void LoggerCore::Flush()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint64_t nTarget = ++m_nFlushRequest;
+        m_cvWake.notify_one();
+        m_cvFlushed.wait(lock, [&]() { return m_nFlushDone >= nTarget; });
+    }
+
+    void LoggerCore::Run()
+    {
+        // 생산자는 알림 없이 링에 넣기만 하므로 짧은 주기로 모아 간다. (Flush/종료 요청은 바로 깨운다)
+        while (true)
+        {
+            uint64_t nFlushRequest = 0;
+            bool bStop = false;
+            LogOption option;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cvWake.wait_for(lock, std::chrono::milliseconds(20), [&]() { return m_bStop || m_nFlushRequest != m_nFlushDone; });
+                nFlushRequest = m_nFlushRequest;
+                bStop = m_bStop;
+                option = m_option;
+            }
+
+            Drain(option);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_nFlushDone = nFlushRequest;
+            }
+            m_cvFlushed.notify_all();
+
+            if (bStop)
+                break;
+        }
+    }
+
+    void LoggerCore::Drain(const LogOption& option)
+    {
+        std::vector<LogRing*> vecRing;
+        {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            for (const auto& pRing : m_vecRing)
+                vecRing.push_back(pRing.get());
+        }
+
+        // 끝난 스레드의 링은 표시를 먼저 확인하고 비운 뒤 정리한다. (표시 이후에는 더 들어오지 않음)
+        std::vector<LogRing*> vecRetire;
+        m_vecBatch.clear();
+        LogRecord record;
+        for (LogRing* pRing : vecRing)
+        {
+            const bool bOrphaned = pRing->bOrphaned.load(std::memory_order_acquire);
+            while (pRing->TryPop(record))
+                m_vecBatch.push_back(std::move(record));
+            if (bOrphaned)
+                vecRetire.push_back(pRing);
+        }
+
+        uint64_t nDropped = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_ringMutex);
+            for (LogRing* pRing : vecRetire)
+            {
+                m_nRetiredDropped += pRing->nDropped.load();
+                m_vecRing.erase(std::remove_if(m_vecRing.begin(), m_vecRing.end(), [&](const std::unique_ptr<LogRing>& p) { return p.get() == pRing; }), m_vecRing.end());
+            }
+            nDropped = m_nRetiredDropped;
+            for (const auto& pRing : m_vecRing)
+                nDropped += pRing->nDropped.load(std::memory_order_relaxed);
+        }
+
+        // 링 사이 순서는 시간으로 맞춘다. (같은 스레드 안의 순서는 그대로)
+        std::stable_sort(m_vecBatch.begin(), m_vecBatch.end(), [](const LogRecord& a, const LogRecord& b) { return a.nTimeNs < b.nTimeNs; });
+        for (const auto& batchRecord : m_vecBatch)
+            Emit(option, batchRecord);
+
+        if (!m_vecBatch.empty() && option.pOutput)
+            std::fflush(option.pOutput);
+
+        std::lock_guard<std::mutex> lock(m_summaryMutex);
+        m_summary.nDropped = nDropped;
+    }
+
+    void LoggerCore::Emit(const LogOption& option, const LogRecord& record)
+    {
+        RateBucket& bucket = m_mapBucket[record.pszCategory];
+        const double fCapacity = static_cast<double>(std::max(1, option.nBurst));
+        if (!bucket.bStarted)
+            bucket.fTokens = fCapacity;
+        else
+            bucket.fTokens = std::min(fCapacity, bucket.fTokens + option.fPerSecond * static_cast<double>(record.nTimeNs - bucket.nLastNs) / 1e9);
+        bucket.bStarted = true;
+        bucket.nLastNs = record.nTimeNs;
+
+        const bool bPrint = bucket.fTokens >= 1.0;
+        {
+            std::lock_guard<std::mutex> lock(m_summaryMutex);
+            ++m_summary.nCount[record.eLevel];
+            if (record.eLevel >= LOG_LEVEL_WARN)
+                ++m_mapCategoryCount[record.pszCategory];
+            if (!bPrint)
+                ++m_summary.nSuppressed;
+        }
+
+        if (!bPrint)
+        {
+            ++bucket.nSuppressed;
+            return;
+        }
+        bucket.fTokens -= 1.0;
+
+        if (!option.pOutput)
+            return;
+
+        std::string strLine;
+        if (option.eFormat == LOG_FORMAT_KV)
+        {
+            char szHead[128];
+            std::snprintf(szHead, sizeof(szHead), "t=%.6f level=%s cat=%s tid=%u msg=\"", static_cast<double>(record.nTimeNs) / 1e9,
+                          GetLevelName(record.eLevel), record.pszCategory, record.nThread);
+            strLine = szHead;
+            for (char ch : record.strMessage)
+            {
+                if (ch == '"' || ch == '\\')
+                    strLine += '\\';
+                strLine += (ch == '\n') ? ' ' : ch;
+            }
+            strLine += '"';
+            if (bucket.nSuppressed > 0)
+                strLine += " suppressed=" + std::to_string(bucket.nSuppressed);
+        }
+        else
+        {
+            strLine = GetTextPrefix(record.eLevel) + record.strMessage;
+            if (bucket.nSuppressed > 0)
+                strLine += " (같은 종류 " + std::to_string(bucket.nSuppressed) + "건 생략)";
+        }
+        strLine += '\n';
+        bucket.nSuppressed = 0;
+
+        std::fwrite(strLine.data(), 1, strLine.size(), option.pOutput);
+    }
+
+    LogSummary LoggerCore::GetSummary()
+    {
+        Flush();
+        std::lock_guard<std::mutex> lock(m_summaryMutex);
+        return m_summary;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> LoggerCore::GetCategoryCounts()
+    {
+        Flush();
+        std::lock_guard<std::mutex> lock(m_summaryMutex);
+        std::vector<std::pair<std::string, uint64_t>> vecCount(m_mapCategoryCount.begin(), m_mapCategoryCount.end());
+        std::sort(vecCount.begin(), vecCount.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+        return vecCount;
+    }
+}
+
+void Logger::Configure(const LogOption& option)
+{
+    LoggerCore::Get().Configure(option);
+}
+
+bool Logger::IsEnabled(LOG_LEVEL eLevel)
+{
+    return eLevel != LOG_LEVEL_OFF && static_cast<int>(eLevel) >= LoggerCore::Get().m_nLevel.load(std::memory_order_relaxed);
+}
+
+void Logger::Write(LOG_LEVEL eLevel, const char* pszCategory, std::string strMessage)
+{
+    if (IsEnabled(eLevel))
+        LoggerCore::Get().Push(eLevel, pszCategory, std::move(strMessage));
+}
+
+void Logger::Flush()
+{
+    LoggerCore::Get().Flush();
+}
+
+LogSummary Logger::GetSummary()
+{
+    return LoggerCore::Get().GetSummary();
+}
+
+void Logger::PrintSummary(std::ostream& os)
+{
+    const LogSummary summary = GetSummary();
+    if (summary.nCount[LOG_LEVEL_WARN] == 0 && summary.nCount[LOG_LEVEL_ERROR] == 0 && summary.nSuppressed == 0 && summary.nDropped == 0)
+        return;
+
+    os << "log: error=" << summary.nCount[LOG_LEVEL_ERROR] << " warn=" << summary.nCount[LOG_LEVEL_WARN]
+        << " suppressed=" << summary.nSuppressed << " dropped=" << summary.nDropped;
+
+    // 분류별 상위 5개
+    const auto vecCount = LoggerCore::Get().GetCategoryCounts();
+    for (size_t i = 0; i < vecCount.size() && i < 5; ++i)
+        os << (i == 0 ? " (" : ", ") << vecCount[i].first << "=" << vecCount[i].second;
+    os << (vecCount.empty() ? "\n" : ")\n");
+}
@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <utility>
+
+// 비동기 로거
+//   작업자는 자기 스레드 전용 링 버퍼(단일 생산자/단일 소비자, 잠금 없음)에 기록만 하고 바로 돌아간다.
+//   백그라운드 스레드 하나가 모든 링을 모아 시간순으로 출력한다. 링이 가득 차면 기다리지 않고 버린다. (dropped)
+//   같은 분류(category)의 기록은 처음 nBurst 건 이후 초당 fPerSecond 건만 출력하고 나머지는 개수만 센다. (suppressed)
+//   파일별 성공 같은 반복 정보는 LOG_LEVEL_DEBUG 로 남겨서 기본 설정에서는 출력하지 않는다.
+
+enum LOG_LEVEL
+{
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF
+};
+
+enum LOG_FORMAT
+{
+    LOG_FORMAT_TEXT = 0,    // "Error: 메시지" (콘솔용, 기존 출력과 같은 모양)
+    LOG_FORMAT_KV           // "t=1.234567 level=error cat=convert tid=3 msg=\"메시지\"" (수집/검색용)
+};
+
+struct LogOption
+{
+    LOG_LEVEL eLevel = LOG_LEVEL_INFO;
+    LOG_FORMAT eFormat = LOG_FORMAT_TEXT;
+    int nBurst = 10;                // 분류별로 제한 없이 출력하는 건수
+    double fPerSecond = 1.0;        // 그 이후 분류별 초당 출력 건수 (0 이면 더 출력하지 않음)
+    size_t nRingSize = 1024;        // 스레드당 링 버퍼 기록 수 (새로 만들어지는 링부터 적용)
+    std::FILE* pOutput = stderr;    // stdout 은 stream 명령의 데이터 출력이므로 기본은 stderr
+};
+
+struct LogSummary
+{
+    uint64_t nCount[LOG_LEVEL_OFF] = {};    // 수준별 기록 수 (생략된 것 포함)
+    uint64_t nSuppressed = 0;               // 빈도 제한으로 출력하지 않은 수
+    uint64_t nDropped = 0;                  // 링이 가득 차서 버린 수
+};
+
+class Logger
+{
+public:
+    // 실행 시작 전에 한 번 설정한다. (이미 쌓인 기록은 먼저 출력된다)
+    static void Configure(const LogOption& option);
+
+    // 메시지를 만들기 전에 확인한다. (비활성 수준이면 문자열 조립 비용도 들지 않게)
+    static bool IsEnabled(LOG_LEVEL eLevel);
+
+    // pszCategory 는 정적 문자열 ("convert", "read", "write" ...). 빈도 제한과 요약의 단위
+    static void Write(LOG_LEVEL eLevel, const char* pszCategory, std::string strMessage);
+
+    // 호출 시점까지 기록된 것을 모두 출력할 때까지 기다린다.
+    static void Flush();
+
+    static LogSummary GetSummary();
+
+    // 경고/오류/생략/버림이 있었으면 "log: ..." 한 줄 (분류별 상위 건수 포함)
+    static void PrintSummary(std::ostream& os);
+};
+
+inline void LogDebug(const char* pszCategory, std::string strMessage) { Logger::Write(LOG_LEVEL_DEBUG, pszCategory, std::move(strMessage)); }
+inline void LogInfo(const char* pszCategory, std::string strMessage) { Logger::Write(LOG_LEVEL_INFO, pszCategory, std::move(strMessage)); }
+inline void LogWarn(const char* pszCategory, std::string strMessage) { Logger::Write(LOG_LEVEL_WARN, pszCategory, std::move(strMessage)); }
+inline void LogError(const char* pszCategory, std::string strMessage) { Logger::Write(LOG_LEVEL_ERROR, pszCategory, std::move(strMessage)); }
@@ -0,0 +1,122 @@
+﻿#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(m_pData, other.m_pData);
+        std::swap(m_nSize, other.m_nSize);
+        std::swap(m_bEmpty, other.m_bEmpty);
+#ifdef _WIN32
+        std::swap(m_hFile, other.m_hFile);
+        std::swap(m_hMapping, other.m_hMapping);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& strPath)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(strPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        m_bEmpty = true;
+        return true;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping)
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!pView)
+    {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_hFile = hFile;
+    m_hMapping = hMapping;
+    m_pData = static_cast<const uint8_t*>(pView);
+    m_nSize = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = open(strPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    if (st.st_size == 0)
+    {
+        close(fd);
+        m_bEmpty = true;
+        return true;
+    }
+
+    void* pView = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // 매핑은 fd 를 닫아도 유지된다.
+    if (pView == MAP_FAILED)
+        return false;
+
+    m_pData = static_cast<const uint8_t*>(pView);
+    m_nSize = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_pData)
+        UnmapViewOfFile(m_pData);
+    if (m_hMapping)
+        CloseHandle(m_hMapping);
+    if (m_hFile)
+        CloseHandle(m_hFile);
+    m_hMapping = nullptr;
+    m_hFile = nullptr;
+#else
+    if (m_pData)
+        munmap(const_cast<uint8_t*>(m_pData), m_nSize);
+#endif
+    m_pData = nullptr;
+    m_nSize = 0;
+    m_bEmpty = false;
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 읽기 전용 메모리 매핑 파일 (Win32 CreateFileMapping / POSIX mmap)
+class MappedFile
+{
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string& strPath);
+    void Close();
+
+    const uint8_t* GetData() const { return m_pData; }
+    size_t GetSize() const { return m_nSize; }
+    bool IsOpen() const { return m_pData != nullptr || m_bEmpty; }
+
+private:
+    const uint8_t* m_pData = nullptr;
+    size_t m_nSize = 0;
+    bool m_bEmpty = false;  // 0 바이트 파일은 매핑할 수 없으므로 따로 표시
+#ifdef _WIN32
+    void* m_hFile = nullptr;
+    void* m_hMapping = nullptr;
+#endif
+};
@@ -0,0 +1,208 @@
+﻿#include "MemoryBudget.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fstream>
+#include <string>
+#endif
+
+namespace
+{
+    // libwebp 손실 인코더의 내부 할당 (매크로블록 정보, 예측 모드, 다중 패스용 토큰 버퍼, 파티션 비트스트림)
+    // 은 밖에서 보이지 않으므로 토큰 버퍼가 가장 커지는 경우를 기준으로 넉넉하게 잡는다.
+    const uint64_t ENCODER_BYTES_PER_PIXEL = 2;
+
+    // libwebp 무손실 인코더: 변환용 ARGB 사본, 해시 체인, 역참조 버퍼, 히스토그램.
+    // 수준이 높을수록 여러 번 시도하므로 높은 수준 기준으로 잡는다.
+    const uint64_t LOSSLESS_ENCODER_BYTES_PER_PIXEL = 24;
+
+    // 디코더 작업 버퍼, 허프만 테이블 등 이미지 크기와 거의 무관한 부분
+    const uint64_t FIXED_OVERHEAD_BYTES = 256 * 1024;
+
+    // 기다리는 중에 취소 플래그를 확인하는 간격
+    const std::chrono::milliseconds CANCEL_POLL_INTERVAL(50);
+}
+
+MemoryBudget::MemoryBudget(uint64_t nBudgetBytes)
+    : m_nBudget(nBudgetBytes)
+{
+    m_stats.nBudget = nBudgetBytes;
+}
+
+uint64_t MemoryBudget::EstimateConvertBytes(int nWidth, int nHeight, size_t nJpegSize, bool bVerify, bool bLossless)
+{
+    const uint64_t nPixels = static_cast<uint64_t>(std::max(nWidth, 0)) * static_cast<uint64_t>(std::max(nHeight, 0));
+    const uint64_t nUVSize = static_cast<uint64_t>((std::max(nWidth, 0) + 1) / 2) * static_cast<uint64_t>((std::max(nHeight, 0) + 1) / 2);
+
+    // 무손실: Y 평면 + ARGB 입력 + 인코더 내부 + 출력 (출력이 입력 JPEG 보다 커지는 경우가 많다)
+    //         검증은 다시 디코딩한 RGBA + G 채널
+    if (bLossless)
+        return nPixels + nPixels * 4 + nPixels * LOSSLESS_ENCODER_BYTES_PER_PIXEL + nPixels + nJpegSize + FIXED_OVERHEAD_BYTES
+             + (bVerify ? nPixels * 5 : 0);
+
+    // Y 평면 + 공유 U/V 평면 + 인코더 내부 + 출력 (출력은 입력 크기를 넘는 경우가 드물다)
+    uint64_t nBytes = nPixels + nUVSize + nPixels * ENCODER_BYTES_PER_PIXEL + nJpegSize + FIXED_OVERHEAD_BYTES;
+
+    // 표본 검증: 다시 디코딩한 Y + U + V
+    if (bVerify)
+        nBytes += nPixels + nUVSize * 2;
+    return nBytes;
+}
+
+uint64_t MemoryBudget::DetectSystemLimit()
+{
+#ifdef _WIN32
+    // Job object 에 묶여 있으면 (컨테이너, 작업 스케줄러) 프로세스/작업 메모리 한도
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION info = {};
+    if (!QueryInformationJobObject(nullptr, JobObjectExtendedLimitInformation, &info, sizeof(info), nullptr))
+        return 0;
+
+    uint64_t nLimit = 0;
+    if (info.BasicLimitInformation.LimitFlags & JOB_OBJECT_LIMIT_PROCESS_MEMORY)
+        nLimit = info.ProcessMemoryLimit;
+    if ((info.BasicLimitInformation.LimitFlags & JOB_OBJECT_LIMIT_JOB_MEMORY) && (nLimit == 0 || info.JobMemoryLimit < nLimit))
+        nLimit = info.JobMemoryLimit;
+    return nLimit;
+#else
+    // cgroup v2: "max" 면 한도 없음
+    {
+        std::ifstream file("/sys/fs/cgroup/memory.max");
+        std::string strValue;
+        if (file >> strValue)
+            return (strValue == "max") ? 0 : std::strtoull(strValue.c_str(), nullptr, 10);
+    }
+
+    // cgroup v1: 한도가 없으면 페이지 단위로 내린 아주 큰 값이 들어 있다.
+    {
+        std::ifstream file("/sys/fs/cgroup/memory/memory.limit_in_bytes");
+        unsigned long long nValue = 0;
+        if (file >> nValue)
+            return (nValue >= (1ULL << 60)) ? 0 : nValue;
+    }
+    return 0;
+#endif
+}
+
+bool MemoryBudget::Reserve(uint64_t nBytes, const std::atomic<bool>* pCancelFlag)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto canAdmit = [&]()
+    {
+        return m_nActive == 0 || m_nReserved + nBytes <= m_nBudget;
+    };
+
+    // 기다리는 작업이 있으면 들어갈 자리가 있어도 그 뒤에 선다. (작은 예약이 계속 끼어들면 큰 예약이 영영 못 들어감)
+    if (!m_deqWaiting.empty() || !canAdmit())
+    {
+        const uint64_t nTicket = m_nNextTicket++;
+        m_deqWaiting.push_back(nTicket);
+        ++m_stats.nWaits;
+
+        const auto waitStartTime = std::chrono::steady_clock::now();
+        while (m_deqWaiting.front() != nTicket || !canAdmit())
+        {
+            if (pCancelFlag && pCancelFlag->load(std::memory_order_relaxed))
+            {
+                m_deqWaiting.erase(std::find(m_deqWaiting.begin(), m_deqWaiting.end(), nTicket));
+                m_stats.durationWait += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStartTime);
+                lock.unlock();
+                m_cvRelease.notify_all();   // 맨 앞이었다면 다음 작업이 들어갈 수 있다.
+                return false;
+            }
+            m_cvRelease.wait_for(lock, CANCEL_POLL_INTERVAL);
+        }
+        m_deqWaiting.pop_front();
+        m_stats.durationWait += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStartTime);
+    }
+
+    if (nBytes > m_nBudget)
+        ++m_stats.nOversize;
+
+    m_nReserved += nBytes;
+    ++m_nActive;
+    ++m_stats.nReservations;
+    m_stats.nPeakReserved = std::max(m_stats.nPeakReserved, m_nReserved);
+
+    // 다음 차례도 남은 예산에 들어가면 바로 들어가게 깨운다.
+    if (!m_deqWaiting.empty())
+    {
+        lock.unlock();
+        m_cvRelease.notify_all();
+    }
+    return true;
+}
+
+void MemoryBudget::Release(uint64_t nBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nReserved -= std::min(nBytes, m_nReserved);
+        --m_nActive;
+    }
+    m_cvRelease.notify_all();
+}
+
+void MemoryBudget::AddActual(int64_t nDelta)
+{
+    const int64_t nActual = m_nActual.fetch_add(nDelta, std::memory_order_relaxed) + nDelta;
+    if (nActual <= 0)
+        return;
+
+    uint64_t nPeak = m_nPeakActual.load(std::memory_order_relaxed);
+    while (static_cast<uint64_t>(nActual) > nPeak && !m_nPeakActual.compare_exchange_weak(nPeak, static_cast<uint64_t>(nActual), std::memory_order_relaxed))
+    {
+    }
+}
+
+MemoryBudgetStats MemoryBudget::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MemoryBudgetStats stats = m_stats;
+    stats.nPeakActual = m_nPeakActual.load(std::memory_order_relaxed);
+    stats.nUnderestimated = m_nUnderestimated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool MemoryReservation::Acquire(MemoryBudget* pBudget, uint64_t nBytes, const std::atomic<bool>* pCancelFlag)
+{
+    Release();
+    if (!pBudget->Reserve(nBytes, pCancelFlag))
+        return false;
+
+    m_pBudget = pBudget;
+    m_nBytes = nBytes;
+    return true;
+}
+
+void MemoryReservation::SetActual(uint64_t nBytes)
+{
+    if (!m_pBudget)
+        return;
+
+    m_pBudget->AddActual(static_cast<int64_t>(nBytes) - static_cast<int64_t>(m_nActual));
+    m_nActual = nBytes;
+    m_nPeakActual = std::max(m_nPeakActual, nBytes);
+}
+
+void MemoryReservation::Release()
+{
+    if (!m_pBudget)
+        return;
+
+    if (m_nPeakActual > m_nBytes)
+        m_pBudget->CountUnderestimated();
+    m_pBudget->AddActual(-static_cast<int64_t>(m_nActual));
+    m_pBudget->Release(m_nBytes);
+
+    m_pBudget = nullptr;
+    m_nBytes = 0;
+    m_nActual = 0;
+    m_nPeakActual = 0;
+}
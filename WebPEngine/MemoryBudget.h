@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// 변환 작업 메모리 예산 (선택 사항)
+//   작업마다 JPEG 헤더의 크기로 최대 사용량(평면 + libwebp 내부 + 출력)을 추정해서 디코딩 전에 예약한다.
+//   남은 예산이 모자라면 다른 작업이 반납할 때까지 기다린다. 기다리는 작업은 도착 순서대로 들어가고,
+//   앞에서 기다리는 작업이 있으면 뒤에 온 작업은 자리가 있어도 끼어들지 않는다. 예약 중인 작업이 없으면
+//   예산보다 큰 이미지도 혼자 들여보낸다. (기다리기만 하면 영원히 처리하지 못하므로)
+//   작업이 끝나면 엔진이 실제로 잡은 버퍼 크기를 알려서 추정치와 비교할 수 있게 한다.
+
+struct MemoryBudgetStats
+{
+    uint64_t nBudget = 0;
+    uint64_t nPeakReserved = 0;     // 동시에 예약된 양의 최대
+    uint64_t nPeakActual = 0;       // 동시에 실제로 잡은 엔진 버퍼의 최대 (libwebp/디코더 내부 할당은 보이지 않음)
+    uint64_t nReservations = 0;
+    uint64_t nWaits = 0;            // 예산이 모자라서 기다린 작업 수
+    uint64_t nOversize = 0;         // 예산보다 커서 혼자 들어간 작업 수
+    uint64_t nUnderestimated = 0;   // 실제 버퍼가 예약보다 컸던 작업 수
+    std::chrono::microseconds durationWait{ 0 };
+};
+
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(uint64_t nBudgetBytes);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // 그레이 변환 한 건의 최대 사용량 추정. nWidth/nHeight 는 인코딩할 크기 (crop 이면 잘라낸 크기)
+    static uint64_t EstimateConvertBytes(int nWidth, int nHeight, size_t nJpegSize, bool bVerify, bool bLossless);
+
+    // 컨테이너(cgroup v1/v2) 나 Job object 의 메모리 한도. 알 수 없으면 0
+    static uint64_t DetectSystemLimit();
+
+    // 예약될 때까지 (앞에서 기다리는 작업이 모두 들어갈 때까지 포함) 기다린다.
+    // 기다리는 중에 *pCancelFlag 가 서면 줄에서 빠지고 예약하지 않고 false
+    bool Reserve(uint64_t nBytes, const std::atomic<bool>* pCancelFlag);
+    void Release(uint64_t nBytes);
+
+    // 예약 중인 작업의 실제 버퍼 크기 변화 (+/-). 최대치 기록용
+    void AddActual(int64_t nDelta);
+    void CountUnderestimated() { m_nUnderestimated.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t GetBudget() const { return m_nBudget; }
+
+    // 작업이 끝난 스레드가 재사용하려고 남겨 둘 수 있는 버퍼 크기 (이보다 크면 반납)
+    uint64_t GetRetainLimit() const { return m_nBudget / 16; }
+
+    MemoryBudgetStats GetStats() const;
+
+private:
+    const uint64_t m_nBudget;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvRelease;
+    uint64_t m_nReserved = 0;
+    int m_nActive = 0;                  // 예약 중인 작업 수
+    std::deque<uint64_t> m_deqWaiting;  // 기다리는 작업의 번호표 (도착 순서). 맨 앞만 들어갈 수 있다.
+    uint64_t m_nNextTicket = 0;
+    MemoryBudgetStats m_stats;          // nPeakActual / nUnderestimated 제외
+
+    std::atomic<int64_t> m_nActual{ 0 };
+    std::atomic<uint64_t> m_nPeakActual{ 0 };
+    std::atomic<uint64_t> m_nUnderestimated{ 0 };
+};
+
+// 작업 하나의 예약. 범위를 벗어나면 반납한다.
+class MemoryReservation
+{
+public:
+    MemoryReservation() {}
+    ~MemoryReservation() { Release(); }
+
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    bool Acquire(MemoryBudget* pBudget, uint64_t nBytes, const std::atomic<bool>* pCancelFlag);
+
+    // 지금 잡고 있는 실제 버퍼 크기 (호출할 때마다 이전 값과의 차이만큼 반영)
+    void SetActual(uint64_t nBytes);
+    void Release();
+
+    bool IsHeld() const { return m_pBudget != nullptr; }
+    MemoryBudget* GetBudget() const { return m_pBudget; }
+
+private:
+    MemoryBudget* m_pBudget = nullptr;
+    uint64_t m_nBytes = 0;
+    uint64_t m_nActual = 0;
+    uint64_t m_nPeakActual = 0;
+};
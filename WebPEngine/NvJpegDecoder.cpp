@@ -0,0 +1,120 @@
+﻿#include "DecoderBackend.h"
+
+#ifdef WEBP_USE_NVJPEG
+
+#include <cuda_runtime.h>
+#include <nvjpeg.h>
+
+namespace
+{
+    // 스레드마다 nvJPEG 핸들/상태/스트림과 디바이스 Y 버퍼를 하나씩 가진다. (이미지마다 cudaMalloc 하지 않음)
+    class NvJpegDecoder : public IDecoderBackend
+    {
+    public:
+        NvJpegDecoder()
+        {
+            if (cudaStreamCreate(&m_stream) != cudaSuccess)
+            {
+                m_stream = nullptr;
+                return;
+            }
+
+            if (nvjpegCreate(NVJPEG_BACKEND_DEFAULT, nullptr, &m_handle) != NVJPEG_STATUS_SUCCESS)
+            {
+                m_handle = nullptr;
+                return;
+            }
+
+            if (nvjpegJpegStateCreate(m_handle, &m_state) != NVJPEG_STATUS_SUCCESS)
+                m_state = nullptr;
+        }
+
+        ~NvJpegDecoder() override
+        {
+            if (m_pDeviceY)
+                cudaFree(m_pDeviceY);
+            if (m_state)
+                nvjpegJpegStateDestroy(m_state);
+            if (m_handle)
+                nvjpegDestroy(m_handle);
+            if (m_stream)
+                cudaStreamDestroy(m_stream);
+        }
+
+        bool IsValid() const { return m_stream && m_handle && m_state; }
+
+        const char* GetName() const override { return "nvjpeg"; }
+
+        bool Probe(const uint8_t* pJpegData, size_t nJpegSize, JpegHeader& header) override
+        {
+            // nvjpegGetImageInfo 는 width/height "배열" 필요.
+            int nComponents = 0;
+            nvjpegChromaSubsampling_t subsampling;
+            int widths[NVJPEG_MAX_COMPONENT] = { 0 };
+            int heights[NVJPEG_MAX_COMPONENT] = { 0 };
+
+            if (nvjpegGetImageInfo(m_handle, pJpegData, nJpegSize, &nComponents, &subsampling, widths, heights) != NVJPEG_STATUS_SUCCESS)
+                return false;
+
+            header.nWidth = widths[0];
+            header.nHeight = heights[0];
+            switch (subsampling)
+            {
+            case NVJPEG_CSS_444:  header.nSubSampling = JPEG_SUBSAMP_444; break;
+            case NVJPEG_CSS_422:  header.nSubSampling = JPEG_SUBSAMP_422; break;
+            case NVJPEG_CSS_420:  header.nSubSampling = JPEG_SUBSAMP_420; break;
+            case NVJPEG_CSS_440:  header.nSubSampling = JPEG_SUBSAMP_440; break;
+            case NVJPEG_CSS_411:  header.nSubSampling = JPEG_SUBSAMP_411; break;
+            case NVJPEG_CSS_GRAY: header.nSubSampling = (nComponents == 1) ? JPEG_SUBSAMP_GRAY : JPEG_SUBSAMP_UNKNOWN; break;
+            default:              header.nSubSampling = JPEG_SUBSAMP_UNKNOWN; break;
+            }
+            return true;
+        }
+
+        bool DecodeInto(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, DecodePlanes& planes) override
+        {
+            const size_t nPitch = static_cast<size_t>(header.nWidth);
+            const size_t nYSize = nPitch * static_cast<size_t>(header.nHeight);
+            if (nYSize > m_nDeviceYSize)
+            {
+                if (m_pDeviceY)
+                    cudaFree(m_pDeviceY);
+                m_pDeviceY = nullptr;
+                m_nDeviceYSize = 0;
+
+                if (cudaMalloc(reinterpret_cast<void**>(&m_pDeviceY), nYSize) != cudaSuccess)
+                    return false;
+                m_nDeviceYSize = nYSize;
+            }
+
+            nvjpegImage_t nvImage = {};
+            nvImage.channel[0] = m_pDeviceY;
+            nvImage.pitch[0] = static_cast<unsigned int>(nPitch);
+
+            if (nvjpegDecode(m_handle, m_state, pJpegData, nJpegSize, NVJPEG_OUTPUT_Y, &nvImage, m_stream) != NVJPEG_STATUS_SUCCESS)
+                return false;
+
+            if (cudaMemcpy2DAsync(planes.pY, planes.nYStride, m_pDeviceY, nPitch, nPitch, header.nHeight, cudaMemcpyDeviceToHost, m_stream) != cudaSuccess)
+                return false;
+
+            return cudaStreamSynchronize(m_stream) == cudaSuccess;
+        }
+
+    private:
+        cudaStream_t m_stream = nullptr;
+        nvjpegHandle_t m_handle = nullptr;
+        nvjpegJpegState_t m_state = nullptr;
+        uint8_t* m_pDeviceY = nullptr;
+        size_t m_nDeviceYSize = 0;
+    };
+}
+
+std::unique_ptr<IDecoderBackend> CreateNvJpegDecoder()
+{
+    auto pDecoder = std::make_unique<NvJpegDecoder>();
+    if (!pDecoder->IsValid())
+        return nullptr;
+    return pDecoder;
+}
+
+#endif // WEBP_USE_NVJPEG
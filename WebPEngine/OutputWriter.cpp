@@ -0,0 +1,372 @@
+﻿#include "OutputWriter.h"
+#include "FileUtil.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    bool SyncFile(FILE* pFile)
+    {
+        if (std::fflush(pFile) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(pFile)) == 0;
+#else
+        return fsync(fileno(pFile)) == 0;
+#endif
+    }
+
+    // 새 이름/삭제가 디스크에 남도록 폴더 항목을 내려쓴다. (Windows 는 파일 fsync 로 충분해서 하지 않음)
+    bool SyncDirectory(const std::string& strDir)
+    {
+#ifdef _WIN32
+        (void)strDir;
+        return true;
+#else
+        const int fd = open(strDir.empty() ? "." : strDir.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        const bool bOk = fsync(fd) == 0;
+        close(fd);
+        return bOk;
+#endif
+    }
+}
+
+const char* GetWriteDurabilityString(WRITE_DURABILITY eDurability)
+{
+    switch (eDurability)
+    {
+    case WRITE_DURABILITY_NONE:  return "none";
+    case WRITE_DURABILITY_BATCH: return "batch";
+    case WRITE_DURABILITY_EACH:  return "each";
+    default:                     return "unknown";
+    }
+}
+
+bool ParseWriteDurability(const std::string& strText, WRITE_DURABILITY& eDurability)
+{
+    for (WRITE_DURABILITY e : { WRITE_DURABILITY_NONE, WRITE_DURABILITY_BATCH, WRITE_DURABILITY_EACH })
+    {
+        if (strText == GetWriteDurabilityString(e))
+        {
+            eDurability = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+OutputWriter::OutputWriter(const OutputWriterOption& option)
+    : m_option(option)
+{
+    m_option.nWriterCount = std::max(1, m_option.nWriterCount);
+    m_option.nBatchFiles = std::max(1, m_option.nBatchFiles);
+}
+
+OutputWriter::~OutputWriter()
+{
+    Finish();
+}
+
+bool OutputWriter::Start()
+{
+    if (!m_option.strScratchDir.empty())
+    {
+        std::error_code ec;
+        fs::create_directories(m_option.strScratchDir, ec);
+        if (!fs::is_directory(m_option.strScratchDir, ec))
+            return false;
+    }
+
+    m_bStarted = true;
+    for (int i = 0; i < m_option.nWriterCount; ++i)
+        m_vecWriter.emplace_back(&OutputWriter::WriterLoop, this);
+    return true;
+}
+
+void OutputWriter::Submit(const std::string& strPath, std::vector<uint8_t>&& vecData)
+{
+    PendingWrite write;
+    write.strPath = strPath;
+    write.nBytes = vecData.size();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_stats.nSubmitted;
+
+    // 1) 메모리 큐에 자리가 있으면 (큐가 비어 있으면 상한보다 커도) 그대로 넣는다.
+    // 2) 아니면 로컬 임시 폴더에 자리가 있으면 거기에 써 둔다.
+    // 3) 둘 다 차 있을 때만 쓰기 스레드가 비울 때까지 기다린다.
+    const bool bScratch = !m_option.strScratchDir.empty();
+    auto fitsQueue = [&]() { return m_nQueueBytes == 0 || m_nQueueBytes + write.nBytes <= m_option.nQueueBytes; };
+    auto fitsScratch = [&]() { return bScratch && (m_nScratchBytes == 0 || m_nScratchBytes + write.nBytes <= m_option.nScratchBytes); };
+
+    if (!fitsQueue() && !fitsScratch())
+    {
+        ++m_stats.nBlocked;
+        const auto waitStart = std::chrono::steady_clock::now();
+        m_cvSpace.wait(lock, [&]() { return fitsQueue() || fitsScratch(); });
+        m_stats.durationBlocked += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStart);
+    }
+
+    if (fitsQueue())
+    {
+        write.vecData = std::move(vecData);
+        EnqueueLocked(std::move(write));
+        return;
+    }
+
+    // 임시 폴더 자리를 먼저 잡고 잠금 밖에서 쓴다.
+    m_nScratchBytes += write.nBytes;
+    m_stats.nPeakScratchBytes = std::max(m_stats.nPeakScratchBytes, m_nScratchBytes);
+    write.strScratchPath = (fs::path(m_option.strScratchDir) / ("stage_" + std::to_string(++m_nScratchSeq) + ".tmp")).string();
+    lock.unlock();
+
+    const bool bStaged = WriteMemoryToFile(write.strScratchPath, vecData.data(), vecData.size());
+    if (!bStaged)
+    {
+        // 임시 폴더에 못 쓰면 메모리로 넘긴다. (상한을 넘더라도 결과를 잃지 않는 쪽을 택한다)
+        LogWarn("write", "임시 폴더에 쓰지 못해 메모리 큐로 넘깁니다: " + write.strScratchPath);
+        std::error_code ec;
+        fs::remove(write.strScratchPath, ec);
+        write.strScratchPath.clear();
+        write.vecData = std::move(vecData);
+    }
+
+    lock.lock();
+    if (bStaged)
+    {
+        ++m_stats.nSpilled;
+    }
+    else
+    {
+        m_nScratchBytes -= write.nBytes;
+        m_cvSpace.notify_all();
+    }
+    EnqueueLocked(std::move(write));
+}
+
+void OutputWriter::EnqueueLocked(PendingWrite&& write)
+{
+    if (write.strScratchPath.empty())
+    {
+        m_nQueueBytes += write.nBytes;
+        m_stats.nPeakQueueBytes = std::max(m_stats.nPeakQueueBytes, m_nQueueBytes);
+    }
+
+    const std::string strDir = fs::path(write.strPath).parent_path().string();
+    std::deque<PendingWrite>& queWrite = m_mapDir[strDir];
+    if (queWrite.empty())
+        m_queDir.push_back(strDir);
+    queWrite.push_back(std::move(write));
+    m_cvWork.notify_one();
+}
+
+bool OutputWriter::Finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_bStarted)
+            return m_stats.nFailed == 0;
+        m_bStarted = false;
+        m_bStop = true;
+    }
+    m_cvWork.notify_all();
+
+    for (auto& writer : m_vecWriter)
+    {
+        if (writer.joinable())
+            writer.join();
+    }
+    m_vecWriter.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats.nFailed == 0;
+}
+
+OutputWriterStats OutputWriter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void OutputWriter::WriterLoop()
+{
+    while (true)
+    {
+        std::string strDir;
+        std::vector<PendingWrite> vecBatch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cvWork.wait(lock, [this]() { return m_bStop || !m_queDir.empty(); });
+            if (m_queDir.empty())
+                return; // m_bStop 이고 남은 파일 없음
+
+            // 가장 오래 기다린 폴더에서 최대 nBatchFiles 개. 남으면 폴더를 뒤로 보내 다른 폴더와 번갈아 쓴다.
+            strDir = m_queDir.front();
+            m_queDir.pop_front();
+            auto it = m_mapDir.find(strDir);
+            std::deque<PendingWrite>& queWrite = it->second;
+            while (!queWrite.empty() && static_cast<int>(vecBatch.size()) < m_option.nBatchFiles)
+            {
+                vecBatch.push_back(std::move(queWrite.front()));
+                queWrite.pop_front();
+            }
+            if (queWrite.empty())
+                m_mapDir.erase(it);
+            else
+                m_queDir.push_back(strDir);
+        }
+
+        WriteBatch(strDir, vecBatch);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& write : vecBatch)
+        {
+            if (write.strScratchPath.empty())
+                m_nQueueBytes -= write.nBytes;
+            else
+                m_nScratchBytes -= write.nBytes;
+        }
+        m_cvSpace.notify_all();
+    }
+}
+
+void OutputWriter::WriteBatch(const std::string& strDir, std::vector<PendingWrite>& vecBatch)
+{
+    std::error_code ec;
+    if (!strDir.empty())
+        fs::create_directories(strDir, ec);
+
+    uint64_t nWritten = 0, nFailed = 0, nSyncs = 0, nBytes = 0;
+    auto fail = [&](const PendingWrite& write, const std::string& strPath)
+    {
+        ++nFailed;
+        LogError("write", "결과 파일 저장 실패: " + strPath);
+        if (!write.strScratchPath.empty())
+            fs::remove(write.strScratchPath, ec);
+    };
+
+    // 임시 폴더에 있던 파일은 로컬에서 다시 읽는다. (최종 위치와 파일 시스템이 다를 수 있어 이름 바꾸기 대신 복사)
+    auto load = [&](PendingWrite& write) -> bool
+    {
+        return write.strScratchPath.empty() || (ReadFileToMemory(write.strScratchPath, write.vecData) && write.vecData.size() == write.nBytes);
+    };
+
+    if (m_option.eDurability == WRITE_DURABILITY_NONE)
+    {
+        for (auto& write : vecBatch)
+        {
+            if (!load(write) || !WriteMemoryToFile(write.strPath, write.vecData.data(), write.vecData.size()))
+            {
+                fail(write, write.strPath);
+                continue;
+            }
+            if (!write.strScratchPath.empty())
+                fs::remove(write.strScratchPath, ec);
+            ++nWritten;
+            nBytes += write.nBytes;
+        }
+    }
+    else
+    {
+        // "<이름>.tmp" 에 쓰고 fsync 한 뒤 이름을 바꿔서, 중간에 꺼져도 최종 이름에는 완전한 파일만 남게 한다.
+        // BATCH 는 묶음 전체를 쓴 다음 fsync 를 이어서 하므로 쓰기가 겹치고, 폴더 fsync 도 묶음당 한 번이다.
+        const bool bEach = m_option.eDurability == WRITE_DURABILITY_EACH;
+        std::vector<FILE*> vecFile(vecBatch.size(), nullptr);
+        for (size_t i = 0; i < vecBatch.size(); ++i)
+        {
+            PendingWrite& write = vecBatch[i];
+            const std::string strTemp = write.strPath + ".tmp";
+            FILE* pFile = load(write) ? std::fopen(strTemp.c_str(), "wb") : nullptr;
+            if (pFile && std::fwrite(write.vecData.data(), 1, write.vecData.size(), pFile) == write.vecData.size())
+            {
+                vecFile[i] = pFile;
+                if (!bEach)
+                    continue;
+                // EACH: 바로 fsync -> 닫기 -> 이름 바꾸기 -> 폴더 fsync
+                //   fsync 가 실패한 파일은 최종 이름으로 내놓지 않는다. (임시 파일을 지우고 실패로 센다)
+                const bool bSynced = SyncFile(pFile);
+                std::fclose(pFile);
+                vecFile[i] = nullptr;
+                ++nSyncs;
+                if (bSynced)
+                    fs::rename(strTemp, write.strPath, ec);
+                if (bSynced && !ec)
+                {
+                    ++nSyncs;
+                    if (!SyncDirectory(strDir))
+                        LogWarn("write", "폴더 fsync 실패: " + strDir);
+                    if (!write.strScratchPath.empty())
+                        fs::remove(write.strScratchPath, ec);
+                    ++nWritten;
+                    nBytes += write.nBytes;
+                    continue;
+                }
+            }
+            else if (pFile)
+            {
+                std::fclose(pFile);
+            }
+            fs::remove(strTemp, ec);
+            fail(write, write.strPath);
+        }
+
+        if (!bEach)
+        {
+            bool bAnyRenamed = false;
+            for (size_t i = 0; i < vecBatch.size(); ++i)
+            {
+                if (!vecFile[i])
+                    continue;
+
+                PendingWrite& write = vecBatch[i];
+                const std::string strTemp = write.strPath + ".tmp";
+                const bool bSynced = SyncFile(vecFile[i]);
+                std::fclose(vecFile[i]);
+                ++nSyncs;
+                if (bSynced)
+                    fs::rename(strTemp, write.strPath, ec);
+                if (!bSynced || ec)
+                {
+                    fs::remove(strTemp, ec);
+                    fail(write, write.strPath);
+                    continue;
+                }
+                bAnyRenamed = true;
+                if (!write.strScratchPath.empty())
+                    fs::remove(write.strScratchPath, ec);
+                ++nWritten;
+                nBytes += write.nBytes;
+            }
+            if (bAnyRenamed)
+            {
+                ++nSyncs;
+                if (!SyncDirectory(strDir))
+                    LogWarn("write", "폴더 fsync 실패: " + strDir);
+            }
+        }
+    }
+
+    // 쓴 버퍼는 바로 놓는다. (통계 갱신 전에 메모리를 돌려준다)
+    for (auto& write : vecBatch)
+        std::vector<uint8_t>().swap(write.vecData);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.nBatches;
+    m_stats.nWritten += nWritten;
+    m_stats.nFailed += nFailed;
+    m_stats.nSyncs += nSyncs;
+    m_stats.nWrittenBytes += nBytes;
+}
@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 출력 파일 뒤쓰기(write-behind)
+//   인코딩한 버퍼를 크기 상한이 있는 큐에 넣고 바로 돌아온다. 전용 쓰기 스레드가 폴더별로 묶어서 쓰고,
+//   내구성 정책에 따라 fsync 를 묶음 단위로 한다. 네트워크 파일 시스템에서 파일마다 close 가 수 ms 걸려도
+//   작업자/파이프라인 출력 스레드는 막히지 않는다. (큐와 로컬 임시 폴더가 모두 찼을 때만 기다린다)
+//
+//   메모리 큐가 차면 로컬 임시 폴더(strScratchDir)에 먼저 써 두고, 쓰기 스레드가 나중에 최종 위치로 옮긴다.
+//   쓰기 실패는 Submit 이 아니라 쓰기 스레드에서 기록되므로 Finish 뒤의 GetStats().nFailed 로 확인한다.
+//   지금은 파이프라인 출력(DirectorySink)에서만 쓴다. ConvertFile / JobManager 는 파일별 결과를 바로 돌려줘야 하므로
+//   작업자에서 직접 쓴다.
+
+enum WRITE_DURABILITY
+{
+    WRITE_DURABILITY_NONE = 0,  // fsync 하지 않음 (OS 가 알아서 내려씀, 기존 동작과 같음)
+    WRITE_DURABILITY_BATCH,     // 묶음의 파일을 모두 쓴 뒤 한꺼번에 fsync -> 이름 바꾸기 -> 폴더 fsync 한 번
+    WRITE_DURABILITY_EACH       // 파일마다 fsync -> 이름 바꾸기 -> 폴더 fsync
+};
+
+const char* GetWriteDurabilityString(WRITE_DURABILITY eDurability);
+bool ParseWriteDurability(const std::string& strText, WRITE_DURABILITY& eDurability);
+
+struct OutputWriterOption
+{
+    int nWriterCount = 2;
+    uint64_t nQueueBytes = 256ull << 20;    // 메모리 큐 상한
+    std::string strScratchDir;              // 비어 있으면 임시 폴더 없이 큐가 비기를 기다린다.
+    uint64_t nScratchBytes = 4ull << 30;
+    WRITE_DURABILITY eDurability = WRITE_DURABILITY_NONE;
+    int nBatchFiles = 32;                   // 한 폴더에서 한 번에 가져가는 최대 파일 수
+};
+
+struct OutputWriterStats
+{
+    uint64_t nSubmitted = 0;
+    uint64_t nWritten = 0;
+    uint64_t nFailed = 0;
+    uint64_t nSpilled = 0;                  // 큐가 차서 임시 폴더를 거친 파일
+    uint64_t nBlocked = 0;                  // 큐와 임시 폴더가 모두 차서 Submit 이 기다린 횟수
+    std::chrono::microseconds durationBlocked{ 0 };
+    uint64_t nBatches = 0;
+    uint64_t nSyncs = 0;                    // 파일 + 폴더 fsync 수
+    uint64_t nWrittenBytes = 0;
+    uint64_t nPeakQueueBytes = 0;
+    uint64_t nPeakScratchBytes = 0;
+};
+
+class OutputWriter
+{
+public:
+    explicit OutputWriter(const OutputWriterOption& option);
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // 임시 폴더를 만들고 쓰기 스레드를 시작한다. 임시 폴더를 만들 수 없으면 false
+    bool Start();
+
+    // strPath 에 쓸 데이터를 넘긴다. (여러 스레드에서 불러도 됨) 상위 폴더는 쓰기 스레드가 만든다.
+    void Submit(const std::string& strPath, std::vector<uint8_t>&& vecData);
+
+    // 남은 파일을 모두 쓰고 쓰기 스레드를 끝낸다. 실패한 파일이 없으면 true
+    bool Finish();
+
+    OutputWriterStats GetStats() const;
+
+private:
+    struct PendingWrite
+    {
+        std::string strPath;
+        std::vector<uint8_t> vecData;   // 비어 있으면 strScratchPath 에 있음
+        std::string strScratchPath;
+        uint64_t nBytes = 0;
+    };
+
+    void WriterLoop();
+    void WriteBatch(const std::string& strDir, std::vector<PendingWrite>& vecBatch);
+    void EnqueueLocked(PendingWrite&& write);
+
+    OutputWriterOption m_option;
+    std::vector<std::thread> m_vecWriter;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvWork;       // 쓸 항목 도착 / 종료
+    std::condition_variable m_cvSpace;      // 큐/임시 폴더에 자리가 생김
+    std::map<std::string, std::deque<PendingWrite>> m_mapDir;  // 폴더별 대기 파일
+    std::deque<std::string> m_queDir;       // 대기 파일이 있는 폴더 (먼저 들어온 순서)
+    uint64_t m_nQueueBytes = 0;
+    uint64_t m_nScratchBytes = 0;
+    uint64_t m_nScratchSeq = 0;
+    bool m_bStarted = false;
+    bool m_bStop = false;
+    OutputWriterStats m_stats;
+};
@@ -0,0 +1,324 @@
+﻿#include "PackFile.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace PackFormat
+{
+    uint64_t HashKey(const char* pKey, size_t nLength)
+    {
+        uint64_t nHash = 14695981039346656037ull;
+        for (size_t i = 0; i < nLength; ++i)
+        {
+            nHash ^= static_cast<uint8_t>(pKey[i]);
+            nHash *= 1099511628211ull;
+        }
+        return nHash;
+    }
+
+    std::string GetPackPath(const std::string& strBase, uint32_t nPackId)
+    {
+        char szSuffix[16];
+        std::snprintf(szSuffix, sizeof(szSuffix), ".%04u.wpk", nPackId);
+        return strBase + szSuffix;
+    }
+
+    std::string GetIndexPath(const std::string& strBase)
+    {
+        return strBase + ".wpx";
+    }
+}
+
+namespace
+{
+    // 색인 키는 경로 구분자를 '/' 로 통일해서 OS 에 상관없이 같은 키로 찾을 수 있게 한다.
+    std::string NormalizeKey(const std::string& strKey)
+    {
+        std::string strOut = strKey;
+        std::replace(strOut.begin(), strOut.end(), '\\', '/');
+        return strOut;
+    }
+
+    bool WriteU32(std::FILE* pFile, uint32_t nValue)
+    {
+        uint8_t buf[4];
+        for (int i = 0; i < 4; ++i)
+            buf[i] = static_cast<uint8_t>(nValue >> (8 * i));
+        return std::fwrite(buf, 1, sizeof(buf), pFile) == sizeof(buf);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PackWriter
+
+PackWriter::PackWriter(const std::string& strBase, uint64_t nMaxPackBytes /*= 1ull << 30*/)
+    : m_strBase(strBase)
+    , m_nMaxPackBytes(nMaxPackBytes)
+{
+}
+
+PackWriter::~PackWriter()
+{
+    if (!m_bFinished)
+        Finish();
+}
+
+bool PackWriter::OpenNextPack()
+{
+    if (m_pPack)
+    {
+        std::fclose(m_pPack);
+        m_pPack = nullptr;
+        ++m_nPackId;
+    }
+
+    const std::string strPath = PackFormat::GetPackPath(m_strBase, m_nPackId);
+    std::error_code ec;
+    const std::filesystem::path parent = std::filesystem::path(strPath).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, ec);
+
+    m_pPack = std::fopen(strPath.c_str(), "wb");
+    if (!m_pPack)
+    {
+        std::cerr << "Error: pack 파일을 만들지 못했습니다: " << strPath << "\n";
+        return false;
+    }
+    std::setvbuf(m_pPack, nullptr, _IOFBF, 1u << 20);
+
+    if (std::fwrite("WPAK", 1, 4, m_pPack) != 4 || !WriteU32(m_pPack, PackFormat::VERSION) || !WriteU32(m_pPack, m_nPackId) || !WriteU32(m_pPack, 0))
+        return false;
+
+    m_nPackOffset = PackFormat::PACK_HEADER_BYTES;
+    m_nPackCount = m_nPackId + 1;
+    return true;
+}
+
+bool PackWriter::Append(const std::string& strKey, const uint8_t* pData, size_t nSize, uint32_t nWidth, uint32_t nHeight)
+{
+    if (m_bFinished || nSize > 0xFFFFFFFFu)
+        return false;
+
+    // 현재 pack 이 상한을 넘으면 다음 pack 으로 넘어간다.
+    if (!m_pPack || (m_nPackOffset > PackFormat::PACK_HEADER_BYTES && m_nPackOffset + nSize > m_nMaxPackBytes))
+    {
+        if (!OpenNextPack())
+            return false;
+    }
+
+    if (nSize > 0 && std::fwrite(pData, 1, nSize, m_pPack) != nSize)
+        return false;
+
+    PendingEntry pending;
+    pending.strKey = NormalizeKey(strKey);
+    std::memset(&pending.entry, 0, sizeof(pending.entry));
+    pending.entry.nKeyHash = PackFormat::HashKey(pending.strKey.data(), pending.strKey.size());
+    pending.entry.nOffset = m_nPackOffset;
+    pending.entry.nLength = static_cast<uint32_t>(nSize);
+    pending.entry.nPackId = m_nPackId;
+    pending.entry.nWidth = nWidth;
+    pending.entry.nHeight = nHeight;
+    m_vecEntry.push_back(std::move(pending));
+
+    m_nPackOffset += nSize;
+    return true;
+}
+
+bool PackWriter::Write(OutputItem& item)
+{
+    if (!item.bOk)
+    {
+        LogError("convert", std::string("변환 실패 (") + GetConvertStatusString(item.result.eStatus) + "): " + item.strName);
+        return true;
+    }
+
+    return Append(item.strName, item.vecWebp.data(), item.vecWebp.size(), static_cast<uint32_t>(item.result.nWidth), static_cast<uint32_t>(item.result.nHeight));
+}
+
+bool PackWriter::Finish()
+{
+    if (m_bFinished)
+        return true;
+    m_bFinished = true;
+
+    bool bOk = true;
+    if (m_pPack)
+    {
+        bOk = std::fclose(m_pPack) == 0;
+        m_pPack = nullptr;
+    }
+
+    // (해시, 키) 순 정렬. 같은 키가 여러 번 들어왔으면 마지막 기록을 남긴다.
+    std::stable_sort(m_vecEntry.begin(), m_vecEntry.end(), [](const PendingEntry& a, const PendingEntry& b)
+    {
+        if (a.entry.nKeyHash != b.entry.nKeyHash)
+            return a.entry.nKeyHash < b.entry.nKeyHash;
+        return a.strKey < b.strKey;
+    });
+
+    std::vector<PendingEntry> vecUnique;
+    vecUnique.reserve(m_vecEntry.size());
+    for (auto& pending : m_vecEntry)
+    {
+        if (!vecUnique.empty() && vecUnique.back().strKey == pending.strKey)
+            vecUnique.back() = std::move(pending);
+        else
+            vecUnique.push_back(std::move(pending));
+    }
+    m_vecEntry.swap(vecUnique);
+
+    std::string strKeys;
+    std::vector<PackIndexEntry> vecIndex;
+    vecIndex.reserve(m_vecEntry.size());
+    for (const auto& pending : m_vecEntry)
+    {
+        PackIndexEntry entry = pending.entry;
+        entry.nKeyOffset = static_cast<uint32_t>(strKeys.size());
+        entry.nKeyLength = static_cast<uint32_t>(pending.strKey.size());
+        strKeys += pending.strKey;
+        vecIndex.push_back(entry);
+    }
+
+    PackIndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.szMagic, "WPIX", 4);
+    header.nVersion = PackFormat::VERSION;
+    header.nEntryCount = vecIndex.size();
+    header.nEntryOffset = sizeof(PackIndexHeader);
+    header.nKeyOffset = header.nEntryOffset + vecIndex.size() * sizeof(PackIndexEntry);
+    header.nKeySize = strKeys.size();
+    header.nPackCount = m_nPackCount;
+
+    // 임시 파일에 쓴 뒤 이름을 바꿔서, 읽는 쪽이 반쯤 쓰인 색인을 보지 않게 한다.
+    const std::string strIndexPath = PackFormat::GetIndexPath(m_strBase);
+    const std::string strTempPath = strIndexPath + ".tmp";
+    std::FILE* pIndex = std::fopen(strTempPath.c_str(), "wb");
+    if (!pIndex)
+        return false;
+
+    bOk = bOk && std::fwrite(&header, sizeof(header), 1, pIndex) == 1;
+    bOk = bOk && (vecIndex.empty() || std::fwrite(vecIndex.data(), sizeof(PackIndexEntry), vecIndex.size(), pIndex) == vecIndex.size());
+    bOk = bOk && (strKeys.empty() || std::fwrite(strKeys.data(), 1, strKeys.size(), pIndex) == strKeys.size());
+    bOk = (std::fclose(pIndex) == 0) && bOk;
+
+    if (!bOk)
+    {
+        std::remove(strTempPath.c_str());
+        return false;
+    }
+
+    std::remove(strIndexPath.c_str());
+    return std::rename(strTempPath.c_str(), strIndexPath.c_str()) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PackReader
+
+bool PackReader::Open(const std::string& strBase)
+{
+    Close();
+
+    if (!m_index.Open(PackFormat::GetIndexPath(strBase)) || m_index.GetSize() < sizeof(PackIndexHeader))
+        return false;
+
+    // 잘리거나 깨진 색인이 mmap 밖을 가리키지 않도록 곱셈/덧셈 넘침 없이 범위를 확인한다.
+    // pack 은 항목을 쓸 때만 새로 열리므로 pack 수가 항목 수(빈 pack 하나 포함)보다 많으면 깨진 색인이다. (큰 resize 방지)
+    const uint64_t nIndexSize = m_index.GetSize();
+    const PackIndexHeader* pHeader = reinterpret_cast<const PackIndexHeader*>(m_index.GetData());
+    if (std::memcmp(pHeader->szMagic, "WPIX", 4) != 0 || pHeader->nVersion != PackFormat::VERSION
+        || pHeader->nEntryOffset > nIndexSize || pHeader->nEntryOffset % alignof(uint64_t) != 0
+        || pHeader->nEntryCount > (nIndexSize - pHeader->nEntryOffset) / sizeof(PackIndexEntry)
+        || pHeader->nKeyOffset > nIndexSize || pHeader->nKeySize > nIndexSize - pHeader->nKeyOffset
+        || pHeader->nPackCount > std::max<uint64_t>(pHeader->nEntryCount, 1))
+    {
+        Close();
+        return false;
+    }
+
+    m_vecPack.resize(pHeader->nPackCount);
+    for (uint32_t i = 0; i < pHeader->nPackCount; ++i)
+    {
+        if (!m_vecPack[i].Open(PackFormat::GetPackPath(strBase, i)))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    // 항목마다 키와 데이터 범위를 한 번 확인해 두면 Find / GetKey 는 확인 없이 바로 읽는다.
+    const PackIndexEntry* pEntry = reinterpret_cast<const PackIndexEntry*>(m_index.GetData() + pHeader->nEntryOffset);
+    for (uint64_t i = 0; i < pHeader->nEntryCount; ++i)
+    {
+        const PackIndexEntry& entry = pEntry[i];
+        const bool bKeyOk = static_cast<uint64_t>(entry.nKeyOffset) + entry.nKeyLength <= pHeader->nKeySize;
+        const bool bDataOk = entry.nPackId < m_vecPack.size() && entry.nOffset <= m_vecPack[entry.nPackId].GetSize()
+            && entry.nLength <= m_vecPack[entry.nPackId].GetSize() - entry.nOffset;
+        if (!bKeyOk || !bDataOk)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    m_pHeader = pHeader;
+    m_pEntry = pEntry;
+    m_pKeys = reinterpret_cast<const char*>(m_index.GetData() + pHeader->nKeyOffset);
+    return true;
+}
+
+void PackReader::Close()
+{
+    m_pHeader = nullptr;
+    m_pEntry = nullptr;
+    m_pKeys = nullptr;
+    m_vecPack.clear();
+    m_index.Close();
+}
+
+bool PackReader::MakeRecord(const PackIndexEntry& entry, Record& record) const
+{
+    if (entry.nPackId >= m_vecPack.size())
+        return false;
+
+    const MappedFile& pack = m_vecPack[entry.nPackId];
+    if (entry.nOffset > pack.GetSize() || entry.nLength > pack.GetSize() - entry.nOffset)
+        return false;
+
+    record.pData = pack.GetData() + entry.nOffset;
+    record.nSize = entry.nLength;
+    record.nWidth = entry.nWidth;
+    record.nHeight = entry.nHeight;
+    return true;
+}
+
+bool PackReader::Find(const std::string& strKey, Record& record) const
+{
+    if (!m_pHeader)
+        return false;
+
+    const std::string strNormalized = NormalizeKey(strKey);
+    const uint64_t nHash = PackFormat::HashKey(strNormalized.data(), strNormalized.size());
+
+    const PackIndexEntry* pBegin = m_pEntry;
+    const PackIndexEntry* pEnd = m_pEntry + m_pHeader->nEntryCount;
+    const PackIndexEntry* it = std::lower_bound(pBegin, pEnd, nHash, [](const PackIndexEntry& entry, uint64_t nValue) { return entry.nKeyHash < nValue; });
+
+    // 해시 충돌은 키 문자열로 구분
+    for (; it != pEnd && it->nKeyHash == nHash; ++it)
+    {
+        if (it->nKeyLength == strNormalized.size() && std::memcmp(m_pKeys + it->nKeyOffset, strNormalized.data(), strNormalized.size()) == 0)
+            return MakeRecord(*it, record);
+    }
+    return false;
+}
+
+std::string PackReader::GetKey(uint64_t nIndex) const
+{
+    if (!m_pHeader || nIndex >= m_pHeader->nEntryCount)
+        return std::string();
+
+    const PackIndexEntry& entry = m_pEntry[nIndex];
+    return std::string(m_pKeys + entry.nKeyOffset, entry.nKeyLength);
+}
@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include "MappedFile.h"
+#include <cstdio>
+
+// 작은 WebP 수백만 개를 파일 하나씩 만들지 않고 큰 pack 파일에 이어 붙이는 출력 형식
+//
+//   <base>.NNNN.wpk : 16 바이트 헤더("WPAK", version, pack_id, 0) + WebP 바이트들을 연속 기록
+//   <base>.wpx      : 정렬된 색인. PackIndexHeader | PackIndexEntry[count] | 키 문자열 blob
+//
+// 색인 항목은 (키 해시, 키) 순으로 정렬되어 있어 mmap 한 상태 그대로 이진 탐색(O(log n))한다.
+// 모든 정수는 little-endian 이며 읽기 측은 구조체를 그대로 매핑해서 사용한다.
+
+#pragma pack(push, 1)
+struct PackIndexHeader
+{
+    char szMagic[4];            // "WPIX"
+    uint32_t nVersion;
+    uint64_t nEntryCount;
+    uint64_t nEntryOffset;
+    uint64_t nKeyOffset;
+    uint64_t nKeySize;
+    uint32_t nPackCount;
+    uint32_t nReserved;
+};
+
+struct PackIndexEntry
+{
+    uint64_t nKeyHash;
+    uint64_t nOffset;           // pack 파일 안의 위치
+    uint32_t nLength;
+    uint32_t nPackId;
+    uint32_t nWidth;
+    uint32_t nHeight;
+    uint32_t nKeyOffset;        // 키 blob 안의 위치
+    uint32_t nKeyLength;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackIndexHeader) == 48, "PackIndexHeader layout");
+static_assert(sizeof(PackIndexEntry) == 40, "PackIndexEntry layout");
+
+namespace PackFormat
+{
+    const uint32_t VERSION = 1;
+    const size_t PACK_HEADER_BYTES = 16;
+
+    uint64_t HashKey(const char* pKey, size_t nLength); // FNV-1a 64
+    std::string GetPackPath(const std::string& strBase, uint32_t nPackId);
+    std::string GetIndexPath(const std::string& strBase);
+}
+
+// 변환 결과를 pack 에 이어 붙이는 출력 대상. Finish() 에서 색인을 정렬해 기록한다.
+class PackWriter : public IOutputSink
+{
+public:
+    explicit PackWriter(const std::string& strBase, uint64_t nMaxPackBytes = 1ull << 30);
+    ~PackWriter();
+
+    // 키를 직접 지정해서 추가 (OutputSink 경로 밖에서 사용할 때)
+    bool Append(const std::string& strKey, const uint8_t* pData, size_t nSize, uint32_t nWidth, uint32_t nHeight);
+
+    bool Write(OutputItem& item) override;
+    bool Finish() override;
+
+    uint64_t GetEntryCount() const { return m_vecEntry.size(); }
+
+private:
+    struct PendingEntry
+    {
+        std::string strKey;
+        PackIndexEntry entry;
+    };
+
+    bool OpenNextPack();
+
+    std::string m_strBase;
+    uint64_t m_nMaxPackBytes;
+    std::FILE* m_pPack = nullptr;
+    uint32_t m_nPackId = 0;
+    uint32_t m_nPackCount = 0;
+    uint64_t m_nPackOffset = 0;
+    std::vector<PendingEntry> m_vecEntry;
+    bool m_bFinished = false;
+};
+
+// 색인/팩을 mmap 해서 키로 WebP 를 복사 없이 찾는 읽기 라이브러리 (여러 스레드에서 동시에 Find 가능)
+class PackReader
+{
+public:
+    struct Record
+    {
+        const uint8_t* pData = nullptr;
+        uint32_t nSize = 0;
+        uint32_t nWidth = 0;
+        uint32_t nHeight = 0;
+    };
+
+    // 모든 항목의 키/데이터 범위를 확인한다. 색인이나 pack 이 잘렸거나 깨졌으면 false
+    bool Open(const std::string& strBase);
+    void Close();
+
+    bool Find(const std::string& strKey, Record& record) const;
+
+    uint64_t GetEntryCount() const { return m_pHeader ? m_pHeader->nEntryCount : 0; }
+    std::string GetKey(uint64_t nIndex) const;
+
+private:
+    bool MakeRecord(const PackIndexEntry& entry, Record& record) const;
+
+    MappedFile m_index;
+    std::vector<MappedFile> m_vecPack;
+    const PackIndexHeader* m_pHeader = nullptr;
+    const PackIndexEntry* m_pEntry = nullptr;
+    const char* m_pKeys = nullptr;
+};
@@ -0,0 +1,176 @@
+﻿#pragma once
+
+#include "DecoderBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 이미지별 평면 처리 파이프라인 (컴파일 시간 특수화)
+//   입력 레이아웃(JPEG 서브샘플링)과 출력 프로파일을 템플릿 인자로 받아서 범위 변환/크로마 준비 루프를
+//   상수 계수와 상수 축소 비율로 컴파일한다. 헤더를 읽은 뒤 SelectPlanePipeline 으로 이미지마다 한 번만 고르고,
+//   픽셀 루프 안에는 모드 분기가 없다.
+//
+//   범위 변환은 256 항목 표 조회 대신 정수 곱셈/시프트로 계산한다. 표 조회는 gather 라서 벡터화되지 않지만
+//   이 식은 16 비트 lane 으로 그대로 SIMD 화된다. (결과는 표와 비트 단위로 같다)
+//
+//   출력 프로파일은 두 가지다. 손실(limited-range Y + 중성 크로마)과 무손실(원래 그레이 값 그대로 펼친 ARGB)
+
+// 입력 레이아웃: 이 엔진이 변환하는 JPEG 은 그레이뿐이라 그레이만 인스턴스화한다.
+struct GrayLayout
+{
+    static const int SUBSAMP = JPEG_SUBSAMP_GRAY;
+    static const int COMPONENTS = 1;
+};
+
+// 출력 프로파일: WebP(VP8) 손실 인코더 입력 = limited-range Y(16..235) + 4:2:0 중성 크로마
+struct LimitedRangeProfile
+{
+    static const bool ARGB_INPUT = false;
+    static const int Y_SCALE = 219;         // limited = round(y * 219/255) + 16
+    static const int Y_OFFSET = 16;
+    static const int CHROMA_SHIFT_X = 1;
+    static const int CHROMA_SHIFT_Y = 1;
+    static const uint8_t CHROMA_NEUTRAL = 128;
+};
+
+// 출력 프로파일: WebP 무손실 인코더 입력 = 범위 변환 없이 디코딩한 그레이를 R=G=B 로 펼친 불투명 ARGB
+//   무손실 인코더는 ARGB 만 받는다. 디코딩한 값이 그대로 보존되므로 보관용 결과는 JPEG 디코딩 결과와 비트 단위로 같다.
+struct LosslessProfile
+{
+    static const bool ARGB_INPUT = true;
+};
+
+// 기준 구현 (표 조회). 특수화한 루프의 정답이자 벤치마크 비교 대상
+struct LimitedRangeTable
+{
+    uint8_t table[256];
+    LimitedRangeTable()
+    {
+        for (int y = 0; y < 256; ++y)
+            table[y] = static_cast<uint8_t>((y * LimitedRangeProfile::Y_SCALE + 127) / 255 + LimitedRangeProfile::Y_OFFSET);
+    }
+};
+
+inline void MapRangeGeneric(const LimitedRangeTable& table, uint8_t* pPlane, size_t nSize)
+{
+    for (size_t p = 0; p < nSize; ++p)
+        pPlane[p] = table.table[pPlane[p]];
+}
+
+// (y * SCALE + 127) / 255 를 나눗셈 없이: x / 255 == (x + 1 + (x >> 8)) >> 8  (0 <= x < 65535)
+template <typename Profile>
+inline void MapRangePlane(uint8_t* pPlane, size_t nSize)
+{
+    static_assert(255 * Profile::Y_SCALE + 127 + 1 + 255 < 65536, "16 비트 lane 안에서 계산할 수 있어야 한다");
+    // 고정 길이 블록으로 나눠서 반복 수가 컴파일 시간 상수인 안쪽 루프를 만든다. (보수적인 벡터화 비용 모델에서도 SIMD 화됨)
+    const size_t BLOCK = 32;
+    size_t p = 0;
+    for (; p + BLOCK <= nSize; p += BLOCK)
+    {
+        uint8_t* pBlock = pPlane + p;
+        for (size_t i = 0; i < BLOCK; ++i)
+        {
+            const uint16_t v = static_cast<uint16_t>(pBlock[i] * Profile::Y_SCALE + 127);
+            pBlock[i] = static_cast<uint8_t>(((v + 1 + (v >> 8)) >> 8) + Profile::Y_OFFSET);
+        }
+    }
+    for (; p < nSize; ++p)
+    {
+        const uint16_t v = static_cast<uint16_t>(pPlane[p] * Profile::Y_SCALE + 127);
+        pPlane[p] = static_cast<uint8_t>(((v + 1 + (v >> 8)) >> 8) + Profile::Y_OFFSET);
+    }
+}
+
+// 무손실: 범위 변환하지 않는다.
+template <>
+inline void MapRangePlane<LosslessProfile>(uint8_t* /*pPlane*/, size_t /*nSize*/)
+{
+}
+
+// 그레이 -> 불투명 ARGB (0xFF000000 | g * 0x010101). MapRangePlane 과 같이 고정 길이 블록으로 나눠서 벡터화한다.
+inline void ExpandGrayToArgb(const uint8_t* pY, int nYStride, int nWidth, int nHeight, uint32_t* pArgb)
+{
+    const int BLOCK = 16;
+    for (int y = 0; y < nHeight; ++y)
+    {
+        const uint8_t* pRow = pY + static_cast<size_t>(y) * static_cast<size_t>(nYStride);
+        uint32_t* pOut = pArgb + static_cast<size_t>(y) * static_cast<size_t>(nWidth);
+        int x = 0;
+        for (; x + BLOCK <= nWidth; x += BLOCK)
+        {
+            for (int i = 0; i < BLOCK; ++i)
+                pOut[x + i] = 0xFF000000u | (static_cast<uint32_t>(pRow[x + i]) * 0x010101u);
+        }
+        for (; x < nWidth; ++x)
+            pOut[x] = 0xFF000000u | (static_cast<uint32_t>(pRow[x]) * 0x010101u);
+    }
+}
+
+template <typename Profile>
+inline int GetChromaWidth(int nWidth)
+{
+    return (nWidth + (1 << Profile::CHROMA_SHIFT_X) - 1) >> Profile::CHROMA_SHIFT_X;
+}
+
+template <typename Profile>
+inline int GetChromaHeight(int nHeight)
+{
+    return (nHeight + (1 << Profile::CHROMA_SHIFT_Y) - 1) >> Profile::CHROMA_SHIFT_Y;
+}
+
+// 그레이 입력의 U/V 는 모두 중성값이라 두 평면이 같은 버퍼를 공유한다.
+template <typename Profile>
+inline void PrepareNeutralChroma(uint8_t* pUV, size_t nSize)
+{
+    std::memset(pUV, Profile::CHROMA_NEUTRAL, nSize);
+}
+
+// 이미지 하나에 쓸 루프 묶음 (레이아웃 x 프로파일 인스턴스)
+//   bArgbInput 이면 pfnExpandArgb 만, 아니면 크로마 함수들만 채워진다.
+struct PlanePipeline
+{
+    const char* pszName;
+    bool bArgbInput;
+    void (*pfnMapRange)(uint8_t* pPlane, size_t nSize);
+    int (*pfnGetChromaWidth)(int nWidth);
+    int (*pfnGetChromaHeight)(int nHeight);
+    void (*pfnPrepareChroma)(uint8_t* pUV, size_t nSize);
+    void (*pfnExpandArgb)(const uint8_t* pY, int nYStride, int nWidth, int nHeight, uint32_t* pArgb);
+};
+
+template <typename Layout, typename Profile>
+PlanePipeline MakePlanePipeline(const char* pszName)
+{
+    PlanePipeline pipeline = { pszName, Profile::ARGB_INPUT, &MapRangePlane<Profile>, nullptr, nullptr, nullptr, nullptr };
+    if constexpr (Profile::ARGB_INPUT)
+    {
+        pipeline.pfnExpandArgb = &ExpandGrayToArgb;
+    }
+    else
+    {
+        pipeline.pfnGetChromaWidth = &GetChromaWidth<Profile>;
+        pipeline.pfnGetChromaHeight = &GetChromaHeight<Profile>;
+        pipeline.pfnPrepareChroma = &PrepareNeutralChroma<Profile>;
+    }
+    return pipeline;
+}
+
+template <typename Layout, typename Profile>
+const PlanePipeline& GetPlanePipeline(const char* pszName)
+{
+    static const PlanePipeline pipeline = MakePlanePipeline<Layout, Profile>(pszName);
+    return pipeline;
+}
+
+// 헤더의 서브샘플링과 출력 방식으로 파이프라인을 고른다. 변환할 수 없는 레이아웃이면 nullptr (CONVERT_ERR_NOT_GRAY)
+inline const PlanePipeline* SelectPlanePipeline(int nSubSampling, bool bLossless = false)
+{
+    switch (nSubSampling)
+    {
+    case JPEG_SUBSAMP_GRAY:
+        return bLossless ? &GetPlanePipeline<GrayLayout, LosslessProfile>("gray/lossless")
+                         : &GetPlanePipeline<GrayLayout, LimitedRangeProfile>("gray/limited");
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,141 @@
+﻿#include "ProcessUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <climits>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace ProcessUtil
+{
+#ifdef _WIN32
+    // CommandLineToArgvW 규칙에 맞게 인자 하나를 따옴표로 감싼다. (따옴표 앞의 '\' 는 두 배로)
+    static void AppendQuoted(std::string& strCommandLine, const std::string& strArg)
+    {
+        if (!strCommandLine.empty())
+            strCommandLine += ' ';
+        if (!strArg.empty() && strArg.find_first_of(" \t\"") == std::string::npos)
+        {
+            strCommandLine += strArg;
+            return;
+        }
+
+        strCommandLine += '"';
+        size_t nBackslash = 0;
+        for (char ch : strArg)
+        {
+            if (ch == '\\')
+            {
+                ++nBackslash;
+                continue;
+            }
+            strCommandLine.append(ch == '"' ? nBackslash * 2 + 1 : nBackslash, '\\');
+            strCommandLine += ch;
+            nBackslash = 0;
+        }
+        strCommandLine.append(nBackslash * 2, '\\');
+        strCommandLine += '"';
+    }
+#endif
+
+    bool Process::IsValid() const
+    {
+#ifdef _WIN32
+        return hProcess != nullptr;
+#else
+        return nPid > 0;
+#endif
+    }
+
+    bool Spawn(const std::vector<std::string>& vecArgs, Process& process)
+    {
+        if (vecArgs.empty())
+            return false;
+
+#ifdef _WIN32
+        std::string strCommandLine;
+        for (const auto& strArg : vecArgs)
+            AppendQuoted(strCommandLine, strArg);
+
+        STARTUPINFOA startupInfo = {};
+        startupInfo.cb = sizeof(startupInfo);
+        PROCESS_INFORMATION processInfo = {};
+        if (!CreateProcessA(vecArgs[0].c_str(), &strCommandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+            return false;
+
+        CloseHandle(processInfo.hThread);
+        process.hProcess = processInfo.hProcess;
+        return true;
+#else
+        std::vector<char*> vecArgv;
+        for (const auto& strArg : vecArgs)
+            vecArgv.push_back(const_cast<char*>(strArg.c_str()));
+        vecArgv.push_back(nullptr);
+
+        const pid_t nPid = fork();
+        if (nPid < 0)
+            return false;
+        if (nPid == 0)
+        {
+            execv(vecArgv[0], vecArgv.data());
+            _exit(127);
+        }
+        process.nPid = nPid;
+        return true;
+#endif
+    }
+
+    bool TryWait(Process& process, int& nExitCode)
+    {
+        if (!process.IsValid())
+            return false;
+
+#ifdef _WIN32
+        if (WaitForSingleObject(process.hProcess, 0) != WAIT_OBJECT_0)
+            return false;
+
+        DWORD dwExitCode = 0;
+        GetExitCodeProcess(process.hProcess, &dwExitCode);
+        CloseHandle(process.hProcess);
+        process.hProcess = nullptr;
+        nExitCode = static_cast<int>(dwExitCode);
+        return true;
+#else
+        int nStatus = 0;
+        if (waitpid(process.nPid, &nStatus, WNOHANG) != process.nPid)
+            return false;
+
+        process.nPid = -1;
+        nExitCode = WIFEXITED(nStatus) ? WEXITSTATUS(nStatus) : (WIFSIGNALED(nStatus) ? 128 + WTERMSIG(nStatus) : 1);
+        return true;
+#endif
+    }
+
+    bool Kill(Process& process)
+    {
+        if (!process.IsValid())
+            return false;
+
+#ifdef _WIN32
+        return TerminateProcess(process.hProcess, 128 + 9) != FALSE;
+#else
+        return kill(process.nPid, SIGKILL) == 0;
+#endif
+    }
+
+    std::string GetExecutablePath()
+    {
+#ifdef _WIN32
+        char szPath[MAX_PATH] = {};
+        const DWORD dwLength = GetModuleFileNameA(nullptr, szPath, MAX_PATH);
+        return (dwLength > 0 && dwLength < MAX_PATH) ? std::string(szPath, dwLength) : std::string();
+#else
+        char szPath[PATH_MAX] = {};
+        const ssize_t nLength = readlink("/proc/self/exe", szPath, sizeof(szPath) - 1);
+        return (nLength > 0) ? std::string(szPath, static_cast<size_t>(nLength)) : std::string();
+#endif
+    }
+}
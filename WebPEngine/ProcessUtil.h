@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+// CreateProcess / fork+exec 차이를 감추는 최소 래퍼 (shard run 과 테스트가 같은 실행 파일의 작업자를 띄울 때 사용)
+namespace ProcessUtil
+{
+    struct Process
+    {
+#ifdef _WIN32
+        void* hProcess = nullptr;   // HANDLE
+#else
+        int nPid = -1;
+#endif
+        bool IsValid() const;
+    };
+
+    // vecArgs[0] 은 실행 파일 경로. 표준 입출력은 물려받는다.
+    bool Spawn(const std::vector<std::string>& vecArgs, Process& process);
+
+    // 끝났으면 종료 코드를 채우고 true (기다리지 않음). 신호로 죽은 POSIX 프로세스는 128 + 신호 번호
+    // Windows 의 예외 종료 코드(0xC0000005 등)는 int 로 바꾸면 음수가 된다. 호출하는 쪽은 알고 있는 정상 코드만 골라낸다.
+    bool TryWait(Process& process, int& nExitCode);
+
+    // 강제로 끝낸다. (SIGKILL / TerminateProcess, Windows 종료 코드는 POSIX 와 같게 128 + 9) 회수는 TryWait 로
+    bool Kill(Process& process);
+
+    // 지금 실행 중인 파일의 경로 (/proc/self/exe, GetModuleFileName). 실패하면 빈 문자열
+    std::string GetExecutablePath();
+}
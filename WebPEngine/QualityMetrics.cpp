@@ -0,0 +1,247 @@
+﻿#include "QualityMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WEBP_METRICS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define WEBP_METRICS_NEON
+#endif
+
+namespace
+{
+    const int SSIM_WINDOW = 8;      // SSIM 창 크기
+    const int SSIM_STEP = 4;        // 창 이동 간격 (겹쳐서 계산)
+    const double SSIM_C1 = (0.01 * 255) * (0.01 * 255);
+    const double SSIM_C2 = (0.03 * 255) * (0.03 * 255);
+    const double MAX_PSNR = 99.0;
+
+    struct WindowStats
+    {
+        uint32_t nSumX = 0, nSumY = 0;
+        uint32_t nSumXX = 0, nSumYY = 0, nSumXY = 0;
+        uint32_t nCount = 0;
+    };
+
+    uint64_t SquaredErrorRow(const uint8_t* pA, const uint8_t* pB, int nWidth)
+    {
+        uint64_t nSum = 0;
+        int x = 0;
+#if defined(WEBP_METRICS_SSE2)
+        // 16 픽셀씩: 16bit 로 늘려 차이를 구하고 madd 로 제곱합을 32bit 4 lane 에 누적 (한 행 안에서는 넘치지 않음)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        for (; x + 16 <= nWidth; x += 16)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pA + x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pB + x));
+            const __m128i dLo = _mm_sub_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            const __m128i dHi = _mm_sub_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(dLo, dLo));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(dHi, dHi));
+        }
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        nSum = static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#elif defined(WEBP_METRICS_NEON)
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (; x + 16 <= nWidth; x += 16)
+        {
+            const uint8x16_t a = vld1q_u8(pA + x);
+            const uint8x16_t b = vld1q_u8(pB + x);
+            const uint8x16_t d = vabdq_u8(a, b);
+            const uint16x8_t dLo = vmull_u8(vget_low_u8(d), vget_low_u8(d));
+            const uint16x8_t dHi = vmull_u8(vget_high_u8(d), vget_high_u8(d));
+            acc = vpadalq_u16(acc, dLo);
+            acc = vpadalq_u16(acc, dHi);
+        }
+        nSum = static_cast<uint64_t>(vgetq_lane_u32(acc, 0)) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+        for (; x < nWidth; ++x)
+        {
+            const int d = static_cast<int>(pA[x]) - static_cast<int>(pB[x]);
+            nSum += static_cast<uint64_t>(d * d);
+        }
+        return nSum;
+    }
+
+    // 8x8 창 통계 (벡터화)
+    void WindowStats8x8(const uint8_t* pA, int nStrideA, const uint8_t* pB, int nStrideB, WindowStats& stats)
+    {
+#if defined(WEBP_METRICS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        __m128i sumX = _mm_setzero_si128(), sumY = _mm_setzero_si128();
+        __m128i sumXX = _mm_setzero_si128(), sumYY = _mm_setzero_si128(), sumXY = _mm_setzero_si128();
+        for (int y = 0; y < SSIM_WINDOW; ++y)
+        {
+            const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pA + y * nStrideA)), zero);
+            const __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pB + y * nStrideB)), zero);
+            sumX = _mm_add_epi32(sumX, _mm_madd_epi16(a, one));
+            sumY = _mm_add_epi32(sumY, _mm_madd_epi16(b, one));
+            sumXX = _mm_add_epi32(sumXX, _mm_madd_epi16(a, a));
+            sumYY = _mm_add_epi32(sumYY, _mm_madd_epi16(b, b));
+            sumXY = _mm_add_epi32(sumXY, _mm_madd_epi16(a, b));
+        }
+
+        auto reduce = [](__m128i v) -> uint32_t
+        {
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+        };
+        stats.nSumX = reduce(sumX);
+        stats.nSumY = reduce(sumY);
+        stats.nSumXX = reduce(sumXX);
+        stats.nSumYY = reduce(sumYY);
+        stats.nSumXY = reduce(sumXY);
+#elif defined(WEBP_METRICS_NEON)
+        uint32x4_t sumX = vdupq_n_u32(0), sumY = vdupq_n_u32(0);
+        uint32x4_t sumXX = vdupq_n_u32(0), sumYY = vdupq_n_u32(0), sumXY = vdupq_n_u32(0);
+        for (int y = 0; y < SSIM_WINDOW; ++y)
+        {
+            const uint8x8_t a = vld1_u8(pA + y * nStrideA);
+            const uint8x8_t b = vld1_u8(pB + y * nStrideB);
+            sumX = vpadalq_u16(sumX, vmovl_u8(a));
+            sumY = vpadalq_u16(sumY, vmovl_u8(b));
+            sumXX = vpadalq_u16(sumXX, vmull_u8(a, a));
+            sumYY = vpadalq_u16(sumYY, vmull_u8(b, b));
+            sumXY = vpadalq_u16(sumXY, vmull_u8(a, b));
+        }
+        stats.nSumX = vaddvq_u32(sumX);
+        stats.nSumY = vaddvq_u32(sumY);
+        stats.nSumXX = vaddvq_u32(sumXX);
+        stats.nSumYY = vaddvq_u32(sumYY);
+        stats.nSumXY = vaddvq_u32(sumXY);
+#else
+        stats = WindowStats();
+        for (int y = 0; y < SSIM_WINDOW; ++y)
+        {
+            for (int x = 0; x < SSIM_WINDOW; ++x)
+            {
+                const uint32_t a = pA[y * nStrideA + x];
+                const uint32_t b = pB[y * nStrideB + x];
+                stats.nSumX += a;
+                stats.nSumY += b;
+                stats.nSumXX += a * a;
+                stats.nSumYY += b * b;
+                stats.nSumXY += a * b;
+            }
+        }
+#endif
+        stats.nCount = SSIM_WINDOW * SSIM_WINDOW;
+    }
+
+    // 8x8 보다 작은 영역 (작은 이미지/가장자리 타일) 은 영역 전체를 창 하나로 본다.
+    void WindowStatsScalar(const uint8_t* pA, int nStrideA, const uint8_t* pB, int nStrideB, int nWidth, int nHeight, WindowStats& stats)
+    {
+        stats = WindowStats();
+        for (int y = 0; y < nHeight; ++y)
+        {
+            for (int x = 0; x < nWidth; ++x)
+            {
+                const uint32_t a = pA[y * nStrideA + x];
+                const uint32_t b = pB[y * nStrideB + x];
+                stats.nSumX += a;
+                stats.nSumY += b;
+                stats.nSumXX += a * a;
+                stats.nSumYY += b * b;
+                stats.nSumXY += a * b;
+            }
+        }
+        stats.nCount = static_cast<uint32_t>(nWidth * nHeight);
+    }
+
+    double SsimFromStats(const WindowStats& stats)
+    {
+        const double n = stats.nCount;
+        const double mx = stats.nSumX / n;
+        const double my = stats.nSumY / n;
+        const double vx = stats.nSumXX / n - mx * mx;
+        const double vy = stats.nSumYY / n - my * my;
+        const double cov = stats.nSumXY / n - mx * my;
+        return ((2.0 * mx * my + SSIM_C1) * (2.0 * cov + SSIM_C2)) / ((mx * mx + my * my + SSIM_C1) * (vx + vy + SSIM_C2));
+    }
+
+    struct Accumulator
+    {
+        uint64_t nSquaredError = 0;
+        uint64_t nPixels = 0;
+        double fSsimSum = 0.0;
+        uint64_t nWindows = 0;
+    };
+
+    void AccumulateArea(const uint8_t* pRef, int nRefStride, const uint8_t* pTest, int nTestStride, int nWidth, int nHeight, Accumulator& acc)
+    {
+        acc.nSquaredError += ComputeSquaredError(pRef, nRefStride, pTest, nTestStride, nWidth, nHeight);
+        acc.nPixels += static_cast<uint64_t>(nWidth) * static_cast<uint64_t>(nHeight);
+
+        WindowStats stats;
+        if (nWidth < SSIM_WINDOW || nHeight < SSIM_WINDOW)
+        {
+            WindowStatsScalar(pRef, nRefStride, pTest, nTestStride, nWidth, nHeight, stats);
+            acc.fSsimSum += SsimFromStats(stats);
+            ++acc.nWindows;
+            return;
+        }
+
+        for (int y = 0; y + SSIM_WINDOW <= nHeight; y += SSIM_STEP)
+        {
+            for (int x = 0; x + SSIM_WINDOW <= nWidth; x += SSIM_STEP)
+            {
+                WindowStats8x8(pRef + static_cast<size_t>(y) * nRefStride + x, nRefStride, pTest + static_cast<size_t>(y) * nTestStride + x, nTestStride, stats);
+                acc.fSsimSum += SsimFromStats(stats);
+                ++acc.nWindows;
+            }
+        }
+    }
+}
+
+uint64_t ComputeSquaredError(const uint8_t* pRef, int nRefStride, const uint8_t* pTest, int nTestStride, int nWidth, int nHeight)
+{
+    uint64_t nSum = 0;
+    for (int y = 0; y < nHeight; ++y)
+        nSum += SquaredErrorRow(pRef + static_cast<size_t>(y) * nRefStride, pTest + static_cast<size_t>(y) * nTestStride, nWidth);
+    return nSum;
+}
+
+QualityScore MeasureQuality(const uint8_t* pRef, int nRefStride, const uint8_t* pTest, int nTestStride, int nWidth, int nHeight, const VerifyOption& option)
+{
+    Accumulator acc;
+    if (option.nTileSize <= 0 || (option.nTileSize >= nWidth && option.nTileSize >= nHeight))
+    {
+        AccumulateArea(pRef, nRefStride, pTest, nTestStride, nWidth, nHeight, acc);
+    }
+    else
+    {
+        // 대각선 방향으로 표본을 고르면 모든 행/열 대역이 골고루 포함된다.
+        const int nTile = option.nTileSize;
+        const int nTileEvery = std::max(1, option.nTileEvery);
+        for (int ty = 0; ty * nTile < nHeight; ++ty)
+        {
+            for (int tx = 0; tx * nTile < nWidth; ++tx)
+            {
+                if ((tx + ty) % nTileEvery != 0)
+                    continue;
+
+                const int x = tx * nTile;
+                const int y = ty * nTile;
+                const size_t nRefOffset = static_cast<size_t>(y) * nRefStride + x;
+                const size_t nTestOffset = static_cast<size_t>(y) * nTestStride + x;
+                AccumulateArea(pRef + nRefOffset, nRefStride, pTest + nTestOffset, nTestStride, std::min(nTile, nWidth - x), std::min(nTile, nHeight - y), acc);
+            }
+        }
+    }
+
+    QualityScore score;
+    score.nPixels = acc.nPixels;
+    if (acc.nPixels == 0)
+        return score;
+
+    const double fMse = static_cast<double>(acc.nSquaredError) / static_cast<double>(acc.nPixels);
+    score.fPsnr = (fMse > 0.0) ? std::min(MAX_PSNR, 10.0 * std::log10(255.0 * 255.0 / fMse)) : MAX_PSNR;
+    score.fSsim = acc.nWindows ? acc.fSsimSum / static_cast<double>(acc.nWindows) : 1.0;
+    return score;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// 변환 결과 품질 검증 (PSNR / SSIM)
+//   기준 평면과 WebP 를 다시 디코딩한 Y 평면을 비교한다. 내부 커널은 SSE2 / NEON 으로 벡터화되어 있고 그 밖의 CPU 에서는 스칼라로 계산한다.
+
+struct VerifyOption
+{
+    int nEvery = 0;             // 0 = 검증 안 함, 1 = 모든 이미지, N = N 장마다 한 장
+    int nTileSize = 0;          // 0 = 이미지 전체 비교, 아니면 이 크기의 타일 격자에서 일부만 비교
+    int nTileEvery = 4;         // 타일 표본 간격 ((tx + ty) % nTileEvery == 0 인 대각선 타일만)
+    double fMinPsnr = 0.0;      // 이 값보다 낮으면 실패 표시 (0 = 검사 안 함)
+    double fMinSsim = 0.0;
+
+    bool IsEnabled() const { return nEvery > 0; }
+};
+
+struct QualityScore
+{
+    double fPsnr = 0.0;         // dB (완전히 같으면 99)
+    double fSsim = 0.0;         // 0..1
+    uint64_t nPixels = 0;       // 실제로 비교한 픽셀 수 (타일 표본이면 일부)
+};
+
+// 두 8bit 평면을 비교한다. option 의 타일 설정으로 표본을 고른다.
+QualityScore MeasureQuality(const uint8_t* pRef, int nRefStride, const uint8_t* pTest, int nTestStride, int nWidth, int nHeight, const VerifyOption& option);
+
+// 제곱 오차 합 (벡터화)
+uint64_t ComputeSquaredError(const uint8_t* pRef, int nRefStride, const uint8_t* pTest, int nTestStride, int nWidth, int nHeight);
@@ -0,0 +1,62 @@
+﻿#include "RunReport.h"
+#include <iostream>
+
+namespace
+{
+    // 이름에 ',' 나 '"' 가 있으면 CSV 규칙대로 따옴표로 감싼다.
+    void WriteCsvField(std::ostream& os, const std::string& strValue)
+    {
+        if (strValue.find_first_of(",\"\r\n") == std::string::npos)
+        {
+            os << strValue;
+            return;
+        }
+
+        os << '"';
+        for (char ch : strValue)
+        {
+            if (ch == '"')
+                os << '"';
+            os << ch;
+        }
+        os << '"';
+    }
+}
+
+bool ReportSink::Open(const std::string& strPath)
+{
+    m_file.open(strPath, std::ios::out | std::ios::trunc);
+    if (!m_file)
+    {
+        std::cerr << "Error: 보고서 파일을 만들지 못했습니다: " << strPath << "\n";
+        return false;
+    }
+
+    m_file << "name,status,width,height,in_bytes,out_bytes,quality,psnr,ssim,verify\n";
+    return true;
+}
+
+bool ReportSink::Write(OutputItem& item)
+{
+    const ConvertResult& result = item.result;
+    WriteCsvField(m_file, item.strName);
+    m_file << ',' << GetConvertStatusString(result.eStatus) << ',' << result.nWidth << ',' << result.nHeight
+        << ',' << result.nInputSize << ',' << result.nOutputSize << ',' << result.fQuality << ',';
+
+    if (result.bVerified)
+        m_file << result.score.fPsnr << ',' << result.score.fSsim << ',' << (result.bVerifyFailed ? "fail" : "pass") << '\n';
+    else
+        m_file << ",,-\n";
+
+    // 보고서 기록 실패는 변환 결과와 별개이므로 출력은 계속 넘긴다.
+    return m_inner.Write(item);
+}
+
+bool ReportSink::Finish()
+{
+    m_file.flush();
+    const bool bReportOk = static_cast<bool>(m_file);
+    if (!bReportOk)
+        std::cerr << "Error: 보고서 기록 실패\n";
+    return m_inner.Finish() && bReportOk;
+}
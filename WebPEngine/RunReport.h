@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include <fstream>
+#include <string>
+
+// 실행 보고서 (항목별 CSV)
+//   다른 출력 대상 앞에 끼워서 항목마다 한 줄을 남기고 그대로 넘긴다.
+//   name,status,width,height,in_bytes,out_bytes,quality,psnr,ssim,verify
+//   verify 는 "-" (표본 아님) / "pass" / "fail". 표본이 아니면 psnr/ssim 칸은 비운다.
+class ReportSink : public IOutputSink
+{
+public:
+    explicit ReportSink(IOutputSink& inner) : m_inner(inner) {}
+
+    bool Open(const std::string& strPath);
+
+    bool Write(OutputItem& item) override;
+    bool Finish() override;
+
+private:
+    IOutputSink& m_inner;
+    std::ofstream m_file;
+};
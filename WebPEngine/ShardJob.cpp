@@ -0,0 +1,441 @@
+﻿#include "ShardJob.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char* const MANIFEST_NAME = "manifest.txt";
+    const char* const MANIFEST_MAGIC = "webp-shard 1";
+    const char* const COMPLETE_FENCE = "complete";   // Complete 가 만든 다음 세대 임대 파일의 내용
+
+    uint64_t HashPath(const std::string& strPath)
+    {
+        uint64_t nHash = 14695981039346656037ull; // FNV-1a 64
+        for (unsigned char ch : strPath)
+        {
+            nHash ^= ch;
+            nHash *= 1099511628211ull;
+        }
+        return nHash;
+    }
+
+    // 임시 이름으로 쓴 뒤 바꿔서, 읽는 쪽이 반쯤 쓴 파일을 보지 않게 한다.
+    bool WriteTextAtomic(const std::string& strPath, const std::string& strText)
+    {
+        const std::string strTempPath = strPath + ".tmp";
+        {
+            std::ofstream ofs(strTempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!ofs)
+                return false;
+            ofs << strText;
+            ofs.flush();
+            if (!ofs)
+                return false;
+        }
+
+        std::error_code ec;
+        fs::rename(strTempPath, strPath, ec);
+        if (ec)
+        {
+            fs::remove(strTempPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // 보고서 한 줄의 두 번째 칸 (status). 이름 칸은 따옴표로 감싸져 있을 수 있다.
+    std::string GetStatusField(const std::string& strLine)
+    {
+        size_t nPos = 0;
+        if (!strLine.empty() && strLine[0] == '"')
+        {
+            nPos = 1;
+            while (nPos < strLine.size())
+            {
+                if (strLine[nPos] == '"')
+                {
+                    if (nPos + 1 < strLine.size() && strLine[nPos + 1] == '"')
+                    {
+                        nPos += 2;
+                        continue;
+                    }
+                    ++nPos;
+                    break;
+                }
+                ++nPos;
+            }
+        }
+        nPos = strLine.find(',', nPos);
+        if (nPos == std::string::npos)
+            return std::string();
+        const size_t nEnd = strLine.find(',', nPos + 1);
+        return strLine.substr(nPos + 1, (nEnd == std::string::npos) ? std::string::npos : nEnd - nPos - 1);
+    }
+}
+
+const char* GetShardSplitString(SHARD_SPLIT eSplit)
+{
+    switch (eSplit)
+    {
+    case SHARD_SPLIT_HASH: return "hash";
+    case SHARD_SPLIT_SIZE: return "size";
+    default:               return "unknown";
+    }
+}
+
+bool ParseShardSplit(const std::string& strText, SHARD_SPLIT& eSplit)
+{
+    for (SHARD_SPLIT e : { SHARD_SPLIT_HASH, SHARD_SPLIT_SIZE })
+    {
+        if (strText == GetShardSplitString(e))
+        {
+            eSplit = e;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::vector<std::string>> SplitShards(const std::vector<ShardFile>& vecFile, int nShardCount, SHARD_SPLIT eSplit)
+{
+    std::vector<std::vector<std::string>> vecShard(static_cast<size_t>(std::max(nShardCount, 1)));
+    const uint64_t nShards = vecShard.size();
+
+    if (eSplit == SHARD_SPLIT_HASH)
+    {
+        for (const auto& file : vecFile)
+            vecShard[static_cast<size_t>(HashPath(file.strPath) % nShards)].push_back(file.strPath);
+        return vecShard;
+    }
+
+    // 이름순으로 늘어놓고, 각 파일의 바이트 중간 지점이 전체의 몇 번째 1/N 에 떨어지는지로 조각을 정한다.
+    // 조각 번호가 단조 증가하므로 연속 구간이 되고, 큰 파일 하나가 경계를 밀어도 이웃 조각과 바이트가 비슷해진다.
+    std::vector<const ShardFile*> vecSorted;
+    vecSorted.reserve(vecFile.size());
+    uint64_t nTotal = 0;
+    for (const auto& file : vecFile)
+    {
+        vecSorted.push_back(&file);
+        nTotal += file.nSize;
+    }
+    std::sort(vecSorted.begin(), vecSorted.end(), [](const ShardFile* a, const ShardFile* b) { return a->strPath < b->strPath; });
+
+    // 크기를 모르면 (모두 0) 파일 수로 나눈다.
+    const bool bByCount = (nTotal == 0);
+    if (bByCount)
+        nTotal = vecSorted.size();
+
+    uint64_t nPrefix = 0;
+    for (const ShardFile* pFile : vecSorted)
+    {
+        const uint64_t nWeight = bByCount ? 1 : pFile->nSize;
+        const double fMid = static_cast<double>(nPrefix) + static_cast<double>(nWeight) / 2.0;
+        const uint64_t nIndex = std::min<uint64_t>(static_cast<uint64_t>(fMid * static_cast<double>(nShards) / static_cast<double>(nTotal)), nShards - 1);
+        vecShard[static_cast<size_t>(nIndex)].push_back(pFile->strPath);
+        nPrefix += nWeight;
+    }
+    return vecShard;
+}
+
+bool ShardJob::Create(const std::string& strJobDir, const std::vector<ShardFile>& vecFile, int nShardCount, SHARD_SPLIT eSplit,
+                      int nLeaseSec, const std::vector<std::string>& vecArgs, std::string& strError)
+{
+    if (nShardCount < 1 || nLeaseSec < 1)
+    {
+        strError = "조각 수와 임대 시간은 1 이상이어야 합니다.";
+        return false;
+    }
+
+    std::error_code ec;
+    const fs::path jobDir(strJobDir);
+    if (fs::exists(jobDir / MANIFEST_NAME, ec))
+    {
+        strError = "이미 계획된 작업 폴더입니다: " + strJobDir;
+        return false;
+    }
+    fs::create_directories(jobDir, ec);
+    if (ec)
+    {
+        strError = "작업 폴더를 만들지 못했습니다: " + strJobDir;
+        return false;
+    }
+
+    ShardJob job;
+    job.m_strJobDir = strJobDir;
+    const std::vector<std::vector<std::string>> vecShard = SplitShards(vecFile, nShardCount, eSplit);
+    for (size_t s = 0; s < vecShard.size(); ++s)
+    {
+        std::string strList;
+        for (const auto& strPath : vecShard[s])
+            strList += strPath + "\n";
+        if (!WriteTextAtomic(job.GetShardPath(static_cast<int>(s), ".list"), strList))
+        {
+            strError = "조각 목록을 쓰지 못했습니다: " + job.GetShardPath(static_cast<int>(s), ".list");
+            return false;
+        }
+    }
+
+    // 매니페스트는 마지막에 쓴다. 매니페스트가 보이면 조각 목록은 모두 있다.
+    std::ostringstream oss;
+    oss << MANIFEST_MAGIC << "\n"
+        << "shards " << nShardCount << "\n"
+        << "split " << GetShardSplitString(eSplit) << "\n"
+        << "files " << vecFile.size() << "\n"
+        << "lease " << nLeaseSec << "\n"
+        << "base " << fs::current_path(ec).string() << "\n";
+    for (const auto& strArg : vecArgs)
+        oss << "arg " << strArg << "\n";
+    if (!WriteTextAtomic((jobDir / MANIFEST_NAME).string(), oss.str()))
+    {
+        strError = "매니페스트를 쓰지 못했습니다: " + (jobDir / MANIFEST_NAME).string();
+        return false;
+    }
+    return true;
+}
+
+bool ShardJob::Open(const std::string& strJobDir)
+{
+    m_strJobDir = strJobDir;
+    m_nShardCount = 0;
+    m_strBaseDir.clear();
+    m_vecArgs.clear();
+
+    std::ifstream ifs((fs::path(strJobDir) / MANIFEST_NAME).string());
+    std::string strLine;
+    if (!ifs || !std::getline(ifs, strLine) || strLine != MANIFEST_MAGIC)
+        return false;
+
+    while (std::getline(ifs, strLine))
+    {
+        const size_t nSpace = strLine.find(' ');
+        if (nSpace == std::string::npos)
+            continue;
+        const std::string strKey = strLine.substr(0, nSpace);
+        const std::string strValue = strLine.substr(nSpace + 1);
+        if (strKey == "shards")
+            m_nShardCount = std::atoi(strValue.c_str());
+        else if (strKey == "split" && !ParseShardSplit(strValue, m_eSplit))
+            return false;
+        else if (strKey == "files")
+            m_nFileCount = std::strtoull(strValue.c_str(), nullptr, 10);
+        else if (strKey == "lease")
+            m_nLeaseSec = std::max(std::atoi(strValue.c_str()), 1);
+        else if (strKey == "base")
+            m_strBaseDir = strValue;
+        else if (strKey == "arg")
+            m_vecArgs.push_back(strValue);
+    }
+    return m_nShardCount > 0;
+}
+
+bool ShardJob::LoadShardFiles(int nShard, std::vector<std::string>& vecPath) const
+{
+    vecPath.clear();
+    std::ifstream ifs(GetShardPath(nShard, ".list"));
+    if (!ifs)
+        return false;
+
+    std::string strLine;
+    while (std::getline(ifs, strLine))
+    {
+        if (!strLine.empty() && strLine.back() == '\r')
+            strLine.pop_back();
+        if (!strLine.empty())
+            vecPath.push_back(strLine);
+    }
+    return true;
+}
+
+std::string ShardJob::GetShardPath(int nShard, const char* pszSuffix) const
+{
+    char szName[32];
+    std::snprintf(szName, sizeof(szName), "shard_%04d", nShard);
+    return (fs::path(m_strJobDir) / (std::string(szName) + pszSuffix)).string();
+}
+
+std::string ShardJob::GetLeasePath(int nShard, int nGeneration) const
+{
+    return GetShardPath(nShard, ".lease.") + std::to_string(nGeneration);
+}
+
+std::string ShardJob::GetReportPath(int nShard) const
+{
+    return GetShardPath(nShard, ".csv");
+}
+
+std::string ShardJob::GetWorkReportPath(int nShard, int nGeneration) const
+{
+    return GetShardPath(nShard, ".csv.") + std::to_string(nGeneration);
+}
+
+bool ShardJob::IsDone(int nShard) const
+{
+    std::error_code ec;
+    return fs::exists(GetShardPath(nShard, ".done"), ec);
+}
+
+int ShardJob::FindLeaseGeneration(int nShard) const
+{
+    std::error_code ec;
+    int nGeneration = 0;
+    while (fs::exists(GetLeasePath(nShard, nGeneration + 1), ec))
+        ++nGeneration;
+    return nGeneration;
+}
+
+bool ShardJob::IsLeaseExpired(int nShard, int nGeneration) const
+{
+    std::error_code ec;
+    const fs::file_time_type lastRenew = fs::last_write_time(GetLeasePath(nShard, nGeneration), ec);
+    if (ec)
+        return false;   // 방금 만들어지는 중이거나 읽을 수 없으면 살아 있는 것으로 본다.
+    return fs::file_time_type::clock::now() - lastRenew > std::chrono::seconds(m_nLeaseSec);
+}
+
+int ShardJob::Claim(const std::string& strOwner, int& nGeneration)
+{
+    // 작업자마다 다른 조각부터 살펴서 같은 파일을 두고 경쟁하는 횟수를 줄인다.
+    const int nStart = static_cast<int>(HashPath(strOwner) % static_cast<uint64_t>(m_nShardCount));
+    for (int i = 0; i < m_nShardCount; ++i)
+    {
+        const int nShard = (nStart + i) % m_nShardCount;
+        if (IsDone(nShard))
+            continue;
+
+        const int nCurrent = FindLeaseGeneration(nShard);
+        if (nCurrent > 0 && !IsLeaseExpired(nShard, nCurrent))
+            continue;
+
+        // "wx": 이미 있으면 실패 (O_CREAT | O_EXCL). 같은 세대를 먼저 만든 작업자가 가져간다.
+        std::FILE* pFile = std::fopen(GetLeasePath(nShard, nCurrent + 1).c_str(), "wx");
+        if (!pFile)
+            continue;
+        std::fprintf(pFile, "%s\n", strOwner.c_str());
+        std::fclose(pFile);
+
+        nGeneration = nCurrent + 1;
+        return nShard;
+    }
+    return -1;
+}
+
+bool ShardJob::Renew(int nShard, int nGeneration)
+{
+    std::error_code ec;
+    if (fs::exists(GetLeasePath(nShard, nGeneration + 1), ec))
+        return false;
+
+    fs::last_write_time(GetLeasePath(nShard, nGeneration), fs::file_time_type::clock::now(), ec);
+    return !ec;
+}
+
+bool ShardJob::Complete(int nShard, int nGeneration, const std::string& strSummary)
+{
+    // 다음 세대 임대 파일을 완료 표식으로 직접 만든다. 넘겨받으려는 작업자와 같은 파일을 "wx" 로 다투므로
+    // 확인과 완료 사이에 빼앗기는 틈이 없다. 먼저 만든 쪽이 이기고, 진 쪽은 세대 보고서만 지운다.
+    std::error_code ec;
+    const std::string strWorkReport = GetWorkReportPath(nShard, nGeneration);
+    std::FILE* pFence = std::fopen(GetLeasePath(nShard, nGeneration + 1).c_str(), "wx");
+    if (!pFence)
+    {
+        fs::remove(strWorkReport, ec);
+        return false;
+    }
+    std::fprintf(pFence, "%s\n", COMPLETE_FENCE);
+    std::fclose(pFence);
+
+    // 여기서 죽으면 표식 임대가 갱신되지 않아 만료되고, 다음 세대가 조각을 다시 한다.
+    fs::rename(strWorkReport, GetReportPath(nShard), ec);
+    if (ec)
+        return false;
+    // 죽은 이전 세대가 쓰다 만 보고서
+    for (int nOld = 1; nOld < nGeneration; ++nOld)
+        fs::remove(GetWorkReportPath(nShard, nOld), ec);
+    return WriteTextAtomic(GetShardPath(nShard, ".done"), strSummary + "\n");
+}
+
+ShardProgress ShardJob::GetProgress() const
+{
+    ShardProgress progress;
+    progress.nShards = m_nShardCount;
+    for (int nShard = 0; nShard < m_nShardCount; ++nShard)
+    {
+        const int nGeneration = FindLeaseGeneration(nShard);
+        const bool bDone = IsDone(nShard);
+        // 끝난 조각의 마지막 세대는 완료 표식
+        if (nGeneration - (bDone ? 1 : 0) >= 2)
+            ++progress.nReassigned;
+
+        if (bDone)
+            ++progress.nDone;
+        else if (nGeneration == 0)
+            ++progress.nPending;
+        else if (IsLeaseExpired(nShard, nGeneration))
+            ++progress.nExpired;
+        else
+            ++progress.nLeased;
+    }
+    return progress;
+}
+
+bool ShardJob::MergeReports(const std::string& strOutPath, ShardMergeStats& stats) const
+{
+    stats = ShardMergeStats();
+    std::ostringstream oss;
+    bool bHeader = false;
+    for (int nShard = 0; nShard < m_nShardCount; ++nShard)
+    {
+        std::ifstream ifs;
+        if (IsDone(nShard))
+            ifs.open(GetReportPath(nShard));
+        std::string strLine;
+        if (!ifs || !std::getline(ifs, strLine))
+        {
+            ++stats.nMissing;
+            continue;
+        }
+
+        ++stats.nReports;
+        if (!bHeader)
+        {
+            oss << strLine << "\n";
+            bHeader = true;
+        }
+        while (std::getline(ifs, strLine))
+        {
+            if (strLine.empty())
+                continue;
+            oss << strLine << "\n";
+            ++stats.nRows;
+            if (GetStatusField(strLine) != "ok")
+                ++stats.nFailedRows;
+        }
+    }
+    return WriteTextAtomic(strOutPath, oss.str());
+}
+
+std::string ShardJob::MakeOwnerName()
+{
+#ifdef _WIN32
+    const char* pszHost = std::getenv("COMPUTERNAME");
+    const std::string strHost = pszHost ? pszHost : "localhost";
+    return strHost + ":" + std::to_string(_getpid());
+#else
+    char szHost[256] = {};
+    if (gethostname(szHost, sizeof(szHost) - 1) != 0)
+        std::snprintf(szHost, sizeof(szHost), "localhost");
+    return std::string(szHost) + ":" + std::to_string(getpid());
+#endif
+}
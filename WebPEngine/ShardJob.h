@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 여러 프로세스 / 여러 노드로 나눠서 돌리는 배치 (조각 = shard)
+//   조정자가 파일 목록을 조각으로 나눠 작업 폴더(공유 파일 시스템 가능)에 매니페스트를 쓰고,
+//   작업자 프로세스들은 조각을 하나씩 임대(lease)해서 변환한 뒤 조각별 보고서와 완료 표시를 남긴다.
+//
+//   작업 폴더:
+//     manifest.txt            조각 수, 나누는 방식, 파일 수, 임대 시간, 계획한 작업 폴더(상대 경로 기준), 작업자가 쓸 변환 인자
+//     shard_0003.list         조각의 파일 경로 (한 줄에 하나)
+//     shard_0003.lease.2      임대 (세대 2). 내용은 소유자, 수정 시각이 마지막 갱신 시각
+//     shard_0003.csv.2        세대 2 작업자가 쓰는 중인 보고서 (ReportSink 형식)
+//     shard_0003.csv          완료된 조각 보고서 (임대를 가진 채 끝낸 세대의 보고서를 이름만 바꿈)
+//     shard_0003.done         완료 표시 (보고서를 제자리에 둔 뒤에 만든다)
+//
+//   임대는 세대 번호가 붙은 파일을 배타적으로 새로 만드는 것으로 얻는다. (O_CREAT|O_EXCL 은 NFS 에서도 원자적)
+//   소유자는 주기적으로 수정 시각을 갱신하고, 갱신이 끊겨 만료된 조각은 다른 작업자가 다음 세대 파일을 만들어 가져간다.
+//   같은 세대를 두 작업자가 동시에 만들 수는 없으므로 빼앗기 경쟁이 없다. 이전 세대 파일은 재할당 기록으로 남긴다.
+//   완료도 같은 방식이다. 끝낸 작업자는 다음 세대 파일을 완료 표식으로 만들고, 그것에 성공해야만 보고서를 제자리에 둔다.
+//   만료 판단은 파일 수정 시각으로 하므로 노드 사이 시계 차이보다 임대 시간을 충분히 길게 잡는다.
+//   임대를 잃은 작업자가 이미 쓴 .webp 는 같은 입력의 같은 결과라서 새 소유자가 덮어써도 된다.
+
+enum SHARD_SPLIT
+{
+    SHARD_SPLIT_HASH = 0,   // 경로 해시 % 조각 수 (목록이 바뀌어도 같은 파일은 같은 조각)
+    SHARD_SPLIT_SIZE        // 이름순 목록을 바이트 합이 비슷한 연속 구간으로 (폴더 단위 지역성 유지)
+};
+
+const char* GetShardSplitString(SHARD_SPLIT eSplit);
+bool ParseShardSplit(const std::string& strText, SHARD_SPLIT& eSplit);
+
+struct ShardFile
+{
+    std::string strPath;
+    uint64_t nSize = 0;
+};
+
+// 파일 목록을 nShardCount 개로 나눈다. 빈 조각이 생길 수 있다.
+std::vector<std::vector<std::string>> SplitShards(const std::vector<ShardFile>& vecFile, int nShardCount, SHARD_SPLIT eSplit);
+
+struct ShardProgress
+{
+    int nShards = 0;
+    int nDone = 0;
+    int nLeased = 0;        // 임대 중 (만료 전)
+    int nExpired = 0;       // 임대가 만료됨 (작업자가 죽었거나 멈춤) -> 다른 작업자가 가져갈 수 있음
+    int nPending = 0;       // 아직 아무도 가져가지 않음
+    int nReassigned = 0;    // 세대가 2 이상인 조각 (한 번 이상 다른 작업자에게 넘어감)
+};
+
+struct ShardMergeStats
+{
+    int nReports = 0;
+    int nMissing = 0;       // 완료 표시가 없거나 보고서를 읽지 못한 조각
+    uint64_t nRows = 0;
+    uint64_t nFailedRows = 0;   // status 가 ok 가 아닌 항목
+};
+
+class ShardJob
+{
+public:
+    // 작업 폴더를 만들고 매니페스트와 조각 목록을 쓴다. 이미 매니페스트가 있으면 실패 (strError)
+    //   지금 작업 폴더를 기준 폴더로 기록한다. 작업자는 그 폴더에서 실행해서 상대 경로 입력/출력을 똑같이 해석한다.
+    static bool Create(const std::string& strJobDir, const std::vector<ShardFile>& vecFile, int nShardCount, SHARD_SPLIT eSplit,
+                       int nLeaseSec, const std::vector<std::string>& vecArgs, std::string& strError);
+
+    // 매니페스트를 읽는다. 없거나 형식이 다르면 false
+    bool Open(const std::string& strJobDir);
+
+    int GetShardCount() const { return m_nShardCount; }
+    SHARD_SPLIT GetSplit() const { return m_eSplit; }
+    uint64_t GetFileCount() const { return m_nFileCount; }
+    int GetLeaseSec() const { return m_nLeaseSec; }
+    const std::string& GetBaseDir() const { return m_strBaseDir; }
+    const std::vector<std::string>& GetArgs() const { return m_vecArgs; }   // 작업자가 쓸 변환 인자
+
+    bool LoadShardFiles(int nShard, std::vector<std::string>& vecPath) const;
+    std::string GetReportPath(int nShard) const;                        // 완료된 보고서
+    std::string GetWorkReportPath(int nShard, int nGeneration) const;   // 작업 중인 세대의 보고서
+    bool IsDone(int nShard) const;
+
+    // 끝나지 않았고 임대가 없거나 만료된 조각 하나를 임대한다. 가져갈 조각이 없으면 -1
+    //   nGeneration: 얻은 세대 (2 이상이면 만료된 임대를 넘겨받음)
+    int Claim(const std::string& strOwner, int& nGeneration);
+
+    // 임대 갱신 (수정 시각을 지금으로). 다음 세대가 생겼으면 (만료되어 넘어감) false -> 이 조각 작업을 멈춘다.
+    bool Renew(int nShard, int nGeneration);
+
+    // 다음 세대를 완료 표식으로 차지한 뒤 세대 보고서를 제자리로 옮기고 완료 표시를 남긴다.
+    // 다음 세대를 이미 다른 작업자가 가져갔으면 (임대를 잃음) 세대 보고서만 지우고 false
+    bool Complete(int nShard, int nGeneration, const std::string& strSummary);
+
+    ShardProgress GetProgress() const;
+
+    // 완료된 조각 보고서를 조각 순서대로 이어 붙인다. (머리 줄은 한 번)
+    bool MergeReports(const std::string& strOutPath, ShardMergeStats& stats) const;
+
+    // "host:pid"
+    static std::string MakeOwnerName();
+
+private:
+    std::string GetShardPath(int nShard, const char* pszSuffix) const;
+    std::string GetLeasePath(int nShard, int nGeneration) const;
+    int FindLeaseGeneration(int nShard) const;  // 가장 높은 세대 (임대가 없으면 0)
+    bool IsLeaseExpired(int nShard, int nGeneration) const;
+
+    std::string m_strJobDir;
+    int m_nShardCount = 0;
+    SHARD_SPLIT m_eSplit = SHARD_SPLIT_HASH;
+    uint64_t m_nFileCount = 0;
+    int m_nLeaseSec = 60;
+    std::string m_strBaseDir;
+    std::vector<std::string> m_vecArgs;
+};
@@ -0,0 +1,160 @@
+﻿#include "StreamProtocol.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    bool WriteU32(std::FILE* pFile, uint32_t nValue)
+    {
+        uint8_t buf[4];
+        for (int i = 0; i < 4; ++i)
+            buf[i] = static_cast<uint8_t>(nValue >> (8 * i));
+        return std::fwrite(buf, 1, sizeof(buf), pFile) == sizeof(buf);
+    }
+
+    bool WriteU64(std::FILE* pFile, uint64_t nValue)
+    {
+        uint8_t buf[8];
+        for (int i = 0; i < 8; ++i)
+            buf[i] = static_cast<uint8_t>(nValue >> (8 * i));
+        return std::fwrite(buf, 1, sizeof(buf), pFile) == sizeof(buf);
+    }
+
+    // 0 = 정상, 1 = 첫 바이트부터 EOF, -1 = 중간에 끊김
+    int ReadExact(std::FILE* pFile, void* pBuffer, size_t nSize)
+    {
+        const size_t nRead = std::fread(pBuffer, 1, nSize, pFile);
+        if (nRead == nSize)
+            return 0;
+        return (nRead == 0 && std::feof(pFile)) ? 1 : -1;
+    }
+
+    int ReadU32(std::FILE* pFile, uint32_t& nValue)
+    {
+        uint8_t buf[4];
+        const int nRet = ReadExact(pFile, buf, sizeof(buf));
+        nValue = 0;
+        for (int i = 0; i < 4; ++i)
+            nValue |= static_cast<uint32_t>(buf[i]) << (8 * i);
+        return nRet;
+    }
+
+    int ReadU64(std::FILE* pFile, uint64_t& nValue)
+    {
+        uint8_t buf[8];
+        const int nRet = ReadExact(pFile, buf, sizeof(buf));
+        nValue = 0;
+        for (int i = 0; i < 8; ++i)
+            nValue |= static_cast<uint64_t>(buf[i]) << (8 * i);
+        return nRet;
+    }
+
+    bool ReadName(std::FILE* pFile, std::string& strName, bool& bError)
+    {
+        uint32_t nNameLen = 0;
+        const int nRet = ReadU32(pFile, nNameLen);
+        if (nRet != 0)
+        {
+            bError = (nRet < 0);
+            return false;
+        }
+
+        if (nNameLen > StreamProtocol::MAX_NAME_BYTES)
+        {
+            bError = true;
+            return false;
+        }
+
+        strName.resize(nNameLen);
+        if (nNameLen > 0 && ReadExact(pFile, &strName[0], nNameLen) != 0)
+        {
+            bError = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool ReadPayload(std::FILE* pFile, std::vector<uint8_t>& vecData, bool& bError)
+    {
+        uint64_t nLen = 0;
+        if (ReadU64(pFile, nLen) != 0 || nLen > StreamProtocol::MAX_PAYLOAD_BYTES)
+        {
+            bError = true;
+            return false;
+        }
+
+        vecData.resize(static_cast<size_t>(nLen));
+        if (nLen > 0 && ReadExact(pFile, vecData.data(), static_cast<size_t>(nLen)) != 0)
+        {
+            bError = true;
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace StreamProtocol
+{
+    bool WriteInputRecord(std::FILE* pFile, const std::string& strName, const uint8_t* pData, size_t nSize)
+    {
+        return WriteU32(pFile, static_cast<uint32_t>(strName.size()))
+            && (strName.empty() || std::fwrite(strName.data(), 1, strName.size(), pFile) == strName.size())
+            && WriteU64(pFile, nSize)
+            && (nSize == 0 || std::fwrite(pData, 1, nSize, pFile) == nSize);
+    }
+
+    bool WriteOutputRecord(std::FILE* pFile, const std::string& strName, uint32_t nStatus, const uint8_t* pData, size_t nSize)
+    {
+        return WriteU32(pFile, static_cast<uint32_t>(strName.size()))
+            && (strName.empty() || std::fwrite(strName.data(), 1, strName.size(), pFile) == strName.size())
+            && WriteU32(pFile, nStatus)
+            && WriteU64(pFile, nSize)
+            && (nSize == 0 || std::fwrite(pData, 1, nSize, pFile) == nSize);
+    }
+
+    bool ReadInputRecord(std::FILE* pFile, std::string& strName, std::vector<uint8_t>& vecData, bool& bError)
+    {
+        bError = false;
+        return ReadName(pFile, strName, bError) && ReadPayload(pFile, vecData, bError);
+    }
+
+    bool ReadOutputRecord(std::FILE* pFile, std::string& strName, uint32_t& nStatus, std::vector<uint8_t>& vecData, bool& bError)
+    {
+        bError = false;
+        if (!ReadName(pFile, strName, bError))
+            return false;
+
+        if (ReadU32(pFile, nStatus) != 0)
+        {
+            bError = true;
+            return false;
+        }
+        return ReadPayload(pFile, vecData, bError);
+    }
+
+    void SetBinaryMode(std::FILE* pFile)
+    {
+#ifdef _WIN32
+        _setmode(_fileno(pFile), _O_BINARY);
+#else
+        (void)pFile;
+#endif
+    }
+}
+
+bool StreamRecordSource::Next(InputItem& item)
+{
+    if (m_bError)
+        return false;
+
+    return StreamProtocol::ReadInputRecord(m_pFile, item.strName, item.vecData, m_bError);
+}
+
+bool StreamRecordSink::Write(OutputItem& item)
+{
+    const uint32_t nStatus = item.bOk ? static_cast<uint32_t>(CONVERT_OK) : static_cast<uint32_t>(item.result.eStatus);
+    return StreamProtocol::WriteOutputRecord(m_pFile, item.strName, nStatus, item.vecWebp.data(), item.bOk ? item.vecWebp.size() : 0);
+}
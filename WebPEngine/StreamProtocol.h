@@ -0,0 +1,54 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include <cstdio>
+
+// stdin/stdout 프레이밍 프로토콜 (모든 정수는 little-endian)
+//
+//   입력 레코드 : u32 name_len | name | u64 jpeg_len | jpeg
+//   출력 레코드 : u32 name_len | name | u32 status | u64 webp_len | webp
+//
+// status 는 CONVERT_STATUS 값 (0 = 성공, 실패 시 webp_len = 0). name 은 입력 레코드의 ID 를 그대로 돌려준다.
+
+namespace StreamProtocol
+{
+    const uint32_t MAX_NAME_BYTES = 64u << 10;
+    const uint64_t MAX_PAYLOAD_BYTES = 1ull << 32;
+
+    bool WriteInputRecord(std::FILE* pFile, const std::string& strName, const uint8_t* pData, size_t nSize);
+    bool WriteOutputRecord(std::FILE* pFile, const std::string& strName, uint32_t nStatus, const uint8_t* pData, size_t nSize);
+
+    // 레코드 하나를 읽는다. 레코드 경계에서 EOF 면 false + bError = false
+    bool ReadInputRecord(std::FILE* pFile, std::string& strName, std::vector<uint8_t>& vecData, bool& bError);
+    bool ReadOutputRecord(std::FILE* pFile, std::string& strName, uint32_t& nStatus, std::vector<uint8_t>& vecData, bool& bError);
+
+    // Windows 에서 stdin/stdout 을 바이너리 모드로 전환
+    void SetBinaryMode(std::FILE* pFile);
+}
+
+// 프레이밍된 입력 스트림을 파이프라인 원천으로 사용
+class StreamRecordSource : public IInputSource
+{
+public:
+    explicit StreamRecordSource(std::FILE* pFile) : m_pFile(pFile) {}
+
+    bool Next(InputItem& item) override;
+    bool HasError() const override { return m_bError; }
+
+private:
+    std::FILE* m_pFile;
+    bool m_bError = false;
+};
+
+// 변환 결과를 프레이밍된 출력 레코드로 기록
+class StreamRecordSink : public IOutputSink
+{
+public:
+    explicit StreamRecordSink(std::FILE* pFile) : m_pFile(pFile) {}
+
+    bool Write(OutputItem& item) override;
+    bool Finish() override { return std::fflush(m_pFile) == 0; }
+
+private:
+    std::FILE* m_pFile;
+};
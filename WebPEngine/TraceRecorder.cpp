@@ -0,0 +1,189 @@
+﻿#include "TraceRecorder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ostream>
+
+namespace
+{
+    std::atomic<uint64_t> g_nNextRecorderId{ 1 };
+
+    // 스레드가 마지막으로 쓴 기록기의 버퍼 (기록 경로에서 잠금 없이 찾기 위함)
+    struct ThreadBufferCache
+    {
+        uint64_t nRecorderId = 0;
+        void* pBuffer = nullptr;
+    };
+
+    thread_local ThreadBufferCache t_cache;
+
+    void WriteJsonString(std::ostream& os, const std::string& strValue)
+    {
+        os << '"';
+        for (char ch : strValue)
+        {
+            if (ch == '"' || ch == '\\')
+            {
+                os << '\\' << ch;
+            }
+            else if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                char szEscape[8];
+                std::snprintf(szEscape, sizeof(szEscape), "\\u%04x", static_cast<unsigned char>(ch));
+                os << szEscape;
+            }
+            else
+            {
+                os << ch;
+            }
+        }
+        os << '"';
+    }
+
+    // ns -> trace-event 의 µs (소수 셋째 자리 = ns 단위)
+    void WriteMicroseconds(std::ostream& os, int64_t nNs)
+    {
+        char szValue[32];
+        std::snprintf(szValue, sizeof(szValue), "%lld.%03lld", static_cast<long long>(nNs / 1000), static_cast<long long>(nNs % 1000));
+        os << szValue;
+    }
+}
+
+TraceRecorder::TraceRecorder(size_t nSpansPerThread)
+    : m_nId(g_nNextRecorderId.fetch_add(1))
+    , m_nSpansPerThread(std::max<size_t>(1, nSpansPerThread))
+    , m_startTime(std::chrono::steady_clock::now())
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetThreadBuffer()
+{
+    if (t_cache.nRecorderId == m_nId)
+        return static_cast<ThreadBuffer*>(t_cache.pBuffer);
+
+    const std::thread::id threadId = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ThreadBuffer* pBuffer = nullptr;
+    for (const auto& pExisting : m_vecBuffer)
+    {
+        if (pExisting->threadId == threadId)
+        {
+            pBuffer = pExisting.get();
+            break;
+        }
+    }
+
+    if (!pBuffer)
+    {
+        std::unique_ptr<ThreadBuffer> pNew(new ThreadBuffer());
+        pNew->threadId = threadId;
+        pNew->nTid = static_cast<int>(m_vecBuffer.size()) + 1;
+        pNew->vecSpan.resize(m_nSpansPerThread);
+        pBuffer = pNew.get();
+        m_vecBuffer.push_back(std::move(pNew));
+    }
+
+    t_cache.nRecorderId = m_nId;
+    t_cache.pBuffer = pBuffer;
+    return pBuffer;
+}
+
+void TraceRecorder::Record(const char* pszName, int64_t nStartNs, int64_t nEndNs)
+{
+    ThreadBuffer* pBuffer = GetThreadBuffer();
+    TraceSpan& span = pBuffer->vecSpan[static_cast<size_t>(pBuffer->nTotal % pBuffer->vecSpan.size())];
+    span.pszName = pszName;
+    span.nItem = pBuffer->nCurrentItem;
+    span.nStartNs = nStartNs;
+    span.nDurationNs = nEndNs - nStartNs;
+    ++pBuffer->nTotal;
+}
+
+void TraceRecorder::BeginItem(uint64_t nItem)
+{
+    GetThreadBuffer()->nCurrentItem = nItem;
+}
+
+void TraceRecorder::SetThreadName(const std::string& strName)
+{
+    ThreadBuffer* pBuffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pBuffer->strName = strName;
+}
+
+void TraceRecorder::SetItemName(uint64_t nItem, const std::string& strName)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapItemName[nItem] = strName;
+}
+
+uint64_t TraceRecorder::GetSpanCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t nCount = 0;
+    for (const auto& pBuffer : m_vecBuffer)
+        nCount += std::min<uint64_t>(pBuffer->nTotal, pBuffer->vecSpan.size());
+    return nCount;
+}
+
+uint64_t TraceRecorder::GetDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t nCount = 0;
+    for (const auto& pBuffer : m_vecBuffer)
+        nCount += pBuffer->nTotal - std::min<uint64_t>(pBuffer->nTotal, pBuffer->vecSpan.size());
+    return nCount;
+}
+
+bool TraceRecorder::WriteChromeTrace(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // {"traceEvents":[ 메타데이터(스레드 이름) ..., 완료 이벤트(ph "X") ... ], "displayTimeUnit":"ms"}
+    os << "{\"traceEvents\":[\n";
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"WebPConverter\"}}";
+
+    int nWorker = 0;
+    for (const auto& pBuffer : m_vecBuffer)
+    {
+        os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->nTid << ",\"args\":{\"name\":";
+        WriteJsonString(os, pBuffer->strName.empty() ? "worker " + std::to_string(++nWorker) : pBuffer->strName);
+        os << "}}";
+    }
+
+    for (const auto& pBuffer : m_vecBuffer)
+    {
+        // 링 버퍼를 오래된 것부터
+        const uint64_t nCapacity = pBuffer->vecSpan.size();
+        const uint64_t nFirst = (pBuffer->nTotal > nCapacity) ? pBuffer->nTotal - nCapacity : 0;
+        for (uint64_t n = nFirst; n < pBuffer->nTotal; ++n)
+        {
+            const TraceSpan& span = pBuffer->vecSpan[static_cast<size_t>(n % nCapacity)];
+            os << ",\n{\"name\":\"" << span.pszName << "\",\"cat\":\"convert\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->nTid << ",\"ts\":";
+            WriteMicroseconds(os, span.nStartNs);
+            os << ",\"dur\":";
+            WriteMicroseconds(os, span.nDurationNs);
+
+            if (span.nItem != NO_ITEM)
+            {
+                os << ",\"args\":{\"item\":" << span.nItem;
+                auto it = m_mapItemName.find(span.nItem);
+                if (it != m_mapItemName.end())
+                {
+                    os << ",\"file\":";
+                    WriteJsonString(os, it->second);
+                }
+                os << "}";
+            }
+            os << "}";
+        }
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return !!os;
+}
@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 파일/단계별 구간(span) 기록기 (선택 사항)
+//   스레드마다 고정 크기 링 버퍼에 (단계 이름, 항목 번호, 시작, 길이) 만 남긴다. 기록 경로에는 잠금이 없다.
+//   버퍼가 차면 가장 오래된 구간부터 덮어쓴다. (GetDroppedCount)
+//   실행이 끝난 뒤 WriteChromeTrace 로 Chrome/Perfetto trace-event JSON 을 만들어 타임라인 뷰어에서 연다.
+
+struct TraceSpan
+{
+    const char* pszName = nullptr;  // 단계 이름 (정적 문자열만)
+    uint64_t nItem = 0;             // 항목 번호 (TraceRecorder::NO_ITEM 이면 항목과 무관)
+    int64_t nStartNs = 0;           // 기록기 생성 시점 기준
+    int64_t nDurationNs = 0;
+};
+
+class TraceRecorder
+{
+public:
+    static const uint64_t NO_ITEM = ~0ULL;
+
+    explicit TraceRecorder(size_t nSpansPerThread = 65536);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // 기록기 생성 시점부터의 경과 시간 (ns)
+    int64_t Now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    }
+
+    // 현재 스레드의 버퍼에 구간 하나를 남긴다. 항목 번호는 BeginItem 으로 정한 현재 항목
+    void Record(const char* pszName, int64_t nStartNs, int64_t nEndNs);
+
+    // 현재 스레드가 처리 중인 항목. 이후 Record 는 이 번호로 남는다. (EndItem 까지)
+    void BeginItem(uint64_t nItem);
+    void EndItem() { BeginItem(NO_ITEM); }
+
+    // 타임라인에 보일 이름 (처음 한 번만 부르면 된다). 스레드 이름을 정하지 않으면 "worker <번호>"
+    void SetThreadName(const std::string& strName);
+    void SetItemName(uint64_t nItem, const std::string& strName);
+
+    // 기록 중인 스레드가 없을 때 호출한다. (파이프라인 Run 이 끝난 뒤)
+    bool WriteChromeTrace(std::ostream& os) const;
+    uint64_t GetSpanCount() const;      // 버퍼에 남아 있는 구간 수
+    uint64_t GetDroppedCount() const;   // 링 버퍼가 넘쳐서 덮어쓴 구간 수
+
+private:
+    struct ThreadBuffer
+    {
+        std::thread::id threadId;
+        int nTid = 0;                       // 타임라인에 쓰는 작은 번호 (등록 순서)
+        std::string strName;
+        uint64_t nCurrentItem = NO_ITEM;
+        std::vector<TraceSpan> vecSpan;     // 링 버퍼
+        uint64_t nTotal = 0;                // 지금까지 기록한 구간 수 (다음 위치 = nTotal % 크기)
+    };
+
+    ThreadBuffer* GetThreadBuffer();
+
+    const uint64_t m_nId;                   // 스레드별 버퍼 캐시 구분용 (주소는 재사용될 수 있음)
+    const size_t m_nSpansPerThread;
+    const std::chrono::steady_clock::time_point m_startTime;
+
+    mutable std::mutex m_mutex;             // 버퍼 등록 / 항목 이름만 보호
+    std::vector<std::unique_ptr<ThreadBuffer>> m_vecBuffer;
+    std::unordered_map<uint64_t, std::string> m_mapItemName;
+};
+
+// 범위를 벗어나거나 End() 를 부르면 구간을 남긴다. pTrace 가 nullptr 이면 아무것도 하지 않는다.
+class TraceScope
+{
+public:
+    TraceScope(TraceRecorder* pTrace, const char* pszName)
+        : m_pTrace(pTrace)
+        , m_pszName(pszName)
+        , m_nStartNs(pTrace ? pTrace->Now() : 0)
+    {
+    }
+
+    ~TraceScope() { End(); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void End()
+    {
+        if (m_pTrace)
+        {
+            m_pTrace->Record(m_pszName, m_nStartNs, m_pTrace->Now());
+            m_pTrace = nullptr;
+        }
+    }
+
+private:
+    TraceRecorder* m_pTrace;
+    const char* m_pszName;
+    int64_t m_nStartNs;
+};
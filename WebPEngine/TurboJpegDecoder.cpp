@@ -0,0 +1,95 @@
+﻿#include "DecoderBackend.h"
+#include <cstring>
+#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG API (부분 디코딩은 3.0 이상의 tj3 API)
+
+namespace
+{
+    // TurboJPEG 핸들은 스레드 간 공유할 수 없으므로 백엔드 인스턴스(= 스레드)마다 하나씩 가진다.
+    class TurboJpegDecoder : public IDecoderBackend
+    {
+    public:
+        TurboJpegDecoder() : m_tj(tjInitDecompress()) {}
+        ~TurboJpegDecoder() override
+        {
+            if (m_tj)
+                tjDestroy(m_tj);
+        }
+
+        bool IsValid() const { return m_tj != nullptr; }
+
+        const char* GetName() const override { return "turbojpeg"; }
+
+        bool Probe(const uint8_t* pJpegData, size_t nJpegSize, JpegHeader& header) override
+        {
+            int nWidth = 0, nHeight = 0, nSubSampling = 0, nColorSpace = 0;
+            if (tjDecompressHeader3(m_tj, pJpegData, static_cast<unsigned long>(nJpegSize), &nWidth, &nHeight, &nSubSampling, &nColorSpace) != 0)
+                return false;
+
+            header.nWidth = nWidth;
+            header.nHeight = nHeight;
+            header.nSubSampling = nSubSampling;
+            return true;
+        }
+
+        bool DecodeInto(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, DecodePlanes& planes) override
+        {
+            return tjDecompress2(m_tj, pJpegData, static_cast<unsigned long>(nJpegSize), planes.pY, header.nWidth, planes.nYStride, header.nHeight, TJPF_GRAY, 0) == 0;
+        }
+
+        // libjpeg-turbo 부분 디코딩: 위쪽 행은 jpeg_skip_scanlines 로 건너뛰고, 영역 밖 MCU 열은 IDCT 하지 않는다.
+        // 왼쪽 경계는 MCU 폭의 배수여야 하므로 내림 정렬해서 디코딩하고 나머지 열은 복사할 때 버린다.
+        // 블록 단위 IDCT 결과는 전체 디코딩과 같으므로 (그레이는 업샘플링 없음) 픽셀이 decode-then-crop 과 동일하다.
+        bool DecodeRegion(const uint8_t* pJpegData, size_t nJpegSize, const JpegHeader& header, const JpegRegion& region, DecodePlanes& planes) override
+        {
+            if (header.nSubSampling < 0 || header.nSubSampling >= TJ_NUMSAMP)
+                return false;
+
+            const int nMcuWidth = tjMCUWidth[header.nSubSampling];
+            const int nAlignedX = region.nX / nMcuWidth * nMcuWidth;
+            const int nSkipX = region.nX - nAlignedX;
+
+            tjregion crop;
+            crop.x = nAlignedX;
+            crop.y = region.nY;
+            crop.w = region.nWidth + nSkipX;
+            crop.h = region.nHeight;
+
+            if (tj3DecompressHeader(m_tj, pJpegData, nJpegSize) != 0 || tj3SetCroppingRegion(m_tj, crop) != 0)
+                return false;
+
+            // 왼쪽이 이미 정렬되어 있으면 호출자 평면에 바로 디코딩
+            uint8_t* pDst = planes.pY;
+            int nPitch = planes.nYStride;
+            if (nSkipX != 0)
+            {
+                m_vecScratch.resize(static_cast<size_t>(crop.w) * static_cast<size_t>(crop.h));
+                pDst = m_vecScratch.data();
+                nPitch = crop.w;
+            }
+
+            const bool bDecoded = tj3Decompress8(m_tj, pJpegData, nJpegSize, pDst, nPitch, TJPF_GRAY) == 0;
+            tj3SetCroppingRegion(m_tj, TJUNCROPPED); // 핸들을 재사용하므로 항상 되돌린다.
+            if (!bDecoded)
+                return false;
+
+            if (nSkipX != 0)
+            {
+                for (int y = 0; y < region.nHeight; ++y)
+                    std::memcpy(planes.pY + static_cast<size_t>(y) * planes.nYStride, pDst + static_cast<size_t>(y) * nPitch + nSkipX, static_cast<size_t>(region.nWidth));
+            }
+            return true;
+        }
+
+    private:
+        tjhandle m_tj;
+        std::vector<uint8_t> m_vecScratch;
+    };
+}
+
+std::unique_ptr<IDecoderBackend> CreateTurboJpegDecoder()
+{
+    auto pDecoder = std::make_unique<TurboJpegDecoder>();
+    if (!pDecoder->IsValid())
+        return nullptr;
+    return pDecoder;
+}
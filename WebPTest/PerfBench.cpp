@@ -0,0 +1,208 @@
+﻿#include "TestCommon.h"
+#include "ConvertEngine.h"
+#include "CorpusGenerator.h"
+#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// 성능 회귀 벤치마크
+//   고정 코퍼스(기본: 시드 고정 합성 그레이 코퍼스, --corpus 폴더를 주면 그 JPEG 들)를 메모리에 올린 뒤
+//   BatchPipeline 으로 --repeat 번 변환해서 가장 빠른 회의 images/s 와 bytes/image 를 잰다.
+//   --baseline 파일이 있으면 처리량이 --max-regression % 넘게 떨어졌을 때 실패한다.
+//   기준선은 코퍼스 설명과 작업자 수가 같을 때만 비교한다. (다른 조건의 숫자는 비교 의미가 없음)
+
+namespace
+{
+    const char* const DEFAULT_BASELINE = "perf_baseline.txt";
+    const double DEFAULT_MAX_REGRESSION = 10.0;    // %
+
+    struct PerfResult
+    {
+        std::string strCorpus;          // 코퍼스 설명 (기준선과 같은 조건인지 확인용)
+        int nThreads = 0;
+        double fImagesPerSec = 0.0;
+        double fBytesPerImage = 0.0;
+    };
+
+    // 출력은 버리고 바이트만 센다. (디스크 쓰기 시간은 측정에서 뺀다)
+    class CountingSink : public IOutputSink
+    {
+    public:
+        bool Write(OutputItem& item) override
+        {
+            nBytes += item.vecWebp.size();
+            return true;
+        }
+
+        uint64_t nBytes = 0;
+    };
+
+    bool LoadCorpus(const CliArgs& args, std::vector<std::vector<uint8_t>>& vecJpeg, std::string& strCorpus)
+    {
+        if (args.Has("corpus"))
+        {
+            const std::string strFolder = args.GetString("corpus");
+            std::vector<std::string> vecPath = ListJpegFiles(strFolder, true);
+            std::sort(vecPath.begin(), vecPath.end());
+            for (const auto& strPath : vecPath)
+            {
+                std::vector<uint8_t> vecData;
+                if (!ReadFileToMemory(strPath, vecData))
+                {
+                    std::cerr << "Error: 코퍼스 파일을 읽지 못했습니다: " << strPath << "\n";
+                    return false;
+                }
+                vecJpeg.push_back(std::move(vecData));
+            }
+            strCorpus = "dir:" + strFolder + " files=" + std::to_string(vecJpeg.size());
+            return !vecJpeg.empty();
+        }
+
+        CorpusSpec spec;
+        spec.nSeed = 37;
+        spec.nCount = static_cast<int>(args.GetDouble("images", 48));
+        spec.ParseSizes("640x480:3,1280x720:1");
+        spec.ParseComplexity("0.2,0.5,0.8");
+        spec.ParseQuality("85");
+        if (spec.nCount <= 0)
+        {
+            std::cerr << "Error: --images 는 1 이상이어야 합니다.\n";
+            return false;
+        }
+
+        CorpusGenerator generator(spec);
+        vecJpeg.resize(static_cast<size_t>(spec.nCount));
+        for (int i = 0; i < spec.nCount; ++i)
+        {
+            CorpusImage image = generator.Describe(i);
+            if (!generator.Generate(image, vecJpeg[static_cast<size_t>(i)]))
+            {
+                std::cerr << "Error: 합성 코퍼스 생성 실패: " << image.strName << "\n";
+                return false;
+            }
+        }
+        strCorpus = "synthetic:" + spec.ToString();
+        return true;
+    }
+
+    // key=value 줄만 읽는다. (# 로 시작하는 줄은 주석)
+    bool LoadBaseline(const std::string& strPath, PerfResult& baseline)
+    {
+        std::ifstream file(strPath);
+        if (!file)
+            return false;
+
+        std::string strLine;
+        while (std::getline(file, strLine))
+        {
+            const size_t nEq = strLine.find('=');
+            if (strLine.empty() || strLine[0] == '#' || nEq == std::string::npos)
+                continue;
+
+            const std::string strKey = strLine.substr(0, nEq);
+            const std::string strValue = strLine.substr(nEq + 1);
+            if (strKey == "corpus")
+                baseline.strCorpus = strValue;
+            else if (strKey == "threads")
+                baseline.nThreads = std::atoi(strValue.c_str());
+            else if (strKey == "images_per_sec")
+                baseline.fImagesPerSec = std::atof(strValue.c_str());
+            else if (strKey == "bytes_per_image")
+                baseline.fBytesPerImage = std::atof(strValue.c_str());
+        }
+        return baseline.fImagesPerSec > 0.0;
+    }
+
+    bool SaveBaseline(const std::string& strPath, const PerfResult& result)
+    {
+        std::ofstream file(strPath);
+        file << "# WebPTest 성능 기준선 (WebPTest --only perf --write-baseline 으로 갱신)\n"
+             << "corpus=" << result.strCorpus << "\n"
+             << "threads=" << result.nThreads << "\n"
+             << "images_per_sec=" << result.fImagesPerSec << "\n"
+             << "bytes_per_image=" << result.fBytesPerImage << "\n";
+        return !!file;
+    }
+}
+
+int RunPerfBench(const CliArgs& args)
+{
+    std::vector<std::vector<uint8_t>> vecJpeg;
+    PerfResult current;
+    if (!LoadCorpus(args, vecJpeg, current.strCorpus))
+        return 2;
+
+    current.nThreads = static_cast<int>(args.GetDouble("threads", 0));
+    if (current.nThreads <= 0)
+        current.nThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    const int nRepeat = std::max(1, static_cast<int>(args.GetDouble("repeat", 3)));
+    const double fMaxRegression = args.GetDouble("max-regression", DEFAULT_MAX_REGRESSION);
+
+    ConvertOption convertOption;
+    convertOption.fQuality = static_cast<float>(args.GetDouble("quality", 80.0));
+    ConvertEngine engine(convertOption);
+
+    PipelineOption pipelineOption;
+    pipelineOption.nWorkerCount = current.nThreads;
+
+    // 첫 회는 스레드별 디코더/평면 버퍼 준비가 섞이므로 버리고, 나머지 중 가장 빠른 회를 쓴다.
+    for (int nRun = 0; nRun <= nRepeat; ++nRun)
+    {
+        BatchPipeline pipeline(engine, pipelineOption);
+        MemoryJpegSource source(vecJpeg);
+        CountingSink sink;
+        const PipelineStats stats = pipeline.Run(source, sink);
+
+        if (stats.nFailed > 0 || stats.nConverted == 0)
+        {
+            std::cerr << "Error: 벤치마크 코퍼스 변환 실패 " << stats.nFailed << "건 (" << current.strCorpus << ")\n";
+            return 2;
+        }
+        if (nRun == 0 || stats.fElapsedSec <= 0.0)
+            continue;
+
+        current.fImagesPerSec = std::max(current.fImagesPerSec, static_cast<double>(stats.nConverted) / stats.fElapsedSec);
+        current.fBytesPerImage = static_cast<double>(sink.nBytes) / static_cast<double>(stats.nConverted);
+    }
+
+    std::cout << "perf: images=" << vecJpeg.size() << " threads=" << current.nThreads << " repeat=" << nRepeat
+        << " images_per_sec=" << current.fImagesPerSec << " bytes_per_image=" << current.fBytesPerImage << "\n";
+
+    if (args.Has("write-baseline"))
+    {
+        const std::string strPath = args.GetString("write-baseline", DEFAULT_BASELINE);
+        if (!SaveBaseline(strPath.empty() ? DEFAULT_BASELINE : strPath, current))
+        {
+            std::cerr << "Error: 기준선을 쓰지 못했습니다: " << strPath << "\n";
+            return 2;
+        }
+        std::cout << "perf: 기준선 저장 " << (strPath.empty() ? DEFAULT_BASELINE : strPath) << "\n";
+        return 0;
+    }
+
+    const std::string strBaseline = args.GetString("baseline", DEFAULT_BASELINE);
+    PerfResult baseline;
+    if (!LoadBaseline(strBaseline, baseline))
+    {
+        std::cout << "perf: 기준선 없음 (" << strBaseline << "), 비교 생략\n";
+        return 0;
+    }
+    if (baseline.strCorpus != current.strCorpus || baseline.nThreads != current.nThreads)
+    {
+        std::cout << "perf: 기준선 조건이 다름 (corpus=" << baseline.strCorpus << " threads=" << baseline.nThreads << "), 비교 생략\n";
+        return 0;
+    }
+
+    const double fThroughputChange = (current.fImagesPerSec / baseline.fImagesPerSec - 1.0) * 100.0;
+    const double fSizeChange = (baseline.fBytesPerImage > 0.0) ? (current.fBytesPerImage / baseline.fBytesPerImage - 1.0) * 100.0 : 0.0;
+    const bool bRegressed = fThroughputChange < -fMaxRegression;
+
+    std::cout << "perf: baseline images_per_sec=" << baseline.fImagesPerSec << " (" << (fThroughputChange >= 0.0 ? "+" : "") << fThroughputChange
+        << "%) bytes_per_image=" << baseline.fBytesPerImage << " (" << (fSizeChange >= 0.0 ? "+" : "") << fSizeChange << "%) -> "
+        << (bRegressed ? "REGRESSION" : "PASS") << " (허용 -" << fMaxRegression << "%)\n";
+    return bRegressed ? 1 : 0;
+}
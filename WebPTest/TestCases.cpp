@@ -0,0 +1,1748 @@
+﻿#include "TestCommon.h"
+#include "AnimationAssembler.h"
+#include "ArchiveSource.h"
+#include "BatchPipeline.h"
+#include "ConversionCache.h"
+#include "ConvertEngine.h"
+#include "CorpusGenerator.h"
+#include "CorpusIndex.h"
+#include "CostModel.h"
+#include "CpuTopology.h"
+#include "DecoderBackend.h"
+#include "FileEndpoint.h"
+#include "FileUtil.h"
+#include "JobManager.h"
+#include "JobPool.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include "OutputWriter.h"
+#include "PackFile.h"
+#include "PlanePipeline.h"
+#include "ProcessUtil.h"
+#include "ShardJob.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <webp/decode.h>  // libwebp 디코더 (WebPGetInfo)
+
+// 정확성 테스트
+//   모두 ConvertEngine / BatchPipeline 의 실제 경로를 거친다. 입력은 CorpusGenerator 와 EncodeGrayJpeg 로 메모리에서 만든다.
+
+namespace
+{
+    // 고정 시드 그레이 코퍼스 이미지 하나 (크기 지정)
+    bool MakeCorpusJpeg(int nIndex, int nWidth, int nHeight, int nSubSampling, std::vector<uint8_t>& vecJpeg)
+    {
+        CorpusSpec spec;
+        spec.nSeed = 2024;
+        spec.vecSize = { { { nWidth, nHeight }, 1.0 } };
+        spec.vecSubsamp = { { nSubSampling, 1.0 } };
+        spec.vecQuality = { { 92, 1.0 } };
+
+        CorpusGenerator generator(spec);
+        CorpusImage image = generator.Describe(nIndex);
+        return generator.Generate(image, vecJpeg);
+    }
+
+    // 1) Full-range -> limited-range 매핑이 표 없이 계산한 값과 픽셀 단위로 같은지
+    //    같은 JPEG 을 디코더 백엔드로 직접 디코딩한 값(full-range)을 기준으로 삼는다.
+    void TestRangeMapping(TestContext& ctx)
+    {
+        const int nWidth = 256;
+        const int nHeight = 16;
+        std::vector<uint8_t> vecRamp(static_cast<size_t>(nWidth) * nHeight);
+        for (int y = 0; y < nHeight; ++y)
+        {
+            for (int x = 0; x < nWidth; ++x)
+                vecRamp[static_cast<size_t>(y) * nWidth + x] = static_cast<uint8_t>(x);
+        }
+
+        std::vector<uint8_t> vecJpeg;
+        if (!ctx.Expect(EncodeGrayJpeg(vecRamp, nWidth, nHeight, 100, vecJpeg), "램프 JPEG 생성 실패"))
+            return;
+
+        IDecoderBackend* pDecoder = GetThreadDecoder(DecoderRegistry::DEFAULT_DECODER);
+        JpegHeader header;
+        if (!ctx.Expect(pDecoder && pDecoder->Probe(vecJpeg.data(), vecJpeg.size(), header), "기본 디코더로 헤더를 읽지 못함"))
+            return;
+
+        std::vector<uint8_t> vecFull(static_cast<size_t>(header.nWidth) * header.nHeight);
+        DecodePlanes planes;
+        planes.pY = vecFull.data();
+        planes.nYStride = header.nWidth;
+        if (!ctx.Expect(pDecoder->DecodeInto(vecJpeg.data(), vecJpeg.size(), header, planes), "기본 디코더 디코딩 실패"))
+            return;
+
+        ConvertEngine engine;
+        std::vector<uint8_t> vecLimited;
+        ConvertResult result;
+        if (!ctx.Expect(engine.DecodeGray(vecJpeg.data(), vecJpeg.size(), engine.GetOption(), vecLimited, result), "DecodeGray 실패"))
+            return;
+        if (!ctx.Expect(vecLimited.size() == vecFull.size(), "DecodeGray 평면 크기가 다름"))
+            return;
+
+        std::vector<bool> vecSeen(256, false);
+        size_t nMismatch = 0;
+        for (size_t p = 0; p < vecFull.size(); ++p)
+        {
+            const int y = vecFull[p];
+            const int nExpected = (y * 219 + 127) / 255 + 16;
+            vecSeen[static_cast<size_t>(y)] = true;
+            if (vecLimited[p] != nExpected && nMismatch++ == 0)
+                ctx.Expect(false, "매핑 불일치: full=" + std::to_string(y) + " limited=" + std::to_string(vecLimited[p]) + " expected=" + std::to_string(nExpected));
+        }
+        ctx.Expect(nMismatch == 0, "매핑 불일치 픽셀 " + std::to_string(nMismatch) + "개");
+
+        // q100 램프는 거의 모든 값을 지나므로 양 끝 (0 -> 16, 255 -> 235) 도 실제로 확인된다.
+        const size_t nCovered = static_cast<size_t>(std::count(vecSeen.begin(), vecSeen.end(), true));
+        ctx.Expect(vecSeen[0] && vecSeen[255], "램프 디코딩 결과에 0 또는 255 가 없음");
+        ctx.Expect(nCovered >= 240, "램프가 덮은 값이 너무 적음: " + std::to_string(nCovered));
+
+        // 특수화한 범위 변환 루프가 256 개 값 모두에서 기준 표와 같은지 (길이 257: 벡터 루프 뒤 나머지 처리까지)
+        std::vector<uint8_t> vecAll(257), vecTable(257);
+        for (size_t i = 0; i < vecAll.size(); ++i)
+            vecAll[i] = vecTable[i] = static_cast<uint8_t>(i);
+        MapRangePlane<LimitedRangeProfile>(vecAll.data(), vecAll.size());
+        MapRangeGeneric(LimitedRangeTable(), vecTable.data(), vecTable.size());
+        ctx.Expect(vecAll == vecTable, "특수화한 범위 변환이 기준 표와 다름");
+    }
+
+    // 2) 변환 결과가 디코딩되고 크기가 원본과 같으며 화질이 기준 이상인지 (홀수/작은 크기 포함)
+    void TestRoundTrip(TestContext& ctx)
+    {
+        const CorpusSize sizes[] = { { 640, 480 }, { 33, 17 }, { 1, 1 }, { 257, 129 } };
+
+        ConvertOption option;
+        option.fQuality = 90.0f;
+        ConvertEngine engine(option);
+
+        VerifyOption measure;
+        measure.nEvery = 1;
+
+        int nIndex = 0;
+        for (const auto& size : sizes)
+        {
+            const std::string strSize = std::to_string(size.nWidth) + "x" + std::to_string(size.nHeight);
+            std::vector<uint8_t> vecJpeg;
+            if (!ctx.Expect(MakeCorpusJpeg(nIndex++, size.nWidth, size.nHeight, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패: " + strSize))
+                continue;
+
+            std::vector<uint8_t> vecWebp;
+            ConvertResult result;
+            const bool bConverted = engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result);
+            if (!ctx.Expect(bConverted, std::string("변환 실패 (") + GetConvertStatusString(result.eStatus) + "): " + strSize))
+                continue;
+
+            int nWebpWidth = 0, nWebpHeight = 0;
+            if (!ctx.Expect(WebPGetInfo(vecWebp.data(), vecWebp.size(), &nWebpWidth, &nWebpHeight) != 0, "WebP 헤더를 읽지 못함: " + strSize))
+                continue;
+            ctx.Expect(nWebpWidth == size.nWidth && nWebpHeight == size.nHeight,
+                       "크기 불일치: " + strSize + " -> " + std::to_string(nWebpWidth) + "x" + std::to_string(nWebpHeight));
+            ctx.Expect(result.nOutputSize == vecWebp.size() && result.nInputSize == vecJpeg.size(), "결과 크기 기록이 실제와 다름: " + strSize);
+
+            // 인코더 입력(limited-range 평면)과 비교
+            std::vector<uint8_t> vecY;
+            ConvertResult decodeResult;
+            QualityScore score;
+            if (!ctx.Expect(engine.DecodeGray(vecJpeg.data(), vecJpeg.size(), option, vecY, decodeResult), "DecodeGray 실패: " + strSize))
+                continue;
+            if (!ctx.Expect(ConvertEngine::MeasureWebp(vecWebp.data(), vecWebp.size(), vecY.data(), size.nWidth, size.nHeight, measure, score),
+                            "WebP 를 다시 디코딩하지 못함: " + strSize))
+                continue;
+            ctx.Expect(score.fPsnr >= 30.0, "PSNR 이 너무 낮음: " + strSize + " psnr=" + std::to_string(score.fPsnr));
+        }
+    }
+
+    // 3) 잘라내기: 결과 크기가 영역 크기와 같고, 영역이 밖으로 나가면 CONVERT_ERR_CROP
+    void TestCrop(TestContext& ctx)
+    {
+        std::vector<uint8_t> vecJpeg;
+        if (!ctx.Expect(MakeCorpusJpeg(0, 640, 480, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패"))
+            return;
+
+        ConvertOption option;
+        option.crop = { 64, 32, 200, 100 };
+        ConvertEngine engine(option);
+
+        std::vector<uint8_t> vecWebp;
+        ConvertResult result;
+        // 메시지는 변환이 끝난 뒤에 만든다. (같은 호출의 인자로 두면 평가 순서가 정해지지 않아 이전 상태가 찍힐 수 있다)
+        const bool bConverted = engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result);
+        if (ctx.Expect(bConverted, std::string("잘라내기 변환 실패: ") + GetConvertStatusString(result.eStatus)))
+        {
+            int nWebpWidth = 0, nWebpHeight = 0;
+            ctx.Expect(WebPGetInfo(vecWebp.data(), vecWebp.size(), &nWebpWidth, &nWebpHeight) != 0 && nWebpWidth == 200 && nWebpHeight == 100,
+                       "잘라낸 크기가 200x100 이 아님: " + std::to_string(nWebpWidth) + "x" + std::to_string(nWebpHeight));
+        }
+
+        option.crop = { 600, 0, 100, 100 };
+        engine.SetOption(option);
+        ctx.Expect(!engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result) && result.eStatus == CONVERT_ERR_CROP,
+                   std::string("이미지 밖 영역이 CONVERT_ERR_CROP 이 아님: ") + GetConvertStatusString(result.eStatus));
+    }
+
+    // 4) 잘못된 입력은 정해진 상태 코드로 실패해야 한다.
+    void TestErrors(TestContext& ctx)
+    {
+        ConvertEngine engine;
+        std::vector<uint8_t> vecWebp;
+        ConvertResult result;
+
+        const uint8_t garbage[] = { 'n', 'o', 't', ' ', 'j', 'p', 'e', 'g' };
+        ctx.Expect(!engine.ConvertMemory(garbage, sizeof(garbage), vecWebp, result) && result.eStatus == CONVERT_ERR_HEADER,
+                   std::string("JPEG 이 아닌 입력이 CONVERT_ERR_HEADER 가 아님: ") + GetConvertStatusString(result.eStatus));
+
+        std::vector<uint8_t> vecJpeg;
+        if (ctx.Expect(MakeCorpusJpeg(1, 320, 240, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패"))
+        {
+            const size_t nHalf = vecJpeg.size() / 2;
+            ctx.Expect(!engine.ConvertMemory(vecJpeg.data(), nHalf, vecWebp, result)
+                       && (result.eStatus == CONVERT_ERR_DECODE || result.eStatus == CONVERT_ERR_HEADER),
+                       std::string("잘린 JPEG 이 디코딩 실패로 끝나지 않음: ") + GetConvertStatusString(result.eStatus));
+        }
+
+        if (ctx.Expect(MakeCorpusJpeg(2, 320, 240, JPEG_SUBSAMP_420, vecJpeg), "컬러 코퍼스 JPEG 생성 실패"))
+        {
+            ctx.Expect(!engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result) && result.eStatus == CONVERT_ERR_NOT_GRAY,
+                       std::string("컬러 JPEG 이 CONVERT_ERR_NOT_GRAY 가 아님: ") + GetConvertStatusString(result.eStatus));
+        }
+
+        ConvertOption option;
+        option.strDecoder = "no-such-decoder";
+        ctx.Expect(!engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), option, vecWebp, result) && result.eStatus == CONVERT_ERR_DECODER,
+                   std::string("없는 디코더가 CONVERT_ERR_DECODER 가 아님: ") + GetConvertStatusString(result.eStatus));
+    }
+
+    // 순서와 결과를 기록하는 출력
+    class RecordingSink : public IOutputSink
+    {
+    public:
+        bool Write(OutputItem& item) override
+        {
+            vecSeq.push_back(item.nSeq);
+            vecOk.push_back(item.bOk);
+            nBytes += item.vecWebp.size();
+            return true;
+        }
+
+        std::vector<uint64_t> vecSeq;
+        std::vector<bool> vecOk;
+        uint64_t nBytes = 0;
+    };
+
+    // 5) BatchPipeline: 순서 유지, 실패 항목 집계, 출력 바이트 합이 통계와 같은지
+    void TestPipeline(TestContext& ctx)
+    {
+        const size_t nItems = 24;
+        const size_t nBadIndex = 7;
+        std::vector<std::vector<uint8_t>> vecJpeg(nItems);
+        for (size_t i = 0; i < nItems; ++i)
+        {
+            if (i == nBadIndex)
+            {
+                vecJpeg[i] = { 0x00, 0x01, 0x02, 0x03 };
+                continue;
+            }
+            if (!ctx.Expect(MakeCorpusJpeg(static_cast<int>(i), 96 + static_cast<int>(i) * 8, 64, JPEG_SUBSAMP_GRAY, vecJpeg[i]), "코퍼스 JPEG 생성 실패"))
+                return;
+        }
+
+        ConvertEngine engine;
+        PipelineOption option;
+        option.nWorkerCount = 4;
+        option.nMaxInflight = 6;
+        BatchPipeline pipeline(engine, option);
+
+        MemoryJpegSource source(vecJpeg);
+        RecordingSink sink;
+        const PipelineStats stats = pipeline.Run(source, sink);
+
+        ctx.Expect(stats.nItems == nItems && stats.nConverted == nItems - 1 && stats.nFailed == 1,
+                   "집계가 다름: items=" + std::to_string(stats.nItems) + " converted=" + std::to_string(stats.nConverted) + " failed=" + std::to_string(stats.nFailed));
+        ctx.Expect(stats.nOutputBytes == sink.nBytes, "출력 바이트 합이 통계와 다름");
+        ctx.Expect(!stats.bSourceError && !stats.bSinkError, "원천/출력 오류가 보고됨");
+
+        bool bOrdered = sink.vecSeq.size() == nItems;
+        for (size_t i = 0; bOrdered && i < nItems; ++i)
+            bOrdered = sink.vecSeq[i] == i;
+        ctx.Expect(bOrdered, "bPreserveOrder 인데 출력 순서가 입력 순서와 다름");
+        ctx.Expect(sink.vecOk.size() == nItems && !sink.vecOk[nBadIndex], "손상 항목이 실패로 표시되지 않음");
+    }
+
+    // 6) JobPool 우선순위 줄: 이미 쌓인 NORMAL 뒤에서 HIGH 가 기다리지 않는지, WEIGHTED 가 NORMAL 을 굶기지 않는지
+    //    묶어 넣은 작업이 모두 실행되고 예외를 던지는 작업이 작업자를 끝내지 않는지
+    void TestPriorityLanes(TestContext& ctx)
+    {
+        // 작업자 하나를 막아 둔 채로 (막는 작업이 실행을 시작한 뒤에) NORMAL 4 개, HIGH 1 개를 넣으면 HIGH 가 먼저 실행된다.
+        {
+            JobPool pool(1);
+            std::atomic<bool> bGate{ false };
+            std::atomic<bool> bBlocked{ false };
+            std::mutex mutexOrder;
+            std::vector<int> vecOrder;
+            pool.push([&]() { bBlocked = true; while (!bGate.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+            while (!bBlocked.load())
+                std::this_thread::yield();
+            for (int i = 0; i < 4; ++i)
+                pool.push([&, i]() { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(i); });
+            pool.push([&]() { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(100); }, JOB_PRIORITY_HIGH);
+            bGate = true;
+            pool.stop();
+            ctx.Expect(vecOrder.size() == 5 && vecOrder[0] == 100, "STRICT 인데 HIGH 가 먼저 실행되지 않음");
+        }
+
+        // WEIGHTED (HIGH 2 개마다 NORMAL 1 개): 두 줄이 모두 쌓여 있으면 NORMAL 이 세 번째 안에 실행된다.
+        {
+            JobPoolOption option;
+            option.nWorkerCount = 1;
+            option.ePolicy = LANE_POLICY_WEIGHTED;
+            option.nHighWeight = 2;
+            JobPool pool(option);
+            std::atomic<bool> bGate{ false };
+            std::atomic<bool> bBlocked{ false };
+            std::mutex mutexOrder;
+            std::vector<int> vecOrder;
+            pool.push([&]() { bBlocked = true; while (!bGate.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+            while (!bBlocked.load())
+                std::this_thread::yield();
+            pool.push([&]() { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(0); });
+            for (int i = 0; i < 6; ++i)
+                pool.push([&, i]() { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(100 + i); }, JOB_PRIORITY_HIGH);
+            bGate = true;
+            pool.stop();
+            ctx.Expect(vecOrder.size() == 7 && vecOrder[2] == 0, "WEIGHTED 인데 NORMAL 이 HIGH 2 개 뒤에 실행되지 않음");
+        }
+
+        // 전용 작업자: 일반 작업자 둘이 모두 막혀 있고 NORMAL 이 쌓여 있어도 HIGH 는 그 뒤를 기다리지 않는다.
+        //   시간 대신 순서로 확인한다. HIGH 가 전부 끝난 뒤에야 막은 것을 풀므로, 쌓인 NORMAL 보다 HIGH 가 먼저 기록돼야 한다.
+        {
+            JobPoolOption option;
+            option.nWorkerCount = 3;
+            option.nReservedHighWorkers = 1;
+            JobPool pool(option);
+            std::atomic<bool> bGate{ false };
+            std::atomic<int> nBlocked{ 0 };
+            std::atomic<int> nHighDone{ 0 };
+            std::mutex mutexOrder;
+            std::vector<int> vecOrder;
+            for (int i = 0; i < 2; ++i)
+                pool.push([&]() { ++nBlocked; while (!bGate.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+            while (nBlocked.load() < 2)
+                std::this_thread::yield();
+            for (int i = 0; i < 10; ++i)
+                pool.push([&, i]() { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(i); });
+            for (int i = 0; i < 3; ++i)
+                pool.push([&, i]() { { std::lock_guard<std::mutex> lock(mutexOrder); vecOrder.push_back(100 + i); } ++nHighDone; }, JOB_PRIORITY_HIGH);
+
+            // 전용 작업자가 없다면 여기서 영영 끝나지 않으므로 넉넉한 상한만 둔다. (시간을 재는 것이 아님)
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (nHighDone.load() < 3 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            bGate = true;
+            pool.stop();
+
+            const JobLaneStats high = pool.getLaneStats(JOB_PRIORITY_HIGH);
+            const JobLaneStats normal = pool.getLaneStats(JOB_PRIORITY_NORMAL);
+            ctx.Expect(high.nCompleted == 3 && normal.nCompleted == 12, "줄별 완료 수가 다름");
+            ctx.Expect(vecOrder.size() == 13 && vecOrder[0] >= 100 && vecOrder[1] >= 100 && vecOrder[2] >= 100, "전용 작업자가 있는데 HIGH 가 쌓인 NORMAL 뒤에 실행됨");
+        }
+
+        // 한 번에 넣은 작업이 모두 실행되고, 예외를 던지는 작업이 작업자를 끝내지 않는지
+        {
+            JobPool pool(2);
+            std::atomic<int> nDone{ 0 };
+            std::vector<std::function<void()>> vecJob;
+            vecJob.push_back([]() { throw std::runtime_error("test"); });
+            for (int i = 0; i < 8; ++i)
+                vecJob.push_back([&]() { ++nDone; });
+            pool.pushBatch(std::move(vecJob));
+            pool.stop();
+
+            const JobLaneStats normal = pool.getLaneStats(JOB_PRIORITY_NORMAL);
+            ctx.Expect(nDone.load() == 8 && normal.nSubmitted == 9 && normal.nCompleted == 9, "묶어 넣은 작업 중 일부가 실행되지 않음: " + std::to_string(nDone.load()));
+        }
+    }
+
+    // 7) 작업자 배치 순서: 노드/L3 영역을 번갈아 쓰고, 물리 코어를 다 쓴 뒤에야 SMT 형제를 쓰는지
+    //    노드 2 개 x L3 영역 2 개 x 코어 2 개 x SMT 2 = CPU 16 개 (CPU 번호는 리눅스처럼 SMT 형제가 뒤쪽 절반)
+    void TestWorkerPlacement(TestContext& ctx)
+    {
+        std::vector<CpuInfo> vecCpu;
+        for (int nCpu = 0; nCpu < 16; ++nCpu)
+        {
+            CpuInfo cpu;
+            cpu.nCpu = nCpu;
+            cpu.nGroupCpu = nCpu;
+            cpu.nCore = nCpu % 8;
+            cpu.nL3 = cpu.nCore / 2;
+            cpu.nNode = cpu.nCore / 4;
+            cpu.nPackage = cpu.nNode;
+            cpu.bPrimary = nCpu < 8;
+            vecCpu.push_back(cpu);
+        }
+        const CpuTopology topology(vecCpu);
+        ctx.Expect(topology.GetNodeCount() == 2 && topology.GetCoreCount() == 8 && topology.GetL3Count() == 4, "토폴로지 개수가 다름: " + topology.ToString());
+
+        // 작업자 4 개: L3 영역마다 하나, 노드는 번갈아
+        const std::vector<CpuInfo> vecFour = topology.PlanWorkers(4);
+        ctx.Expect(vecFour.size() == 4, "배치 수가 다름");
+        if (vecFour.size() == 4)
+        {
+            ctx.Expect(vecFour[0].nNode != vecFour[1].nNode && vecFour[1].nNode != vecFour[2].nNode, "노드가 번갈아 나오지 않음");
+            std::vector<int> vecL3;
+            for (const auto& cpu : vecFour)
+                vecL3.push_back(cpu.nL3);
+            std::sort(vecL3.begin(), vecL3.end());
+            ctx.Expect(std::unique(vecL3.begin(), vecL3.end()) == vecL3.end(), "작업자 4 개가 L3 영역 4 개에 나뉘지 않음");
+        }
+
+        // 작업자 16 개: 앞의 8 개는 모두 서로 다른 물리 코어, 전체는 모든 CPU 를 한 번씩
+        const std::vector<CpuInfo> vecAll = topology.PlanWorkers(16);
+        std::vector<int> vecCore, vecCpuIndex;
+        for (size_t i = 0; i < vecAll.size(); ++i)
+        {
+            if (i < 8)
+            {
+                ctx.Expect(vecAll[i].bPrimary, "물리 코어가 남았는데 SMT 형제에 배치됨");
+                vecCore.push_back(vecAll[i].nCore);
+            }
+            vecCpuIndex.push_back(vecAll[i].nCpu);
+        }
+        std::sort(vecCore.begin(), vecCore.end());
+        std::sort(vecCpuIndex.begin(), vecCpuIndex.end());
+        ctx.Expect(vecCore.size() == 8 && std::unique(vecCore.begin(), vecCore.end()) == vecCore.end(), "앞쪽 작업자가 물리 코어를 나눠 쓰지 않음");
+        ctx.Expect(vecCpuIndex.size() == 16 && std::unique(vecCpuIndex.begin(), vecCpuIndex.end()) == vecCpuIndex.end(), "같은 CPU 에 작업자가 둘 이상");
+
+        // CPU 보다 작업자가 많으면 다시 돈다.
+        ctx.Expect(topology.PlanWorkers(20).size() == 20, "CPU 수보다 많은 작업자를 배치하지 않음");
+
+        // 실제 시스템에서 고정한 풀도 작업을 끝까지 처리해야 한다. (고정이 거부되어도 동작은 같음)
+        JobPoolOption option;
+        option.nWorkerCount = 2;
+        option.bPinWorkers = true;
+        JobPool pool(option);
+        std::atomic<int> nDone{ 0 };
+        for (int i = 0; i < 8; ++i)
+            pool.push([&nDone]() { ++nDone; });
+        pool.stop();
+        ctx.Expect(nDone == 8, "고정한 풀이 작업을 모두 처리하지 않음");
+    }
+
+    // 8) 변환 캐시: 두 번째 요청은 변환하지 않고, 동시 요청은 한 번만 변환하며, 디스크 계층은 다시 열어도 남고 크기 상한을 지키는지
+    void TestConversionCache(TestContext& ctx)
+    {
+        std::vector<uint8_t> vecJpeg;
+        if (!ctx.Expect(MakeCorpusJpeg(0, 96, 64, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패"))
+            return;
+
+        ConvertOption option;
+        ConvertEngine engine(option);
+        std::atomic<int> nConvertCount{ 0 };
+        auto convert = [&](std::vector<uint8_t>& vecWebp, ConvertResult& result)
+        {
+            ++nConvertCount;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 동시 요청이 겹치도록
+            return engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result);
+        };
+
+        // 키: 설정이 다르면 다른 키
+        const std::string strKey = ConversionCache::MakeContentKey(vecJpeg.data(), vecJpeg.size(), option);
+        ConvertOption optionOther = option;
+        optionOther.fQuality = 50.0f;
+        ctx.Expect(strKey != ConversionCache::MakeContentKey(vecJpeg.data(), vecJpeg.size(), optionOther), "품질이 달라도 키가 같음");
+
+        const std::string strDir = (std::filesystem::temp_directory_path() / "webptest_cache").string();
+        std::error_code ec;
+        std::filesystem::remove_all(strDir, ec);
+
+        ConversionCacheOption cacheOption;
+        cacheOption.nMemoryBytes = 16u << 20;
+        cacheOption.nShardCount = 4;
+        cacheOption.strDiskDir = strDir;
+        {
+            ConversionCache cache(cacheOption);
+            if (!ctx.Expect(cache.Open(), "캐시 폴더 열기 실패"))
+                return;
+
+            // 동시 요청 8 개 -> 변환 1 번, 나머지는 합류
+            std::vector<std::thread> vecThread;
+            std::atomic<int> nOk{ 0 };
+            for (int i = 0; i < 8; ++i)
+                vecThread.emplace_back([&]() { if (cache.GetOrConvert(strKey, convert).bOk) ++nOk; });
+            for (auto& thread : vecThread)
+                thread.join();
+            ctx.Expect(nOk == 8 && nConvertCount == 1, "동시 요청이 " + std::to_string(nConvertCount.load()) + "번 변환됨");
+
+            const CacheLookup lookup = cache.GetOrConvert(strKey, convert);
+            ctx.Expect(lookup.bOk && lookup.eTier == CACHE_TIER_MEMORY && nConvertCount == 1, "두 번째 요청이 메모리에서 나오지 않음");
+
+            const ConversionCacheStats stats = cache.GetStats();
+            ctx.Expect(stats.nMisses == 1 && stats.nMemoryHits + stats.nSharedHits == 8 && stats.nDiskEntries == 1, "캐시 통계가 다름");
+        }
+
+        // 다시 열면 디스크에서 (변환 없이) 나온다.
+        const size_t nWebpSize = [&]()
+        {
+            ConversionCache cache(cacheOption);
+            cache.Open();
+            const CacheLookup lookup = cache.GetOrConvert(strKey, convert);
+            ctx.Expect(lookup.bOk && lookup.eTier == CACHE_TIER_DISK && nConvertCount == 1, "다시 연 캐시가 디스크 항목을 찾지 못함");
+            return lookup.pWebp ? lookup.pWebp->size() : 0;
+        }();
+
+        // 디스크 상한을 항목 2 개 크기로 줄이면 가장 오래된 항목부터 지운다.
+        cacheOption.nMemoryBytes = 0;
+        cacheOption.nDiskBytes = nWebpSize * 2;
+        {
+            ConversionCache cache(cacheOption);
+            cache.Open();
+            for (int nQuality = 60; nQuality < 64; ++nQuality)
+            {
+                ConvertOption optionQuality = option;
+                optionQuality.fQuality = static_cast<float>(nQuality);
+                cache.GetOrConvert(ConversionCache::MakeContentKey(vecJpeg.data(), vecJpeg.size(), optionQuality), convert);
+            }
+            const ConversionCacheStats stats = cache.GetStats();
+            ctx.Expect(stats.nDiskBytes <= cacheOption.nDiskBytes && stats.nDiskEvictions > 0, "디스크 상한을 넘음: " + std::to_string(stats.nDiskBytes));
+            ctx.Expect(cache.GetOrConvert(strKey, convert).eTier == CACHE_TIER_CONVERTED, "축출된 항목이 남아 있음");
+        }
+
+        // 밖에서 지운 디스크 항목은 색인과 크기 합계에서 빠지고, 변환 함수가 예외를 던져도 같은 키의 다음 요청이 막히지 않는다.
+        cacheOption.nDiskBytes = 4ull << 20;
+        {
+            ConversionCache cache(cacheOption);
+            cache.Open();
+            const ConversionCacheStats before = cache.GetStats();
+            std::filesystem::remove(std::filesystem::path(strDir) / (strKey + ".webp"), ec);
+
+            std::atomic<int> nThrown{ 0 };
+            auto convertThrow = [&](std::vector<uint8_t>&, ConvertResult&) -> bool
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50)); // 합류할 요청이 들어오도록
+                throw std::runtime_error("convert failed");
+            };
+            std::vector<std::thread> vecThread;
+            for (int i = 0; i < 3; ++i)
+            {
+                vecThread.emplace_back([&]()
+                {
+                    try
+                    {
+                        cache.GetOrConvert(strKey, convertThrow);
+                    }
+                    catch (const std::runtime_error&)
+                    {
+                        ++nThrown;
+                    }
+                });
+            }
+            for (auto& thread : vecThread)
+                thread.join();
+            const ConversionCacheStats after = cache.GetStats();
+            ctx.Expect(nThrown == 3, "예외가 모든 요청에 전달되지 않음: " + std::to_string(nThrown.load()));
+            ctx.Expect(after.nDiskEntries + 1 == before.nDiskEntries && after.nDiskBytes + nWebpSize == before.nDiskBytes, "읽지 못한 디스크 항목이 색인에 남음");
+
+            const CacheLookup lookup = cache.GetOrConvert(strKey, convert);
+            ctx.Expect(lookup.bOk && lookup.eTier == CACHE_TIER_CONVERTED, "예외 뒤의 요청이 다시 변환하지 않음");
+        }
+        std::filesystem::remove_all(strDir, ec);
+    }
+
+    // 9) 뒤쓰기: 큐가 작아 임시 폴더를 거쳐도 모든 파일이 내용 그대로 최종 위치에 남고, 임시 파일은 지워지는지
+    void TestOutputWriter(TestContext& ctx)
+    {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_writer";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+
+        OutputWriterOption option;
+        option.nWriterCount = 2;
+        option.nQueueBytes = 4096;
+        option.strScratchDir = (root / "scratch").string();
+        option.eDurability = WRITE_DURABILITY_BATCH;
+        option.nBatchFiles = 4;
+
+        const int nFiles = 24;
+        {
+            OutputWriter writer(option);
+            if (!ctx.Expect(writer.Start(), "임시 폴더를 만들지 못함"))
+                return;
+
+            for (int i = 0; i < nFiles; ++i)
+            {
+                std::vector<uint8_t> vecData(1000 + static_cast<size_t>(i), static_cast<uint8_t>(i));
+                writer.Submit((root / ("dir" + std::to_string(i % 3)) / ("f" + std::to_string(i) + ".webp")).string(), std::move(vecData));
+            }
+            ctx.Expect(writer.Finish(), "쓰기 실패가 있음");
+
+            const OutputWriterStats stats = writer.GetStats();
+            ctx.Expect(stats.nWritten == static_cast<uint64_t>(nFiles) && stats.nSpilled > 0 && stats.nSyncs > 0, "뒤쓰기 통계가 다름");
+        }
+
+        for (int i = 0; i < nFiles; ++i)
+        {
+            std::vector<uint8_t> vecData;
+            const std::string strPath = (root / ("dir" + std::to_string(i % 3)) / ("f" + std::to_string(i) + ".webp")).string();
+            const bool bRead = ReadFileToMemory(strPath, vecData);
+            ctx.Expect(bRead && vecData.size() == 1000 + static_cast<size_t>(i) && vecData.front() == static_cast<uint8_t>(i), "내용이 다름: " + strPath);
+        }
+        ctx.Expect(std::filesystem::is_empty(option.strScratchDir, ec), "임시 파일이 남아 있음");
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 10) 애니메이션: 프레임이 입력 순서대로 들어가고, 손상/크기가 다른 프레임은 건너뛰며, 창보다 많은 프레임을 붙잡지 않는지
+    void TestAnimation(TestContext& ctx)
+    {
+        const size_t nFrames = 12;
+        std::vector<std::vector<uint8_t>> vecJpeg(nFrames);
+        for (size_t i = 0; i < nFrames; ++i)
+        {
+            const int nWidth = (i == 5) ? 64 : 96;  // 5 번은 크기가 다름
+            if (!ctx.Expect(MakeCorpusJpeg(static_cast<int>(i), nWidth, 64, JPEG_SUBSAMP_GRAY, vecJpeg[i]), "코퍼스 JPEG 생성 실패"))
+                return;
+        }
+        vecJpeg[8] = { 0x00, 0x01, 0x02, 0x03 };    // 손상
+
+        ConvertEngine engine;
+        AnimationOption option;
+        option.nWorkerCount = 3;
+        option.nWindow = 4;
+        option.nFrameMs = 50;
+        AnimationAssembler assembler(engine, option);
+
+        MemoryJpegSource source(vecJpeg);
+        std::vector<uint8_t> vecWebp;
+        AnimationStats stats;
+        const bool bAssembled = assembler.Run(source, vecWebp, stats);
+        if (!ctx.Expect(bAssembled, "애니메이션 조립 실패: " + stats.strError))
+            return;
+
+        ctx.Expect(stats.nFrames == nFrames && stats.nEncoded == nFrames - 2 && stats.nSkipped == 2,
+                   "집계가 다름: frames=" + std::to_string(stats.nFrames) + " encoded=" + std::to_string(stats.nEncoded) + " skipped=" + std::to_string(stats.nSkipped));
+        ctx.Expect(stats.nPeakFrames <= option.nWindow, "창보다 많은 프레임을 붙잡음: " + std::to_string(stats.nPeakFrames));
+        ctx.Expect(stats.nOutputBytes == vecWebp.size() && !vecWebp.empty(), "출력 크기 기록이 실제와 다름");
+
+        int nWebpWidth = 0, nWebpHeight = 0;
+        ctx.Expect(WebPGetInfo(vecWebp.data(), vecWebp.size(), &nWebpWidth, &nWebpHeight) != 0 && nWebpWidth == 96 && nWebpHeight == 64,
+                   "캔버스 크기가 첫 프레임과 다름");
+
+        // 넣을 프레임이 하나도 없으면 실패
+        std::vector<std::vector<uint8_t>> vecBad(2, std::vector<uint8_t>{ 0x00, 0x01 });
+        MemoryJpegSource badSource(vecBad);
+        ctx.Expect(!assembler.Run(badSource, vecWebp, stats) && stats.nSkipped == 2, "프레임이 없는데 성공함");
+    }
+
+    // 11) 무손실: WebP 를 다시 디코딩한 값이 JPEG 을 디코더 백엔드로 직접 디코딩한 값(full-range)과 비트 단위로 같은지
+    void TestLossless(TestContext& ctx)
+    {
+        // ARGB 펼치기: 블록 뒤 나머지까지 R=G=B=값, A=255
+        std::vector<uint8_t> vecGray(19 * 3);
+        for (size_t i = 0; i < vecGray.size(); ++i)
+            vecGray[i] = static_cast<uint8_t>(i * 5);
+        std::vector<uint32_t> vecArgb(17 * 3);
+        ExpandGrayToArgb(vecGray.data(), 19, 17, 3, vecArgb.data());
+        bool bExpanded = true;
+        for (int y = 0; y < 3; ++y)
+        {
+            for (int x = 0; x < 17; ++x)
+            {
+                const uint32_t g = vecGray[static_cast<size_t>(y) * 19 + x];
+                bExpanded = bExpanded && vecArgb[static_cast<size_t>(y) * 17 + x] == (0xFF000000u | (g << 16) | (g << 8) | g);
+            }
+        }
+        ctx.Expect(bExpanded, "그레이 -> ARGB 펼치기 결과가 다름");
+
+        const CorpusSize sizes[] = { { 640, 480 }, { 33, 17 } };
+        ConvertOption option;
+        option.bLossless = true;
+        option.nLosslessLevel = LOSSLESS_LEVEL_FAST;
+        ConvertEngine engine(option);
+
+        int nIndex = 0;
+        for (const auto& size : sizes)
+        {
+            const std::string strSize = std::to_string(size.nWidth) + "x" + std::to_string(size.nHeight);
+            std::vector<uint8_t> vecJpeg;
+            if (!ctx.Expect(MakeCorpusJpeg(nIndex++, size.nWidth, size.nHeight, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패: " + strSize))
+                continue;
+
+            IDecoderBackend* pDecoder = GetThreadDecoder(DecoderRegistry::DEFAULT_DECODER);
+            JpegHeader header;
+            if (!ctx.Expect(pDecoder && pDecoder->Probe(vecJpeg.data(), vecJpeg.size(), header), "기본 디코더로 헤더를 읽지 못함: " + strSize))
+                continue;
+            std::vector<uint8_t> vecFull(static_cast<size_t>(header.nWidth) * header.nHeight);
+            DecodePlanes planes;
+            planes.pY = vecFull.data();
+            planes.nYStride = header.nWidth;
+            if (!ctx.Expect(pDecoder->DecodeInto(vecJpeg.data(), vecJpeg.size(), header, planes), "기본 디코더 디코딩 실패: " + strSize))
+                continue;
+
+            std::vector<uint8_t> vecWebp;
+            ConvertResult result;
+            const bool bConverted = engine.ConvertMemory(vecJpeg.data(), vecJpeg.size(), vecWebp, result);
+            if (!ctx.Expect(bConverted, std::string("무손실 변환 실패 (") + GetConvertStatusString(result.eStatus) + "): " + strSize))
+                continue;
+
+            std::vector<uint8_t> vecRgba(vecFull.size() * 4);
+            if (!ctx.Expect(WebPDecodeRGBAInto(vecWebp.data(), vecWebp.size(), vecRgba.data(), vecRgba.size(), size.nWidth * 4) != nullptr,
+                            "무손실 WebP 를 다시 디코딩하지 못함: " + strSize))
+                continue;
+
+            size_t nMismatch = 0;
+            for (size_t p = 0; p < vecFull.size(); ++p)
+            {
+                const uint8_t* pPixel = &vecRgba[p * 4];
+                if (pPixel[0] != vecFull[p] || pPixel[1] != vecFull[p] || pPixel[2] != vecFull[p] || pPixel[3] != 255)
+                    ++nMismatch;
+            }
+            ctx.Expect(nMismatch == 0, "무손실 결과가 원래 값과 다른 픽셀 " + std::to_string(nMismatch) + "개: " + strSize);
+        }
+    }
+
+    // 12) 조각 실행: 두 방식 모두 파일이 정확히 한 조각에만 들어가는지, 만료된 임대는 다음 세대로 넘어가고
+    //     이전 세대는 갱신/완료하지 못하는지, 병합 보고서가 머리 줄 하나와 모든 행을 갖는지
+    void TestShardJob(TestContext& ctx)
+    {
+        std::vector<ShardFile> vecFile;
+        uint64_t nTotalBytes = 0;
+        uint64_t nMaxBytes = 0;
+        for (int i = 0; i < 50; ++i)
+        {
+            ShardFile file;
+            file.strPath = "dir" + std::to_string(i % 4) + "/f" + std::to_string(100 + i) + ".jpg";
+            file.nSize = (i == 7) ? 40000 : static_cast<uint64_t>(1000 * (i % 5 + 1));
+            nTotalBytes += file.nSize;
+            nMaxBytes = std::max(nMaxBytes, file.nSize);
+            vecFile.push_back(file);
+        }
+
+        for (SHARD_SPLIT eSplit : { SHARD_SPLIT_HASH, SHARD_SPLIT_SIZE })
+        {
+            const std::vector<std::vector<std::string>> vecShard = SplitShards(vecFile, 4, eSplit);
+            std::multiset<std::string> setAssigned;
+            std::vector<std::string> vecConcat;
+            for (const auto& vecPath : vecShard)
+            {
+                setAssigned.insert(vecPath.begin(), vecPath.end());
+                vecConcat.insert(vecConcat.end(), vecPath.begin(), vecPath.end());
+            }
+            std::multiset<std::string> setInput;
+            for (const auto& file : vecFile)
+                setInput.insert(file.strPath);
+            ctx.Expect(vecShard.size() == 4 && setAssigned == setInput, std::string("파일이 정확히 한 조각에 들어가지 않음: ") + GetShardSplitString(eSplit));
+            if (eSplit != SHARD_SPLIT_SIZE)
+                continue;
+
+            // 크기 방식: 이름순 연속 구간이고, 조각 바이트가 평균에서 가장 큰 파일 하나 이상 벗어나지 않음
+            ctx.Expect(std::is_sorted(vecConcat.begin(), vecConcat.end()), "크기 방식 조각이 연속 구간이 아님");
+            for (const auto& vecPath : vecShard)
+            {
+                uint64_t nBytes = 0;
+                for (const auto& strPath : vecPath)
+                    nBytes += std::find_if(vecFile.begin(), vecFile.end(), [&](const ShardFile& file) { return file.strPath == strPath; })->nSize;
+                const double fDiff = static_cast<double>(nBytes) - static_cast<double>(nTotalBytes) / 4.0;
+                ctx.Expect(std::abs(fDiff) <= static_cast<double>(nMaxBytes), "크기 방식 조각의 바이트가 치우침: " + std::to_string(nBytes));
+            }
+        }
+
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_shard";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+
+        std::string strError;
+        const std::vector<std::string> vecArgs = { "--quality=75", "--out=out" };
+        const bool bCreated = ShardJob::Create(root.string(), vecFile, 3, SHARD_SPLIT_HASH, 1, vecArgs, strError);
+        if (!ctx.Expect(bCreated, "작업 계획 실패: " + strError))
+            return;
+        ctx.Expect(!ShardJob::Create(root.string(), vecFile, 3, SHARD_SPLIT_HASH, 1, vecArgs, strError), "이미 계획된 폴더에 다시 계획함");
+
+        ShardJob job;
+        if (!ctx.Expect(job.Open(root.string()) && job.GetShardCount() == 3 && job.GetFileCount() == vecFile.size() && job.GetArgs() == vecArgs,
+                        "매니페스트를 다시 읽은 값이 다름"))
+            return;
+
+        std::vector<int> vecShard(3);
+        int nGeneration = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            vecShard[i] = job.Claim("node:" + std::to_string(i), nGeneration);
+            ctx.Expect(vecShard[i] >= 0 && nGeneration == 1, "남은 조각을 임대하지 못함");
+        }
+        ctx.Expect(vecShard[0] != vecShard[1] && vecShard[1] != vecShard[2] && vecShard[0] != vecShard[2], "같은 조각을 두 번 임대함");
+        ctx.Expect(job.Claim("node:3", nGeneration) < 0, "모두 임대 중인데 임대함");
+
+        // 첫 작업자가 멈춘 것처럼 갱신 시각을 과거로 돌린다.
+        char szLease[32];
+        std::snprintf(szLease, sizeof(szLease), "shard_%04d.lease.1", vecShard[0]);
+        std::filesystem::last_write_time(root / szLease, std::filesystem::file_time_type::clock::now() - std::chrono::seconds(10), ec);
+        ctx.Expect(job.GetProgress().nExpired == 1, "만료된 임대를 세지 못함");
+        ctx.Expect(job.Claim("node:3", nGeneration) == vecShard[0] && nGeneration == 2, "만료된 조각을 다음 세대로 넘겨받지 못함");
+        ctx.Expect(!job.Renew(vecShard[0], 1) && job.Renew(vecShard[0], 2), "이전 세대가 갱신하거나 새 세대가 갱신하지 못함");
+        ctx.Expect(!job.Complete(vecShard[0], 1, "stale") && !job.IsDone(vecShard[0]), "이전 세대가 완료함");
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const int nGen = (i == 0) ? 2 : 1;
+            {
+                std::ofstream ofs(job.GetWorkReportPath(vecShard[i], nGen));
+                ofs << "name,status,width,height,in_bytes,out_bytes,quality,psnr,ssim,verify\n";
+                ofs << "\"a,b" << i << ".jpg\",ok,8,8,10,20,80,,,-\n";
+                ofs << "c" << i << ".jpg," << (i == 1 ? "invalid jpeg header" : "ok") << ",0,0,10,0,80,,,-\n";
+            }
+            ctx.Expect(job.Complete(vecShard[i], nGen, "test"), "임대를 가진 세대가 완료하지 못함");
+        }
+
+        const ShardProgress progress = job.GetProgress();
+        ctx.Expect(progress.nDone == 3 && progress.nReassigned == 1 && progress.nLeased == 0, "진행 상황이 다름");
+
+        ShardMergeStats mergeStats;
+        const std::string strMerged = (root / "merged.csv").string();
+        ctx.Expect(job.MergeReports(strMerged, mergeStats) && mergeStats.nReports == 3 && mergeStats.nMissing == 0 && mergeStats.nRows == 6 && mergeStats.nFailedRows == 1,
+                   "병합 집계가 다름: rows=" + std::to_string(mergeStats.nRows) + " failed=" + std::to_string(mergeStats.nFailedRows));
+        std::ifstream ifs(strMerged);
+        std::string strLine;
+        size_t nLines = 0, nHeaders = 0;
+        while (std::getline(ifs, strLine))
+        {
+            ++nLines;
+            if (strLine.compare(0, 5, "name,") == 0)
+                ++nHeaders;
+        }
+        ctx.Expect(nLines == 7 && nHeaders == 1, "병합 보고서 줄 수가 다름");
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 13) 비용 모델: 알려진 선형 비용을 관측하면 처음 보는 특징도 몇 % 안에서 맞히는지, 저장/불러오기와 설정 키,
+    //     JobManager 가 큰 파일부터 처리하고 끝나면 남은 작업/ETA 가 0 이며 모델을 갱신하는지
+    void TestCostModel(TestContext& ctx)
+    {
+        // 실제 비용: decode = 2ms + 10ms/MP + 20ms/MP(progressive), encode = 1ms + 40ms/MP + 5ms/MB
+        auto makeResult = [](const CostFeatures& features)
+        {
+            ConvertResult result;
+            const double fDecode = 0.002 + 0.010 * features.fMegapixels + (features.bProgressive ? 0.020 * features.fMegapixels : 0.0);
+            const double fEncode = 0.001 + 0.040 * features.fMegapixels + 0.005 * features.fInputMB;
+            result.durationDecode = std::chrono::microseconds(static_cast<int64_t>(fDecode * 1e6));
+            result.durationEncode = std::chrono::microseconds(static_cast<int64_t>(fEncode * 1e6));
+            return result;
+        };
+        auto makeFeatures = [](int i)
+        {
+            CostFeatures features;
+            features.fMegapixels = 0.1 + (i * 37 % 120) / 10.0;
+            features.fInputMB = features.fMegapixels * (0.1 + (i * 13 % 10) / 20.0);
+            features.bProgressive = (i % 4) == 0;
+            return features;
+        };
+
+        CostModel model;
+        for (int i = 0; i < 300; ++i)
+            model.Observe(makeFeatures(i), makeResult(makeFeatures(i)));
+        ctx.Expect(model.GetStats().nObserved == 300, "관측 수가 다름");
+
+        double fWorstError = 0.0;
+        for (int i = 1000; i < 1020; ++i)
+        {
+            const CostFeatures features = makeFeatures(i * 7 + 3);
+            const ConvertResult actual = makeResult(features);
+            const double fActual = static_cast<double>((actual.durationDecode + actual.durationEncode).count()) * 1e-6;
+            fWorstError = std::max(fWorstError, std::fabs(model.Predict(features).GetTotalSec() - fActual) / fActual);
+        }
+        ctx.Expect(fWorstError < 0.05, "학습한 모델의 예측 오차가 큼: " + std::to_string(fWorstError * 100.0) + "%");
+
+        // 변환할 수 없는 파일은 비용 0, 실패 결과는 관측하지 않음
+        CostFeatures rejected = makeFeatures(1);
+        rejected.bConvertible = false;
+        ConvertResult failed = makeResult(makeFeatures(1));
+        failed.eStatus = CONVERT_ERR_DECODE;
+        model.Observe(makeFeatures(1), failed);
+        ctx.Expect(model.Predict(rejected).GetTotalSec() == 0.0 && model.GetStats().nObserved == 300, "변환할 수 없는 파일/실패 결과 처리가 다름");
+
+        // 저장한 모델은 같은 설정에서만 같은 예측으로 돌아온다.
+        const std::string strPath = (std::filesystem::temp_directory_path() / "webptest_cost.txt").string();
+        ctx.Expect(model.Save(strPath, "q=80"), "비용 모델 저장 실패");
+        CostModel loaded;
+        ctx.Expect(!loaded.Load(strPath, "q=90"), "다른 설정의 모델을 불러옴");
+        ctx.Expect(loaded.Load(strPath, "q=80") && std::fabs(loaded.Predict(makeFeatures(5)).GetTotalSec() - model.Predict(makeFeatures(5)).GetTotalSec()) < 1e-9,
+                   "불러온 모델의 예측이 다름");
+        std::error_code ec;
+        std::filesystem::remove(strPath, ec);
+
+        // ETA: 끝난 쪽 예측 2초가 1초 걸렸으면 남은 4초는 2초. 끝난 것이 없으면 작업자 수로 나눈다.
+        ctx.Expect(std::fabs(EstimateRemaining(4.0, 2.0, 1.0, 8).fEtaSec - 2.0) < 1e-9 && std::fabs(EstimateRemaining(4.0, 0.0, 0.0, 4).fEtaSec - 1.0) < 1e-9,
+                   "ETA 계산이 다름");
+
+        // JobManager: 작업자 하나로 순서대로 처리되게 해서 파일별 입력 크기 변화로 처리 순서를 본다.
+        //   입력은 a/, b/ 두 폴더에 같은 이름으로 나눠 두고 출력이 서로 덮어쓰지 않는지도 본다.
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_costjob";
+        std::filesystem::remove_all(root, ec);
+        std::filesystem::create_directories(root / "a", ec);
+        std::filesystem::create_directories(root / "b", ec);
+        JobRequest request;
+        for (int i = 0; i < 12; ++i)
+        {
+            const bool bLarge = (i % 3) == 2;
+            std::vector<uint8_t> vecJpeg;
+            if (!ctx.Expect(MakeCorpusJpeg(i, bLarge ? 640 : 96, bLarge ? 480 : 64, JPEG_SUBSAMP_GRAY, vecJpeg), "코퍼스 JPEG 생성 실패"))
+                return;
+            const std::string strJpegPath = (root / (i % 2 ? "b" : "a") / ("c" + std::to_string(i / 2) + ".jpg")).string();
+            WriteMemoryToFile(strJpegPath, vecJpeg.data(), vecJpeg.size());
+            request.vecPath.push_back(strJpegPath);
+        }
+        request.strOutDir = (root / "out").string();
+        request.bEstimateCost = true;
+        request.bLargestFirst = true;
+        request.progressInterval = std::chrono::milliseconds(0);
+
+        std::mutex mutexProgress;
+        std::vector<JobProgress> vecProgress;
+        request.onProgress = [&](const JobProgress& progress)
+        {
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            vecProgress.push_back(progress);
+        };
+
+        JobManager manager(std::make_shared<JobPool>(1));
+        const JobResult result = manager.Submit(request).Wait();
+        ctx.Expect(result.progress.eState == JOB_DONE && result.progress.nConverted == 12, "비용 예측 작업이 끝나지 않음");
+        ctx.Expect(result.progress.fRemainingWorkSec == 0.0 && result.progress.fEtaSec == 0.0, "끝난 작업의 남은 작업/ETA 가 0 이 아님");
+        ctx.Expect(manager.GetCostModel().GetStats().nObserved == 12, "JobManager 가 비용 모델을 갱신하지 않음");
+
+        bool bEtaReported = false;
+        std::vector<uint64_t> vecInputDelta;
+        uint64_t nLastInput = 0;
+        for (const auto& progress : vecProgress)
+        {
+            bEtaReported = bEtaReported || (progress.eState == JOB_RUNNING && progress.fEtaSec >= 0.0 && progress.fRemainingWorkSec >= 0.0);
+            if (progress.nInputBytes > nLastInput)
+                vecInputDelta.push_back(progress.nInputBytes - nLastInput);
+            nLastInput = progress.nInputBytes;
+        }
+        ctx.Expect(bEtaReported, "진행 중에 ETA 를 보고하지 않음");
+        ctx.Expect(vecInputDelta.size() == 12 && *std::min_element(vecInputDelta.begin(), vecInputDelta.begin() + 4) > *std::max_element(vecInputDelta.begin() + 4, vecInputDelta.end()),
+                   "큰 파일부터 처리하지 않음");
+
+        size_t nOutputCount = 0;
+        for (std::filesystem::recursive_directory_iterator it(root / "out", ec), end; !ec && it != end; it.increment(ec))
+            nOutputCount += it->is_regular_file() ? 1 : 0;
+        ctx.Expect(nOutputCount == 12 && std::filesystem::exists(root / "out" / "a" / "c0.webp") && std::filesystem::exists(root / "out" / "b" / "c0.webp"),
+                   "같은 이름의 입력 출력이 겹침: " + std::to_string(nOutputCount) + " 개");
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 14) 아카이브 멤버 경로: "../", 절대 경로 멤버가 출력 폴더 밖으로 나가지 않는지
+    //     파일/폴더 입력은 "../" 나 절대 경로로 주어도 입력 기준 폴더 아래 상대 경로로 출력 폴더에 들어가는지
+    //     중앙 디렉터리 크기/위치가 파일 밖을 가리키는 zip 멤버를 읽기 전에 걸러내는지
+    void TestArchivePaths(TestContext& ctx)
+    {
+        // ustar 헤더 + 데이터 블록 (체크섬은 필드를 공백으로 채우고 계산)
+        auto addMember = [](std::vector<uint8_t>& vecTar, const std::string& strName, const std::vector<uint8_t>& vecData)
+        {
+            uint8_t header[512] = {};
+            std::memcpy(header, strName.data(), std::min<size_t>(strName.size(), 99));
+            std::snprintf(reinterpret_cast<char*>(header + 100), 8, "%07o", 0644);
+            std::snprintf(reinterpret_cast<char*>(header + 124), 12, "%011o", static_cast<unsigned>(vecData.size()));
+            header[156] = '0';
+            std::memcpy(header + 257, "ustar", 6);
+            std::memcpy(header + 263, "00", 2);
+            std::memset(header + 148, ' ', 8);
+            unsigned nSum = 0;
+            for (uint8_t c : header)
+                nSum += c;
+            std::snprintf(reinterpret_cast<char*>(header + 148), 8, "%06o", nSum);
+            vecTar.insert(vecTar.end(), header, header + 512);
+            vecTar.insert(vecTar.end(), vecData.begin(), vecData.end());
+            vecTar.resize((vecTar.size() + 511) / 512 * 512, 0);
+        };
+
+        const std::vector<uint8_t> vecData(100, 0xAB);
+        std::vector<uint8_t> vecTar;
+        addMember(vecTar, "ok/a.jpg", vecData);
+        addMember(vecTar, "../../evil.jpg", vecData);
+        addMember(vecTar, "ok/../../evil2.jpg", vecData);
+        addMember(vecTar, "/etc/abs.jpg", vecData);
+        addMember(vecTar, "./ok/b.jpg", vecData);
+        vecTar.resize(vecTar.size() + 1024, 0);
+
+        std::FILE* pFile = std::tmpfile();
+        if (!ctx.Expect(pFile != nullptr, "임시 파일 생성 실패"))
+            return;
+        std::fwrite(vecTar.data(), 1, vecTar.size(), pFile);
+        std::rewind(pFile);
+
+        std::vector<std::string> vecName;
+        TarArchiveSource tar(pFile, true);
+        InputItem item;
+        while (tar.Next(item))
+            vecName.push_back(item.strName);
+        ctx.Expect(!tar.HasError(), "tar 읽기 오류");
+        const std::vector<std::string> vecExpected = { "ok/a.jpg", "etc/abs.jpg", "ok/b.jpg" };
+        ctx.Expect(vecName == vecExpected, "멤버 이름 정리 결과가 다름 (" + std::to_string(vecName.size()) + "개)");
+
+        // 출력 폴더가 있으면 항목 이름이 무엇이든 그 아래에만 쓴다.
+        const std::filesystem::path outDir = std::filesystem::path("out");
+        DirectorySink sink(outDir.string());
+        ctx.Expect(sink.MakeOutputPath("../../evil.jpg").empty() && sink.MakeOutputPath("a/../../evil.jpg").empty(), "\"..\" 경로를 막지 않음");
+        ctx.Expect(std::filesystem::path(sink.MakeOutputPath("/etc/abs.jpg")) == outDir / "etc" / "abs.webp", "절대 경로가 출력 폴더 아래로 들어오지 않음");
+        ctx.Expect(MakeSafeRelativePath("/").empty() && MakeSafeRelativePath("./.").empty(), "빈 경로를 허용함");
+
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_input_root";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        std::filesystem::create_directories(root / "in" / "sub", ec);
+        std::filesystem::create_directories(root / "other", ec);
+        const std::filesystem::path absoluteIn = std::filesystem::absolute(root / "in", ec);
+        const std::string strRelativeIn = std::filesystem::relative(absoluteIn, std::filesystem::current_path(ec), ec).string();
+        WriteMemoryToFile((absoluteIn / "a.jpg").string(), vecData.data(), vecData.size());
+        WriteMemoryToFile((absoluteIn / "sub" / "b.jpg").string(), vecData.data(), vecData.size());
+        WriteMemoryToFile((root / "other" / "a.jpg").string(), vecData.data(), vecData.size());
+
+        // 폴더 하나: 폴더 자체가 기준 (현재 폴더 기준 "../" 로 시작하는 상대 경로와 절대 경로 모두)
+        for (const std::string& strIn : { strRelativeIn, absoluteIn.string() })
+        {
+            const std::vector<std::string> vecPath = { (std::filesystem::path(strIn) / "a.jpg").string(), (std::filesystem::path(strIn) / "sub" / "b.jpg").string() };
+            FileListSource files(vecPath);
+            files.SetInputRoot(FindInputRoot({ strIn }));
+            std::vector<std::string> vecOutPath;
+            InputItem input;
+            while (files.Next(input))
+                vecOutPath.push_back(sink.MakeOutputPath(input.strOutputName));
+            ctx.Expect(vecOutPath.size() == 2 && std::filesystem::path(vecOutPath[0]) == outDir / "a.webp" && std::filesystem::path(vecOutPath[1]) == outDir / "sub" / "b.webp",
+                       "입력 폴더 기준 출력 경로가 아님: " + strIn + " -> " + (vecOutPath.empty() ? std::string() : vecOutPath[0]));
+        }
+
+        // 같은 이름의 파일이 있는 폴더 둘: 공통 상위 폴더 기준이라 겹치지 않는다. 기준 밖의 경로는 파일 이름만
+        const std::string strRoot = FindInputRoot({ absoluteIn.string(), (root / "other").string() });
+        ctx.Expect(std::filesystem::path(MakeInputRelativePath(strRoot, (root / "other" / "a.jpg").string())) == std::filesystem::path("other") / "a.jpg"
+                   && std::filesystem::path(MakeInputRelativePath(strRoot, (absoluteIn / "a.jpg").string())) == std::filesystem::path("in") / "a.jpg",
+                   "여러 입력 폴더의 공통 기준이 다름: " + strRoot);
+        ctx.Expect(MakeInputRelativePath((absoluteIn / "sub").string(), (absoluteIn / "a.jpg").string()) == "a.jpg", "기준 밖의 입력이 파일 이름으로 바뀌지 않음");
+
+        // 중앙 디렉터리의 압축 크기/로컬 헤더 위치가 파일 밖을 가리키는 zip: 큰 버퍼를 잡지 않고 손상으로 건너뛴다.
+        auto putU16 = [](std::vector<uint8_t>& vec, uint32_t nValue) { vec.push_back(static_cast<uint8_t>(nValue)); vec.push_back(static_cast<uint8_t>(nValue >> 8)); };
+        auto putU32 = [&](std::vector<uint8_t>& vec, uint32_t nValue) { putU16(vec, nValue & 0xFFFF); putU16(vec, nValue >> 16); };
+        const std::string strMember = "big.jpg";
+        std::vector<uint8_t> vecZip;
+        putU32(vecZip, 0x04034b50);
+        for (int i = 0; i < 22; ++i)
+            vecZip.push_back(0);
+        putU16(vecZip, static_cast<uint32_t>(strMember.size()));
+        putU16(vecZip, 0);
+        vecZip.insert(vecZip.end(), strMember.begin(), strMember.end());
+        vecZip.insert(vecZip.end(), 16, 0xAB);
+
+        const uint32_t nCdOffset = static_cast<uint32_t>(vecZip.size());
+        const uint32_t entries[2][2] = { { 0x7FFFFF00u, 0 }, { 16, 0x40000000u } };   // { 압축 크기, 로컬 헤더 위치 }
+        for (const auto& entry : entries)
+        {
+            putU32(vecZip, 0x02014b50);
+            putU16(vecZip, 20); putU16(vecZip, 20); putU16(vecZip, 0); putU16(vecZip, 0);   // 버전, 플래그, 저장(method 0)
+            putU32(vecZip, 0); putU32(vecZip, 0);                                          // 시각, CRC
+            putU32(vecZip, entry[0]); putU32(vecZip, 16);                                  // 압축/원래 크기
+            putU16(vecZip, static_cast<uint32_t>(strMember.size())); putU16(vecZip, 0); putU16(vecZip, 0);
+            putU16(vecZip, 0); putU16(vecZip, 0); putU32(vecZip, 0);
+            putU32(vecZip, entry[1]);
+            vecZip.insert(vecZip.end(), strMember.begin(), strMember.end());
+        }
+        const uint32_t nCdSize = static_cast<uint32_t>(vecZip.size()) - nCdOffset;
+        putU32(vecZip, 0x06054b50);
+        putU16(vecZip, 0); putU16(vecZip, 0); putU16(vecZip, 2); putU16(vecZip, 2);
+        putU32(vecZip, nCdSize); putU32(vecZip, nCdOffset); putU16(vecZip, 0);
+
+        const std::string strZipPath = (root / "bad.zip").string();
+        WriteMemoryToFile(strZipPath, vecZip.data(), vecZip.size());
+        ZipArchiveSource zip;
+        const bool bOpened = zip.Open(strZipPath);
+        InputItem zipItem;
+        ctx.Expect(bOpened && zip.GetMemberCount() == 0 && !zip.Next(zipItem) && zip.HasError(), "파일 밖을 가리키는 zip 멤버를 걸러내지 않음");
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 15) 조각 실행 (실제 프로세스): 임대를 쥔 채 멈춘 작업자를 강제 종료하면 다른 작업자 프로세스가 그 조각을
+    //     다음 세대로 넘겨받아 모든 조각이 끝나고, 병합 보고서에 빠진 행이 없는지. 작업자는 이 실행 파일 자신 (--shard-worker)
+    void TestShardProcesses(TestContext& ctx)
+    {
+        const std::string strExe = ProcessUtil::GetExecutablePath();
+        if (!ctx.Expect(!strExe.empty(), "실행 파일 경로를 알 수 없음"))
+            return;
+
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_shard_proc";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+
+        std::vector<ShardFile> vecFile;
+        for (int i = 0; i < 24; ++i)
+        {
+            ShardFile file;
+            file.strPath = "p/f" + std::to_string(i) + ".jpg";
+            file.nSize = 1000;
+            vecFile.push_back(file);
+        }
+        std::string strError;
+        const bool bCreated = ShardJob::Create(root.string(), vecFile, 6, SHARD_SPLIT_HASH, 1, std::vector<std::string>(), strError);
+        if (!ctx.Expect(bCreated, "작업 계획 실패: " + strError))
+            return;
+        ShardJob job;
+        if (!ctx.Expect(job.Open(root.string()), "매니페스트를 읽지 못함"))
+            return;
+
+        // 프로세스가 끝나기를 nTimeoutMs 까지 기다린다. 넘으면 강제 종료하고 -1
+        auto waitExit = [](ProcessUtil::Process& process, int nTimeoutMs)
+        {
+            int nExitCode = 0;
+            for (int nWaited = 0; nWaited < nTimeoutMs; nWaited += 20)
+            {
+                if (ProcessUtil::TryWait(process, nExitCode))
+                    return nExitCode;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            ProcessUtil::Kill(process);
+            while (!ProcessUtil::TryWait(process, nExitCode))
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return -1;
+        };
+
+        // 임대를 하나 쥐고 갱신만 계속하는 작업자
+        ProcessUtil::Process hung;
+        if (!ctx.Expect(ProcessUtil::Spawn({ strExe, "--shard-worker", root.string(), "--owner", "hung", "--hang" }, hung), "작업자를 띄우지 못함"))
+            return;
+        int nHungShard = -1;
+        for (int nWaited = 0; nHungShard < 0 && nWaited < 10000; nWaited += 20)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            for (int nShard = 0; nShard < job.GetShardCount(); ++nShard)
+            {
+                char szLease[32];
+                std::snprintf(szLease, sizeof(szLease), "shard_%04d.lease.1", nShard);
+                std::ifstream ifs(root / szLease);
+                std::string strOwner;
+                if (std::getline(ifs, strOwner) && strOwner == "hung")
+                    nHungShard = nShard;
+            }
+        }
+        ctx.Expect(nHungShard >= 0, "멈출 작업자가 조각을 임대하지 못함");
+        ProcessUtil::Kill(hung);
+        const int nHungExit = waitExit(hung, 5000);
+        ctx.Expect(nHungExit != 0 && nHungExit != 1 && nHungExit != 2, "강제 종료한 작업자가 정상 종료 코드를 냄: " + std::to_string(nHungExit));
+
+        std::vector<ProcessUtil::Process> vecWorker(2);
+        for (size_t i = 0; i < vecWorker.size(); ++i)
+            ctx.Expect(ProcessUtil::Spawn({ strExe, "--shard-worker", root.string(), "--owner", "w" + std::to_string(i) }, vecWorker[i]), "작업자를 띄우지 못함");
+        for (auto& worker : vecWorker)
+            ctx.Expect(waitExit(worker, 30000) == 0, "작업자가 정상 종료하지 않음");
+
+        const ShardProgress progress = job.GetProgress();
+        ctx.Expect(progress.nDone == 6 && progress.nReassigned == 1, "조각이 모두 끝나지 않았거나 재할당 수가 다름: done=" + std::to_string(progress.nDone)
+                   + " reassigned=" + std::to_string(progress.nReassigned));
+        ShardMergeStats mergeStats;
+        ctx.Expect(job.MergeReports((root / "merged.csv").string(), mergeStats) && mergeStats.nMissing == 0 && mergeStats.nRows == vecFile.size(),
+                   "병합 보고서 행 수가 다름: " + std::to_string(mergeStats.nRows));
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 16) pack 색인: 기록한 항목을 찾고, 항목 범위가 키 blob / pack 밖을 가리키거나 pack 이 잘리면 열지 않는지
+    //     헤더의 pack 수가 항목 수보다 많거나 항목 위치가 정렬되지 않은 색인도 열지 않는지
+    void TestPackIndex(TestContext& ctx)
+    {
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_pack";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        std::filesystem::create_directories(root, ec);
+        const std::string strBase = (root / "p").string();
+
+        const std::vector<uint8_t> vecData(300, 0x5A);
+        {
+            PackWriter writer(strBase);
+            for (int i = 0; i < 10; ++i)
+                writer.Append("k" + std::to_string(i) + ".webp", vecData.data(), vecData.size() - static_cast<size_t>(i), 8, 8);
+            ctx.Expect(writer.Finish(), "pack 기록 실패");
+        }
+
+        PackReader reader;
+        PackReader::Record record;
+        ctx.Expect(reader.Open(strBase) && reader.Find("k3.webp", record) && record.nSize == vecData.size() - 3, "기록한 항목을 찾지 못함");
+        reader.Close();
+
+        std::vector<uint8_t> vecIndex;
+        const std::string strIndexPath = PackFormat::GetIndexPath(strBase);
+        if (!ctx.Expect(ReadFileToMemory(strIndexPath, vecIndex), "색인을 읽지 못함"))
+            return;
+
+        // 색인 항목 하나를 고쳐 쓰고 열어 본다.
+        auto openPatched = [&](const std::function<void(PackIndexEntry&)>& patch)
+        {
+            std::vector<uint8_t> vecPatched = vecIndex;
+            PackIndexEntry entry;
+            std::memcpy(&entry, vecPatched.data() + sizeof(PackIndexHeader), sizeof(entry));
+            patch(entry);
+            std::memcpy(vecPatched.data() + sizeof(PackIndexHeader), &entry, sizeof(entry));
+            WriteMemoryToFile(strIndexPath, vecPatched.data(), vecPatched.size());
+            PackReader patched;
+            return patched.Open(strBase);
+        };
+        ctx.Expect(!openPatched([](PackIndexEntry& entry) { entry.nKeyLength = 0xFFFFFFF0u; }), "키 blob 밖을 가리키는 색인을 엶");
+        ctx.Expect(!openPatched([](PackIndexEntry& entry) { entry.nOffset = ~0ull - 4; }), "pack 밖을 가리키는 색인을 엶 (넘침)");
+        ctx.Expect(!openPatched([](PackIndexEntry& entry) { entry.nPackId = 7; }), "없는 pack 을 가리키는 색인을 엶");
+
+        // 색인 헤더를 고쳐 쓰고 열어 본다.
+        auto openPatchedHeader = [&](const std::function<void(PackIndexHeader&)>& patch)
+        {
+            std::vector<uint8_t> vecPatched = vecIndex;
+            PackIndexHeader header;
+            std::memcpy(&header, vecPatched.data(), sizeof(header));
+            patch(header);
+            std::memcpy(vecPatched.data(), &header, sizeof(header));
+            WriteMemoryToFile(strIndexPath, vecPatched.data(), vecPatched.size());
+            PackReader patched;
+            return patched.Open(strBase);
+        };
+        ctx.Expect(!openPatchedHeader([](PackIndexHeader& header) { header.nPackCount = 0xFFFFFFF0u; }), "항목 수보다 pack 수가 많은 색인을 엶");
+        ctx.Expect(!openPatchedHeader([](PackIndexHeader& header) { header.nEntryOffset += 4; header.nEntryCount -= 1; }), "정렬되지 않은 항목 위치의 색인을 엶");
+
+        // 색인 끝이 잘린 경우 / pack 이 잘린 경우
+        WriteMemoryToFile(strIndexPath, vecIndex.data(), vecIndex.size() - 5);
+        ctx.Expect(!reader.Open(strBase), "잘린 색인을 엶");
+        WriteMemoryToFile(strIndexPath, vecIndex.data(), vecIndex.size());
+        std::filesystem::resize_file(PackFormat::GetPackPath(strBase, 0), PackFormat::PACK_HEADER_BYTES + 100, ec);
+        ctx.Expect(!reader.Open(strBase), "잘린 pack 을 엶");
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // 17) 메모리 예산: 자리가 있으면 바로 들어가고, 반납하면 기다리던 작업이 깨고, 예산보다 큰 예약은 혼자 들어가며,
+    //     기다리는 큰 예약 뒤에 온 작은 예약은 끼어들지 않고, 취소한 작업은 줄에서 빠지는지
+    void TestMemoryBudget(TestContext& ctx)
+    {
+        // 기다리는 쪽 스레드가 줄에 섰는지는 nWaits 로 본다. (상한은 넉넉하게만 둔다)
+        auto waitFor = [](const std::function<bool()>& pfnDone)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!pfnDone() && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return pfnDone();
+        };
+
+        // 자리가 있으면 바로, 모자라면 반납할 때까지 기다린다.
+        {
+            MemoryBudget budget(100);
+            ctx.Expect(budget.Reserve(60, nullptr) && budget.Reserve(30, nullptr) && budget.GetStats().nWaits == 0, "자리가 있는데 바로 들어가지 못함");
+
+            std::atomic<bool> bAdmitted{ false };
+            std::thread waiter([&]() { bAdmitted = budget.Reserve(50, nullptr); });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 1; }) && !bAdmitted.load(), "예산이 모자란데 기다리지 않음");
+            budget.Release(60);
+            waiter.join();
+            ctx.Expect(bAdmitted.load() && budget.GetStats().nPeakReserved == 90, "반납한 뒤에 기다리던 작업이 들어가지 않음");
+            budget.Release(30);
+            budget.Release(50);
+        }
+
+        // 예산보다 큰 예약: 아무도 없으면 혼자 들어가고, 그동안 다른 예약은 기다린다.
+        {
+            MemoryBudget budget(100);
+            ctx.Expect(budget.Reserve(500, nullptr) && budget.GetStats().nOversize == 1, "예산보다 큰 예약이 혼자 들어가지 못함");
+
+            std::atomic<bool> bAdmitted{ false };
+            std::thread waiter([&]() { bAdmitted = budget.Reserve(10, nullptr); });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 1; }) && !bAdmitted.load(), "큰 예약이 혼자 들어간 동안 다른 예약이 같이 들어감");
+            budget.Release(500);
+            waiter.join();
+            ctx.Expect(bAdmitted.load(), "큰 예약을 반납한 뒤에 기다리던 작업이 들어가지 않음");
+            budget.Release(10);
+        }
+
+        // 도착 순서: 80 이 잡혀 있을 때 95 가 기다리면, 뒤에 온 10 은 자리가 있어도 95 뒤에 선다.
+        //   95 가 들어가면 10 이 들어갈 자리가 없으므로 95 를 반납할 때까지 10 은 계속 기다린다.
+        {
+            MemoryBudget budget(100);
+            budget.Reserve(80, nullptr);
+
+            std::atomic<bool> bLarge{ false };
+            std::atomic<bool> bSmall{ false };
+            std::thread large([&]() { bLarge = budget.Reserve(95, nullptr); });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 1; }), "큰 예약이 기다리지 않음");
+            std::thread small([&]() { bSmall = budget.Reserve(10, nullptr); });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 2; }) && !bSmall.load(), "작은 예약이 기다리는 큰 예약 앞으로 끼어듦");
+
+            budget.Release(80);
+            large.join();
+            ctx.Expect(bLarge.load() && !bSmall.load(), "먼저 기다린 큰 예약이 먼저 들어가지 않음");
+            budget.Release(95);
+            small.join();
+            ctx.Expect(bSmall.load() && budget.GetStats().nPeakReserved == 95, "큰 예약을 반납한 뒤에 작은 예약이 들어가지 않음");
+            budget.Release(10);
+        }
+
+        // 취소: 맨 앞에서 기다리던 작업이 취소되면 false 로 돌아오고, 뒤에 선 작업은 바로 들어간다.
+        {
+            MemoryBudget budget(100);
+            budget.Reserve(90, nullptr);
+
+            std::atomic<bool> bCancel{ false };
+            std::atomic<int> nCancelled{ -1 };
+            std::atomic<bool> bAdmitted{ false };
+            std::thread cancelled([&]() { nCancelled = budget.Reserve(50, &bCancel) ? 0 : 1; });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 1; }), "취소할 예약이 기다리지 않음");
+            std::thread behind([&]() { bAdmitted = budget.Reserve(5, nullptr); });
+            ctx.Expect(waitFor([&]() { return budget.GetStats().nWaits == 2; }) && !bAdmitted.load(), "뒤에 온 예약이 기다리는 예약 앞으로 끼어듦");
+
+            bCancel = true;
+            cancelled.join();
+            behind.join();
+            ctx.Expect(nCancelled.load() == 1, "취소했는데 예약됨");
+            ctx.Expect(bAdmitted.load() && budget.GetStats().nReservations == 2, "취소한 예약 뒤에 선 작업이 들어가지 않음");
+            budget.Release(90);
+            budget.Release(5);
+        }
+    }
+
+    // 18) 코퍼스 색인: 헤더 값이 맞고, 저장/불러오기 뒤에도 같으며, 크기나 수정 시각이 바뀐 파일만 다시 읽는지
+    void TestCorpusIndex(TestContext& ctx)
+    {
+        // SOI [DRI] SOFn SOS + 채움 바이트. 색인은 SOS 까지만 읽으므로 엔트로피 데이터는 필요 없다.
+        auto makeHeader = [](int nWidth, int nHeight, uint8_t marker, int nComponents, uint8_t lumaSampling, int nRestart, size_t nPadding)
+        {
+            std::vector<uint8_t> vecData = { 0xFF, 0xD8 };
+            if (nRestart > 0)
+                vecData.insert(vecData.end(), { 0xFF, 0xDD, 0x00, 0x04, static_cast<uint8_t>(nRestart >> 8), static_cast<uint8_t>(nRestart) });
+
+            const int nLength = 8 + nComponents * 3;
+            vecData.insert(vecData.end(), { 0xFF, marker, static_cast<uint8_t>(nLength >> 8), static_cast<uint8_t>(nLength), 8,
+                                            static_cast<uint8_t>(nHeight >> 8), static_cast<uint8_t>(nHeight), static_cast<uint8_t>(nWidth >> 8), static_cast<uint8_t>(nWidth),
+                                            static_cast<uint8_t>(nComponents) });
+            for (int c = 0; c < nComponents; ++c)
+                vecData.insert(vecData.end(), { static_cast<uint8_t>(c + 1), c == 0 ? lumaSampling : static_cast<uint8_t>(0x11), 0 });
+
+            vecData.insert(vecData.end(), { 0xFF, 0xDA, 0x00, 0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00 });
+            vecData.resize(vecData.size() + nPadding, 0x55);
+            return vecData;
+        };
+
+        const std::filesystem::path root = std::filesystem::temp_directory_path() / "webptest_corpus_index";
+        std::error_code ec;
+        std::filesystem::remove_all(root, ec);
+        std::filesystem::create_directories(root, ec);
+
+        const std::string strGray = (root / "gray.jpg").string();
+        const std::string strProgressive = (root / "progressive.jpg").string();
+        const std::string strCorrupt = (root / "corrupt.jpg").string();
+        const std::string strMissing = (root / "missing.jpg").string();
+        auto writeFile = [](const std::string& strPath, const std::vector<uint8_t>& vecData) { return WriteMemoryToFile(strPath, vecData.data(), vecData.size()); };
+        writeFile(strGray, makeHeader(640, 480, 0xC0, 1, 0x11, 0, 100));
+        writeFile(strProgressive, makeHeader(1920, 1080, 0xC2, 3, 0x22, 4, 100));
+        writeFile(strCorrupt, std::vector<uint8_t>(64, 0x00));
+        const std::vector<std::string> vecPath = { strGray, strProgressive, strCorrupt, strMissing };
+
+        CorpusIndex index;
+        CorpusScanStats stats = index.Update(vecPath, 2);
+        ctx.Expect(stats.nScanned == 4 && stats.nReused == 0, "처음 검사인데 다시 읽은 수가 다름");
+
+        const CorpusFileInfo* pGray = index.Find(strGray);
+        const CorpusFileInfo* pProgressive = index.Find(strProgressive);
+        ctx.Expect(pGray && pGray->info.eStatus == JPEG_SCAN_OK && pGray->info.nWidth == 640 && pGray->info.nHeight == 480
+                   && pGray->info.nSubSampling == JPEG_SUBSAMP_GRAY && !pGray->info.bProgressive && pGray->info.nRestartInterval == 0, "그레이 헤더 값이 다름");
+        ctx.Expect(pProgressive && pProgressive->info.eStatus == JPEG_SCAN_OK && pProgressive->info.nWidth == 1920 && pProgressive->info.nHeight == 1080
+                   && pProgressive->info.nSubSampling == JPEG_SUBSAMP_420 && pProgressive->info.bProgressive && pProgressive->info.nRestartInterval == 4, "progressive 헤더 값이 다름");
+        ctx.Expect(index.Find(strCorrupt) && index.Find(strCorrupt)->info.eStatus == JPEG_SCAN_CORRUPT, "손상 파일을 손상으로 보지 않음");
+        ctx.Expect(index.Find(strMissing) && index.Find(strMissing)->info.eStatus == JPEG_SCAN_UNREADABLE, "없는 파일을 읽을 수 없음으로 보지 않음");
+
+        // 저장 -> 불러오기: 모든 항목이 그대로 돌아오고, 바뀐 파일이 없으면 아무것도 다시 읽지 않는다.
+        const std::string strIndexPath = (root / "corpus.wci").string();
+        ctx.Expect(index.Save(strIndexPath), "색인 저장 실패");
+        CorpusIndex loaded;
+        ctx.Expect(loaded.Load(strIndexPath) && loaded.GetFiles().size() == index.GetFiles().size(), "색인을 다시 불러오지 못함");
+        for (const auto& file : index.GetFiles())
+        {
+            const CorpusFileInfo* pLoaded = loaded.Find(file.strPath);
+            ctx.Expect(pLoaded && pLoaded->nFileSize == file.nFileSize && pLoaded->nModifiedTime == file.nModifiedTime && pLoaded->info.eStatus == file.info.eStatus
+                       && pLoaded->info.nWidth == file.info.nWidth && pLoaded->info.nHeight == file.info.nHeight && pLoaded->info.nSubSampling == file.info.nSubSampling
+                       && pLoaded->info.nComponents == file.info.nComponents && pLoaded->info.bProgressive == file.info.bProgressive
+                       && pLoaded->info.nRestartInterval == file.info.nRestartInterval, "불러온 항목이 다름: " + file.strPath);
+        }
+        stats = loaded.Update(vecPath, 2);
+        ctx.Expect(stats.nReused == 3 && stats.nScanned == 1, "바뀐 파일이 없는데 다시 읽음 (없는 파일만 다시 확인해야 함)");
+
+        // 크기만 바뀜 (수정 시각은 되돌림) -> 다시 읽는다.
+        const auto grayTime = std::filesystem::last_write_time(strGray, ec);
+        writeFile(strGray, makeHeader(800, 600, 0xC0, 1, 0x11, 0, 200));
+        std::filesystem::last_write_time(strGray, grayTime, ec);
+
+        // 수정 시각만 바뀜 (크기는 같음) -> 다시 읽는다.
+        const auto progressiveTime = std::filesystem::last_write_time(strProgressive, ec);
+        writeFile(strProgressive, makeHeader(1280, 720, 0xC2, 3, 0x22, 4, 100));
+        std::filesystem::last_write_time(strProgressive, progressiveTime + std::chrono::seconds(10), ec);
+
+        stats = loaded.Update(vecPath, 2);
+        ctx.Expect(stats.nScanned == 3 && stats.nReused == 1, "크기/수정 시각이 바뀐 파일만 다시 읽지 않음");
+        pGray = loaded.Find(strGray);
+        pProgressive = loaded.Find(strProgressive);
+        ctx.Expect(pGray && pGray->info.nWidth == 800 && pGray->info.nHeight == 600, "크기가 바뀐 파일의 새 헤더가 반영되지 않음");
+        ctx.Expect(pProgressive && pProgressive->info.nWidth == 1280 && pProgressive->info.nHeight == 720, "수정 시각이 바뀐 파일의 새 헤더가 반영되지 않음");
+
+        // 목록에서 빠진 파일은 색인에서도 빠진다. 형식이 다른 색인 파일은 불러오지 않는다.
+        stats = loaded.Update({ strGray, strProgressive }, 2);
+        ctx.Expect(stats.nRemoved == 2 && loaded.GetFiles().size() == 2 && !loaded.Find(strCorrupt), "빠진 파일이 색인에 남음");
+        ctx.Expect(!CorpusIndex().Load(strCorrupt), "형식이 다른 색인 파일을 불러옴");
+
+        std::filesystem::remove_all(root, ec);
+    }
+
+    // JSON 문법만 확인하는 작은 파서 (값 하나 + 뒤는 공백만)
+    class JsonChecker
+    {
+    public:
+        explicit JsonChecker(const std::string& strText) : m_strText(strText) {}
+
+        bool Check()
+        {
+            if (!Value())
+                return false;
+            SkipSpace();
+            return m_nPos == m_strText.size();
+        }
+
+    private:
+        void SkipSpace()
+        {
+            while (m_nPos < m_strText.size() && std::strchr(" \t\r\n", m_strText[m_nPos]))
+                ++m_nPos;
+        }
+
+        bool Eat(char ch)
+        {
+            SkipSpace();
+            if (m_nPos < m_strText.size() && m_strText[m_nPos] == ch)
+            {
+                ++m_nPos;
+                return true;
+            }
+            return false;
+        }
+
+        bool String()
+        {
+            if (!Eat('"'))
+                return false;
+            while (m_nPos < m_strText.size())
+            {
+                const unsigned char ch = static_cast<unsigned char>(m_strText[m_nPos++]);
+                if (ch == '"')
+                    return true;
+                if (ch < 0x20)
+                    return false;
+                if (ch == '\\')
+                {
+                    if (m_nPos >= m_strText.size())
+                        return false;
+                    const char escape = m_strText[m_nPos++];
+                    if (escape == 'u')
+                    {
+                        for (int i = 0; i < 4; ++i, ++m_nPos)
+                        {
+                            if (m_nPos >= m_strText.size() || !std::isxdigit(static_cast<unsigned char>(m_strText[m_nPos])))
+                                return false;
+                        }
+                    }
+                    else if (!std::strchr("\"\\/bfnrt", escape))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool Number()
+        {
+            SkipSpace();
+            const size_t nStart = m_nPos;
+            if (m_nPos < m_strText.size() && m_strText[m_nPos] == '-')
+                ++m_nPos;
+            size_t nDigits = 0;
+            while (m_nPos < m_strText.size() && std::isdigit(static_cast<unsigned char>(m_strText[m_nPos])))
+                ++m_nPos, ++nDigits;
+            if (m_nPos < m_strText.size() && m_strText[m_nPos] == '.')
+            {
+                ++m_nPos;
+                size_t nFraction = 0;
+                while (m_nPos < m_strText.size() && std::isdigit(static_cast<unsigned char>(m_strText[m_nPos])))
+                    ++m_nPos, ++nFraction;
+                if (nFraction == 0)
+                    return false;
+            }
+            return nDigits > 0 && m_nPos > nStart;
+        }
+
+        bool Value()
+        {
+            SkipSpace();
+            if (m_nPos >= m_strText.size())
+                return false;
+
+            const char ch = m_strText[m_nPos];
+            if (ch == '{')
+            {
+                ++m_nPos;
+                if (Eat('}'))
+                    return true;
+                do
+                {
+                    if (!String() || !Eat(':') || !Value())
+                        return false;
+                } while (Eat(','));
+                return Eat('}');
+            }
+            if (ch == '[')
+            {
+                ++m_nPos;
+                if (Eat(']'))
+                    return true;
+                do
+                {
+                    if (!Value())
+                        return false;
+                } while (Eat(','));
+                return Eat(']');
+            }
+            if (ch == '"')
+                return String();
+            for (const char* pszWord : { "true", "false", "null" })
+            {
+                if (m_strText.compare(m_nPos, std::strlen(pszWord), pszWord) == 0)
+                {
+                    m_nPos += std::strlen(pszWord);
+                    return true;
+                }
+            }
+            return Number();
+        }
+
+        const std::string& m_strText;
+        size_t m_nPos = 0;
+    };
+
+    // 19) 구간 기록: 내보낸 trace 가 올바른 JSON 이고, 링 버퍼가 넘치면 가장 오래된 구간부터 버리며, 이름의 특수 문자가 이스케이프되는지
+    void TestTraceRecorder(TestContext& ctx)
+    {
+        TraceRecorder trace(4);
+        trace.SetThreadName("main \"quoted\" \\ name");
+        trace.SetItemName(7, "dir\\a \"b\"\n\x01.jpg");
+
+        trace.BeginItem(7);
+        trace.Record("decode", 1000, 3500);
+        trace.EndItem();
+        trace.Record("idle", 4000, 4000);
+
+        // 작업자: 10 개를 남기면 마지막 4 개만 남는다. (시작 시각 = 번호 x 1 µs)
+        std::thread worker([&]()
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                trace.BeginItem(static_cast<uint64_t>(i));
+                trace.Record("encode", i * 1000LL, i * 1000LL + 500);
+            }
+            trace.EndItem();
+        });
+        worker.join();
+
+        ctx.Expect(trace.GetSpanCount() == 6 && trace.GetDroppedCount() == 6, "구간 수가 다름: " + std::to_string(trace.GetSpanCount()) + " / 버림 " + std::to_string(trace.GetDroppedCount()));
+
+        std::ostringstream os;
+        ctx.Expect(trace.WriteChromeTrace(os), "trace 쓰기 실패");
+        const std::string strJson = os.str();
+        ctx.Expect(JsonChecker(strJson).Check(), "trace 가 올바른 JSON 이 아님");
+
+        auto count = [&](const std::string& strNeedle)
+        {
+            size_t nCount = 0;
+            for (size_t nPos = strJson.find(strNeedle); nPos != std::string::npos; nPos = strJson.find(strNeedle, nPos + 1))
+                ++nCount;
+            return nCount;
+        };
+        ctx.Expect(count("\"ph\":\"X\"") == 6 && count("\"thread_name\"") == 2, "이벤트/스레드 수가 다름");
+        ctx.Expect(count("\"name\":\"encode\"") == 4 && count("\"ts\":6.000") == 1 && count("\"ts\":9.000") == 1 && count("\"ts\":5.000") == 0,
+                   "넘친 링 버퍼에서 가장 오래된 구간이 남음");
+        ctx.Expect(count("\"ts\":1.000,\"dur\":2.500,\"args\":{\"item\":7,\"file\":\"dir\\\\a \\\"b\\\"\\u000a\\u0001.jpg\"}") == 1,
+                   "항목 이름/시간이 다르게 기록됨");
+        ctx.Expect(count("\"name\":\"worker 1\"") == 1 && count("main \\\"quoted\\\" \\\\ name") == 1, "스레드 이름이 다름");
+    }
+
+    // 20) 로거: 여러 스레드가 링에 넣은 기록이 빠짐없이, 스레드 안에서는 넣은 순서대로, 전체는 시간순으로 출력되는지
+    void TestLogger(TestContext& ctx)
+    {
+        const int THREADS = 4;
+        const int MESSAGES = 2000;
+
+        std::FILE* pFile = std::tmpfile();
+        if (!ctx.Expect(pFile != nullptr, "임시 파일을 만들지 못함"))
+            return;
+
+        LogOption option;
+        option.eLevel = LOG_LEVEL_INFO;
+        option.eFormat = LOG_FORMAT_KV;
+        option.nBurst = THREADS * MESSAGES * 2;   // 빈도 제한으로 생략되지 않게
+        option.nRingSize = MESSAGES + 16;         // 출력 스레드가 늦어도 링이 넘치지 않게
+        option.pOutput = pFile;
+        Logger::Configure(option);
+        const LogSummary before = Logger::GetSummary();
+
+        std::vector<std::thread> vecThread;
+        for (int t = 0; t < THREADS; ++t)
+        {
+            vecThread.emplace_back([t]()
+            {
+                for (int i = 0; i < MESSAGES; ++i)
+                    LogInfo("order", std::to_string(t) + ":" + std::to_string(i));
+            });
+        }
+        for (auto& thread : vecThread)
+            thread.join();
+        LogDebug("order", "debug 는 INFO 수준에서 출력하지 않음");
+        Logger::Flush();
+        const LogSummary after = Logger::GetSummary();
+        Logger::Configure(LogOption());
+
+        std::string strText;
+        std::rewind(pFile);
+        char szBuffer[4096];
+        for (size_t nRead; (nRead = std::fread(szBuffer, 1, sizeof(szBuffer), pFile)) > 0;)
+            strText.append(szBuffer, nRead);
+        std::fclose(pFile);
+
+        std::vector<int> vecNext(THREADS, 0);
+        bool bOrdered = true;
+        bool bTimeOrdered = true;
+        double fLastTime = -1.0;
+        size_t nLines = 0;
+        std::istringstream is(strText);
+        for (std::string strLine; std::getline(is, strLine);)
+        {
+            const size_t nMsg = strLine.find("msg=\"");
+            if (strLine.find("cat=order") == std::string::npos || nMsg == std::string::npos)
+                continue;
+            ++nLines;
+
+            const double fTime = std::strtod(strLine.c_str() + 2, nullptr);
+            bTimeOrdered = bTimeOrdered && fTime >= fLastTime;
+            fLastTime = fTime;
+
+            int nThread = -1;
+            int nIndex = -1;
+            if (std::sscanf(strLine.c_str() + nMsg + 5, "%d:%d", &nThread, &nIndex) != 2 || nThread < 0 || nThread >= THREADS || vecNext[nThread] != nIndex)
+                bOrdered = false;
+            else
+                ++vecNext[nThread];
+        }
+
+        ctx.Expect(nLines == static_cast<size_t>(THREADS) * MESSAGES && bOrdered, "기록이 빠졌거나 스레드 안의 순서가 바뀜: " + std::to_string(nLines) + " 줄");
+        ctx.Expect(bTimeOrdered, "출력이 시간순이 아님");
+        ctx.Expect(after.nCount[LOG_LEVEL_INFO] - before.nCount[LOG_LEVEL_INFO] == static_cast<uint64_t>(THREADS) * MESSAGES
+                   && after.nDropped == before.nDropped && after.nSuppressed == before.nSuppressed, "요약의 기록/버림/생략 수가 다름");
+    }
+
+    struct TestCase
+    {
+        const char* pszName;
+        void (*pfnRun)(TestContext&);
+    };
+
+    const TestCase g_testCases[] =
+    {
+        { "range_mapping", TestRangeMapping },
+        { "round_trip",    TestRoundTrip },
+        { "crop",          TestCrop },
+        { "errors",        TestErrors },
+        { "pipeline",      TestPipeline },
+        { "priority_lanes", TestPriorityLanes },
+        { "worker_placement", TestWorkerPlacement },
+        { "conversion_cache", TestConversionCache },
+        { "output_writer", TestOutputWriter },
+        { "animation",     TestAnimation },
+        { "lossless",      TestLossless },
+        { "shard_job",     TestShardJob },
+        { "cost_model",    TestCostModel },
+        { "archive_paths", TestArchivePaths },
+        { "shard_processes", TestShardProcesses },
+        { "pack_index",    TestPackIndex },
+        { "memory_budget", TestMemoryBudget },
+        { "corpus_index",  TestCorpusIndex },
+        { "trace_recorder", TestTraceRecorder },
+        { "logger",        TestLogger },
+    };
+}
+
+int RunCorrectnessTests(const CliArgs& args)
+{
+    const std::string strFilter = args.GetString("filter");
+
+    int nFailures = 0;
+    for (const auto& test : g_testCases)
+    {
+        if (!strFilter.empty() && std::string(test.pszName).find(strFilter) == std::string::npos)
+            continue;
+
+        TestContext ctx(test.pszName);
+        test.pfnRun(ctx);
+        std::cout << (ctx.GetFailureCount() == 0 ? "[PASS] " : "[FAIL] ") << test.pszName << "\n";
+        nFailures += ctx.GetFailureCount();
+    }
+    return nFailures;
+}
+
+int RunShardTestWorker(const CliArgs& args)
+{
+    ShardJob job;
+    if (!job.Open(args.GetString("shard-worker")))
+        return 2;
+
+    const std::string strOwner = args.GetString("owner", ShardJob::MakeOwnerName());
+    const bool bHang = args.Has("hang");
+    for (;;)
+    {
+        int nGeneration = 0;
+        const int nShard = job.Claim(strOwner, nGeneration);
+        if (nShard < 0)
+        {
+            // 남은 조각은 다른 작업자가 임대 중이다. 끝나거나 만료될 때까지 기다린다.
+            const ShardProgress progress = job.GetProgress();
+            if (progress.nDone == progress.nShards)
+                return 0;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            continue;
+        }
+
+        std::vector<std::string> vecPath;
+        job.LoadShardFiles(nShard, vecPath);
+        {
+            std::ofstream ofs(job.GetWorkReportPath(nShard, nGeneration));
+            ofs << "name,status,width,height,in_bytes,out_bytes,quality,psnr,ssim,verify\n";
+            for (const auto& strPath : vecPath)
+                ofs << strPath << ",ok,8,8,10,20,80,,,-\n";
+        }
+
+        // 변환하는 동안처럼 임대를 갱신한다. --hang 이면 강제 종료될 때까지 갱신만 한다.
+        bool bLost = false;
+        for (int i = 0; bHang || i < 3; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (!job.Renew(nShard, nGeneration))
+            {
+                bLost = true;
+                break;
+            }
+        }
+        if (!bLost)
+            job.Complete(nShard, nGeneration, "owner=" + strOwner);
+    }
+}
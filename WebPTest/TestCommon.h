@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include "BatchPipeline.h"
+#include "CliArgs.h"      // WebPCli 의 명령행 파서를 그대로 쓴다. (헤더만 있음)
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// WebPTest 공용 선언
+//   정확성 테스트(TestCases.cpp)와 성능 회귀 벤치마크(PerfBench.cpp)가 WebPEngine 의 실제 변환 경로를 그대로 사용한다.
+
+// 테스트 하나의 실패 기록. Expect 가 false 를 받으면 메시지를 출력하고 실패로 남긴다.
+class TestContext
+{
+public:
+    explicit TestContext(const char* pszName) : m_pszName(pszName) {}
+
+    bool Expect(bool bCondition, const std::string& strMessage)
+    {
+        if (!bCondition)
+        {
+            ++m_nFailures;
+            std::cerr << "  FAIL [" << m_pszName << "] " << strMessage << "\n";
+        }
+        return bCondition;
+    }
+
+    int GetFailureCount() const { return m_nFailures; }
+
+private:
+    const char* m_pszName;
+    int m_nFailures = 0;
+};
+
+// 메모리의 JPEG 목록을 차례로 내보내는 원천 (항목 이름은 "item<번호>")
+class MemoryJpegSource : public IInputSource
+{
+public:
+    explicit MemoryJpegSource(const std::vector<std::vector<uint8_t>>& vecJpeg) : m_vecJpeg(vecJpeg) {}
+
+    bool Next(InputItem& item) override
+    {
+        if (m_nIndex >= m_vecJpeg.size())
+            return false;
+        item.strName = "item" + std::to_string(m_nIndex);
+        item.vecData = m_vecJpeg[m_nIndex++];
+        return true;
+    }
+
+private:
+    const std::vector<std::vector<uint8_t>>& m_vecJpeg;
+    size_t m_nIndex = 0;
+};
+
+// 그레이 픽셀 -> JPEG (TurboJPEG). 테스트 입력을 파일 없이 만든다.
+bool EncodeGrayJpeg(const std::vector<uint8_t>& vecPixel, int nWidth, int nHeight, int nQuality, std::vector<uint8_t>& vecJpeg);
+
+// 정확성 테스트 전체 실행. 실패한 검사 수를 돌려준다.
+int RunCorrectnessTests(const CliArgs& args);
+
+// 조각 실행 테스트의 작업자 프로세스 (WebPTest --shard-worker <작업 폴더> --owner 이름 [--hang])
+//   조각을 임대해서 가짜 보고서를 쓰고 완료한다. --hang 이면 첫 조각의 임대를 갱신만 하며 멈춰 있다.
+int RunShardTestWorker(const CliArgs& args);
+
+// 성능 측정 + 기준선 비교. 0 = 통과, 1 = 회귀, 2 = 실행 오류
+int RunPerfBench(const CliArgs& args);
@@ -1,166 +1,62 @@
-// jpeg_to_webp_turbo_webpencode.cpp
-// Windows, C++14 
-// : libjpeg-turbo JPEG ڵϰ libwebp WebPEncodeRGB ñ״ó  ս WebP 
-// ʿ ̺귯: libjpeg-turbo (turbojpeg.h / turbojpeg.lib), libwebp (webp/encode.h / webp.lib)
-//  : turbojpeg.lib, webp.lib ũ;   ʿ DLL  exe   
-
-#include <cstdio>
-#include <cstdlib>
-#include <cstdint>
-#include <cstring>
-#include <string>
-#include <vector>
-#include <iostream>
-#include <fstream>
-
-#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG API
-#include <webp/encode.h>  // libwebp ڴ (WebPEncodeRGB, WebPFree )
-
-//  ̳ʸ о vector 
-static bool ReadFileToMemory(const std::string& strPath, std::vector<uint8_t>& vecOut)
+﻿// WebPTest: WebPEngine 정확성 테스트 + 성능 회귀 벤치마크
+//   WebPTest                              정확성 테스트 후 성능 측정 (기준선이 있으면 비교)
+//   WebPTest --only correctness           정확성 테스트만
+//   WebPTest --only perf --baseline perf_baseline.txt --max-regression 10
+//   WebPTest --only perf --write-baseline perf_baseline.txt   현재 측정값을 기준선으로 저장
+//   WebPTest --shard-worker <작업 폴더> ...   shard_processes 테스트가 띄우는 작업자 (직접 실행하지 않음)
+// 종료 코드: 0 = 모두 통과, 1 = 테스트 실패 또는 처리량 회귀, 2 = 인자/실행 오류
+
+#include "TestCommon.h"
+#include <turbojpeg.h>    // libjpeg-turbo TurboJPEG 3 API (tj3Compress8)
+
+bool EncodeGrayJpeg(const std::vector<uint8_t>& vecPixel, int nWidth, int nHeight, int nQuality, std::vector<uint8_t>& vecJpeg)
 {
-    std::ifstream ifs(strPath, std::ios::binary | std::ios::ate); //     б ͸  (ate) ġŴ(̷ ϸ ٷ  ũ⸦ ȹ)
-    if (!ifs)
-        return false; //  ⿡ н false ȯ
-
-    std::streamsize sz = ifs.tellg();
-    ifs.seekg(0, std::ios::beg);
-    
-    if (sz <= 0)
-    {
-        vecOut.clear();
-        return true;
-    }
-    
-    vecOut.resize(static_cast<size_t>(sz)); //  ũ⸦  ũ⸸ŭ  б ۸ غմϴ. (sz size_t ĳƮ)
-    if (!ifs.read(reinterpret_cast<char*>(vecOut.data()), sz))
+    tjhandle tj = tj3Init(TJINIT_COMPRESS);
+    if (!tj)
         return false;
 
-    return true;
-}
+    tj3Set(tj, TJPARAM_QUALITY, nQuality);
+    tj3Set(tj, TJPARAM_SUBSAMP, TJSAMP_GRAY);
 
-// ޸(+ũ) Ͽ  
-static bool WriteMemoryToFile(const std::string& path, const uint8_t* data, size_t size) {
-    std::ofstream ofs(path, std::ios::binary);
-    
-    if (!ofs)
-        return false;
-    
-    ofs.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
-    
-    return !!ofs;
+    unsigned char* pJpeg = nullptr;
+    size_t nJpegSize = 0;
+    const bool bOk = tj3Compress8(tj, vecPixel.data(), nWidth, nWidth, nHeight, TJPF_GRAY, &pJpeg, &nJpegSize) == 0;
+    if (bOk)
+        vecJpeg.assign(pJpeg, pJpeg + nJpegSize);
+
+    tj3Free(pJpeg);
+    tj3Destroy(tj);
+    return bOk;
 }
 
-// JPEG -> WebP ȯ (ս) : libjpeg-turbo RGB ڵ  WebPEncodeRGB ȣ
-bool ConvertJpegToWebP_Lossy_TurboJPEG_WebPEncodeRGB(const std::string& jpegPath, const std::string& webpPath, float quality)
+int main(int argc, char** argv)
 {
-    // 1) JPEG  ޸𸮷 б
-    std::vector<uint8_t> vecJpegData;
-    if (!ReadFileToMemory(jpegPath, vecJpegData))
-    {
-        std::cerr << "Error: JPEG   ߽ϴ: " << jpegPath << "\n";
-        return false;
-    }
-
-    // 2) TurboJPEG ڴ ʱȭ
-    tjhandle tj = tjInitDecompress(); // TurboJPEG ڴ ڵ 
-    if (!tj)
-    {
-        std::cerr << "Error: tjInitDecompress : " << tjGetErrorStr() << "\n";
-        return false;
-    }
-
-    int nWidth = 0, nHeight = 0, nSubSamp = 0, nColorSpace = 0;
-    
-    //  ޸𸮿 ε JPEG Ʈ(jpegData)  ĽϿ width/height/subsamp/colorspace  ϴ.
-    if (tjDecompressHeader3(tj, vecJpegData.data(), static_cast<unsigned long>(vecJpegData.size()), &nWidth, &nHeight, &nSubSamp, &nColorSpace) != 0)
-    {
-        std::cerr << "Error: tjDecompressHeader3 : " << tjGetErrorStr() << "\n";
-        tjDestroy(tj);
-        return false;
-    }
+    const CliArgs args(argc, argv, 1);
+    if (args.Has("shard-worker"))
+        return RunShardTestWorker(args);
 
-    if (nWidth <= 0 || nHeight <= 0) {
-        std::cerr << "Error: ߸ ̹ ũ: " << nWidth << "x" << nHeight << "\n";
-        tjDestroy(tj);
-        return false;
-    }
-
-    // 3) RGB  Ҵ (3Ʈ per pixel)
-    const int nPixelSize = 3;
-    const int nStride = nWidth * nPixelSize;
-    size_t nNeeded = static_cast<size_t>(nWidth) * static_cast<size_t>(nHeight) * static_cast<size_t>(nPixelSize);
-    //  ÷ο ˻
-    if (nNeeded == 0 || nNeeded / nPixelSize / static_cast<size_t>(nHeight) != static_cast<size_t>(nWidth))
+    const std::string strOnly = args.GetString("only");
+    if (!strOnly.empty() && strOnly != "correctness" && strOnly != "perf")
     {
-        std::cerr << "Error: ̹ ũ  (÷ο )\n";
-        tjDestroy(tj);
-        return false;
+        std::cerr << "Error: --only 는 correctness 또는 perf 여야 합니다: " << strOnly << "\n";
+        return 2;
     }
 
-    uint8_t* pszRgbBuffer = static_cast<uint8_t*>(std::malloc(nNeeded));
-    if (!pszRgbBuffer)
+    int nExitCode = 0;
+    if (strOnly.empty() || strOnly == "correctness")
     {
-        std::cerr << "Error: RGB  Ҵ \n";
-        tjDestroy(tj);
-        return false;
+        const int nFailures = RunCorrectnessTests(args);
+        std::cout << "correctness: " << (nFailures == 0 ? "PASS" : "FAIL") << " (failures=" << nFailures << ")\n";
+        if (nFailures > 0)
+            nExitCode = 1;
     }
-    std::memset(pszRgbBuffer, 0, nNeeded);
 
-    // 4) JPEG -> RGB ڵ (TJPF_RGB: R,G,B )
-    if (tjDecompress2(tj, vecJpegData.data(), static_cast<unsigned long>(vecJpegData.size()), pszRgbBuffer, nWidth, nStride, nHeight, TJPF_RGB, 0 /* flags */) != 0)
+    if (strOnly.empty() || strOnly == "perf")
     {
-        std::cerr << "Error: tjDecompress2 : " << tjGetErrorStr() << "\n";
-        std::free(pszRgbBuffer);
-        tjDestroy(tj);
-        return false;
-    }
-
-    //  ̻ TurboJPEG ڵ ʿ 
-    tjDestroy(tj);
-
-    // 5) WebPEncodeRGB ȣ
-    uint8_t* pszWebpData = nullptr;
-    size_t nWebpSize = WebPEncodeRGB(pszRgbBuffer, nWidth, nHeight, nStride, quality, &pszWebpData);
-    if (nWebpSize == 0 || pszWebpData == nullptr) {
-        std::cerr << "Error: WebPEncodeRGB  ( ũ 0 Ǵ NULL )\n";
-        std::free(pszRgbBuffer);
-        // webpData ҴǾ webpSize==0  WebPFree ϰ ȣ
-        if (pszWebpData)
-            WebPFree(pszWebpData);
-
-        return false;
+        const int nPerf = RunPerfBench(args);
+        if (nPerf > nExitCode)
+            nExitCode = nPerf;
     }
 
-    // 6)  Ϸ 
-    bool wrote = WriteMemoryToFile(webpPath, pszWebpData, nWebpSize);
-    if (!wrote) {
-        std::cerr << "Error: WebP   : " << webpPath << "\n";
-        WebPFree(pszWebpData);
-        std::free(pszRgbBuffer);
-        return false;
-    }
-
-    // 7) 
-    WebPFree(pszWebpData);  // libwebp Ҵ ޸ 
-    std::free(pszRgbBuffer);
-
-    return true;
+    return nExitCode;
 }
-
-int main(int argc, char** argv)
-{
-    std::string inPath = "Crater.jpg";
-    std::string outPath = "Output.webp";
-    float quality = 80.0f;
-
-    bool ok = ConvertJpegToWebP_Lossy_TurboJPEG_WebPEncodeRGB(inPath, outPath, quality);
-    if (ok) {
-        std::cout << "ȯ : " << outPath << "\n";
-        return 0;
-    }
-    else {
-        std::cerr << "ȯ \n";
-        return 2;
-    }
-}
\ No newline at end of file